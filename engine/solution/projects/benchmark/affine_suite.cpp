@@ -0,0 +1,168 @@
+﻿#include "include.hpp"
+#include "benchmark.hpp"
+
+namespace
+{
+	// 比べるための 4x4 の逆行列 (部分ピボット選択の Gauss-Jordan)
+	matrix4x4 inverse_4x4(const matrix4x4& m)
+	{
+		std::array<std::array<float, 8>, 4> a = {};
+		for(auto y = 0u; y < 4; ++y)
+		{
+			for(auto x = 0u; x < 4; ++x) a[y][x] = m.at(y * 4 + x);
+			a[y][4 + y] = 1.0f;
+		}
+
+		for(auto column = 0u; column < 4; ++column)
+		{
+			auto pivot = column;
+			for(auto y = column + 1; y < 4; ++y)
+			{
+				if(std::abs(a[y][column]) > std::abs(a[pivot][column])) pivot = y;
+			}
+			std::swap(a[column], a[pivot]);
+
+			const auto& scale = 1.0f / a[column][column];
+			for(auto& value : a[column]) value *= scale;
+
+			for(auto y = 0u; y < 4; ++y)
+			{
+				if(y == column) continue;
+
+				const auto& factor = a[y][column];
+				for(auto x = 0u; x < 8; ++x) a[y][x] -= factor * a[column][x];
+			}
+		}
+
+		matrix4x4 result;
+		for(auto y = 0u; y < 4; ++y)
+		{
+			for(auto x = 0u; x < 4; ++x) result.at(y * 4 + x) = a[y][4 + x];
+		}
+		return result;
+	}
+
+	// 行ベクトル形式の p * m
+	vector3 transform_point_4x4(const matrix4x4& m, const vector3& p)
+	{
+		return vector3
+		(
+			p.x() * m.at(0u) + p.y() * m.at(4u) + p.z() * m.at(8u) + m.at(12u),
+			p.x() * m.at(1u) + p.y() * m.at(5u) + p.z() * m.at(9u) + m.at(13u),
+			p.x() * m.at(2u) + p.y() * m.at(6u) + p.z() * m.at(10u) + m.at(14u)
+		);
+	}
+}
+
+namespace benchmark
+{
+	/*
+		affine3x4 (3x4, SSE) と matrix4x4 の比較
+		変換は 回転 (任意の軸) x 拡縮 x 平行移動 で作り、inverse_rigid だけは拡縮なしの組を使う
+	*/
+	bool run_affine_benchmark(const options& options, core::job_system&)
+	{
+		const auto& count = options.pick<size_t>(1 << 16, 1024);
+
+		std::vector<float> values(count * 8);
+		math::philox4x32(79).fill_uniform(values, -1.0f, 1.0f);
+
+		std::vector<affine3x4> affines(count);
+		std::vector<affine3x4> rigids(count);
+		std::vector<matrix4x4> matrices(count);
+		std::vector<vector3> points(count);
+		for(size_t i = 0; i < count; ++i)
+		{
+			const auto* v = values.data() + i * 8;
+
+			// 軸 (v0..v2) 回りに v3 * pi 回す (ロドリゲスの回転公式)
+			auto axis = vector3(v[0], v[1], v[2] + 1.5f).normalized();
+			const auto& angle = v[3] * 3.14159265f;
+			const auto& c = std::cos(angle);
+			const auto& s = std::sin(angle);
+			const auto& t = 1.0f - c;
+			const auto& x = axis.x();
+			const auto& y = axis.y();
+			const auto& z = axis.z();
+
+			auto rotation = matrix4x4
+			(
+				t * x * x + c, t * x * y + s * z, t * x * z - s * y, 0,
+				t * x * y - s * z, t * y * y + c, t * y * z + s * x, 0,
+				t * x * z + s * y, t * y * z - s * x, t * z * z + c, 0,
+				v[4] * 10.0f, v[5] * 10.0f, v[6] * 10.0f, 1
+			);
+			rigids[i] = affine3x4(rotation);
+
+			const auto& scale = 1.5f + v[7];
+			for(auto k = 0u; k < 12; ++k) rotation.at(k) *= scale;
+			matrices[i] = rotation;
+			affines[i] = affine3x4(rotation);
+			points[i] = vector3(v[4], v[5], v[6]) * 50.0f;
+		}
+
+		std::vector<affine3x4> affine_out(count);
+		std::vector<matrix4x4> matrix_out(count);
+		std::vector<vector3> point_out(count);
+
+		report r("affine");
+		const auto& repeat = options.repeat(20);
+
+		r.measure("compose/affine3x4", count, repeat, [&]
+		{
+			for(size_t i = 0; i + 1 < count; ++i) affine_out[i] = affines[i] * affines[i + 1];
+			keep(affine_out.front());
+		}, sizeof(affine3x4) * 3);
+		r.measure("compose/matrix4x4", count, repeat, [&]
+		{
+			for(size_t i = 0; i + 1 < count; ++i) matrix_out[i] = matrices[i] * matrices[i + 1];
+			keep(matrix_out.front());
+		}, sizeof(matrix4x4) * 3);
+
+		r.measure("inverse/affine3x4", count, repeat, [&]
+		{
+			for(size_t i = 0; i < count; ++i) affine_out[i] = affines[i].inverse();
+			keep(affine_out.back());
+		}, sizeof(affine3x4) * 2);
+		r.measure("inverse_rigid/affine3x4", count, repeat, [&]
+		{
+			for(size_t i = 0; i < count; ++i) affine_out[i] = rigids[i].inverse_rigid();
+			keep(affine_out.back());
+		}, sizeof(affine3x4) * 2);
+		r.measure("inverse/matrix4x4_gauss_jordan", count, repeat, [&]
+		{
+			for(size_t i = 0; i < count; ++i) matrix_out[i] = inverse_4x4(matrices[i]);
+			keep(matrix_out.back());
+		}, sizeof(matrix4x4) * 2);
+
+		r.measure("transform_point/affine3x4", count, repeat, [&]
+		{
+			for(size_t i = 0; i < count; ++i) point_out[i] = affines[i].transform_point(points[i]);
+			keep(point_out.back());
+		}, sizeof(affine3x4) + sizeof(vector3) * 2);
+		r.measure("transform_point/matrix4x4", count, repeat, [&]
+		{
+			for(size_t i = 0; i < count; ++i) point_out[i] = transform_point_4x4(matrices[i], points[i]);
+			keep(point_out.back());
+		}, sizeof(matrix4x4) + sizeof(vector3) * 2);
+
+		/*  逆変換の誤差 (a * inverse(a) と単位行列の差の最大)  */
+		auto max_error = 0.0f;
+		for(size_t i = 0; i < count; ++i)
+		{
+			const auto& product = (affines[i] * affines[i].inverse()).to_matrix();
+			const auto& rigid = (rigids[i] * rigids[i].inverse_rigid()).to_matrix();
+			const auto& identity = matrix4x4::identity();
+			for(auto k = 0u; k < 16; ++k)
+			{
+				max_error = std::max(max_error, std::abs(product.at(k) - identity.at(k)));
+				max_error = std::max(max_error, std::abs(rigid.at(k) - identity.at(k)));
+			}
+		}
+		r.metric("max_inverse_error", max_error);
+		r.metric("bytes/affine3x4", sizeof(affine3x4));
+		r.metric("bytes/matrix4x4", sizeof(matrix4x4));
+
+		return r.write_json(options);
+	}
+}
\ No newline at end of file
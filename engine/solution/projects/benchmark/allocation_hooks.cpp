@@ -0,0 +1,69 @@
+﻿#include "pch.hpp"
+#include "frame_stats.hpp"
+
+/*
+	グローバルな operator new / delete を置き換えて、割り当ての回数を core::heap_allocations() に数える
+	(frame_stats の allocations_per_frame 用。この翻訳単位をリンクした実行ファイルだけが数える)
+*/
+
+namespace
+{
+	void* allocate(size_t size, size_t alignment) noexcept
+	{
+		core::count_heap_allocation();
+
+		size = std::max<size_t>(size, 1);
+		if(alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) return std::malloc(size);
+
+#ifdef _WIN32
+		return _aligned_malloc(size, alignment);
+#else
+		// aligned_alloc の大きさは alignment の倍数
+		return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+	}
+
+	void release(void* p, size_t alignment) noexcept
+	{
+#ifdef _WIN32
+		if(alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+		{
+			_aligned_free(p);
+			return;
+		}
+#endif
+		(void)alignment;
+		std::free(p);
+	}
+
+	void* allocate_or_throw(size_t size, size_t alignment)
+	{
+		auto* p = allocate(size, alignment);
+		if(p == nullptr) throw std::bad_alloc();
+		return p;
+	}
+
+	const bool g_tracking = (core::set_heap_allocation_tracking(true), true);
+}
+
+void* operator new(size_t size) { return allocate_or_throw(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new[](size_t size) { return allocate_or_throw(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new(size_t size, std::align_val_t alignment) { return allocate_or_throw(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return allocate_or_throw(size, static_cast<size_t>(alignment)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocate(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocate(size, static_cast<size_t>(alignment)); }
+
+void operator delete(void* p) noexcept { release(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete[](void* p) noexcept { release(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete(void* p, size_t) noexcept { release(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete[](void* p, size_t) noexcept { release(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete(void* p, std::align_val_t alignment) noexcept { release(p, static_cast<size_t>(alignment)); }
+void operator delete[](void* p, std::align_val_t alignment) noexcept { release(p, static_cast<size_t>(alignment)); }
+void operator delete(void* p, size_t, std::align_val_t alignment) noexcept { release(p, static_cast<size_t>(alignment)); }
+void operator delete[](void* p, size_t, std::align_val_t alignment) noexcept { release(p, static_cast<size_t>(alignment)); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { release(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { release(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete(void* p, std::align_val_t alignment, const std::nothrow_t&) noexcept { release(p, static_cast<size_t>(alignment)); }
+void operator delete[](void* p, std::align_val_t alignment, const std::nothrow_t&) noexcept { release(p, static_cast<size_t>(alignment)); }
\ No newline at end of file
@@ -0,0 +1,61 @@
+﻿#include "include.hpp"
+#include "benchmark.hpp"
+
+namespace benchmark
+{
+	/*
+		シミュレーションの tick と同じ抽出 (extract_instances) を、一時メモリを既定のリソース / tick のアリーナに置いて比べる
+		allocations_per_tick_* は慣らした後の1回あたりのヒープ確保回数 (アリーナ側は 0 になるはず)
+	*/
+	bool run_arena_benchmark(const options& options, core::job_system& jobs)
+	{
+		const auto& count = options.pick<uint32_t>(1000000, 20000);
+
+		core::entity_world world;
+		for(auto i = 0u; i < count; ++i)
+		{
+			auto transform = matrix4x4::identity();
+			transform.at(12u) = static_cast<float>(i);
+
+			if(i % 3 == 0) world.create(core::world_transform{ transform }, core::mesh_component{}, core::material_component{});
+			else world.create(core::world_transform{ transform }, core::mesh_component{});
+		}
+
+		std::vector<core::instance_record> out(count);
+		core::linear_arena arena(64 * 1024);
+
+		report r("arena");
+		const auto& repeat = options.repeat(50);
+
+		r.measure("extract/default_resource", count, repeat, [&]
+		{
+			keep(core::extract_instances(world, jobs, gsl::span<core::instance_record>(out)));
+		}, sizeof(core::instance_record));
+
+		r.measure("extract/tick_arena", count, repeat, [&]
+		{
+			arena.reset();
+			keep(core::extract_instances(world, jobs, gsl::span<core::instance_record>(out), &arena));
+		}, sizeof(core::instance_record));
+
+		/*  1 tick あたりのヒープ確保回数  */
+		constexpr uint32_t ticks = 16;
+		auto allocations = [&](auto&& tick)
+		{
+			const auto& before = core::heap_allocations();
+			for(auto i = 0u; i < ticks; ++i) tick();
+			return static_cast<double>(core::heap_allocations() - before) / ticks;
+		};
+
+		r.metric("allocations_per_tick_default", allocations([&] { core::extract_instances(world, jobs, gsl::span<core::instance_record>(out)); }));
+		r.metric("allocations_per_tick_arena", allocations([&]
+		{
+			arena.reset();
+			core::extract_instances(world, jobs, gsl::span<core::instance_record>(out), &arena);
+		}));
+		r.metric("arena_upstream_allocations", static_cast<double>(arena.get_stats().upstream_allocations));
+		r.metric("arena_high_water_bytes", static_cast<double>(arena.get_stats().high_water));
+
+		return r.write_json(options);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+﻿#include "include.hpp"
+#include "benchmark.hpp"
+
+namespace benchmark
+{
+	void report::add(measurement result)
+	{
+		const auto& per_item = result.items > 0 ? result.ns_per_run / static_cast<double>(result.items) : 0.0;
+		std::cout << boost::format("%-10s %-32s %14.0f ns/run %10.2f ns/item") % m_suite % result.name % result.ns_per_run % per_item;
+		if(result.bytes_per_item > 0.0) std::cout << boost::format(" %8.2f GB/s") % (result.bytes_per_item / per_item);
+		std::cout << '\n';
+
+		m_results.push_back(std::move(result));
+	}
+
+	void report::metric(std::string name, double value)
+	{
+		std::cout << boost::format("%-10s %-32s %14.4f\n") % m_suite % name % value;
+		m_metrics.emplace_back(std::move(name), value);
+	}
+
+	bool report::write_json(const options& options) const
+	{
+		std::ofstream file(options.output + "/" + m_suite + ".json");
+		if(!file) return false;
+
+		file << std::fixed;
+		file.precision(2);
+
+		file << "{\"suite\":\"" << m_suite << "\",\"smoke\":" << (options.smoke ? "true" : "false") << ",\"results\":[";
+		for(size_t i = 0; i < m_results.size(); ++i)
+		{
+			const auto& result = m_results[i];
+			const auto& per_item = result.items > 0 ? result.ns_per_run / static_cast<double>(result.items) : 0.0;
+
+			file << (i == 0 ? "\n" : ",\n")
+				<< "{\"name\":\"" << result.name << "\""
+				<< ",\"items\":" << result.items
+				<< ",\"ns_per_run\":" << result.ns_per_run
+				<< ",\"min_ns_per_run\":" << result.min_ns_per_run
+				<< ",\"ns_per_item\":" << per_item;
+			if(result.bytes_per_item > 0.0) file << ",\"gb_per_second\":" << result.bytes_per_item / per_item;
+			file << "}";
+		}
+		file << "\n]";
+
+		if(!m_metrics.empty())
+		{
+			file.precision(6);
+			file << ",\"metrics\":{";
+			for(size_t i = 0; i < m_metrics.size(); ++i) file << (i == 0 ? "\n" : ",\n") << "\"" << m_metrics[i].first << "\":" << m_metrics[i].second;
+			file << "\n}";
+		}
+		file << "}\n";
+
+		return file.good();
+	}
+}
\ No newline at end of file
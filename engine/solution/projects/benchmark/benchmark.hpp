@@ -0,0 +1,110 @@
+﻿#pragma once
+
+/*
+	Linux でも動くベンチマーク (core_benchmark) の共通部分
+
+	・スイートごとに output/<スイート名>.json へ結果を書く (コミット間で比べる用)
+	・--smoke のときは件数を減らして1回ずつ回す (ctest で動くことだけを確かめる)
+*/
+
+namespace benchmark
+{
+	struct options
+	{
+		std::string output = ".";
+		bool smoke = false;
+
+	public:
+		// smoke のときは小さい方を使う
+		template<typename T> inline T pick(T full, T small) const noexcept { return smoke ? small : full; }
+		inline uint32_t repeat(uint32_t full) const noexcept { return smoke ? 1u : full; }
+	};
+
+	struct measurement
+	{
+		std::string name;
+		uint64_t items;				// 1回で処理する数
+		double ns_per_run;			// 中央値
+		double min_ns_per_run;
+		double bytes_per_item;		// 0 なら書かない
+	};
+
+	/*  1つのスイートの結果  */
+	class report
+	{
+	public:
+		explicit report(std::string suite) : m_suite(std::move(suite)) {}
+
+	public:
+		// 1回空回ししてから repeat 回計る
+		template<class F> void measure(std::string name, uint64_t items, uint32_t repeat, F&& func, double bytes_per_item = 0.0);
+
+		void add(measurement result);
+
+		// 時間以外の値 (断片化率や1フレームの確保回数など)
+		void metric(std::string name, double value);
+
+		bool write_json(const options& options) const;
+
+	public:
+		inline const std::vector<measurement>& results() const noexcept { return m_results; }
+		inline const std::vector<std::pair<std::string, double>>& metrics() const noexcept { return m_metrics; }
+
+	private:
+		std::string m_suite;
+		std::vector<measurement> m_results;
+		std::vector<std::pair<std::string, double>> m_metrics;
+	};
+
+	// 最適化で計算が消されないようにする (value をメモリに置いて、読まれたものとして扱わせる)
+	inline const void* volatile g_keep_sink = nullptr;
+	template<typename T> inline void keep(const T& value) noexcept
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r"(&value) : "memory");
+#else
+		g_keep_sink = &value;
+		_ReadWriteBarrier();
+#endif
+	}
+
+	/*  スイート (main.cpp の表に並べる)  */
+	bool run_affine_benchmark(const options& options, core::job_system& jobs);
+	bool run_arena_benchmark(const options& options, core::job_system& jobs);
+	bool run_bounds_benchmark(const options& options, core::job_system& jobs);
+	bool run_bvh_benchmark(const options& options, core::job_system& jobs);
+	bool run_ecs_benchmark(const options& options, core::job_system& jobs);
+	bool run_frame_benchmark(const options& options, core::job_system& jobs);
+	bool run_instance_benchmark(const options& options, core::job_system& jobs);
+	bool run_lod_benchmark(const options& options, core::job_system& jobs);
+	bool run_math_benchmark(const options& options, core::job_system& jobs);
+	bool run_mesh_asset_benchmark(const options& options, core::job_system& jobs);
+	bool run_meshlet_benchmark(const options& options, core::job_system& jobs);
+	bool run_pool_benchmark(const options& options, core::job_system& jobs);
+	bool run_profiler_benchmark(const options& options, core::job_system& jobs);
+	bool run_random_benchmark(const options& options, core::job_system& jobs);
+	bool run_streamer_benchmark(const options& options, core::job_system& jobs);
+	bool run_tlsf_benchmark(const options& options, core::job_system& jobs);
+	bool run_transform_benchmark(const options& options, core::job_system& jobs);
+
+	/*  -----  inline定義  -----------------------------------  */
+
+	template<class F> void report::measure(std::string name, uint64_t items, uint32_t repeat, F&& func, double bytes_per_item)
+	{
+		Expects(repeat > 0);
+
+		func();
+
+		std::vector<double> times;
+		times.reserve(repeat);
+		for(auto i = 0u; i < repeat; ++i)
+		{
+			const auto& begin = std::chrono::steady_clock::now();
+			func();
+			times.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count());
+		}
+		std::sort(times.begin(), times.end());
+
+		add(measurement{ std::move(name), items, times[times.size() / 2], times.front(), bytes_per_item });
+	}
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+﻿#include "include.hpp"
+#include "benchmark.hpp"
+
+namespace
+{
+	std::vector<float> uniform(uint64_t stream, size_t count, float low, float high)
+	{
+		std::vector<float> values(count);
+		math::philox4x32(47, stream).fill_uniform(values, low, high);
+		return values;
+	}
+}
+
+namespace benchmark
+{
+	/*  まとめて処理する関数と、1つずつ処理する場合を並べて計る  */
+	bool run_bounds_benchmark(const options& options, core::job_system&)
+	{
+		const auto& count = options.pick<size_t>(1 << 20, 4096);
+
+		const auto& centers = uniform(0, count * 3, -500.0f, 500.0f);
+		const auto& extents = uniform(1, count * 3, 0.5f, 4.0f);
+		const auto& angles = uniform(2, count, 0.0f, 6.2831853f);
+
+		std::vector<math::aabb> boxes(count);
+		std::vector<math::sphere> spheres(count);
+		std::vector<affine3x4> transforms(count);
+		std::vector<vector3> points(count);
+		for(size_t i = 0; i < count; ++i)
+		{
+			const vector3 center(centers[i * 3 + 0], centers[i * 3 + 1], centers[i * 3 + 2]);
+			const vector3 extent(extents[i * 3 + 0], extents[i * 3 + 1], extents[i * 3 + 2]);
+			boxes[i] = math::aabb::from_center(vector3(0.0f), extent);
+			spheres[i] = math::sphere{ center, extent.length() };
+			points[i] = center;
+
+			// y 軸回りの回転と平行移動
+			const auto& c = std::cos(angles[i]);
+			const auto& s = std::sin(angles[i]);
+			transforms[i] = affine3x4(vector4a(c, 0.0f, s, center.x()), vector4a(0.0f, 1.0f, 0.0f, center.y()), vector4a(-s, 0.0f, c, center.z()));
+		}
+
+		// 中央の 1/4 ほどが入る視錐台
+		const std::array<vector4, 6> planes =
+		{
+			vector4(1.0f, 0.0f, 0.0f, 250.0f),
+			vector4(-1.0f, 0.0f, 0.0f, 250.0f),
+			vector4(0.0f, 1.0f, 0.0f, 250.0f),
+			vector4(0.0f, -1.0f, 0.0f, 250.0f),
+			vector4(0.0f, 0.0f, 1.0f, 500.0f),
+			vector4(0.0f, 0.0f, -1.0f, 500.0f),
+		};
+		const auto& view = math::frustum::from_vectors(planes);
+
+		std::vector<math::aabb> world(count);
+		std::vector<math::aabb8> box_blocks(math::bounds_blocks(count));
+		std::vector<math::sphere8> sphere_blocks(math::bounds_blocks(count));
+		std::vector<uint8_t> masks(math::bounds_blocks(count));
+		math::transform_aabbs(boxes, transforms, world);
+		math::pack_aabbs(world, box_blocks);
+		math::pack_spheres(spheres, sphere_blocks);
+
+		report r("bounds");
+		const auto& repeat = options.repeat(20);
+
+		r.measure("transform_aabbs/scalar", count, repeat, [&]
+		{
+			for(size_t i = 0; i < count; ++i) world[i] = boxes[i].transformed(transforms[i]);
+			keep(world.back());
+		}, sizeof(math::aabb) * 2 + sizeof(affine3x4));
+		r.measure("transform_aabbs/batch", count, repeat, [&]
+		{
+			math::transform_aabbs(boxes, transforms, world);
+			keep(world.back());
+		}, sizeof(math::aabb) * 2 + sizeof(affine3x4));
+
+		r.measure("cull_aabbs/scalar", count, repeat, [&]
+		{
+			size_t visible = 0;
+			for(const auto& box : world) visible += view.test(box) != math::containment::outside;
+			keep(visible);
+		}, sizeof(math::aabb));
+		r.measure("cull_aabbs/batch", count, repeat, [&]
+		{
+			math::cull_aabbs(view, box_blocks, count, masks);
+			keep(masks.back());
+		}, sizeof(math::aabb));
+
+		r.measure("cull_spheres/scalar", count, repeat, [&]
+		{
+			size_t visible = 0;
+			for(const auto& s : spheres) visible += view.test(s) != math::containment::outside;
+			keep(visible);
+		}, sizeof(math::sphere));
+		r.measure("cull_spheres/batch", count, repeat, [&]
+		{
+			math::cull_spheres(view, sphere_blocks, count, masks);
+			keep(masks.back());
+		}, sizeof(math::sphere));
+
+		r.measure("merge_aabbs/scalar", count, repeat, [&]
+		{
+			auto result = math::aabb::empty();
+			for(const auto& box : world) result.merge(box);
+			keep(result);
+		}, sizeof(math::aabb));
+		r.measure("merge_aabbs/batch", count, repeat, [&]
+		{
+			keep(math::merge_aabbs(gsl::span<const math::aabb>(world)));
+		}, sizeof(math::aabb));
+
+		r.measure("sphere_from_points", count, repeat, [&]
+		{
+			keep(math::sphere_from_points(points));
+		}, sizeof(vector3) * 3);
+
+		return r.write_json(options);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+﻿#include "include.hpp"
+#include "benchmark.hpp"
+
+namespace
+{
+	// 中心は [-extent, extent]、半分の幅は [0.5, 2]
+	std::vector<core::bvh_bounds> random_bounds(uint64_t stream, size_t count, float extent)
+	{
+		std::vector<float> centers(count * 3);
+		std::vector<float> halves(count * 3);
+		math::philox4x32(53, stream).fill_uniform(centers, -extent, extent);
+		math::philox4x32(53, stream + 1).fill_uniform(halves, 0.5f, 2.0f);
+
+		std::vector<core::bvh_bounds> bounds(count);
+		for(size_t i = 0; i < count; ++i)
+		{
+			for(auto axis = 0; axis < 3; ++axis)
+			{
+				bounds[i].min[axis] = centers[i * 3 + axis] - halves[i * 3 + axis];
+				bounds[i].max[axis] = centers[i * 3 + axis] + halves[i * 3 + axis];
+			}
+		}
+		return bounds;
+	}
+}
+
+namespace benchmark
+{
+	/*
+		1M 物体の BVH の構築・refit・問い合わせ
+		視錐台は全体の 1/8 ほどを含む箱、AABB は小さな範囲、raycast は中心を通る向きのばらばらなレイ
+	*/
+	bool run_bvh_benchmark(const options& options, core::job_system&)
+	{
+		const auto& count = options.pick<size_t>(1000000, 10000);
+		const auto& extent = options.pick(1000.0f, 100.0f);
+
+		const auto& bounds = random_bounds(0, count, extent);
+		const auto& moved = random_bounds(2, count / 10, extent);
+
+		core::bvh tree;
+
+		report r("bvh");
+		const auto& repeat = options.repeat(10);
+
+		r.measure("build", count, options.repeat(3), [&]
+		{
+			tree.build(bounds);
+			keep(tree.node_count());
+		});
+
+		const auto& half = extent * 0.5f;
+		const std::array<vector4, 6> planes =
+		{
+			vector4(1.0f, 0.0f, 0.0f, half),
+			vector4(-1.0f, 0.0f, 0.0f, half),
+			vector4(0.0f, 1.0f, 0.0f, half),
+			vector4(0.0f, -1.0f, 0.0f, half),
+			vector4(0.0f, 0.0f, 1.0f, half),
+			vector4(0.0f, 0.0f, -1.0f, half),
+		};
+
+		std::vector<uint32_t> out;
+		out.reserve(count);
+
+		r.measure("query_frustum", count, repeat, [&]
+		{
+			out.clear();
+			tree.query_frustum(planes, out);
+			keep(out.size());
+		});
+		r.metric("frustum_hits", static_cast<double>(out.size()));
+
+		// 比べるための総当たり
+		r.measure("query_frustum/brute_force", count, repeat, [&]
+		{
+			out.clear();
+			for(auto i = 0u; i < bounds.size(); ++i)
+			{
+				const auto& b = bounds[i];
+				auto inside = true;
+				for(const auto& plane : planes)
+				{
+					const auto& distance = plane.x() * (plane.x() > 0 ? b.max[0] : b.min[0]) + plane.y() * (plane.y() > 0 ? b.max[1] : b.min[1]) + plane.z() * (plane.z() > 0 ? b.max[2] : b.min[2]) + plane.w();
+					inside = inside && distance >= 0;
+				}
+				if(inside) out.push_back(i);
+			}
+			keep(out.size());
+		});
+
+		constexpr size_t query_count = 1000;
+		const auto& boxes = random_bounds(4, query_count, extent);
+		std::vector<float> directions(query_count * 3);
+		math::philox4x32(53, 6).fill_uniform(directions, -1.0f, 1.0f);
+
+		r.measure("query_aabb", query_count, repeat, [&]
+		{
+			size_t hits = 0;
+			for(auto box : boxes)
+			{
+				// 一辺 ~20 の範囲
+				for(auto axis = 0; axis < 3; ++axis)
+				{
+					box.min[axis] -= 8.0f;
+					box.max[axis] += 8.0f;
+				}
+				out.clear();
+				tree.query_aabb(box, out);
+				hits += out.size();
+			}
+			keep(hits);
+		});
+
+		r.measure("raycast", query_count, repeat, [&]
+		{
+			size_t hits = 0;
+			for(size_t i = 0; i < query_count; ++i)
+			{
+				const auto& direction = vector3(directions[i * 3 + 0], directions[i * 3 + 1], directions[i * 3 + 2] + 1e-3f).normalized();
+				const auto& origin = direction * -extent * 2.0f;
+				hits += tree.raycast(origin, direction, extent * 4.0f).object != core::INVALID_BVH_OBJECT;
+			}
+			keep(hits);
+		});
+
+		/*  1 割の物体を動かしてから refit / rebuild  */
+		r.measure("update_refit", moved.size(), repeat, [&]
+		{
+			for(auto i = 0u; i < moved.size(); ++i) tree.update(i * 10, moved[i]);
+			tree.refit();
+			keep(tree.node_count());
+		});
+		r.metric("cost_after_move", tree.cost());
+
+		// maintain() が作り直すのは最初の1回だけなので、rebuild() を直接計る
+		r.metric("maintain_rebuilds", tree.maintain() ? 1.0 : 0.0);
+		r.measure("rebuild", count, options.repeat(3), [&]
+		{
+			tree.rebuild();
+			keep(tree.node_count());
+		});
+		r.metric("cost_after_rebuild", tree.cost());
+		r.metric("nodes", static_cast<double>(tree.node_count()));
+
+		return r.write_json(options);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+﻿#include "include.hpp"
+#include "benchmark.hpp"
+
+namespace
+{
+	// 追加 / 削除を計るためのコンポーネント (描画では使わない)
+	struct velocity
+	{
+		std::array<float, 3> value;
+	};
+}
+
+namespace benchmark
+{
+	/*
+		1M エンティティ (world_transform + mesh、3つに1つは material も持つ) での
+		作成、走査 (1スレッド / ジョブ)、コンポーネントの追加と削除 (アーキタイプ間の移動)、描画用の抽出
+	*/
+	bool run_ecs_benchmark(const options& options, core::job_system& jobs)
+	{
+		const auto& count = options.pick<uint32_t>(1000000, 20000);
+
+		auto populate = [&](core::entity_world& world, std::vector<core::entity>& entities)
+		{
+			for(auto i = 0u; i < count; ++i)
+			{
+				auto transform = matrix4x4::identity();
+				transform.at(12u) = static_cast<float>(i);
+
+				if(i % 3 == 0) entities[i] = world.create(core::world_transform{ transform }, core::mesh_component{}, core::material_component{});
+				else entities[i] = world.create(core::world_transform{ transform }, core::mesh_component{});
+			}
+		};
+
+		report r("ecs");
+		const auto& repeat = options.repeat(10);
+
+		std::vector<core::entity> entities(count);
+		r.measure("create", count, options.repeat(3), [&]
+		{
+			core::entity_world world;
+			populate(world, entities);
+			keep(world.size());
+		});
+
+		core::entity_world world;
+		populate(world, entities);
+
+		r.measure("each", count, repeat, [&]
+		{
+			float sum = 0.0f;
+			world.each<core::world_transform>([&](gsl::span<const core::entity>, gsl::span<core::world_transform> transforms)
+			{
+				for(const auto& transform : transforms) sum += transform.world.at(12u);
+			});
+			keep(sum);
+		}, sizeof(core::world_transform));
+
+		r.measure("parallel_each", count, repeat, [&]
+		{
+			world.parallel_each<core::world_transform>(jobs, [&](gsl::span<const core::entity>, gsl::span<core::world_transform> transforms)
+			{
+				for(auto& transform : transforms) transform.world.at(13u) += 1.0f;
+			});
+			keep(world);
+		}, sizeof(core::world_transform));
+
+		// 半分のエンティティに付けてから外す (どちらも別のアーキタイプへ行ごと移す)。items は移した回数
+		r.measure("add_remove_component", (count + 1) / 2 * 2, repeat, [&]
+		{
+			for(auto i = 0u; i < count; i += 2) world.add(entities[i], velocity{});
+			for(auto i = 0u; i < count; i += 2) world.remove<velocity>(entities[i]);
+			keep(world);
+		});
+
+		std::vector<core::instance_record> records(count);
+		std::vector<matrix4x4> matrices(count);
+		r.measure("extract/instance_record", count, repeat, [&]
+		{
+			keep(core::extract_instances(world, jobs, gsl::span<core::instance_record>(records)));
+		}, sizeof(core::instance_record));
+		r.measure("extract/matrix4x4", count, repeat, [&]
+		{
+			keep(core::extract_instances(world, jobs, gsl::span<matrix4x4>(matrices)));
+		}, sizeof(matrix4x4));
+
+		r.metric("entities", static_cast<double>(world.size()));
+		r.metric("chunks", static_cast<double>(world.collect_chunks(core::make_component_mask<core::world_transform>()).size()));
+
+		return r.write_json(options);
+	}
+}
\ No newline at end of file
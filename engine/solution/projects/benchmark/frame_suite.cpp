@@ -0,0 +1,16 @@
+﻿#include "include.hpp"
+#include "benchmark.hpp"
+
+namespace benchmark
+{
+	bool run_frame_benchmark(const options& options, core::job_system& jobs)
+	{
+		if(!options.smoke) return core::run_frame_benchmarks(options.output + "/frame.json", jobs);
+
+		const std::array<core::frame_benchmark_desc, 1> benchmarks =
+		{
+			core::frame_benchmark_desc{ "smoke", 2000, 4, 1 },
+		};
+		return core::run_frame_benchmarks(options.output + "/frame.json", jobs, benchmarks);
+	}
+}
\ No newline at end of file
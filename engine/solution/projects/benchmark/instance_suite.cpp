@@ -0,0 +1,78 @@
+﻿#include "include.hpp"
+#include "benchmark.hpp"
+
+namespace benchmark
+{
+	/*
+		インスタンスデータを CPU で詰める速さと、1フレームで書くバイト数
+		matrix4x4 をそのまま書く (64 bytes) 場合と instance_record に詰める (48 bytes) 場合を比べる
+		書き込み先はアップロード用の領域と同じく、毎フレーム全体を上書きする連続したバッファ
+	*/
+	bool run_instance_benchmark(const options& options, core::job_system&)
+	{
+		const auto& count = options.pick<size_t>(1000000, 10000);
+
+		std::vector<float> values(count * 12);
+		math::philox4x32(61).fill_uniform(values, -100.0f, 100.0f);
+
+		std::vector<matrix4x4> matrices(count);
+		std::vector<affine3x4> affines(count);
+		for(size_t i = 0; i < count; ++i)
+		{
+			const auto* v = values.data() + i * 12;
+			matrices[i] = matrix4x4
+			(
+				v[0], v[1], v[2], 0,
+				v[3], v[4], v[5], 0,
+				v[6], v[7], v[8], 0,
+				v[9], v[10], v[11], 1
+			);
+			affines[i] = affine3x4(vector4a(v[0], v[3], v[6], v[9]), vector4a(v[1], v[4], v[7], v[10]), vector4a(v[2], v[5], v[8], v[11]));
+		}
+
+		std::vector<matrix4x4> matrix_buffer(count);
+		std::vector<core::instance_record> record_buffer(count);
+		const auto& previous = matrices;
+		std::vector<core::instance_record> previous_records(count);
+		for(size_t i = 0; i < count; ++i) previous_records[i] = core::pack_instance(matrices[i]);
+
+		report r("instance");
+		const auto& repeat = options.repeat(20);
+
+		r.measure("write/matrix4x4", count, repeat, [&]
+		{
+			std::copy(matrices.begin(), matrices.end(), matrix_buffer.begin());
+			keep(matrix_buffer.back());
+		}, sizeof(matrix4x4));
+		r.measure("pack/matrix4x4", count, repeat, [&]
+		{
+			for(size_t i = 0; i < count; ++i) record_buffer[i] = core::pack_instance(matrices[i]);
+			keep(record_buffer.back());
+		}, sizeof(core::instance_record));
+		r.measure("pack/affine3x4", count, repeat, [&]
+		{
+			for(size_t i = 0; i < count; ++i) record_buffer[i] = core::pack_instance(affines[i]);
+			keep(record_buffer.back());
+		}, sizeof(core::instance_record));
+
+		/*  tick 間の補間をしてから書く場合  */
+		r.measure("lerp/matrix4x4", count, repeat, [&]
+		{
+			for(size_t i = 0; i < count; ++i) matrix_buffer[i] = core::lerp_instance(previous[i], matrices[i], 0.25f);
+			keep(matrix_buffer.back());
+		}, sizeof(matrix4x4));
+		r.measure("lerp/instance_record", count, repeat, [&]
+		{
+			for(size_t i = 0; i < count; ++i) record_buffer[i] = core::lerp_instance(previous_records[i], core::pack_instance(matrices[i]), 0.25f);
+			keep(record_buffer.back());
+		}, sizeof(core::instance_record));
+
+		const auto& matrix_bytes = static_cast<double>(count * sizeof(matrix4x4));
+		const auto& record_bytes = static_cast<double>(count * sizeof(core::instance_record));
+		r.metric("bytes_per_frame/matrix4x4", matrix_bytes);
+		r.metric("bytes_per_frame/instance_record", record_bytes);
+		r.metric("bytes_ratio", record_bytes / matrix_bytes);
+
+		return r.write_json(options);
+	}
+}
\ No newline at end of file
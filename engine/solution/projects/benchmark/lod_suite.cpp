@@ -0,0 +1,85 @@
+﻿#include "include.hpp"
+#include "benchmark.hpp"
+
+namespace
+{
+	/*  平方根と割り算で投影直径を求め、閾値を順に見ていく素直な実装 (比較用)  */
+	void select_lods_reference(const core::lod_select_desc& desc, gsl::span<const float> x, gsl::span<const float> y, gsl::span<const float> z, gsl::span<const float> radius, gsl::span<uint8_t> out_lods)
+	{
+		const auto& pixel_scale = desc.projection_scale * desc.viewport_height;
+
+		for(size_t i = 0; i < out_lods.size(); ++i)
+		{
+			const auto& distance = (vector3(x[i], y[i], z[i]) - desc.camera_position).length();
+			const auto& diameter = radius[i] * pixel_scale / distance;
+
+			uint8_t lod = 0;
+			while(lod + 1u < desc.lod_count && diameter < desc.screen_thresholds.at(lod + 1u)) ++lod;
+			out_lods[i] = lod;
+		}
+	}
+}
+
+namespace benchmark
+{
+	/*
+		インスタンスごとの LOD 選択 (SoA の select_lods) と、LOD ごとの並べ替え
+		平方根と分岐を使う素直な実装と比べ、選ばれた LOD が一致しない数も書く
+	*/
+	bool run_lod_benchmark(const options& options, core::job_system&)
+	{
+		const auto& count = options.pick<size_t>(1000000, 10000);
+
+		std::vector<float> x(count), y(count), z(count), radius(count);
+		math::philox4x32(71, 0).fill_uniform(x, -1000.0f, 1000.0f);
+		math::philox4x32(71, 1).fill_uniform(y, -50.0f, 50.0f);
+		math::philox4x32(71, 2).fill_uniform(z, -1000.0f, 1000.0f);
+		math::philox4x32(71, 3).fill_uniform(radius, 1.0f, 20.0f);
+
+		const core::lod_select_desc desc
+		{
+			vector3(0.0f, 10.0f, 0.0f),
+			1.0f / std::tan(30.0f * math::to_rad),
+			1080.0f,
+			{ 0.0f, 400.0f, 200.0f, 100.0f, 50.0f, 25.0f, 0.0f, 0.0f },
+			6u
+		};
+
+		std::vector<uint8_t> lods(count);
+		std::vector<uint8_t> reference_lods(count);
+		std::vector<uint32_t> order(count);
+
+		report r("lod");
+		const auto& repeat = options.repeat(20);
+
+		r.measure("select_lods/soa", count, repeat, [&]
+		{
+			core::select_lods(desc, x, y, z, radius, lods);
+			keep(lods.back());
+		}, sizeof(float) * 4 + sizeof(uint8_t));
+		r.measure("select_lods/reference", count, repeat, [&]
+		{
+			select_lods_reference(desc, x, y, z, radius, reference_lods);
+			keep(reference_lods.back());
+		}, sizeof(float) * 4 + sizeof(uint8_t));
+
+		core::lod_buckets buckets{};
+		r.measure("bucket_by_lod", count, repeat, [&]
+		{
+			buckets = core::bucket_by_lod(lods, desc.lod_count, order);
+			keep(order.back());
+		}, sizeof(uint8_t) + sizeof(uint32_t));
+
+		// 閾値ちょうどの丸め違いだけが残るはず
+		size_t mismatches = 0;
+		for(size_t i = 0; i < count; ++i) mismatches += lods[i] != reference_lods[i] ? 1 : 0;
+		r.metric("mismatches", static_cast<double>(mismatches));
+
+		for(auto k = 0u; k < desc.lod_count; ++k)
+		{
+			r.metric("instances/lod" + std::to_string(k), static_cast<double>(buckets.instance_count.at(k)));
+		}
+
+		return r.write_json(options);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+﻿#include "include.hpp"
+#include "benchmark.hpp"
+
+namespace
+{
+	struct suite
+	{
+		const char* name;
+		bool (*run)(const benchmark::options& options, core::job_system& jobs);
+	};
+
+	const std::array suites =
+	{
+		suite{ "affine", benchmark::run_affine_benchmark },
+		suite{ "arena", benchmark::run_arena_benchmark },
+		suite{ "bounds", benchmark::run_bounds_benchmark },
+		suite{ "bvh", benchmark::run_bvh_benchmark },
+		suite{ "ecs", benchmark::run_ecs_benchmark },
+		suite{ "frame", benchmark::run_frame_benchmark },
+		suite{ "instance", benchmark::run_instance_benchmark },
+		suite{ "lod", benchmark::run_lod_benchmark },
+		suite{ "math", benchmark::run_math_benchmark },
+		suite{ "mesh_asset", benchmark::run_mesh_asset_benchmark },
+		suite{ "meshlet", benchmark::run_meshlet_benchmark },
+		suite{ "pool", benchmark::run_pool_benchmark },
+		suite{ "profiler", benchmark::run_profiler_benchmark },
+		suite{ "random", benchmark::run_random_benchmark },
+		suite{ "streamer", benchmark::run_streamer_benchmark },
+		suite{ "tlsf", benchmark::run_tlsf_benchmark },
+		suite{ "transform", benchmark::run_transform_benchmark },
+	};
+
+	void print_usage()
+	{
+		std::cout << "usage: core_benchmark [all";
+		for(const auto& entry : suites) std::cout << '|' << entry.name;
+		std::cout << "]... [--smoke] [--output <dir>]\n";
+	}
+}
+
+/*
+	core_benchmark [スイート名...] [--smoke] [--output <出力先>]
+	スイート名を省略したら全部を回す
+*/
+int32_t main(int32_t argc, char** argv)
+{
+	benchmark::options options;
+	std::vector<std::string_view> names;
+
+	for(auto i = 1; i < argc; ++i)
+	{
+		const std::string_view arg(argv[i]);
+		if(arg == "--smoke") options.smoke = true;
+		else if(arg == "--output" && i + 1 < argc) options.output = argv[++i];
+		else if(arg == "--help")
+		{
+			print_usage();
+			return 0;
+		}
+		else if(arg != "all") names.push_back(arg);
+	}
+
+	for(const auto& name : names)
+	{
+		if(std::none_of(suites.begin(), suites.end(), [&](const suite& entry) { return entry.name == name; }))
+		{
+			std::cerr << "unknown benchmark: " << name << '\n';
+			print_usage();
+			return 1;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(options.output, error);
+
+	core::job_system jobs;
+
+	auto succeeded = true;
+	for(const auto& entry : suites)
+	{
+		if(!names.empty() && std::find(names.begin(), names.end(), entry.name) == names.end()) continue;
+		if(!entry.run(options, jobs))
+		{
+			std::cerr << entry.name << ": failed\n";
+			succeeded = false;
+		}
+	}
+
+	return succeeded ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+﻿#include "include.hpp"
+#include "benchmark.hpp"
+#include "../tests/legacy_math.hpp"
+
+namespace benchmark
+{
+	/*
+		basic_vector / basic_matrix と置き換える前のクラス (tests/legacy_math.hpp) の速さを比べる
+		前の matrix4x4 の積は転置した結果を返すが、計算量は同じなのでそのまま並べる
+	*/
+	bool run_math_benchmark(const options& options, core::job_system&)
+	{
+		const auto& count = options.pick<size_t>(1 << 20, 4096);
+
+		std::vector<float> values(count * 16);
+		math::philox4x32(73).fill_uniform(values, -2.0f, 2.0f);
+
+		std::vector<matrix4x4> matrices(count);
+		std::vector<legacy::matrix4x4> legacy_matrices(count);
+		std::vector<vector3> vectors(count);
+		std::vector<legacy::vector3> legacy_vectors(count);
+		for(size_t i = 0; i < count; ++i)
+		{
+			const auto* v = values.data() + i * 16;
+			std::copy_n(v, 16, matrices[i].data());
+			std::copy_n(v, 16, legacy_matrices[i].data());
+			vectors[i] = vector3(v[0], v[1], v[2]);
+			legacy_vectors[i] = legacy::vector3(v[0], v[1], v[2]);
+		}
+
+		report r("math");
+		const auto& repeat = options.repeat(20);
+
+		/*  隣どうしを掛けて書き戻す (前の結果に依存させない)  */
+		std::vector<matrix4x4> products(count);
+		std::vector<legacy::matrix4x4> legacy_products(count);
+		r.measure("matrix4x4_multiply/basic_matrix", count, repeat, [&]
+		{
+			for(size_t i = 0; i + 1 < count; ++i) products[i] = matrices[i] * matrices[i + 1];
+			keep(products.front());
+		}, sizeof(matrix4x4) * 3);
+		r.measure("matrix4x4_multiply/legacy", count, repeat, [&]
+		{
+			for(size_t i = 0; i + 1 < count; ++i) legacy_products[i] = legacy_matrices[i] * legacy_matrices[i + 1];
+			keep(legacy_products.front());
+		}, sizeof(matrix4x4) * 3);
+
+		r.measure("matrix4x4_add/basic_matrix", count, repeat, [&]
+		{
+			for(size_t i = 0; i + 1 < count; ++i) products[i] = matrices[i] + matrices[i + 1];
+			keep(products.front());
+		}, sizeof(matrix4x4) * 3);
+		r.measure("matrix4x4_add/legacy", count, repeat, [&]
+		{
+			for(size_t i = 0; i + 1 < count; ++i) legacy_products[i] = legacy_matrices[i] + legacy_matrices[i + 1];
+			keep(legacy_products.front());
+		}, sizeof(matrix4x4) * 3);
+
+		r.measure("vector3_length/basic_vector", count, repeat, [&]
+		{
+			float sum = 0.0f;
+			for(const auto& v : vectors) sum += v.length();
+			keep(sum);
+		}, sizeof(vector3));
+		r.measure("vector3_length/legacy", count, repeat, [&]
+		{
+			float sum = 0.0f;
+			for(const auto& v : legacy_vectors) sum += v.length();
+			keep(sum);
+		}, sizeof(vector3));
+
+		r.measure("vector3_cross_dot/basic_vector", count, repeat, [&]
+		{
+			float sum = 0.0f;
+			for(size_t i = 0; i + 1 < count; ++i) sum += vectors[i].cross(vectors[i + 1]).dot(vectors[i]);
+			keep(sum);
+		}, sizeof(vector3));
+		r.measure("vector3_cross_dot/legacy", count, repeat, [&]
+		{
+			float sum = 0.0f;
+			for(size_t i = 0; i + 1 < count; ++i) sum += legacy_vectors[i].cross(legacy_vectors[i + 1]).dot(legacy_vectors[i]);
+			keep(sum);
+		}, sizeof(vector3));
+
+		return r.write_json(options);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,183 @@
+﻿#include "include.hpp"
+#include "benchmark.hpp"
+
+#ifndef _WIN32
+#include <malloc.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// 波打った size x size 頂点の格子をテキスト形式で書く
+	bool write_text_grid(const std::string& path, uint32_t size)
+	{
+		std::ofstream file(path, std::ios::trunc);
+		if(!file) return false;
+
+		file << std::fixed;
+		file.precision(5);
+		for(auto y = 0u; y < size; ++y)
+		{
+			for(auto x = 0u; x < size; ++x)
+			{
+				const auto& height = std::sin(x * 0.05f) * std::cos(y * 0.07f) * 4.0f;
+				file << "v " << static_cast<float>(x) << ' ' << height << ' ' << static_cast<float>(y) << " 0.5 0.5 0.5 1\n";
+			}
+		}
+
+		for(auto y = 0u; y + 1 < size; ++y)
+		{
+			for(auto x = 0u; x + 1 < size; ++x)
+			{
+				const auto& i = y * size + x;
+				file << "f " << i << ' ' << i + size << ' ' << i + 1 << '\n';
+				file << "f " << i + 1 << ' ' << i + size << ' ' << i + size + 1 << '\n';
+			}
+		}
+
+		return static_cast<bool>(file);
+	}
+
+	// 読み込んだものを全部触る (マップしたページも実際に読ませる)
+	uint64_t checksum(gsl::span<const vertex> vertices, gsl::span<const uint32_t> indices) noexcept
+	{
+		uint64_t sum = 0;
+		for(const auto& v : vertices) sum += v.color + v.position.at(0);
+		for(const auto& index : indices) sum += index;
+		return sum;
+	}
+
+	/*
+		func を fork した子プロセスで実行し、getrusage の最大常駐サイズが増えた分 (KiB) を返す
+		ru_maxrss は減らないので、同じプロセスで続けて計ると前の処理の山に隠れてしまう
+		子プロセスでは親から引き継いだ空き領域を OS に返し、最大値を今の値に戻してから計る
+		(Windows では計らずに -1)
+	*/
+	template<class F> double peak_rss_growth(F&& func)
+	{
+#ifdef _WIN32
+		(void)func;
+		return -1.0;
+#else
+		std::array<int, 2> fds{};
+		if(::pipe(fds.data()) != 0) return -1.0;
+
+		const auto& pid = ::fork();
+		if(pid == 0)
+		{
+			::close(fds[0]);
+
+#ifdef __GLIBC__
+			::malloc_trim(0);
+#endif
+			// Linux 4.0 以降は "5" で最大常駐サイズを戻せる
+			std::ofstream("/proc/self/clear_refs") << "5";
+
+			rusage before{};
+			::getrusage(RUSAGE_SELF, &before);
+			func();
+			rusage after{};
+			::getrusage(RUSAGE_SELF, &after);
+
+			const int64_t growth = after.ru_maxrss - before.ru_maxrss;
+			const auto& written = ::write(fds[1], &growth, sizeof(growth));
+			::_exit(written == sizeof(growth) ? 0 : 1);
+		}
+
+		::close(fds[1]);
+
+		int64_t growth = -1;
+		const auto& read = pid > 0 ? ::read(fds[0], &growth, sizeof(growth)) : 0;
+		::close(fds[0]);
+
+		if(pid > 0)
+		{
+			int status = 0;
+			::waitpid(pid, &status, 0);
+		}
+
+		return read == sizeof(growth) ? static_cast<double>(growth) : -1.0;
+#endif
+	}
+}
+
+namespace benchmark
+{
+	/*
+		メモリマップしたバイナリメッシュ (mesh_asset::open) と、同じメッシュをテキストからパースした場合の読み込み時間と最大常駐サイズ
+		どちらもページキャッシュに載った状態で計る (ディスクの速さは入れない)
+		常駐サイズは処理ごとに子プロセスで計った増分 (KiB)
+	*/
+	bool run_mesh_asset_benchmark(const options& options, core::job_system&)
+	{
+		const auto& size = options.pick(1024u, 64u);
+		const auto& text_path = options.output + "/mesh_asset_benchmark.txt";
+		const auto& binary_path = options.output + "/mesh_asset_benchmark.mesh";
+
+		if(!write_text_grid(text_path, size)) return false;
+
+		report r("mesh_asset");
+
+		const auto& convert_begin = std::chrono::steady_clock::now();
+		if(!core::convert_text_mesh(text_path, binary_path, 2)) return false;
+		r.metric("convert_seconds", std::chrono::duration<double>(std::chrono::steady_clock::now() - convert_begin).count());
+
+		const auto& vertex_count = static_cast<uint64_t>(size) * size;
+
+		auto load_mapped = [&]
+		{
+			core::mesh_asset asset;
+			if(!asset.open(binary_path)) return uint64_t(0);
+
+			// テキスト側と同じく LOD0 だけ
+			const auto& lod0 = asset.lods()[0];
+			return checksum(asset.vertices(), asset.indices().subspan(lod0.index_offset, lod0.index_count));
+		};
+
+		// 実行時にテキストを読むなら、vertex まで作って初めて使える
+		auto load_text = [&]
+		{
+			core::text_mesh mesh;
+			if(!core::read_text_mesh(text_path, mesh)) return uint64_t(0);
+
+			std::vector<vertex> vertices;
+			vertices.reserve(mesh.positions.size());
+			for(size_t i = 0; i < mesh.positions.size(); ++i) vertices.emplace_back(mesh.positions[i], mesh.colors[i]);
+			return checksum(vertices, mesh.indices);
+		};
+
+		uint64_t mapped_sum = 0;
+		r.measure("open/mapped", vertex_count, options.repeat(20), [&]
+		{
+			mapped_sum = load_mapped();
+			keep(mapped_sum);
+		});
+
+		uint64_t text_sum = 0;
+		r.measure("parse/text", vertex_count, options.repeat(3), [&]
+		{
+			text_sum = load_text();
+			keep(text_sum);
+		});
+
+		std::error_code error;
+		r.metric("file_bytes/mapped", static_cast<double>(std::filesystem::file_size(binary_path, error)));
+		r.metric("file_bytes/text", static_cast<double>(std::filesystem::file_size(text_path, error)));
+		r.metric("peak_rss_kib/mapped", peak_rss_growth([&] { keep(load_mapped()); }));
+		r.metric("peak_rss_kib/text", peak_rss_growth([&] { keep(load_text()); }));
+
+		std::filesystem::remove(text_path, error);
+		std::filesystem::remove(binary_path, error);
+
+		// LOD0 の頂点とインデックスはどちらも同じものを読んでいるはず
+		if(mapped_sum == 0 || mapped_sum != text_sum)
+		{
+			std::cerr << "mesh_asset: mapped and text meshes differ\n";
+			return false;
+		}
+
+		return r.write_json(options);
+	}
+}
\ No newline at end of file
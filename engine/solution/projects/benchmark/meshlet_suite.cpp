@@ -0,0 +1,142 @@
+﻿#include "include.hpp"
+#include "benchmark.hpp"
+
+namespace
+{
+	struct sphere_mesh
+	{
+		std::vector<vector3> positions;
+		std::vector<uint32_t> indices;
+	};
+
+	// 半径1の UV 球 (極で縮退する三角形は作らない)
+	sphere_mesh make_sphere(uint32_t rings, uint32_t segments)
+	{
+		sphere_mesh mesh;
+		mesh.positions.reserve(size_t(rings + 1) * (segments + 1));
+		for(auto i = 0u; i <= rings; ++i)
+		{
+			const auto& theta = math::pi * i / rings;
+			for(auto j = 0u; j <= segments; ++j)
+			{
+				const auto& phi = 2.0f * math::pi * j / segments;
+				mesh.positions.push_back(vector3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)));
+			}
+		}
+
+		mesh.indices.reserve(size_t(rings) * segments * 6);
+		for(auto i = 0u; i < rings; ++i)
+		{
+			for(auto j = 0u; j < segments; ++j)
+			{
+				const auto& a = i * (segments + 1) + j;
+				const auto& b = a + 1;
+				const auto& c = a + segments + 1;
+				const auto& d = c + 1;
+
+				if(i != 0) mesh.indices.insert(mesh.indices.end(), { a, b, c });
+				if(i != rings - 1) mesh.indices.insert(mesh.indices.end(), { b, d, c });
+			}
+		}
+
+		return mesh;
+	}
+
+	core::meshlet_cull_view make_view(const vector3& position, float fov_y)
+	{
+		core::camera camera;
+		camera.set_position(vector3d(position.x(), position.y(), position.z()));
+		camera.set_direction(-position);
+		camera.set_perspective(fov_y, 16.0f / 9.0f, 0.01f);
+		camera.update();
+
+		return core::meshlet_cull_view{ camera.to_local(camera.position()), camera.frustum() };
+	}
+
+	/*  比べるための三角形単位のカリング (裏面と視錐台)  */
+	size_t cull_triangles(const sphere_mesh& mesh, const core::meshlet_cull_view& view)
+	{
+		size_t visible = 0;
+		for(size_t i = 0; i < mesh.indices.size(); i += 3)
+		{
+			const auto& a = mesh.positions[mesh.indices[i + 0]];
+			const auto& b = mesh.positions[mesh.indices[i + 1]];
+			const auto& c = mesh.positions[mesh.indices[i + 2]];
+
+			auto inside = (b - a).cross(c - a).dot(a - view.camera_position) < 0.0f;
+			for(const auto& plane : view.planes)
+			{
+				const auto& normal = vector3(plane.x(), plane.y(), plane.z());
+				inside = inside && std::max({ normal.dot(a), normal.dot(b), normal.dot(c) }) + plane.w() >= 0.0f;
+			}
+			visible += inside ? 1 : 0;
+		}
+		return visible;
+	}
+}
+
+namespace benchmark
+{
+	/*
+		メッシュレットの構築と CPU カリング
+		球の外から全体を見る視点 (ほぼ半分が法線コーンで落ちる) と、近くから一部だけを見る視点 (視錐台でも落ちる) で計る
+		三角形単位で裏面と視錐台を判定する場合とも比べる
+	*/
+	bool run_meshlet_benchmark(const options& options, core::job_system&)
+	{
+		const auto& rings = options.pick(500u, 50u);
+		const auto& mesh = make_sphere(rings, rings * 2);
+		const auto& triangle_count = mesh.indices.size() / 3;
+
+		report r("meshlet");
+
+		core::meshlet_mesh meshlets;
+		r.measure("build", triangle_count, options.repeat(3), [&]
+		{
+			meshlets = core::build_meshlets(mesh.positions, mesh.indices);
+			keep(meshlets.meshlets.size());
+		});
+
+		const auto& meshlet_count = meshlets.meshlets.size();
+		r.metric("meshlets", static_cast<double>(meshlet_count));
+		r.metric("triangles_per_meshlet", static_cast<double>(triangle_count) / meshlet_count);
+		r.metric("vertices_per_meshlet", static_cast<double>(meshlets.vertex_indices.size()) / meshlet_count);
+		r.metric("bytes/meshlet", static_cast<double>(sizeof(core::meshlet) + sizeof(core::meshlet_bounds)));
+
+		const std::array<std::pair<std::string, core::meshlet_cull_view>, 2> views =
+		{
+			std::pair{ std::string("outside"), make_view(vector3(0.0f, 0.5f, -3.0f), 60.0f * math::to_rad) },
+			std::pair{ std::string("close"), make_view(vector3(0.0f, 0.0f, -1.5f), 30.0f * math::to_rad) },
+		};
+
+		std::vector<uint32_t> visible(meshlet_count);
+		const auto& repeat = options.repeat(20);
+
+		for(const auto& [name, view] : views)
+		{
+			size_t visible_count = 0;
+			r.measure("cull/" + name, meshlet_count, repeat, [&]
+			{
+				visible_count = core::cull_meshlets(meshlets, view, visible);
+				keep(visible_count);
+			}, sizeof(core::meshlet_bounds));
+
+			size_t visible_triangles = 0;
+			for(size_t i = 0; i < visible_count; ++i) visible_triangles += meshlets.meshlets[visible[i]].triangle_count;
+
+			size_t reference_triangles = 0;
+			r.measure("cull_triangles/" + name, triangle_count, options.repeat(5), [&]
+			{
+				reference_triangles = cull_triangles(mesh, view);
+				keep(reference_triangles);
+			});
+
+			// メッシュレット単位では保守的に残すので、三角形単位より多くなる
+			r.metric("visible_meshlet_ratio/" + name, static_cast<double>(visible_count) / meshlet_count);
+			r.metric("visible_triangle_ratio/" + name, static_cast<double>(visible_triangles) / triangle_count);
+			r.metric("reference_triangle_ratio/" + name, static_cast<double>(reference_triangles) / triangle_count);
+		}
+
+		return r.write_json(options);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+﻿#include "include.hpp"
+#include "benchmark.hpp"
+
+namespace benchmark
+{
+	namespace
+	{
+		// 1フレームに1回更新するような小さなオブジェクト (32 bytes)
+		struct pool_object
+		{
+			std::array<float, 3> position;
+			std::array<float, 3> velocity;
+			float lifetime;
+			uint32_t flags;
+		};
+
+		inline void step(pool_object& object, float dt) noexcept
+		{
+			for(auto i = 0; i < 3; ++i) object.position[i] += object.velocity[i] * dt;
+			object.lifetime -= dt;
+		}
+
+		pool_object make_object(uint32_t i) noexcept
+		{
+			const auto& f = static_cast<float>(i);
+			return pool_object{ { f, 0.0f, -f }, { 1.0f, 0.5f, 0.25f }, 10.0f, i };
+		}
+	}
+
+	/*
+		object_pool (実体を詰めて持つ) と、個別に確保して並びをシャッフルした std::vector<std::unique_ptr<T>> を比べる
+		・iterate: 全要素を1回ずつ更新する (プールは連続、unique_ptr は飛び飛びに読む)
+		・lookup: ランダムなハンドル / 添字から引く (どちらも間接参照が1段入る)
+		・churn: 1割を破棄して作り直す (プールは末尾と入れ替えるので隙間ができない)
+	*/
+	bool run_pool_benchmark(const options& options, core::job_system&)
+	{
+		const auto& count = options.pick<uint32_t>(1000000, 20000);
+		constexpr float dt = 1.0f / 60.0f;
+
+		core::object_pool<pool_object> pool;
+		std::vector<core::handle<pool_object>> handles(count);
+		for(auto i = 0u; i < count; ++i) handles[i] = pool.create(make_object(i));
+
+		// 確保した順のままだと隣に並びやすいので、並びをシャッフルしてから回す
+		std::vector<std::unique_ptr<pool_object>> pointers(count);
+		for(auto i = 0u; i < count; ++i) pointers[i] = std::make_unique<pool_object>(make_object(i));
+		std::shuffle(pointers.begin(), pointers.end(), math::philox4x32(83));
+
+		report r("pool");
+		const auto& repeat = options.repeat(20);
+
+		r.measure("iterate/object_pool", count, repeat, [&]
+		{
+			for(auto& object : pool) step(object, dt);
+			keep(pool.objects().front());
+		}, sizeof(pool_object));
+
+		r.measure("iterate/unique_ptr_shuffled", count, repeat, [&]
+		{
+			for(auto& object : pointers) step(*object, dt);
+			keep(*pointers.front());
+		}, sizeof(pool_object));
+
+		/*  ランダムな順で引く  */
+		std::vector<uint32_t> order(count);
+		std::iota(order.begin(), order.end(), 0u);
+		std::shuffle(order.begin(), order.end(), math::philox4x32(83, 1));
+
+		r.measure("lookup/handle", count, repeat, [&]
+		{
+			float sum = 0.0f;
+			for(const auto& i : order) sum += pool.get(handles[i])->lifetime;
+			keep(sum);
+		});
+
+		r.measure("lookup/unique_ptr", count, repeat, [&]
+		{
+			float sum = 0.0f;
+			for(const auto& i : order) sum += pointers[i]->lifetime;
+			keep(sum);
+		});
+
+		/*  1割を破棄して作り直す (ハンドル / ポインタは同じ位置に入れ直す)  */
+		const auto& churn = count / 10;
+
+		r.measure("churn/object_pool", churn, repeat, [&]
+		{
+			for(auto n = 0u; n < churn; ++n)
+			{
+				const auto& i = order[n];
+				pool.destroy(handles[i]);
+				handles[i] = pool.create(make_object(i));
+			}
+		});
+
+		r.measure("churn/unique_ptr", churn, repeat, [&]
+		{
+			for(auto n = 0u; n < churn; ++n)
+			{
+				const auto& i = order[n];
+				pointers[i] = std::make_unique<pool_object>(make_object(i));
+			}
+		});
+
+		// churn の後も詰まったまま
+		r.metric("pool_size", static_cast<double>(pool.size()));
+
+		return r.write_json(options);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+﻿#include "include.hpp"
+#include "benchmark.hpp"
+
+namespace benchmark
+{
+	namespace
+	{
+		// インライン化で中のゾーンがまとめられないようにする
+#if defined(__GNUC__) || defined(__clang__)
+		__attribute__((noinline))
+#else
+		__declspec(noinline)
+#endif
+		void empty_zone() noexcept
+		{
+			PROFILE_SCOPE("benchmark/empty");
+		}
+	}
+
+	/*
+		空の PROFILE_SCOPE 1回あたりの時間 (開始と終了の記録を含む)。目安は 20 ns 以下
+		profile_clock() を2回読むので、時刻の読み取りが遅い環境 (仮想マシンなど) ではそれが下限になる
+		・empty: 同じスレッドで続けて開く
+		・nested: 2段に入れ子にする (1回あたり 2 ゾーン)
+		・clock: profile_clock() だけ (ゾーンの下限)
+	*/
+	bool run_profiler_benchmark(const options& options, core::job_system&)
+	{
+		const auto& count = options.pick<uint32_t>(1u << 22, 1u << 14);
+
+		// スレッドの登録 (初回だけロックする) は計測に含めない
+		empty_zone();
+
+		report r("profiler");
+		const auto& repeat = options.repeat(10);
+
+		r.measure("zone/empty", count, repeat, [&]
+		{
+			for(auto i = 0u; i < count; ++i) empty_zone();
+		});
+
+		r.measure("zone/nested", count * 2ull, repeat, [&]
+		{
+			for(auto i = 0u; i < count; ++i)
+			{
+				PROFILE_SCOPE("benchmark/outer");
+				empty_zone();
+			}
+		});
+
+		r.measure("clock", count, repeat, [&]
+		{
+			uint64_t sum = 0;
+			for(auto i = 0u; i < count; ++i) sum += core::profile_clock();
+			keep(sum);
+		});
+
+		/*  ゾーンの時間のうち、時刻の読み取り (開始と終了で2回) を除いたプロファイラ自身の分  */
+		const auto& per_item = [&](const char* name)
+		{
+			const auto& it = std::find_if(r.results().begin(), r.results().end(), [name](const measurement& m) { return m.name == name; });
+			return it->ns_per_run / static_cast<double>(it->items);
+		};
+		r.metric("zone_overhead_ns", per_item("zone/empty") - 2.0 * per_item("clock"));
+
+		// 記録したものは次のフレームの集計で読まれるので、ここで片付けておく
+		PROFILE_FRAME();
+
+		return r.write_json(options);
+	}
+}
\ No newline at end of file
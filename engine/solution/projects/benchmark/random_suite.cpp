@@ -0,0 +1,54 @@
+﻿#include "include.hpp"
+#include "benchmark.hpp"
+
+namespace benchmark
+{
+	/*  count 個の float を埋める速さを philox4x32 (1スレッド / ジョブ) と mt19937 で比べる  */
+	bool run_random_benchmark(const options& options, core::job_system& jobs)
+	{
+		const auto& count = options.pick<size_t>(1 << 24, 1 << 14);
+		std::vector<float> values(count);
+		std::vector<uint32_t> bits(count);
+
+		report r("random");
+		const auto& repeat = options.repeat(10);
+
+		const math::philox4x32 random(1);
+		r.measure("philox/fill", count, repeat, [&]
+		{
+			random.fill(bits);
+			keep(bits.back());
+		}, sizeof(uint32_t));
+		r.measure("philox/fill_uniform", count, repeat, [&]
+		{
+			random.fill_uniform(values, 0.0f, 1.0f);
+			keep(values.back());
+		}, sizeof(float));
+		r.measure("philox/fill_uniform_jobs", count, repeat, [&]
+		{
+			// 範囲ごとに offset を渡すので、分け方によらず1スレッドと同じ値になる
+			jobs.parallel_for(count, 64 * 1024, [&](size_t begin, size_t end)
+			{
+				random.fill_uniform(gsl::span<float>(values).subspan(begin, end - begin), 0.0f, 1.0f, begin);
+			});
+			keep(values.back());
+		}, sizeof(float));
+
+		auto sequential = random;
+		boost::random::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+		r.measure("philox/operator", count, repeat, [&]
+		{
+			for(auto& value : values) value = distribution(sequential);
+			keep(values.back());
+		}, sizeof(float));
+
+		boost::random::mt19937 engine(1);
+		r.measure("mt19937", count, repeat, [&]
+		{
+			for(auto& value : values) value = distribution(engine);
+			keep(values.back());
+		}, sizeof(float));
+
+		return r.write_json(options);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+﻿#include "include.hpp"
+#include "benchmark.hpp"
+
+namespace
+{
+	/*  ファイルの代わりに、決めておいた大きさのデータを返すバックエンド  */
+	class memory_backend final : public core::file_backend
+	{
+	public:
+		explicit memory_backend(std::unordered_map<std::string, size_t> sizes) : m_sizes(std::move(sizes)) {}
+
+	public:
+		bool read(const std::string& path, std::vector<std::byte>& out) override
+		{
+			const auto& it = m_sizes.find(path);
+			if(it == m_sizes.end()) return false;
+
+			out.assign(it->second, std::byte{ 0x5a });
+			return true;
+		}
+
+	private:
+		std::unordered_map<std::string, size_t> m_sizes;
+	};
+
+	inline double percentile_ms(std::vector<double> values, double p)
+	{
+		if(values.empty()) return 0.0;
+
+		const size_t index = std::min(static_cast<size_t>(p * values.size()), values.size() - 1);
+		std::nth_element(values.begin(), values.begin() + index, values.end());
+		return values[index];
+	}
+}
+
+namespace benchmark
+{
+	/*
+		遅いディスク (throttled_file_backend) 越しに優先度付きの要求を大量に流し、1フレームのアップロード量を制限して dispatch する
+		要求してから完了コールバックが呼ばれるまで (見えるようになるまで) の時間と、全体のスループットを出す
+		要求は最初の 20 フレームに分けて出し、優先度の高い 1 割の遅延も別に出す (優先度順に読めているか)
+	*/
+	bool run_streamer_benchmark(const options& options, core::job_system&)
+	{
+		using clock = std::chrono::steady_clock;
+
+		const auto& count = options.pick<size_t>(4000, 200);
+		constexpr uint32_t ISSUE_FRAMES = 20;
+		constexpr auto FRAME_TIME = std::chrono::milliseconds(4);
+		constexpr uint64_t UPLOAD_BUDGET = 2ull << 20;
+
+		std::vector<int32_t> sizes(count);
+		std::vector<float> distances(count);
+		std::vector<float> importances(count);
+		math::philox4x32(73, 0).fill_uniform(sizes, 16 * 1024, 256 * 1024);
+		math::philox4x32(73, 1).fill_uniform(distances, 1.0f, 1000.0f);
+		math::philox4x32(73, 2).fill_uniform(importances, 0.5f, 2.0f);
+
+		std::vector<std::string> paths(count);
+		std::unordered_map<std::string, size_t> files;
+		std::vector<float> priorities(count);
+		for(size_t i = 0; i < count; ++i)
+		{
+			paths[i] = "asset_" + std::to_string(i);
+			files.emplace(paths[i], static_cast<size_t>(sizes[i]));
+			priorities[i] = core::stream_priority(distances[i], importances[i]);
+		}
+
+		// 200 MB/s、200us の読み込みを 2 スレッドで
+		auto backend = std::make_unique<core::throttled_file_backend>(std::make_unique<memory_backend>(std::move(files)), std::chrono::microseconds(200), 200ull << 20);
+		core::asset_streamer streamer(std::move(backend), 2);
+
+		std::vector<clock::time_point> requested(count);
+		std::vector<double> latencies(count, 0.0);
+		size_t completed = 0;
+		size_t failed = 0;
+
+		const auto& begin = clock::now();
+		auto next_frame = begin;
+		uint32_t frames = 0;
+		size_t issued = 0;
+		uint64_t dispatched = 0;
+
+		while(completed + failed < count)
+		{
+			/*  要求を出す  */
+			const size_t issue_end = std::min(count, count * (frames + 1) / ISSUE_FRAMES);
+			for(; issued < issue_end; ++issued)
+			{
+				const auto& index = issued;
+				requested[index] = clock::now();
+				streamer.request(paths[index], priorities[index], [&, index](core::stream_id, bool succeeded, gsl::span<const std::byte>)
+				{
+					latencies[index] = std::chrono::duration<double, std::milli>(clock::now() - requested[index]).count();
+					++(succeeded ? completed : failed);
+				});
+			}
+
+			dispatched += streamer.dispatch(UPLOAD_BUDGET);
+			++frames;
+
+			next_frame += FRAME_TIME;
+			std::this_thread::sleep_until(next_frame);
+		}
+
+		const auto& elapsed = std::chrono::duration<double>(clock::now() - begin).count();
+
+		// 優先度の高い (値の小さい) 1 割
+		auto sorted = priorities;
+		std::nth_element(sorted.begin(), sorted.begin() + count / 10, sorted.end());
+		const auto& high_priority = sorted[count / 10];
+
+		std::vector<double> high_latencies;
+		for(size_t i = 0; i < count; ++i)
+		{
+			if(priorities[i] < high_priority) high_latencies.push_back(latencies[i]);
+		}
+
+		report r("streamer");
+		r.add(measurement{ "stream", count, elapsed * 1.0e9, elapsed * 1.0e9, static_cast<double>(dispatched) / count });
+		r.metric("latency_ms/p50", percentile_ms(latencies, 0.5));
+		r.metric("latency_ms/p99", percentile_ms(latencies, 0.99));
+		r.metric("latency_ms/p50_high_priority", percentile_ms(high_latencies, 0.5));
+		r.metric("latency_ms/p99_high_priority", percentile_ms(high_latencies, 0.99));
+		r.metric("mb_per_second", static_cast<double>(dispatched) / (1024.0 * 1024.0) / elapsed);
+		r.metric("frames", frames);
+		r.metric("failed", static_cast<double>(failed));
+
+		return failed == 0 && r.write_json(options);
+	}
+}
\ No newline at end of file
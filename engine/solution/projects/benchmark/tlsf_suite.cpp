@@ -0,0 +1,70 @@
+﻿#include "include.hpp"
+#include "benchmark.hpp"
+
+namespace benchmark
+{
+	/*
+		GPU ヒープ (4 KiB 単位) の使い方を真似た確保・解放
+		半分ほど埋めてから1つ解放して1つ確保するのを繰り返し、1回あたりの時間と、終わった後の断片化を出す
+	*/
+	bool run_tlsf_benchmark(const options& options, core::job_system&)
+	{
+		constexpr uint64_t GRANULARITY = 4096;
+		const auto& capacity = options.pick<uint64_t>(1ull << 30, 64ull << 20);
+		const auto& operations = options.pick<size_t>(1 << 20, 4096);
+
+		// 確保するサイズは先に作っておく (乱数の時間を入れない)
+		std::vector<int32_t> sizes(operations + capacity / (256 * 1024));
+		math::philox4x32(32).fill_uniform(sizes, 1, 512 * 1024);
+
+		core::tlsf_allocator allocator;
+		std::vector<core::tlsf_allocation> live;
+
+		auto reset = [&]
+		{
+			allocator = core::tlsf_allocator(capacity, GRANULARITY);
+			live.clear();
+
+			// 平均 256 KiB なので半分ほど埋まる
+			for(size_t i = 0; i < capacity / (512 * 1024); ++i) live.push_back(allocator.allocate(static_cast<uint64_t>(sizes[i]), GRANULARITY));
+		};
+
+		report r("tlsf");
+
+		r.measure("fill", capacity / (512 * 1024), options.repeat(10), [&]
+		{
+			reset();
+			keep(live.back());
+		});
+
+		uint32_t failures = 0;
+		r.measure("free_allocate", operations, options.repeat(10), [&]
+		{
+			reset();
+
+			failures = 0;
+			auto victim = uint64_t(0x9E3779B97F4A7C15);
+			for(size_t i = 0; i < operations; ++i)
+			{
+				// 解放する位置は乗算で散らす
+				victim = victim * 6364136223846793005ull + 1442695040888963407ull;
+				auto& slot = live[(victim >> 33) % live.size()];
+				if(slot.valid()) allocator.free(slot);
+
+				slot = allocator.allocate(static_cast<uint64_t>(sizes[i % sizes.size()]), i % 4 == 0 ? 64 * 1024 : GRANULARITY);
+				failures += slot.valid() ? 0 : 1;
+			}
+			keep(live.back());
+		});
+
+		/*  最後の状態の断片化 (1 - 最大の空き / 空きの合計)  */
+		const auto& stats = allocator.get_stats();
+		const auto& free_bytes = stats.capacity - stats.used;
+		r.metric("used_ratio", static_cast<double>(stats.used) / static_cast<double>(stats.capacity));
+		r.metric("fragmentation", free_bytes > 0 ? 1.0 - static_cast<double>(stats.largest_free) / static_cast<double>(free_bytes) : 0.0);
+		r.metric("free_blocks", stats.free_blocks);
+		r.metric("failed_allocations", failures);
+
+		return r.write_json(options);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+﻿#include "include.hpp"
+#include "benchmark.hpp"
+
+namespace benchmark
+{
+	/*
+		約 1M ノードの階層 (根 900 個、深さ 4、子は各 10 個で 999,900 ノード。transform_id の上限は 2^20) の update()
+		全部が変更された場合と、1% の根だけ動かした場合を 1スレッド / ジョブ で比べる
+	*/
+	bool run_transform_benchmark(const options& options, core::job_system& jobs)
+	{
+		const auto& roots = options.pick<uint32_t>(900, 20);
+		constexpr uint32_t fan_out = 10;
+
+		core::transform_hierarchy hierarchy;
+		std::vector<core::transform_id> root_ids;
+		std::vector<core::transform_id> level;
+		std::vector<core::transform_id> next;
+
+		auto local = matrix4x4::identity();
+		local.at(12u) = 1.0f;
+
+		uint32_t instance = 0;
+		for(auto r = 0u; r < roots; ++r)
+		{
+			root_ids.push_back(hierarchy.create(local, {}, instance++));
+
+			level.assign(1, root_ids.back());
+			for(auto depth = 1u; depth < 4; ++depth)
+			{
+				next.clear();
+				for(const auto& parent : level)
+				{
+					for(auto c = 0u; c < fan_out; ++c) next.push_back(hierarchy.create(local, parent, instance++));
+				}
+				std::swap(level, next);
+			}
+		}
+
+		std::vector<matrix4x4> instances(instance);
+		hierarchy.update(instances);
+
+		const auto& count = hierarchy.size();
+
+		report r("transform");
+		const auto& repeat = options.repeat(10);
+
+		auto touch_all = [&] { for(const auto& id : root_ids) hierarchy.set_local(id, local); };
+		auto touch_some = [&] { for(size_t i = 0; i < root_ids.size(); i += 100) hierarchy.set_local(root_ids[i], local); };
+
+		r.measure("update_all/serial", count, repeat, [&]
+		{
+			touch_all();
+			hierarchy.update(instances);
+			keep(instances.back());
+		}, sizeof(matrix4x4) * 2);
+		r.measure("update_all/jobs", count, repeat, [&]
+		{
+			touch_all();
+			hierarchy.update(instances, &jobs);
+			keep(instances.back());
+		}, sizeof(matrix4x4) * 2);
+
+		r.measure("update_1pct/serial", count, repeat, [&]
+		{
+			touch_some();
+			hierarchy.update(instances);
+			keep(instances.back());
+		});
+		r.measure("update_1pct/jobs", count, repeat, [&]
+		{
+			touch_some();
+			hierarchy.update(instances, &jobs);
+			keep(instances.back());
+		});
+
+		// 親の付け替えで並び替えが必要になった後の update() (rebuild を含む)
+		r.measure("reparent_update", count, repeat, [&]
+		{
+			hierarchy.set_parent(root_ids.back(), root_ids.front());
+			hierarchy.update(instances);
+			hierarchy.set_parent(root_ids.back(), {});
+			hierarchy.update(instances);
+			keep(instances.back());
+		});
+
+		r.metric("nodes", static_cast<double>(count));
+		r.metric("depths", static_cast<double>(hierarchy.depth_count()));
+
+		return r.write_json(options);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,371 @@
+﻿#pragma once
+#include "matrix4x4.hpp"
+#include "vector3.hpp"
+#include "vector4.hpp"
+
+/*
+	アフィン変換 (4x4 の最後の列 0,0,0,1 を持たない形)
+
+	行ベクトル形式の 4x4 を転置した 3 行 x 4 列で持つ (instance_record / シェーダと同じ並び)
+	・row(i) = (回転拡縮の i 列目, 平行移動の i 成分)、点は p' = (dot(row_0, p1), dot(row_1, p1), dot(row_2, p1))
+	・積 a * b は matrix4x4 と同じく「a の後に b」
+	・float は x86 で SSE を使う (定数式の中では使わない)
+*/
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MATH_SSE 1
+#else
+#define MATH_SSE 0
+#endif
+
+#if MATH_SSE
+namespace
+{
+	inline __m128 sse_mask_xyz(__m128 v) noexcept { return _mm_and_ps(v, _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1))); }
+	inline __m128 sse_mask_w(__m128 v) noexcept { return _mm_and_ps(v, _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0))); }
+
+	// w は 0 になる (入力の w が 0 のとき)
+	inline __m128 sse_cross(__m128 a, __m128 b) noexcept
+	{
+		const auto& a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+		const auto& b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+		const auto& c = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+		return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+	}
+
+	// (dot(r0, v), dot(r1, v), dot(r2, v), 0)
+	inline __m128 sse_dot3x4(__m128 r0, __m128 r1, __m128 r2, __m128 v) noexcept
+	{
+		auto m0 = _mm_mul_ps(r0, v);
+		auto m1 = _mm_mul_ps(r1, v);
+		auto m2 = _mm_mul_ps(r2, v);
+		auto m3 = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS(m0, m1, m2, m3);
+		return _mm_add_ps(_mm_add_ps(m0, m1), _mm_add_ps(m2, m3));
+	}
+
+	// 3x3 の行 c0..c2 (w = 0) と平行移動 t から逆変換の行を書く (w = -dot(c_i, t))
+	inline void sse_store_inverse(__m128 c0, __m128 c1, __m128 c2, __m128 t, float* out) noexcept
+	{
+		const auto& d = _mm_sub_ps(_mm_setzero_ps(), sse_dot3x4(c0, c1, c2, t));
+		_mm_store_ps(out + 0, _mm_or_ps(c0, sse_mask_w(_mm_shuffle_ps(d, d, _MM_SHUFFLE(0, 0, 0, 0)))));
+		_mm_store_ps(out + 4, _mm_or_ps(c1, sse_mask_w(_mm_shuffle_ps(d, d, _MM_SHUFFLE(1, 1, 1, 1)))));
+		_mm_store_ps(out + 8, _mm_or_ps(c2, sse_mask_w(_mm_shuffle_ps(d, d, _MM_SHUFFLE(2, 2, 2, 2)))));
+	}
+}
+#endif
+
+namespace math
+{
+	template<typename T = float> class basic_affine3x4
+	{
+	public:
+		using row_type = basic_vector<T, 4, storage_policy::aligned>;
+
+	public:
+		explicit inline constexpr basic_affine3x4() noexcept = default;
+		explicit inline constexpr basic_affine3x4(const row_type& row_0, const row_type& row_1, const row_type& row_2) noexcept : _{ row_0, row_1, row_2 } {}
+
+		// 行ベクトル形式の 4x4 から (最後の列は捨てる)
+		explicit inline constexpr basic_affine3x4(const basic_matrix4x4<T>& matrix) noexcept;
+
+	public:
+		inline constexpr T* data() noexcept { return _[0].data(); }
+		inline constexpr row_type& row(size_t i) noexcept { return _[i]; }
+
+	public:
+		inline constexpr const T* data() const noexcept { return _[0].data(); }
+		inline constexpr const row_type& row(size_t i) const noexcept { return _[i]; }
+		inline constexpr basic_vector3<T> translation() const noexcept { return basic_vector3<T>(_[0].w(), _[1].w(), _[2].w()); }
+
+		inline constexpr basic_matrix4x4<T> to_matrix() const noexcept;
+
+	public:
+		// 合成 (乗算 36 回)
+		inline constexpr basic_affine3x4 operator*(const basic_affine3x4& other) const noexcept;
+		inline constexpr basic_affine3x4& operator*=(const basic_affine3x4& other) noexcept { return *this = *this * other; }
+
+		inline constexpr bool operator==(const basic_affine3x4& other) const noexcept = default;
+
+	public:
+		inline constexpr basic_vector3<T> transform_point(const basic_vector3<T>& point) const noexcept;
+		inline constexpr basic_vector3<T> transform_vector(const basic_vector3<T>& vector) const noexcept;
+
+		inline constexpr T determinant() const noexcept;
+
+		// 一般のアフィン逆変換 (余因子 / 行列式)。行列式が 0 なら結果は不定
+		inline constexpr basic_affine3x4 inverse() const noexcept;
+
+		// 回転と平行移動だけのとき (転置で済む)
+		inline constexpr basic_affine3x4 inverse_rigid() const noexcept;
+
+		// 法線用の逆転置 (平行移動は 0)。transform_vector() で法線を変換する
+		inline constexpr basic_affine3x4 inverse_transpose() const noexcept;
+
+		// 12 要素 (48 bytes) を out へそのまま書く。GPU のインスタンスデータに直接書くとき用
+		inline void store(T* out) const noexcept;
+
+	public:
+		static inline constexpr basic_affine3x4 identity() noexcept;
+		static inline constexpr basic_affine3x4 translation(const basic_vector3<T>& offset) noexcept;
+		static inline constexpr basic_affine3x4 scale(const basic_vector3<T>& scale) noexcept;
+
+	private:
+		// 回転拡縮部分の行 (平行移動を除いた 3 要素)
+		inline constexpr basic_vector3<T> linear_row(size_t i) const noexcept { return basic_vector3<T>(_[i].x(), _[i].y(), _[i].z()); }
+
+	private:
+		std::array<row_type, 3> _;
+	};
+
+	/*  -----  using宣言  -----------------------------------  */
+
+	using affine3x4 = basic_affine3x4<float>;
+	using affine3x4f = basic_affine3x4<float>;
+	using affine3x4d = basic_affine3x4<double>;
+
+	static_assert(sizeof(affine3x4) == 48, "affine3x4 は 48 bytes (3 x float4)");
+
+	/*  -----  inline定義  -----------------------------------  */
+
+	template<typename T> inline constexpr basic_affine3x4<T>::basic_affine3x4(const basic_matrix4x4<T>& matrix) noexcept
+	{
+		const auto* m = matrix.data();
+		unroll<3>([&](auto i) { _[i] = row_type(m[i], m[4 + i], m[8 + i], m[12 + i]); });
+	}
+
+	template<typename T> inline constexpr basic_matrix4x4<T> basic_affine3x4<T>::to_matrix() const noexcept
+	{
+		return basic_matrix4x4<T>
+		(
+			_[0].x(), _[1].x(), _[2].x(), 0,
+			_[0].y(), _[1].y(), _[2].y(), 0,
+			_[0].z(), _[1].z(), _[2].z(), 0,
+			_[0].w(), _[1].w(), _[2].w(), 1
+		);
+	}
+
+	template<typename T> inline constexpr basic_affine3x4<T> basic_affine3x4<T>::operator*(const basic_affine3x4& other) const noexcept
+	{
+		/*  「this の後に other」 = 列形式で other * this。各行は this の行の線形結合 + other の平行移動  */
+		basic_affine3x4 result;
+
+#if MATH_SSE
+		if constexpr (std::is_same_v<T, float>)
+		{
+			if(!std::is_constant_evaluated())
+			{
+				const auto& r0 = _mm_load_ps(_[0].data());
+				const auto& r1 = _mm_load_ps(_[1].data());
+				const auto& r2 = _mm_load_ps(_[2].data());
+
+				for(size_t i = 0; i < 3; ++i)
+				{
+					const auto& o = _mm_load_ps(other._[i].data());
+					auto row = _mm_mul_ps(_mm_shuffle_ps(o, o, _MM_SHUFFLE(0, 0, 0, 0)), r0);
+					row = _mm_add_ps(row, _mm_mul_ps(_mm_shuffle_ps(o, o, _MM_SHUFFLE(1, 1, 1, 1)), r1));
+					row = _mm_add_ps(row, _mm_mul_ps(_mm_shuffle_ps(o, o, _MM_SHUFFLE(2, 2, 2, 2)), r2));
+					row = _mm_add_ps(row, sse_mask_w(o));
+					_mm_store_ps(result._[i].data(), row);
+				}
+
+				return result;
+			}
+		}
+#endif
+
+		unroll<3>([&](auto i)
+		{
+			const auto& o = other._[i];
+			result._[i] = _[0] * o.x() + _[1] * o.y() + _[2] * o.z();
+			result._[i].w() += o.w();
+		});
+
+		return result;
+	}
+
+	template<typename T> inline constexpr basic_vector3<T> basic_affine3x4<T>::transform_point(const basic_vector3<T>& point) const noexcept
+	{
+#if MATH_SSE
+		if constexpr (std::is_same_v<T, float>)
+		{
+			if(!std::is_constant_evaluated())
+			{
+				row_type result;
+				const auto& p = _mm_set_ps(1.0f, point.z(), point.y(), point.x());
+				_mm_store_ps(result.data(), sse_dot3x4(_mm_load_ps(_[0].data()), _mm_load_ps(_[1].data()), _mm_load_ps(_[2].data()), p));
+				return basic_vector3<T>(result.x(), result.y(), result.z());
+			}
+		}
+#endif
+
+		const row_type p(point.x(), point.y(), point.z(), T(1));
+		return basic_vector3<T>(_[0].dot(p), _[1].dot(p), _[2].dot(p));
+	}
+
+	template<typename T> inline constexpr basic_vector3<T> basic_affine3x4<T>::transform_vector(const basic_vector3<T>& vector) const noexcept
+	{
+#if MATH_SSE
+		if constexpr (std::is_same_v<T, float>)
+		{
+			if(!std::is_constant_evaluated())
+			{
+				row_type result;
+				const auto& v = _mm_set_ps(0.0f, vector.z(), vector.y(), vector.x());
+				_mm_store_ps(result.data(), sse_dot3x4(_mm_load_ps(_[0].data()), _mm_load_ps(_[1].data()), _mm_load_ps(_[2].data()), v));
+				return basic_vector3<T>(result.x(), result.y(), result.z());
+			}
+		}
+#endif
+
+		return basic_vector3<T>(linear_row(0).dot(vector), linear_row(1).dot(vector), linear_row(2).dot(vector));
+	}
+
+	template<typename T> inline constexpr T basic_affine3x4<T>::determinant() const noexcept
+	{
+		return linear_row(0).dot(linear_row(1).cross(linear_row(2)));
+	}
+
+	template<typename T> inline constexpr basic_affine3x4<T> basic_affine3x4<T>::inverse_transpose() const noexcept
+	{
+		/*  行 a, b, c の 3x3 の逆行列の転置は (b x c, c x a, a x b) / det  */
+#if MATH_SSE
+		if constexpr (std::is_same_v<T, float>)
+		{
+			if(!std::is_constant_evaluated())
+			{
+				const auto& a = sse_mask_xyz(_mm_load_ps(_[0].data()));
+				const auto& b = sse_mask_xyz(_mm_load_ps(_[1].data()));
+				const auto& c = sse_mask_xyz(_mm_load_ps(_[2].data()));
+				const auto& bc = sse_cross(b, c);
+				const auto& det = sse_dot3x4(a, a, a, bc);
+				const auto& inv_det = _mm_div_ps(_mm_set1_ps(1.0f), _mm_shuffle_ps(det, det, _MM_SHUFFLE(0, 0, 0, 0)));
+
+				basic_affine3x4 result;
+				_mm_store_ps(result._[0].data(), _mm_mul_ps(bc, inv_det));
+				_mm_store_ps(result._[1].data(), _mm_mul_ps(sse_cross(c, a), inv_det));
+				_mm_store_ps(result._[2].data(), _mm_mul_ps(sse_cross(a, b), inv_det));
+				return result;
+			}
+		}
+#endif
+
+		const auto& a = linear_row(0);
+		const auto& b = linear_row(1);
+		const auto& c = linear_row(2);
+
+		const auto& bc = b.cross(c);
+		const auto& ca = c.cross(a);
+		const auto& ab = a.cross(b);
+		const auto& inv_det = T(1) / a.dot(bc);
+
+		return basic_affine3x4
+		(
+			row_type(bc.x() * inv_det, bc.y() * inv_det, bc.z() * inv_det, 0),
+			row_type(ca.x() * inv_det, ca.y() * inv_det, ca.z() * inv_det, 0),
+			row_type(ab.x() * inv_det, ab.y() * inv_det, ab.z() * inv_det, 0)
+		);
+	}
+
+	template<typename T> inline constexpr basic_affine3x4<T> basic_affine3x4<T>::inverse() const noexcept
+	{
+		/*  3x3 は逆転置を転置し直し、平行移動は -L^-1 t  */
+#if MATH_SSE
+		if constexpr (std::is_same_v<T, float>)
+		{
+			if(!std::is_constant_evaluated())
+			{
+				const auto& it = inverse_transpose();
+
+				auto c0 = _mm_load_ps(it._[0].data());
+				auto c1 = _mm_load_ps(it._[1].data());
+				auto c2 = _mm_load_ps(it._[2].data());
+				auto zero = _mm_setzero_ps();
+				_MM_TRANSPOSE4_PS(c0, c1, c2, zero);
+
+				basic_affine3x4 result;
+				sse_store_inverse(c0, c1, c2, _mm_set_ps(0.0f, _[2].w(), _[1].w(), _[0].w()), result.data());
+				return result;
+			}
+		}
+#endif
+
+		const auto& it = inverse_transpose();
+		const auto& t = translation();
+
+		const basic_vector3<T> c0(it._[0].x(), it._[1].x(), it._[2].x());
+		const basic_vector3<T> c1(it._[0].y(), it._[1].y(), it._[2].y());
+		const basic_vector3<T> c2(it._[0].z(), it._[1].z(), it._[2].z());
+
+		return basic_affine3x4
+		(
+			row_type(c0.x(), c0.y(), c0.z(), -c0.dot(t)),
+			row_type(c1.x(), c1.y(), c1.z(), -c1.dot(t)),
+			row_type(c2.x(), c2.y(), c2.z(), -c2.dot(t))
+		);
+	}
+
+	template<typename T> inline constexpr basic_affine3x4<T> basic_affine3x4<T>::inverse_rigid() const noexcept
+	{
+#if MATH_SSE
+		if constexpr (std::is_same_v<T, float>)
+		{
+			if(!std::is_constant_evaluated())
+			{
+				// 転置すると 4 行目が平行移動になる
+				auto c0 = _mm_load_ps(_[0].data());
+				auto c1 = _mm_load_ps(_[1].data());
+				auto c2 = _mm_load_ps(_[2].data());
+				auto t = _mm_setzero_ps();
+				_MM_TRANSPOSE4_PS(c0, c1, c2, t);
+
+				basic_affine3x4 result;
+				sse_store_inverse(c0, c1, c2, t, result.data());
+				return result;
+			}
+		}
+#endif
+
+		const basic_vector3<T> c0(_[0].x(), _[1].x(), _[2].x());
+		const basic_vector3<T> c1(_[0].y(), _[1].y(), _[2].y());
+		const basic_vector3<T> c2(_[0].z(), _[1].z(), _[2].z());
+		const auto& t = translation();
+
+		return basic_affine3x4
+		(
+			row_type(c0.x(), c0.y(), c0.z(), -c0.dot(t)),
+			row_type(c1.x(), c1.y(), c1.z(), -c1.dot(t)),
+			row_type(c2.x(), c2.y(), c2.z(), -c2.dot(t))
+		);
+	}
+
+	template<typename T> inline void basic_affine3x4<T>::store(T* out) const noexcept
+	{
+#if MATH_SSE
+		if constexpr (std::is_same_v<T, float>)
+		{
+			// 書き込み先 (マップしたアップロードヒープなど) の整列は問わない
+			_mm_storeu_ps(out + 0, _mm_load_ps(_[0].data()));
+			_mm_storeu_ps(out + 4, _mm_load_ps(_[1].data()));
+			_mm_storeu_ps(out + 8, _mm_load_ps(_[2].data()));
+			return;
+		}
+#endif
+		unroll<3>([&](auto i) { std::copy_n(_[i].data(), 4, out + i * 4); });
+	}
+
+	template<typename T> inline constexpr basic_affine3x4<T> basic_affine3x4<T>::identity() noexcept
+	{
+		return basic_affine3x4(row_type(1, 0, 0, 0), row_type(0, 1, 0, 0), row_type(0, 0, 1, 0));
+	}
+
+	template<typename T> inline constexpr basic_affine3x4<T> basic_affine3x4<T>::translation(const basic_vector3<T>& offset) noexcept
+	{
+		return basic_affine3x4(row_type(1, 0, 0, offset.x()), row_type(0, 1, 0, offset.y()), row_type(0, 0, 1, offset.z()));
+	}
+
+	template<typename T> inline constexpr basic_affine3x4<T> basic_affine3x4<T>::scale(const basic_vector3<T>& scale) noexcept
+	{
+		return basic_affine3x4(row_type(scale.x(), 0, 0, 0), row_type(0, scale.y(), 0, 0), row_type(0, 0, scale.z(), 0));
+	}
+}
\ No newline at end of file
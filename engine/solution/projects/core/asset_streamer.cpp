@@ -0,0 +1,246 @@
+﻿#include "pch.hpp"
+#include "asset_streamer.hpp"
+
+namespace core
+{
+	bool std_file_backend::read(const std::string& path, std::vector<std::byte>& out)
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if(!file) return false;
+
+		const auto& size = file.tellg();
+		if(size < 0) return false;
+
+		out.resize(gsl::narrow<size_t>(static_cast<std::streamoff>(size)));
+		file.seekg(0);
+		file.read(reinterpret_cast<char*>(out.data()), size);
+
+		return file.good() || file.eof();
+	}
+
+	throttled_file_backend::throttled_file_backend(std::unique_ptr<file_backend> inner, std::chrono::microseconds latency, uint64_t bytes_per_second)
+		: m_inner(std::move(inner))
+		, m_latency(latency)
+		, m_bytes_per_second(bytes_per_second)
+	{
+		Expects(m_inner != nullptr);
+		Expects(m_bytes_per_second > 0);
+	}
+
+	bool throttled_file_backend::read(const std::string& path, std::vector<std::byte>& out)
+	{
+		const auto& start = std::chrono::steady_clock::now();
+		const auto& result = m_inner->read(path, out);
+
+		// レイテンシ + サイズ / 帯域 が経過するまで待つ
+		const auto& transfer = std::chrono::microseconds(out.size() * 1000000ull / m_bytes_per_second);
+		std::this_thread::sleep_until(start + m_latency + transfer);
+
+		return result;
+	}
+
+	asset_streamer::asset_streamer(std::unique_ptr<file_backend> backend, uint32_t thread_count)
+		: m_backend(std::move(backend))
+	{
+		Expects(m_backend != nullptr);
+		Expects(thread_count > 0);
+
+		for(auto i = 0u; i < thread_count; ++i)
+		{
+			m_threads.emplace_back([this] { worker(); });
+		}
+	}
+
+	asset_streamer::~asset_streamer()
+	{
+		{
+			std::lock_guard lock(m_mutex);
+			m_exit = true;
+		}
+		m_condition.notify_all();
+
+		for(auto& thread : m_threads) thread.join();
+	}
+
+	stream_id asset_streamer::request(const std::string& path, float priority, stream_callback callback)
+	{
+		stream_id id{};
+		{
+			std::lock_guard lock(m_mutex);
+
+			id = m_next_id++;
+			m_requests.emplace(id, request_state{ path, priority, 0, std::move(callback), {}, request_status::pending, false });
+			m_pending.push(queue_entry{ priority, 0, id });
+
+			++m_pending_count;
+			++m_stats.requested;
+		}
+		m_condition.notify_one();
+
+		return id;
+	}
+
+	void asset_streamer::update_priority(stream_id id, float priority)
+	{
+		std::lock_guard lock(m_mutex);
+
+		const auto& it = m_requests.find(id);
+		if(it == m_requests.end()) return;
+
+		// 古いエントリはバージョン違いで捨てられる
+		auto& state = it->second;
+		state.priority = priority;
+		++state.version;
+
+		switch(state.status)
+		{
+			case request_status::pending:
+				m_pending.push(queue_entry{ priority, state.version, id });
+				break;
+
+			case request_status::ready:
+				m_ready.push(queue_entry{ priority, state.version, id });
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	void asset_streamer::cancel(stream_id id)
+	{
+		std::lock_guard lock(m_mutex);
+
+		const auto& it = m_requests.find(id);
+		if(it == m_requests.end()) return;
+
+		// 読み込み中のものは完了時に捨てる
+		switch(it->second.status)
+		{
+			case request_status::pending:
+				--m_pending_count;
+				break;
+
+			case request_status::ready:
+				--m_ready_count;
+				break;
+
+			default:
+				break;
+		}
+
+		m_requests.erase(it);
+		++m_stats.cancelled;
+	}
+
+	uint64_t asset_streamer::dispatch(uint64_t upload_budget)
+	{
+		uint64_t dispatched = 0;
+
+		while(true)
+		{
+			request_state state{};
+			stream_id id{};
+
+			{
+				std::lock_guard lock(m_mutex);
+
+				// 取り消し済み・優先度更新前のエントリを捨てる
+				while(!m_ready.empty())
+				{
+					const auto& top = m_ready.top();
+					const auto& it = m_requests.find(top.id);
+					if(it != m_requests.end() && it->second.version == top.version && it->second.status == request_status::ready) break;
+					m_ready.pop();
+				}
+
+				if(m_ready.empty()) break;
+
+				id = m_ready.top().id;
+				auto& ready = m_requests.at(id);
+
+				// 予算を超える場合は次のフレームに回す (ただし1フレームに最低1件は渡す)
+				if(dispatched > 0 && dispatched + ready.data.size() > upload_budget) break;
+
+				m_ready.pop();
+				state = std::move(ready);
+				m_requests.erase(id);
+				--m_ready_count;
+
+				m_stats.bytes_dispatched += state.data.size();
+				++(state.succeeded ? m_stats.completed : m_stats.failed);
+			}
+
+			dispatched += state.data.size();
+
+			// コールバックはロックの外 (描画スレッド) で呼ぶ
+			if(state.callback) state.callback(id, state.succeeded, state.data);
+		}
+
+		return dispatched;
+	}
+
+	stream_stats asset_streamer::get_stats() const
+	{
+		std::lock_guard lock(m_mutex);
+
+		auto stats = m_stats;
+		stats.pending = m_pending_count;
+		stats.ready = m_ready_count;
+		return stats;
+	}
+
+	void asset_streamer::worker()
+	{
+		while(true)
+		{
+			stream_id id{};
+			std::string path;
+
+			{
+				std::unique_lock lock(m_mutex);
+
+				while(true)
+				{
+					m_condition.wait(lock, [this] { return m_exit || !m_pending.empty(); });
+					if(m_exit) return;
+
+					const auto& top = m_pending.top();
+					const auto& it = m_requests.find(top.id);
+					const auto& valid = it != m_requests.end() && it->second.version == top.version && it->second.status == request_status::pending;
+
+					id = top.id;
+					m_pending.pop();
+
+					if(!valid) continue;
+
+					it->second.status = request_status::loading;
+					path = it->second.path;
+					--m_pending_count;
+					break;
+				}
+			}
+
+			/*  読み込み (ロックの外)  */
+			std::vector<std::byte> data;
+			const auto& succeeded = m_backend->read(path, data);
+
+			{
+				std::lock_guard lock(m_mutex);
+
+				m_stats.bytes_read += data.size();
+
+				const auto& it = m_requests.find(id);
+				if(it == m_requests.end()) continue;
+
+				auto& state = it->second;
+				state.status = request_status::ready;
+				state.succeeded = succeeded;
+				state.data = std::move(data);
+
+				m_ready.push(queue_entry{ state.priority, state.version, id });
+				++m_ready_count;
+			}
+		}
+	}
+}
\ No newline at end of file
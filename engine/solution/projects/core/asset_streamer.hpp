@@ -0,0 +1,138 @@
+﻿#pragma once
+
+namespace core
+{
+	/*  -----  ファイル読み込みのバックエンド  -----------------------------------  */
+
+	class file_backend
+	{
+	public:
+		virtual ~file_backend() = default;
+
+	public:
+		// ファイル全体を out に読み込む。失敗したら false
+		virtual bool read(const std::string& path, std::vector<std::byte>& out) = 0;
+	};
+
+	/*  標準ライブラリのみで実装したバックエンド (どのプラットフォームでも動く)  */
+	class std_file_backend final : public file_backend
+	{
+	public:
+		bool read(const std::string& path, std::vector<std::byte>& out) override;
+	};
+
+	/*  遅いディスクを模したバックエンド (レイテンシと帯域で読み込みを遅らせる)  */
+	class throttled_file_backend final : public file_backend
+	{
+	public:
+		throttled_file_backend(std::unique_ptr<file_backend> inner, std::chrono::microseconds latency, uint64_t bytes_per_second);
+
+	public:
+		bool read(const std::string& path, std::vector<std::byte>& out) override;
+
+	private:
+		std::unique_ptr<file_backend> m_inner;
+		std::chrono::microseconds m_latency;
+		uint64_t m_bytes_per_second;
+	};
+
+	/*  -----  ストリーミング  -----------------------------------  */
+
+	using stream_id = uint64_t;
+	using stream_callback = std::function<void(stream_id id, bool succeeded, gsl::span<const std::byte> data)>;
+
+	// 距離が近いほど、重要度が高いほど先に読む (値が小さいほど優先)
+	inline float stream_priority(float camera_distance, float importance) noexcept
+	{
+		return camera_distance / std::max(importance, 1.0e-4f);
+	}
+
+	struct stream_stats
+	{
+		uint64_t requested;
+		uint64_t completed;
+		uint64_t failed;
+		uint64_t cancelled;
+		uint64_t bytes_read;
+		uint64_t bytes_dispatched;
+		uint32_t pending;		// 読み込み待ち (取り消し・優先度更新で残った古いキューのエントリは数えない)
+		uint32_t ready;			// 読み込み済みで dispatch() 待ち
+	};
+
+	/*
+		I/O スレッドでファイルを読み、描画スレッドの dispatch() で完了コールバックを呼ぶ
+		dispatch() 1回で渡すバイト数は upload_budget で制限する
+	*/
+	class asset_streamer
+	{
+	public:
+		explicit asset_streamer(std::unique_ptr<file_backend> backend, uint32_t thread_count = 2);
+		~asset_streamer();
+
+	public:
+		asset_streamer(const asset_streamer&) = delete;
+		asset_streamer& operator=(const asset_streamer&) = delete;
+
+	public:
+		stream_id request(const std::string& path, float priority, stream_callback callback);
+		void update_priority(stream_id id, float priority);
+		void cancel(stream_id id);
+
+		// 描画スレッドから毎フレーム呼ぶ。優先度順に upload_budget バイトまでコールバックを呼び、渡したバイト数を返す
+		uint64_t dispatch(uint64_t upload_budget);
+
+	public:
+		stream_stats get_stats() const;
+
+	private:
+		enum class request_status : uint8_t
+		{
+			pending,
+			loading,
+			ready,
+		};
+
+		struct request_state
+		{
+			std::string path;
+			float priority;
+			uint64_t version;
+			stream_callback callback;
+			std::vector<std::byte> data;
+			request_status status;
+			bool succeeded;
+		};
+
+		struct queue_entry
+		{
+			float priority;
+			uint64_t version;
+			stream_id id;
+
+			// std::priority_queue は最大値が先頭なので逆順にする
+			inline bool operator<(const queue_entry& other) const noexcept { return priority > other.priority; }
+		};
+
+	private:
+		void worker();
+
+	private:
+		std::unique_ptr<file_backend> m_backend;
+		std::vector<std::thread> m_threads;
+
+		mutable std::mutex m_mutex;
+		std::condition_variable m_condition;
+		bool m_exit = false;
+
+		stream_id m_next_id = 1;
+		std::unordered_map<stream_id, request_state> m_requests;
+		std::priority_queue<queue_entry> m_pending;
+		std::priority_queue<queue_entry> m_ready;
+
+		// キューには古いエントリが残るので、状態ごとの件数は別に数える
+		uint32_t m_pending_count = 0;
+		uint32_t m_ready_count = 0;
+
+		stream_stats m_stats = {};
+	};
+}
\ No newline at end of file
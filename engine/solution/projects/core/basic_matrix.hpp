@@ -0,0 +1,149 @@
+﻿#pragma once
+#include "basic_vector.hpp"
+
+namespace math
+{
+	/*
+		R 行 C 列の行列 (行優先で並べる)
+		行ベクトル形式 (v * M、平行移動は最後の行) で、積 a * b は「a の後に b」を掛ける
+		at(x, y) は x 列 y 行
+		(置き換える前の matrix4x4 は operator+ / operator- が転置した和と差を、operator* が (b * a) の転置を返していた)
+	*/
+	template<typename T, size_t R, size_t C> class basic_matrix
+	{
+	public:
+		static constexpr size_t rows = R;
+		static constexpr size_t columns = C;
+		static constexpr size_t count = R * C;
+
+	public:
+		inline constexpr explicit basic_matrix() noexcept = default;
+
+		template<typename... Args> requires (sizeof...(Args) == R * C && (std::is_arithmetic_v<Args> && ...))
+		inline constexpr explicit basic_matrix(Args... values) noexcept : _{ static_cast<T>(values)... } {}
+
+	public:
+		inline constexpr T* data() noexcept { return _.data(); }
+		inline constexpr T& at(uint32_t i) { return _.at(i); }
+		inline constexpr T& at(uint64_t x, uint64_t y) { return _.at(x + y * C); }
+
+	public:
+		inline constexpr const T* data() const noexcept { return _.data(); }
+		inline constexpr const T& at(uint32_t i) const { return _.at(i); }
+		inline constexpr const T& at(uint64_t x, uint64_t y) const { return _.at(x + y * C); }
+
+		inline constexpr basic_vector<T, C> row(size_t y) const noexcept;
+
+	public:
+		inline constexpr basic_matrix& operator+=(const basic_matrix& other) noexcept;
+		inline constexpr basic_matrix& operator-=(const basic_matrix& other) noexcept;
+		inline constexpr basic_matrix& operator*=(const basic_matrix& other) noexcept requires (R == C);
+		inline constexpr basic_matrix& operator*=(T value) noexcept;
+
+	public:
+		inline constexpr basic_matrix operator+(const basic_matrix& other) const noexcept { return basic_matrix(*this) += other; }
+		inline constexpr basic_matrix operator-(const basic_matrix& other) const noexcept { return basic_matrix(*this) -= other; }
+		inline constexpr basic_matrix operator*(T value) const noexcept { return basic_matrix(*this) *= value; }
+
+		template<size_t K> inline constexpr basic_matrix<T, R, K> operator*(const basic_matrix<T, C, K>& other) const noexcept;
+
+		inline constexpr bool operator==(const basic_matrix& other) const noexcept = default;
+
+	public:
+		inline constexpr basic_matrix<T, C, R> transposed() const noexcept;
+
+	public:
+		static inline constexpr basic_matrix identity() noexcept requires (R == C);
+
+	private:
+		std::array<T, R * C> _;
+	};
+
+	/*  -----  inline定義  -----------------------------------  */
+
+	template<typename T, size_t R, size_t C> inline constexpr basic_vector<T, C> basic_matrix<T, R, C>::row(size_t y) const noexcept
+	{
+		basic_vector<T, C> result;
+		unroll<C>([&](auto x) { result[x] = _[y * C + x]; });
+		return result;
+	}
+
+	template<typename T, size_t R, size_t C> inline constexpr basic_matrix<T, R, C>& basic_matrix<T, R, C>::operator+=(const basic_matrix& other) noexcept
+	{
+		unroll<R * C>([&](auto i) { _[i] += other._[i]; });
+		return *this;
+	}
+
+	template<typename T, size_t R, size_t C> inline constexpr basic_matrix<T, R, C>& basic_matrix<T, R, C>::operator-=(const basic_matrix& other) noexcept
+	{
+		unroll<R * C>([&](auto i) { _[i] -= other._[i]; });
+		return *this;
+	}
+
+	template<typename T, size_t R, size_t C> inline constexpr basic_matrix<T, R, C>& basic_matrix<T, R, C>::operator*=(const basic_matrix& other) noexcept requires (R == C)
+	{
+		*this = *this * other;
+		return *this;
+	}
+
+	template<typename T, size_t R, size_t C> inline constexpr basic_matrix<T, R, C>& basic_matrix<T, R, C>::operator*=(T value) noexcept
+	{
+		unroll<R * C>([&](auto i) { _[i] *= value; });
+		return *this;
+	}
+
+	template<typename T, size_t R, size_t C> template<size_t K> inline constexpr basic_matrix<T, R, K> basic_matrix<T, R, C>::operator*(const basic_matrix<T, C, K>& other) const noexcept
+	{
+		/*  result[y][x] = Σ this[y][k] * other[k][x]  (右辺の行を左辺の要素倍して足していく)  */
+		basic_matrix<T, R, K> result;
+		const auto* r = other.data();
+		auto* o = result.data();
+
+		unroll<R>([&](auto y)
+		{
+			unroll<K>([&](auto x) { o[y * K + x] = _[y * C] * r[x]; });
+			unroll<C - 1>([&](auto k)
+			{
+				const auto& scale = _[y * C + k + 1];
+				unroll<K>([&](auto x) { o[y * K + x] += scale * r[(k + 1) * K + x]; });
+			});
+		});
+
+		return result;
+	}
+
+	template<typename T, size_t R, size_t C> inline constexpr basic_matrix<T, C, R> basic_matrix<T, R, C>::transposed() const noexcept
+	{
+		basic_matrix<T, C, R> result;
+		auto* o = result.data();
+
+		unroll<R>([&](auto y)
+		{
+			unroll<C>([&](auto x) { o[x * R + y] = _[y * C + x]; });
+		});
+
+		return result;
+	}
+
+	template<typename T, size_t R, size_t C> inline constexpr basic_matrix<T, R, C> basic_matrix<T, R, C>::identity() noexcept requires (R == C)
+	{
+		basic_matrix result;
+		unroll<R * C>([&](auto i) { result._[i] = i % (C + 1) == 0 ? T(1) : T(0); });
+		return result;
+	}
+
+	// 行ベクトル * 行列
+	template<typename T, size_t R, size_t C, storage_policy P> inline constexpr basic_vector<T, C, P> operator*(const basic_vector<T, R, P>& v, const basic_matrix<T, R, C>& m) noexcept
+	{
+		basic_vector<T, C, P> result;
+		const auto* r = m.data();
+
+		unroll<C>([&](auto x) { result[x] = v[0] * r[x]; });
+		unroll<R - 1>([&](auto k)
+		{
+			unroll<C>([&](auto x) { result[x] += v[k + 1] * r[(k + 1) * C + x]; });
+		});
+
+		return result;
+	}
+}
\ No newline at end of file
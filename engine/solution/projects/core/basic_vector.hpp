@@ -0,0 +1,204 @@
+﻿#pragma once
+#include "math.hpp"
+
+namespace math
+{
+	/*
+		要素の並べ方
+		packed  : 要素だけを詰める (vector3 は 12 bytes。頂点やバッファにそのまま置ける)
+		aligned : 16 bytes 境界に置き、サイズも 16 の倍数にする (vector3 は 16 bytes。SIMD でまとめて読める)
+	*/
+	enum class storage_policy : uint8_t
+	{
+		packed,
+		aligned,
+	};
+
+	// 0..N-1 を定数として func に渡す (ループを展開した形になる)
+	template<size_t N, class F> inline constexpr void unroll(F&& func)
+	{
+		[&]<size_t... I>(std::index_sequence<I...>)
+		{
+			(func(std::integral_constant<size_t, I>{}), ...);
+		}(std::make_index_sequence<N>{});
+	}
+
+	// std::abs は C++20 では constexpr でないため
+	template<typename T> inline constexpr T abs_of(T value) noexcept { return value < T(0) ? -value : value; }
+
+	template<typename T> inline constexpr T sqrt_of(T value) noexcept
+	{
+		// 定数式の中だけ近似の math::sqrt を使う
+		if(std::is_constant_evaluated()) return static_cast<T>(math::sqrt(static_cast<float>(value)));
+		return static_cast<T>(std::sqrt(value));
+	}
+
+	template<typename T, size_t N, storage_policy P = storage_policy::packed> class basic_vector
+	{
+		static_assert(N >= 2 && N <= 4, "basic_vector は 2 ～ 4 要素");
+
+	public:
+		static constexpr size_t size = N;
+		static constexpr size_t alignment = P == storage_policy::aligned ? std::max<size_t>(16, alignof(T)) : alignof(T);
+
+	public:
+		explicit inline constexpr basic_vector() noexcept : basic_vector(T(0)) {}
+		explicit inline constexpr basic_vector(T value) noexcept { unroll<N>([&](auto i) { _[i] = value; }); }
+
+		template<typename... Args> requires (sizeof...(Args) == N && (std::is_arithmetic_v<Args> && ...))
+		explicit inline constexpr basic_vector(Args... values) noexcept : _{ static_cast<T>(values)... } {}
+
+		// 並べ方の違うものからの変換
+		template<storage_policy Q> requires (Q != P)
+		explicit inline constexpr basic_vector(const basic_vector<T, N, Q>& other) noexcept { unroll<N>([&](auto i) { _[i] = other[i]; }); }
+
+	public:
+		inline constexpr T* data() noexcept { return _.data(); }
+		inline constexpr T& operator[](size_t index) noexcept { return _[index]; }
+		inline constexpr T& at(size_t index) { return _.at(index); }
+
+		inline constexpr T& x() noexcept { return _[0]; }
+		inline constexpr T& y() noexcept { return _[1]; }
+		inline constexpr T& z() noexcept requires (N >= 3) { return _[2]; }
+		inline constexpr T& w() noexcept requires (N >= 4) { return _[3]; }
+
+	public:
+		inline constexpr const T* data() const noexcept { return _.data(); }
+		inline constexpr const T& operator[](size_t index) const noexcept { return _[index]; }
+		inline constexpr const T& at(size_t index) const { return _.at(index); }
+
+		inline constexpr const T& x() const noexcept { return _[0]; }
+		inline constexpr const T& y() const noexcept { return _[1]; }
+		inline constexpr const T& z() const noexcept requires (N >= 3) { return _[2]; }
+		inline constexpr const T& w() const noexcept requires (N >= 4) { return _[3]; }
+
+	public:
+		inline constexpr basic_vector& operator+=(const basic_vector& other) noexcept;
+		inline constexpr basic_vector& operator-=(const basic_vector& other) noexcept;
+		inline constexpr basic_vector& operator*=(T value) noexcept;
+		inline constexpr basic_vector& operator/=(T value) noexcept;
+
+	public:
+		inline constexpr basic_vector operator+(const basic_vector& other) const noexcept;
+		inline constexpr basic_vector operator-(const basic_vector& other) const noexcept;
+		inline constexpr basic_vector operator*(T value) const noexcept;
+		inline constexpr basic_vector operator/(T value) const noexcept;
+		inline constexpr basic_vector operator-() const noexcept;
+
+		inline constexpr bool operator==(const basic_vector& other) const noexcept = default;
+
+	public:
+		// 長さ 0 のときはそのまま
+		inline constexpr void normalize() noexcept;
+
+	public:
+		inline constexpr T length_square() const noexcept { return dot(*this); }
+		inline constexpr T length() const noexcept { return sqrt_of(length_square()); }
+		inline constexpr basic_vector normalized() const noexcept;
+		inline constexpr T dot(const basic_vector& other) const noexcept;
+
+		// 2 要素は z 成分 (スカラー)、3 要素はベクトル
+		inline constexpr T cross(const basic_vector& other) const noexcept requires (N == 2);
+		inline constexpr basic_vector cross(const basic_vector& other) const noexcept requires (N == 3);
+
+	public:
+		static inline constexpr basic_vector one() noexcept { return basic_vector(T(1)); }
+		static inline constexpr basic_vector zero() noexcept { return basic_vector(T(0)); }
+
+		static inline constexpr basic_vector right() noexcept requires (N == 3) { return basic_vector(1, 0, 0); }
+		static inline constexpr basic_vector left() noexcept requires (N == 3) { return basic_vector(-1, 0, 0); }
+		static inline constexpr basic_vector up() noexcept requires (N == 3) { return basic_vector(0, 1, 0); }
+		static inline constexpr basic_vector down() noexcept requires (N == 3) { return basic_vector(0, -1, 0); }
+		static inline constexpr basic_vector forward() noexcept requires (N == 3) { return basic_vector(0, 0, 1); }
+		static inline constexpr basic_vector backward() noexcept requires (N == 3) { return basic_vector(0, 0, -1); }
+
+	private:
+		alignas(alignment) std::array<T, N> _;
+	};
+
+	/*  -----  inline定義  -----------------------------------  */
+
+	template<typename T, size_t N, storage_policy P> inline constexpr basic_vector<T, N, P>& basic_vector<T, N, P>::operator+=(const basic_vector& other) noexcept
+	{
+		unroll<N>([&](auto i) { _[i] += other._[i]; });
+		return *this;
+	}
+
+	template<typename T, size_t N, storage_policy P> inline constexpr basic_vector<T, N, P>& basic_vector<T, N, P>::operator-=(const basic_vector& other) noexcept
+	{
+		unroll<N>([&](auto i) { _[i] -= other._[i]; });
+		return *this;
+	}
+
+	template<typename T, size_t N, storage_policy P> inline constexpr basic_vector<T, N, P>& basic_vector<T, N, P>::operator*=(T value) noexcept
+	{
+		unroll<N>([&](auto i) { _[i] *= value; });
+		return *this;
+	}
+
+	template<typename T, size_t N, storage_policy P> inline constexpr basic_vector<T, N, P>& basic_vector<T, N, P>::operator/=(T value) noexcept
+	{
+		// 整数は逆数にすると 0 になるので要素ごとに割る
+		if constexpr (std::is_floating_point_v<T>)
+		{
+			return *this *= T(1) / value;
+		}
+		else
+		{
+			unroll<N>([&](auto i) { _[i] /= value; });
+			return *this;
+		}
+	}
+
+	template<typename T, size_t N, storage_policy P> inline constexpr basic_vector<T, N, P> basic_vector<T, N, P>::operator+(const basic_vector& other) const noexcept { return basic_vector(*this) += other; }
+	template<typename T, size_t N, storage_policy P> inline constexpr basic_vector<T, N, P> basic_vector<T, N, P>::operator-(const basic_vector& other) const noexcept { return basic_vector(*this) -= other; }
+	template<typename T, size_t N, storage_policy P> inline constexpr basic_vector<T, N, P> basic_vector<T, N, P>::operator*(T value) const noexcept { return basic_vector(*this) *= value; }
+	template<typename T, size_t N, storage_policy P> inline constexpr basic_vector<T, N, P> basic_vector<T, N, P>::operator/(T value) const noexcept { return basic_vector(*this) /= value; }
+
+	template<typename T, size_t N, storage_policy P> inline constexpr basic_vector<T, N, P> basic_vector<T, N, P>::operator-() const noexcept
+	{
+		auto result = *this;
+		unroll<N>([&](auto i) { result._[i] = -_[i]; });
+		return result;
+	}
+
+	template<typename T, size_t N, storage_policy P> inline constexpr void basic_vector<T, N, P>::normalize() noexcept
+	{
+		const auto& length = this->length();
+		if(length > T(0)) *this /= length;
+	}
+
+	template<typename T, size_t N, storage_policy P> inline constexpr basic_vector<T, N, P> basic_vector<T, N, P>::normalized() const noexcept
+	{
+		auto copy = *this;
+		copy.normalize();
+		return copy;
+	}
+
+	template<typename T, size_t N, storage_policy P> inline constexpr T basic_vector<T, N, P>::dot(const basic_vector& other) const noexcept
+	{
+		T result(0);
+		unroll<N>([&](auto i) { result += _[i] * other._[i]; });
+		return result;
+	}
+
+	template<typename T, size_t N, storage_policy P> inline constexpr T basic_vector<T, N, P>::cross(const basic_vector& other) const noexcept requires (N == 2)
+	{
+		return x() * other.y() - other.x() * y();
+	}
+
+	template<typename T, size_t N, storage_policy P> inline constexpr basic_vector<T, N, P> basic_vector<T, N, P>::cross(const basic_vector& other) const noexcept requires (N == 3)
+	{
+		return basic_vector
+		(
+			y() * other.z() - z() * other.y(),
+			z() * other.x() - x() * other.z(),
+			x() * other.y() - y() * other.x()
+		);
+	}
+
+	template<typename T, size_t N, storage_policy P> inline constexpr basic_vector<T, N, P> operator*(T value, const basic_vector<T, N, P>& vector) noexcept { return vector * value; }
+
+	static_assert(sizeof(basic_vector<float, 3>) == 12, "packed は要素だけの大きさ");
+	static_assert(sizeof(basic_vector<float, 3, storage_policy::aligned>) == 16, "aligned は 16 bytes 単位");
+}
\ No newline at end of file
@@ -0,0 +1,628 @@
+﻿#include "include.hpp"
+
+namespace
+{
+	using math::aabb;
+	using math::aabb8;
+	using math::sphere;
+	using math::sphere8;
+	using math::BOUNDS_LANES;
+
+	constexpr float INF = std::numeric_limits<float>::infinity();
+
+	static_assert(sizeof(aabb) == sizeof(float) * 6, "aabb は float 6 個を詰めた並び");
+	static_assert(sizeof(vector3) == sizeof(float) * 3, "vector3 は float 3 個を詰めた並び");
+
+	using lanes = std::array<float, BOUNDS_LANES>;
+
+	/*
+		8 要素をまとめて計算する型 (SSE では 4 要素 x 2)
+		比較の結果はレーンごとのマスクで、select() と to_bits() に渡す
+	*/
+#if MATH_SSE
+	struct float8
+	{
+		__m128 lo;
+		__m128 hi;
+	};
+
+	inline float8 load(const float* p) noexcept { return { _mm_loadu_ps(p), _mm_loadu_ps(p + 4) }; }
+	inline float8 load(const lanes& a) noexcept { return load(a.data()); }
+	inline void store(lanes& a, const float8& v) noexcept
+	{
+		_mm_storeu_ps(a.data(), v.lo);
+		_mm_storeu_ps(a.data() + 4, v.hi);
+	}
+
+	inline float8 broadcast(float value) noexcept { return { _mm_set1_ps(value), _mm_set1_ps(value) }; }
+	inline float8 lane_index() noexcept { return { _mm_set_ps(3, 2, 1, 0), _mm_set_ps(7, 6, 5, 4) }; }
+
+	inline float8 operator+(const float8& a, const float8& b) noexcept { return { _mm_add_ps(a.lo, b.lo), _mm_add_ps(a.hi, b.hi) }; }
+	inline float8 operator-(const float8& a, const float8& b) noexcept { return { _mm_sub_ps(a.lo, b.lo), _mm_sub_ps(a.hi, b.hi) }; }
+	inline float8 operator*(const float8& a, const float8& b) noexcept { return { _mm_mul_ps(a.lo, b.lo), _mm_mul_ps(a.hi, b.hi) }; }
+	inline float8 min(const float8& a, const float8& b) noexcept { return { _mm_min_ps(a.lo, b.lo), _mm_min_ps(a.hi, b.hi) }; }
+	inline float8 max(const float8& a, const float8& b) noexcept { return { _mm_max_ps(a.lo, b.lo), _mm_max_ps(a.hi, b.hi) }; }
+	inline float8 abs(const float8& a) noexcept
+	{
+		const auto& sign = _mm_set1_ps(-0.0f);
+		return { _mm_andnot_ps(sign, a.lo), _mm_andnot_ps(sign, a.hi) };
+	}
+
+	inline float8 greater(const float8& a, const float8& b) noexcept { return { _mm_cmpgt_ps(a.lo, b.lo), _mm_cmpgt_ps(a.hi, b.hi) }; }
+	inline float8 less(const float8& a, const float8& b) noexcept { return { _mm_cmplt_ps(a.lo, b.lo), _mm_cmplt_ps(a.hi, b.hi) }; }
+	inline float8 select(const float8& mask, const float8& a, const float8& b) noexcept
+	{
+		return { _mm_or_ps(_mm_and_ps(mask.lo, a.lo), _mm_andnot_ps(mask.lo, b.lo)), _mm_or_ps(_mm_and_ps(mask.hi, a.hi), _mm_andnot_ps(mask.hi, b.hi)) };
+	}
+	inline uint32_t to_bits(const float8& mask) noexcept { return static_cast<uint32_t>(_mm_movemask_ps(mask.lo) | (_mm_movemask_ps(mask.hi) << 4)); }
+
+	// 詰めて並んだ点 8 個 (float 24 個) を x, y, z に分ける
+	inline void load_points(const float* p, float8& x, float8& y, float8& z) noexcept
+	{
+		auto split = [](const float* q, __m128& x, __m128& y, __m128& z)
+		{
+			const auto& a = _mm_loadu_ps(q + 0);		// x0 y0 z0 x1
+			const auto& b = _mm_loadu_ps(q + 4);		// y1 z1 x2 y2
+			const auto& c = _mm_loadu_ps(q + 8);		// z2 x3 y3 z3
+			const auto& t0 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2));	// x2 y2 x3 y3
+			const auto& t1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));	// y0 z0 y1 z1
+			x = _mm_shuffle_ps(a, t0, _MM_SHUFFLE(2, 0, 3, 0));
+			y = _mm_shuffle_ps(t1, t0, _MM_SHUFFLE(3, 1, 2, 0));
+			z = _mm_shuffle_ps(t1, c, _MM_SHUFFLE(3, 0, 3, 1));
+		};
+		split(p, x.lo, y.lo, z.lo);
+		split(p + 12, x.hi, y.hi, z.hi);
+	}
+
+	// 箱 8 個を min_x, min_y, min_z, max_x, max_y, max_z に分ける
+	inline void load_boxes(const aabb* boxes, std::array<float8, 6>& out) noexcept
+	{
+		auto split = [](const float* q, __m128 (&v)[6])
+		{
+			// 各箱の先頭 4 要素 (min_x min_y min_z max_x) は転置、残りの max_y max_z は 2 個ずつ詰める
+			v[0] = _mm_loadu_ps(q + 0);
+			v[1] = _mm_loadu_ps(q + 6);
+			v[2] = _mm_loadu_ps(q + 12);
+			v[3] = _mm_loadu_ps(q + 18);
+			_MM_TRANSPOSE4_PS(v[0], v[1], v[2], v[3]);
+
+			const auto& yz01 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(q + 4)), reinterpret_cast<const __m64*>(q + 10));
+			const auto& yz23 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(q + 16)), reinterpret_cast<const __m64*>(q + 22));
+			v[4] = _mm_shuffle_ps(yz01, yz23, _MM_SHUFFLE(2, 0, 2, 0));
+			v[5] = _mm_shuffle_ps(yz01, yz23, _MM_SHUFFLE(3, 1, 3, 1));
+		};
+
+		__m128 lo[6];
+		__m128 hi[6];
+		split(boxes[0].min.data(), lo);
+		split(boxes[4].min.data(), hi);
+		for(size_t i = 0; i < 6; ++i) out[i] = { lo[i], hi[i] };
+	}
+
+	inline void store_boxes(aabb* boxes, const std::array<float8, 6>& in) noexcept
+	{
+		auto merge = [](float* q, __m128 v0, __m128 v1, __m128 v2, __m128 v3, __m128 max_y, __m128 max_z)
+		{
+			_MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+			const auto& yz01 = _mm_unpacklo_ps(max_y, max_z);
+			const auto& yz23 = _mm_unpackhi_ps(max_y, max_z);
+
+			_mm_storeu_ps(q + 0, v0);
+			_mm_storeu_ps(q + 6, v1);
+			_mm_storeu_ps(q + 12, v2);
+			_mm_storeu_ps(q + 18, v3);
+			_mm_storel_pi(reinterpret_cast<__m64*>(q + 4), yz01);
+			_mm_storeh_pi(reinterpret_cast<__m64*>(q + 10), yz01);
+			_mm_storel_pi(reinterpret_cast<__m64*>(q + 16), yz23);
+			_mm_storeh_pi(reinterpret_cast<__m64*>(q + 22), yz23);
+		};
+
+		merge(boxes[0].min.data(), in[0].lo, in[1].lo, in[2].lo, in[3].lo, in[4].lo, in[5].lo);
+		merge(boxes[4].min.data(), in[0].hi, in[1].hi, in[2].hi, in[3].hi, in[4].hi, in[5].hi);
+	}
+
+	// 行列 8 個の行 r を要素ごとに分ける
+	inline void load_rows(const affine3x4* transforms, size_t r, std::array<float8, 4>& out) noexcept
+	{
+		auto split = [&](const affine3x4* t, __m128& m0, __m128& m1, __m128& m2, __m128& m3)
+		{
+			m0 = _mm_load_ps(t[0].row(r).data());
+			m1 = _mm_load_ps(t[1].row(r).data());
+			m2 = _mm_load_ps(t[2].row(r).data());
+			m3 = _mm_load_ps(t[3].row(r).data());
+			_MM_TRANSPOSE4_PS(m0, m1, m2, m3);
+		};
+		split(transforms, out[0].lo, out[1].lo, out[2].lo, out[3].lo);
+		split(transforms + 4, out[0].hi, out[1].hi, out[2].hi, out[3].hi);
+	}
+#else
+	struct float8
+	{
+		lanes v;
+	};
+
+	template<class F> inline float8 each(F&& func) noexcept
+	{
+		float8 result;
+		math::unroll<BOUNDS_LANES>([&](auto i) { result.v[i] = func(i); });
+		return result;
+	}
+
+	inline float8 load(const float* p) noexcept { return each([&](size_t i) { return p[i]; }); }
+	inline float8 load(const lanes& a) noexcept { return float8{ a }; }
+	inline void store(lanes& a, const float8& v) noexcept { a = v.v; }
+
+	inline float8 broadcast(float value) noexcept { return each([&](size_t) { return value; }); }
+	inline float8 lane_index() noexcept { return each([&](size_t i) { return static_cast<float>(i); }); }
+
+	inline float8 operator+(const float8& a, const float8& b) noexcept { return each([&](size_t i) { return a.v[i] + b.v[i]; }); }
+	inline float8 operator-(const float8& a, const float8& b) noexcept { return each([&](size_t i) { return a.v[i] - b.v[i]; }); }
+	inline float8 operator*(const float8& a, const float8& b) noexcept { return each([&](size_t i) { return a.v[i] * b.v[i]; }); }
+	inline float8 min(const float8& a, const float8& b) noexcept { return each([&](size_t i) { return std::min(a.v[i], b.v[i]); }); }
+	inline float8 max(const float8& a, const float8& b) noexcept { return each([&](size_t i) { return std::max(a.v[i], b.v[i]); }); }
+	inline float8 abs(const float8& a) noexcept { return each([&](size_t i) { return std::abs(a.v[i]); }); }
+
+	// マスクは 1 / 0
+	inline float8 greater(const float8& a, const float8& b) noexcept { return each([&](size_t i) { return a.v[i] > b.v[i] ? 1.0f : 0.0f; }); }
+	inline float8 less(const float8& a, const float8& b) noexcept { return each([&](size_t i) { return a.v[i] < b.v[i] ? 1.0f : 0.0f; }); }
+	inline float8 select(const float8& mask, const float8& a, const float8& b) noexcept { return each([&](size_t i) { return mask.v[i] != 0.0f ? a.v[i] : b.v[i]; }); }
+	inline uint32_t to_bits(const float8& mask) noexcept
+	{
+		uint32_t bits = 0;
+		for(size_t i = 0; i < BOUNDS_LANES; ++i) bits |= mask.v[i] != 0.0f ? 1u << i : 0u;
+		return bits;
+	}
+
+	inline void load_points(const float* p, float8& x, float8& y, float8& z) noexcept
+	{
+		x = each([&](size_t i) { return p[i * 3 + 0]; });
+		y = each([&](size_t i) { return p[i * 3 + 1]; });
+		z = each([&](size_t i) { return p[i * 3 + 2]; });
+	}
+
+	inline void load_boxes(const aabb* boxes, std::array<float8, 6>& out) noexcept
+	{
+		for(size_t k = 0; k < 3; ++k)
+		{
+			out[k] = each([&](size_t i) { return boxes[i].min[k]; });
+			out[k + 3] = each([&](size_t i) { return boxes[i].max[k]; });
+		}
+	}
+
+	inline void store_boxes(aabb* boxes, const std::array<float8, 6>& in) noexcept
+	{
+		for(size_t i = 0; i < BOUNDS_LANES; ++i)
+		{
+			boxes[i] = aabb{ vector3(in[0].v[i], in[1].v[i], in[2].v[i]), vector3(in[3].v[i], in[4].v[i], in[5].v[i]) };
+		}
+	}
+
+	inline void load_rows(const affine3x4* transforms, size_t r, std::array<float8, 4>& out) noexcept
+	{
+		for(size_t k = 0; k < 4; ++k) out[k] = each([&](size_t i) { return transforms[i].row(r)[k]; });
+	}
+#endif
+
+	inline float reduce_min(const float8& v) noexcept
+	{
+		lanes a;
+		store(a, v);
+		return *std::min_element(a.begin(), a.end());
+	}
+
+	inline float reduce_max(const float8& v) noexcept
+	{
+		lanes a;
+		store(a, v);
+		return *std::max_element(a.begin(), a.end());
+	}
+
+	/*  from から最も遠い点の番号 (同じ距離なら番号の小さい方)  */
+	size_t farthest_point(gsl::span<const vector3> points, const vector3& from)
+	{
+		// 番号は float で持つので 2^24 個まで
+		Expects(points.size() <= (1u << 24));
+
+		const auto& fx = broadcast(from.x());
+		const auto& fy = broadcast(from.y());
+		const auto& fz = broadcast(from.z());
+
+		auto best = broadcast(-1.0f);
+		auto best_index = broadcast(0.0f);
+		auto index = lane_index();
+
+		const auto* data = points.data()->data();
+		const auto& full = points.size() / BOUNDS_LANES * BOUNDS_LANES;
+		for(size_t i = 0; i < full; i += BOUNDS_LANES)
+		{
+			float8 x, y, z;
+			load_points(data + i * 3, x, y, z);
+
+			const auto& dx = x - fx;
+			const auto& dy = y - fy;
+			const auto& dz = z - fz;
+			const auto& d = dx * dx + dy * dy + dz * dz;
+
+			const auto& farther = greater(d, best);
+			best = select(farther, d, best);
+			best_index = select(farther, index, best_index);
+			index = index + broadcast(static_cast<float>(BOUNDS_LANES));
+		}
+
+		/*  レーンをまとめ、残りを1つずつ調べる  */
+		lanes distances, indices;
+		store(distances, best);
+		store(indices, best_index);
+
+		auto result_distance = -1.0f;
+		size_t result = 0;
+		for(size_t lane = 0; lane < BOUNDS_LANES; ++lane)
+		{
+			const auto& i = static_cast<size_t>(indices[lane]);
+			if(distances[lane] > result_distance || (distances[lane] == result_distance && i < result))
+			{
+				result_distance = distances[lane];
+				result = i;
+			}
+		}
+
+		for(auto i = full; i < points.size(); ++i)
+		{
+			const auto& d = (points[i] - from).length_square();
+			if(d > result_distance)
+			{
+				result_distance = d;
+				result = i;
+			}
+		}
+
+		return result;
+	}
+}
+
+namespace math
+{
+	containment frustum::test(const aabb& box) const noexcept
+	{
+		auto inside = true;
+		for(const auto& plane : planes)
+		{
+			// 法線方向に最も進んだ頂点 / 最も戻った頂点
+			const auto& n = plane.normal;
+			const auto& far_distance = n.x() * (n.x() > 0 ? box.max.x() : box.min.x()) + n.y() * (n.y() > 0 ? box.max.y() : box.min.y()) + n.z() * (n.z() > 0 ? box.max.z() : box.min.z()) + plane.distance;
+			if(far_distance < 0) return containment::outside;
+
+			const auto& near_distance = n.x() * (n.x() > 0 ? box.min.x() : box.max.x()) + n.y() * (n.y() > 0 ? box.min.y() : box.max.y()) + n.z() * (n.z() > 0 ? box.min.z() : box.max.z()) + plane.distance;
+			if(near_distance < 0) inside = false;
+		}
+		return inside ? containment::inside : containment::intersect;
+	}
+
+	containment frustum::test(const sphere& s) const noexcept
+	{
+		auto inside = true;
+		for(const auto& plane : planes)
+		{
+			const auto& distance = plane.signed_distance(s.center);
+			if(distance < -s.radius) return containment::outside;
+			if(distance < s.radius) inside = false;
+		}
+		return inside ? containment::inside : containment::intersect;
+	}
+
+	containment frustum::test(const obb& box) const noexcept
+	{
+		auto inside = true;
+		for(const auto& plane : planes)
+		{
+			// 法線方向に投影した箱の半径
+			const auto& radius = box.extent.x() * std::abs(plane.normal.dot(box.axes[0])) + box.extent.y() * std::abs(plane.normal.dot(box.axes[1])) + box.extent.z() * std::abs(plane.normal.dot(box.axes[2]));
+			const auto& distance = plane.signed_distance(box.center);
+			if(distance < -radius) return containment::outside;
+			if(distance < radius) inside = false;
+		}
+		return inside ? containment::inside : containment::intersect;
+	}
+
+	frustum frustum::from_vectors(gsl::span<const vector4, 6> planes) noexcept
+	{
+		frustum result;
+		for(size_t i = 0; i < 6; ++i) result.planes[i] = plane::from_vector(planes[i]);
+		return result;
+	}
+
+	frustum frustum::from_view_projection(gsl::span<const float, 16> m) noexcept
+	{
+		// 行ベクトル形式なので列から平面を作る
+		auto column = [&](uint32_t c) { return vector4(m[0 * 4 + c], m[1 * 4 + c], m[2 * 4 + c], m[3 * 4 + c]); };
+
+		const auto& c0 = column(0);
+		const auto& c1 = column(1);
+		const auto& c2 = column(2);
+		const auto& c3 = column(3);
+
+		const std::array<vector4, 6> planes =
+		{
+			c3 + c0,	// left
+			c3 - c0,	// right
+			c3 + c1,	// bottom
+			c3 - c1,	// top
+			c2,			// near (D3D は 0 <= z)
+			c3 - c2,	// far
+		};
+
+		auto result = from_vectors(planes);
+		for(auto& plane : result.planes) plane = plane.normalized();
+		return result;
+	}
+
+	void pack_aabbs(gsl::span<const aabb> boxes, gsl::span<aabb8> out)
+	{
+		Expects(out.size() >= bounds_blocks(boxes.size()));
+
+		const auto& full = boxes.size() / BOUNDS_LANES;
+		for(size_t i = 0; i < full; ++i)
+		{
+			std::array<float8, 6> box;
+			load_boxes(boxes.data() + i * BOUNDS_LANES, box);
+
+			auto& block = out[i];
+			store(block.min_x, box[0]);
+			store(block.min_y, box[1]);
+			store(block.min_z, box[2]);
+			store(block.max_x, box[3]);
+			store(block.max_y, box[4]);
+			store(block.max_z, box[5]);
+		}
+
+		for(auto i = full; i < bounds_blocks(boxes.size()); ++i)
+		{
+			auto& block = out[i];
+			for(size_t lane = 0; lane < BOUNDS_LANES; ++lane)
+			{
+				const auto& index = i * BOUNDS_LANES + lane;
+				const auto& box = index < boxes.size() ? boxes[index] : aabb::empty();
+				block.min_x[lane] = box.min.x();
+				block.min_y[lane] = box.min.y();
+				block.min_z[lane] = box.min.z();
+				block.max_x[lane] = box.max.x();
+				block.max_y[lane] = box.max.y();
+				block.max_z[lane] = box.max.z();
+			}
+		}
+	}
+
+	void pack_spheres(gsl::span<const sphere> spheres, gsl::span<sphere8> out)
+	{
+		Expects(out.size() >= bounds_blocks(spheres.size()));
+
+		for(size_t i = 0; i < bounds_blocks(spheres.size()); ++i)
+		{
+			auto& block = out[i];
+			for(size_t lane = 0; lane < BOUNDS_LANES; ++lane)
+			{
+				const auto& index = i * BOUNDS_LANES + lane;
+				const auto& s = index < spheres.size() ? spheres[index] : sphere{ vector3(0.0f), 0.0f };
+				block.center_x[lane] = s.center.x();
+				block.center_y[lane] = s.center.y();
+				block.center_z[lane] = s.center.z();
+				block.radius[lane] = s.radius;
+			}
+		}
+	}
+
+	void transform_aabbs(gsl::span<const aabb> boxes, gsl::span<const affine3x4> transforms, gsl::span<aabb> out)
+	{
+		Expects(transforms.size() >= boxes.size());
+		Expects(out.size() >= boxes.size());
+
+		const auto& half = broadcast(0.5f);
+
+		const auto& full = boxes.size() / BOUNDS_LANES * BOUNDS_LANES;
+		for(size_t i = 0; i < full; i += BOUNDS_LANES)
+		{
+			/*  8 個分の箱を SoA に並べ替え、中心と半分の大きさにする  */
+			std::array<float8, 6> box;
+			load_boxes(boxes.data() + i, box);
+
+			const auto& cx = (box[0] + box[3]) * half;
+			const auto& cy = (box[1] + box[4]) * half;
+			const auto& cz = (box[2] + box[5]) * half;
+			const auto& ex = (box[3] - box[0]) * half;
+			const auto& ey = (box[4] - box[1]) * half;
+			const auto& ez = (box[5] - box[2]) * half;
+
+			// 行 r = (回転拡縮の r 列目, 平行移動の r 成分)
+			for(size_t r = 0; r < 3; ++r)
+			{
+				std::array<float8, 4> m;
+				load_rows(transforms.data() + i, r, m);
+
+				const auto& center = m[0] * cx + m[1] * cy + m[2] * cz + m[3];
+				const auto& extent = abs(m[0]) * ex + abs(m[1]) * ey + abs(m[2]) * ez;
+				box[r] = center - extent;
+				box[r + 3] = center + extent;
+			}
+
+			store_boxes(out.data() + i, box);
+		}
+
+		for(auto i = full; i < boxes.size(); ++i) out[i] = boxes[i].transformed(transforms[i]);
+	}
+
+	aabb merge_aabbs(gsl::span<const aabb> boxes)
+	{
+		/*
+			並べ替えずに min, max を点の並びとして 8 個 (箱 4 個) ずつ読む
+			偶数レーンが min、奇数レーンが max になる
+		*/
+		auto lo_x = broadcast(INF), lo_y = broadcast(INF), lo_z = broadcast(INF);
+		auto hi_x = broadcast(-INF), hi_y = broadcast(-INF), hi_z = broadcast(-INF);
+
+		const auto* data = boxes.data()->min.data();
+		const auto& boxes_per_load = BOUNDS_LANES / 2;
+		const auto& full = boxes.size() / boxes_per_load * boxes_per_load;
+		for(size_t i = 0; i < full; i += boxes_per_load)
+		{
+			float8 x, y, z;
+			load_points(data + i * 6, x, y, z);
+			lo_x = min(lo_x, x);
+			lo_y = min(lo_y, y);
+			lo_z = min(lo_z, z);
+			hi_x = max(hi_x, x);
+			hi_y = max(hi_y, y);
+			hi_z = max(hi_z, z);
+		}
+
+		auto result = aabb::empty();
+		{
+			std::array<lanes, 6> a;
+			store(a[0], lo_x);
+			store(a[1], lo_y);
+			store(a[2], lo_z);
+			store(a[3], hi_x);
+			store(a[4], hi_y);
+			store(a[5], hi_z);
+
+			for(size_t lane = 0; lane < BOUNDS_LANES; lane += 2)
+			{
+				result.merge(aabb{ vector3(a[0][lane], a[1][lane], a[2][lane]), vector3(a[3][lane + 1], a[4][lane + 1], a[5][lane + 1]) });
+			}
+		}
+
+		for(auto i = full; i < boxes.size(); ++i) result.merge(boxes[i]);
+
+		return result;
+	}
+
+	aabb merge_aabbs(gsl::span<const aabb8> blocks)
+	{
+		auto lo_x = broadcast(INF), lo_y = broadcast(INF), lo_z = broadcast(INF);
+		auto hi_x = broadcast(-INF), hi_y = broadcast(-INF), hi_z = broadcast(-INF);
+
+		for(const auto& block : blocks)
+		{
+			lo_x = min(lo_x, load(block.min_x));
+			lo_y = min(lo_y, load(block.min_y));
+			lo_z = min(lo_z, load(block.min_z));
+			hi_x = max(hi_x, load(block.max_x));
+			hi_y = max(hi_y, load(block.max_y));
+			hi_z = max(hi_z, load(block.max_z));
+		}
+
+		return aabb{ vector3(reduce_min(lo_x), reduce_min(lo_y), reduce_min(lo_z)), vector3(reduce_max(hi_x), reduce_max(hi_y), reduce_max(hi_z)) };
+	}
+
+	aabb aabb_from_points(gsl::span<const vector3> points)
+	{
+		auto lo_x = broadcast(INF), lo_y = broadcast(INF), lo_z = broadcast(INF);
+		auto hi_x = broadcast(-INF), hi_y = broadcast(-INF), hi_z = broadcast(-INF);
+
+		const auto* data = points.data()->data();
+		const auto& full = points.size() / BOUNDS_LANES * BOUNDS_LANES;
+		for(size_t i = 0; i < full; i += BOUNDS_LANES)
+		{
+			float8 x, y, z;
+			load_points(data + i * 3, x, y, z);
+			lo_x = min(lo_x, x);
+			lo_y = min(lo_y, y);
+			lo_z = min(lo_z, z);
+			hi_x = max(hi_x, x);
+			hi_y = max(hi_y, y);
+			hi_z = max(hi_z, z);
+		}
+
+		auto result = aabb{ vector3(reduce_min(lo_x), reduce_min(lo_y), reduce_min(lo_z)), vector3(reduce_max(hi_x), reduce_max(hi_y), reduce_max(hi_z)) };
+		for(auto i = full; i < points.size(); ++i) result.merge(points[i]);
+
+		return result;
+	}
+
+	sphere sphere_from_points(gsl::span<const vector3> points)
+	{
+		Expects(!points.empty());
+
+		/*  最初の点から最も遠い点 a、a から最も遠い点 b を直径の両端にする  */
+		const auto& a = points[farthest_point(points, points[0])];
+		const auto& b = points[farthest_point(points, a)];
+		const auto& center = (a + b) * 0.5f;
+
+		// 全ての点が入るように半径を決める (中心は動かさない)
+		const auto& cx = broadcast(center.x());
+		const auto& cy = broadcast(center.y());
+		const auto& cz = broadcast(center.z());
+		auto radius_square = broadcast(0.0f);
+
+		const auto* data = points.data()->data();
+		const auto& full = points.size() / BOUNDS_LANES * BOUNDS_LANES;
+		for(size_t i = 0; i < full; i += BOUNDS_LANES)
+		{
+			float8 x, y, z;
+			load_points(data + i * 3, x, y, z);
+
+			const auto& dx = x - cx;
+			const auto& dy = y - cy;
+			const auto& dz = z - cz;
+			radius_square = max(radius_square, dx * dx + dy * dy + dz * dz);
+		}
+
+		auto result = reduce_max(radius_square);
+		for(auto i = full; i < points.size(); ++i) result = std::max(result, (points[i] - center).length_square());
+
+		return sphere{ center, std::sqrt(result) };
+	}
+
+	void cull_aabbs(const frustum& view, gsl::span<const aabb8> blocks, size_t count, gsl::span<uint8_t> out_masks)
+	{
+		Expects(blocks.size() >= bounds_blocks(count));
+		Expects(out_masks.size() >= bounds_blocks(count));
+
+		const auto& zero = broadcast(0.0f);
+
+		for(size_t i = 0; i < bounds_blocks(count); ++i)
+		{
+			const auto& block = blocks[i];
+			auto visible = count - i * BOUNDS_LANES >= BOUNDS_LANES ? 0xffu : (1u << (count - i * BOUNDS_LANES)) - 1u;
+
+			for(const auto& plane : view.planes)
+			{
+				// 法線方向に最も進んだ頂点が裏側なら外
+				const auto& n = plane.normal;
+				const auto& px = load(n.x() > 0 ? block.max_x : block.min_x);
+				const auto& py = load(n.y() > 0 ? block.max_y : block.min_y);
+				const auto& pz = load(n.z() > 0 ? block.max_z : block.min_z);
+
+				const auto& distance = px * broadcast(n.x()) + py * broadcast(n.y()) + pz * broadcast(n.z()) + broadcast(plane.distance);
+				visible &= ~to_bits(less(distance, zero));
+			}
+
+			out_masks[i] = static_cast<uint8_t>(visible);
+		}
+	}
+
+	void cull_spheres(const frustum& view, gsl::span<const sphere8> blocks, size_t count, gsl::span<uint8_t> out_masks)
+	{
+		Expects(blocks.size() >= bounds_blocks(count));
+		Expects(out_masks.size() >= bounds_blocks(count));
+
+		for(size_t i = 0; i < bounds_blocks(count); ++i)
+		{
+			const auto& block = blocks[i];
+			auto visible = count - i * BOUNDS_LANES >= BOUNDS_LANES ? 0xffu : (1u << (count - i * BOUNDS_LANES)) - 1u;
+
+			const auto& x = load(block.center_x);
+			const auto& y = load(block.center_y);
+			const auto& z = load(block.center_z);
+			const auto& neg_radius = broadcast(0.0f) - load(block.radius);
+
+			for(const auto& plane : view.planes)
+			{
+				const auto& n = plane.normal;
+				const auto& distance = x * broadcast(n.x()) + y * broadcast(n.y()) + z * broadcast(n.z()) + broadcast(plane.distance);
+				visible &= ~to_bits(less(distance, neg_radius));
+			}
+
+			out_masks[i] = static_cast<uint8_t>(visible);
+		}
+	}
+}
\ No newline at end of file
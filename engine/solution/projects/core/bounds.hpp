@@ -0,0 +1,270 @@
+﻿#pragma once
+#include "affine3x4.hpp"
+
+/*
+	境界ボリューム (AABB / 球 / OBB / 平面 / 視錐台)
+
+	・平面は n・p + distance >= 0 を内側とする (meshlet_cull_view や camera::frustum() の vector4 と同じ向き)
+	・まとめて処理する関数は 8 要素ずつ SoA に並べ替えて計算する (aabb8 / sphere8 は SoA のまま持つとき用)
+*/
+
+namespace math
+{
+	enum class containment : uint8_t
+	{
+		outside,
+		intersect,
+		inside,
+	};
+
+	/*  -----  AABB  -----------------------------------  */
+
+	struct aabb
+	{
+		vector3 min;
+		vector3 max;
+
+	public:
+		inline constexpr vector3 center() const noexcept { return (min + max) * 0.5f; }
+		inline constexpr vector3 extent() const noexcept { return (max - min) * 0.5f; }
+		inline constexpr bool valid() const noexcept { return min.x() <= max.x() && min.y() <= max.y() && min.z() <= max.z(); }
+
+		inline constexpr float surface_area() const noexcept;
+		inline constexpr bool contains(const vector3& point) const noexcept;
+		inline constexpr bool overlaps(const aabb& other) const noexcept;
+
+		inline constexpr void merge(const vector3& point) noexcept;
+		inline constexpr void merge(const aabb& other) noexcept;
+
+		// 変換後の箱を囲む AABB (Arvo の方法)
+		inline aabb transformed(const affine3x4& transform) const noexcept;
+
+	public:
+		// merge() の単位元 (min > max)
+		static inline constexpr aabb empty() noexcept;
+		static inline constexpr aabb from_center(const vector3& center, const vector3& extent) noexcept { return aabb{ center - extent, center + extent }; }
+	};
+
+	/*  -----  球  -----------------------------------  */
+
+	struct sphere
+	{
+		vector3 center;
+		float radius;
+
+	public:
+		inline constexpr bool contains(const vector3& point) const noexcept { return (point - center).length_square() <= radius * radius; }
+		inline constexpr bool overlaps(const sphere& other) const noexcept;
+
+		inline constexpr aabb bounds() const noexcept { return aabb::from_center(center, vector3(radius)); }
+	};
+
+	/*  -----  OBB  -----------------------------------  */
+
+	struct obb
+	{
+		vector3 center;
+		std::array<vector3, 3> axes;		// 正規直交
+		vector3 extent;					// axes 方向の半分の長さ
+
+	public:
+		inline bool contains(const vector3& point) const noexcept;
+		inline aabb bounds() const noexcept;
+
+		// 変換後の箱 (せん断は表せないので、軸が直交しない変換では近似になる)
+		static inline obb from(const aabb& box, const affine3x4& transform) noexcept;
+	};
+
+	/*  -----  平面  -----------------------------------  */
+
+	struct plane
+	{
+		vector3 normal;
+		float distance;
+
+	public:
+		inline constexpr float signed_distance(const vector3& point) const noexcept { return normal.dot(point) + distance; }
+		inline constexpr vector4 to_vector() const noexcept { return vector4(normal.x(), normal.y(), normal.z(), distance); }
+
+		// 法線の長さを 1 にする (長さ 0 ならそのまま)
+		inline plane normalized() const noexcept;
+
+	public:
+		static inline constexpr plane from_vector(const vector4& v) noexcept { return plane{ vector3(v.x(), v.y(), v.z()), v.w() }; }
+		static inline constexpr plane from_point(const vector3& normal, const vector3& point) noexcept { return plane{ normal, -normal.dot(point) }; }
+	};
+
+	/*  -----  視錐台  -----------------------------------  */
+
+	struct frustum
+	{
+		std::array<plane, 6> planes;		// left, right, bottom, top, near, far (法線は内向き)
+
+	public:
+		containment test(const aabb& box) const noexcept;
+		containment test(const sphere& s) const noexcept;
+		containment test(const obb& box) const noexcept;
+
+	public:
+		static frustum from_vectors(gsl::span<const vector4, 6> planes) noexcept;
+
+		// ビュー行列 * 射影行列 (行ベクトル形式、行優先の16要素、D3D の 0 <= z <= w) から取り出す (Gribb & Hartmann)
+		static frustum from_view_projection(gsl::span<const float, 16> view_projection) noexcept;
+	};
+
+	/*  -----  SoA (8 要素ずつ)  -----------------------------------  */
+
+	inline constexpr size_t BOUNDS_LANES = 8;
+
+	struct alignas(32) aabb8
+	{
+		std::array<float, BOUNDS_LANES> min_x;
+		std::array<float, BOUNDS_LANES> min_y;
+		std::array<float, BOUNDS_LANES> min_z;
+		std::array<float, BOUNDS_LANES> max_x;
+		std::array<float, BOUNDS_LANES> max_y;
+		std::array<float, BOUNDS_LANES> max_z;
+	};
+
+	struct alignas(32) sphere8
+	{
+		std::array<float, BOUNDS_LANES> center_x;
+		std::array<float, BOUNDS_LANES> center_y;
+		std::array<float, BOUNDS_LANES> center_z;
+		std::array<float, BOUNDS_LANES> radius;
+	};
+
+	inline constexpr size_t bounds_blocks(size_t count) noexcept { return (count + BOUNDS_LANES - 1) / BOUNDS_LANES; }
+
+	// 余ったレーンは空の箱 / 半径 0 の球で埋める
+	void pack_aabbs(gsl::span<const aabb> boxes, gsl::span<aabb8> out);
+	void pack_spheres(gsl::span<const sphere> spheres, gsl::span<sphere8> out);
+
+	/*  -----  まとめて処理する  -----------------------------------  */
+
+	// out[i] = boxes[i].transformed(transforms[i])
+	void transform_aabbs(gsl::span<const aabb> boxes, gsl::span<const affine3x4> transforms, gsl::span<aabb> out);
+
+	aabb merge_aabbs(gsl::span<const aabb> boxes);
+	aabb merge_aabbs(gsl::span<const aabb8> blocks);
+	aabb aabb_from_points(gsl::span<const vector3> points);
+
+	// 最も離れた2点 (の近似) を直径の初期値にし、全ての点が入る半径にする。points は空でないこと
+	sphere sphere_from_points(gsl::span<const vector3> points);
+
+	// out_masks[i] の bit j = 要素 i * 8 + j が視錐台と交わる (部分的に入っているものを含む)。count 以降のビットは 0
+	void cull_aabbs(const frustum& view, gsl::span<const aabb8> blocks, size_t count, gsl::span<uint8_t> out_masks);
+	void cull_spheres(const frustum& view, gsl::span<const sphere8> blocks, size_t count, gsl::span<uint8_t> out_masks);
+
+	/*  -----  inline定義  -----------------------------------  */
+
+	inline constexpr float aabb::surface_area() const noexcept
+	{
+		const auto& size = max - min;
+		if(size.x() < 0 || size.y() < 0 || size.z() < 0) return 0.0f;
+		return 2.0f * (size.x() * size.y() + size.y() * size.z() + size.z() * size.x());
+	}
+
+	inline constexpr bool aabb::contains(const vector3& point) const noexcept
+	{
+		return min.x() <= point.x() && point.x() <= max.x()
+			&& min.y() <= point.y() && point.y() <= max.y()
+			&& min.z() <= point.z() && point.z() <= max.z();
+	}
+
+	inline constexpr bool aabb::overlaps(const aabb& other) const noexcept
+	{
+		return min.x() <= other.max.x() && other.min.x() <= max.x()
+			&& min.y() <= other.max.y() && other.min.y() <= max.y()
+			&& min.z() <= other.max.z() && other.min.z() <= max.z();
+	}
+
+	inline constexpr void aabb::merge(const vector3& point) noexcept
+	{
+		unroll<3>([&](auto i)
+		{
+			min[i] = std::min(min[i], point[i]);
+			max[i] = std::max(max[i], point[i]);
+		});
+	}
+
+	inline constexpr void aabb::merge(const aabb& other) noexcept
+	{
+		unroll<3>([&](auto i)
+		{
+			min[i] = std::min(min[i], other.min[i]);
+			max[i] = std::max(max[i], other.max[i]);
+		});
+	}
+
+	inline aabb aabb::transformed(const affine3x4& transform) const noexcept
+	{
+		/*  中心は点として、半分の大きさは回転拡縮の絶対値で変換する  */
+		const auto& c = center();
+		const auto& e = extent();
+
+		vector3 new_center;
+		vector3 new_extent;
+		unroll<3>([&](auto i)
+		{
+			const auto& row = transform.row(i);
+			new_center[i] = row.x() * c.x() + row.y() * c.y() + row.z() * c.z() + row.w();
+			new_extent[i] = std::abs(row.x()) * e.x() + std::abs(row.y()) * e.y() + std::abs(row.z()) * e.z();
+		});
+		return from_center(new_center, new_extent);
+	}
+
+	inline constexpr aabb aabb::empty() noexcept
+	{
+		constexpr auto inf = std::numeric_limits<float>::infinity();
+		return aabb{ vector3(inf), vector3(-inf) };
+	}
+
+	inline constexpr bool sphere::overlaps(const sphere& other) const noexcept
+	{
+		const auto& r = radius + other.radius;
+		return (other.center - center).length_square() <= r * r;
+	}
+
+	inline bool obb::contains(const vector3& point) const noexcept
+	{
+		const auto& d = point - center;
+		auto inside = true;
+		unroll<3>([&](auto i) { inside = inside && std::abs(d.dot(axes[i])) <= extent[i]; });
+		return inside;
+	}
+
+	inline aabb obb::bounds() const noexcept
+	{
+		vector3 radius;
+		unroll<3>([&](auto j) { radius[j] = std::abs(axes[0][j]) * extent[0] + std::abs(axes[1][j]) * extent[1] + std::abs(axes[2][j]) * extent[2]; });
+		return aabb::from_center(center, radius);
+	}
+
+	inline obb obb::from(const aabb& box, const affine3x4& transform) noexcept
+	{
+		obb result{ vector3(), { vector3(), vector3(), vector3() }, vector3() };
+		result.center = transform.transform_point(box.center());
+
+		const auto& e = box.extent();
+		unroll<3>([&](auto i)
+		{
+			// 箱の軸 i を変換した向きと長さ
+			auto axis = vector3(0.0f);
+			axis[i] = 1.0f;
+			axis = transform.transform_vector(axis);
+
+			const auto& length = axis.length();
+			result.axes[i] = length > 0.0f ? axis / length : axis;
+			result.extent[i] = e[i] * length;
+		});
+		return result;
+	}
+
+	inline plane plane::normalized() const noexcept
+	{
+		const auto& length = normal.length();
+		if(length <= 0.0f) return *this;
+		return plane{ normal / length, distance / length };
+	}
+}
\ No newline at end of file
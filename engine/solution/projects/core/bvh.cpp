@@ -0,0 +1,638 @@
+﻿#include "include.hpp"
+
+namespace
+{
+	using core::bvh_bounds;
+	using core::bvh_node;
+
+	constexpr float INF = std::numeric_limits<float>::infinity();
+	constexpr uint32_t BIN_COUNT = 16;
+
+	inline constexpr bvh_bounds empty_bounds() noexcept
+	{
+		return bvh_bounds{ { INF, INF, INF }, { -INF, -INF, -INF } };
+	}
+
+	inline void merge(bvh_bounds& to, const bvh_bounds& from) noexcept
+	{
+		for(auto axis = 0; axis < 3; ++axis)
+		{
+			to.min[axis] = std::min(to.min[axis], from.min[axis]);
+			to.max[axis] = std::max(to.max[axis], from.max[axis]);
+		}
+	}
+
+	inline float surface_area(const bvh_bounds& b) noexcept
+	{
+		const auto& x = b.max[0] - b.min[0];
+		const auto& y = b.max[1] - b.min[1];
+		const auto& z = b.max[2] - b.min[2];
+		return (x < 0 || y < 0 || z < 0) ? 0.0f : 2.0f * (x * y + y * z + z * x);
+	}
+
+	inline float centroid(const bvh_bounds& b, int axis) noexcept
+	{
+		return (b.min[axis] + b.max[axis]) * 0.5f;
+	}
+
+	inline bvh_bounds lane_bounds(const bvh_node& node, int lane) noexcept
+	{
+		return bvh_bounds{ { node.min_x[lane], node.min_y[lane], node.min_z[lane] }, { node.max_x[lane], node.max_y[lane], node.max_z[lane] } };
+	}
+
+	inline void set_lane(bvh_node& node, int lane, const bvh_bounds& b) noexcept
+	{
+		node.min_x[lane] = b.min[0];
+		node.min_y[lane] = b.min[1];
+		node.min_z[lane] = b.min[2];
+		node.max_x[lane] = b.max[0];
+		node.max_y[lane] = b.max[1];
+		node.max_z[lane] = b.max[2];
+	}
+
+	inline bvh_node empty_node() noexcept
+	{
+		bvh_node node{};
+		for(auto lane = 0; lane < 4; ++lane) set_lane(node, lane, empty_bounds());
+		node.child.fill(core::bvh::EMPTY_CHILD);
+		node.count.fill(0);
+		return node;
+	}
+
+	inline bool overlaps(const bvh_bounds& a, const bvh_bounds& b) noexcept
+	{
+		return a.min[0] <= b.max[0] && b.min[0] <= a.max[0]
+			&& a.min[1] <= b.max[1] && b.min[1] <= a.max[1]
+			&& a.min[2] <= b.max[2] && b.min[2] <= a.max[2];
+	}
+
+	/*  視錐台との判定 (0: 外側 / 1: 交差 / 2: 内側)  */
+	inline int classify(const bvh_bounds& b, gsl::span<const vector4, 6> planes) noexcept
+	{
+		auto inside = true;
+		for(const auto& plane : planes)
+		{
+			// 法線方向に最も進んだ頂点 / 最も戻った頂点
+			const auto& far_distance = plane.x() * (plane.x() > 0 ? b.max[0] : b.min[0]) + plane.y() * (plane.y() > 0 ? b.max[1] : b.min[1]) + plane.z() * (plane.z() > 0 ? b.max[2] : b.min[2]) + plane.w();
+			if(far_distance < 0) return 0;
+
+			const auto& near_distance = plane.x() * (plane.x() > 0 ? b.min[0] : b.max[0]) + plane.y() * (plane.y() > 0 ? b.min[1] : b.max[1]) + plane.z() * (plane.z() > 0 ? b.min[2] : b.max[2]) + plane.w();
+			if(near_distance < 0) inside = false;
+		}
+		return inside ? 2 : 1;
+	}
+
+	/*  レイとの判定 (交わらなければ false)  */
+	struct ray
+	{
+		std::array<float, 3> origin;
+		std::array<float, 3> inverse;
+		float max_distance;
+	};
+
+	inline ray make_ray(const vector3& origin, const vector3& direction, float max_distance) noexcept
+	{
+		return ray{ { origin.x(), origin.y(), origin.z() }, { 1.0f / direction.x(), 1.0f / direction.y(), 1.0f / direction.z() }, max_distance };
+	}
+
+	inline bool intersect(const ray& r, const bvh_bounds& b, float& t_enter) noexcept
+	{
+		auto t_min = 0.0f;
+		auto t_max = r.max_distance;
+		for(auto axis = 0; axis < 3; ++axis)
+		{
+			const auto& t0 = (b.min[axis] - r.origin[axis]) * r.inverse[axis];
+			const auto& t1 = (b.max[axis] - r.origin[axis]) * r.inverse[axis];
+			t_min = std::max(t_min, std::min(t0, t1));
+			t_max = std::min(t_max, std::max(t0, t1));
+		}
+
+		t_enter = t_min;
+		return t_min <= t_max;
+	}
+}
+
+namespace core
+{
+	void bvh::build(gsl::span<const bvh_bounds> bounds)
+	{
+		m_bounds.assign(bounds.begin(), bounds.end());
+		m_alive.assign(bounds.size(), 1);
+		m_alive_count = bounds.size();
+
+		m_pending.clear();
+		m_free.clear();
+		m_removed.clear();
+
+		rebuild();
+	}
+
+	uint32_t bvh::insert(const bvh_bounds& bounds)
+	{
+		uint32_t object{};
+		if(!m_free.empty())
+		{
+			object = m_free.back();
+			m_free.pop_back();
+
+			m_bounds.at(object) = bounds;
+			m_alive.at(object) = 1;
+		}
+		else
+		{
+			object = gsl::narrow<uint32_t>(m_bounds.size());
+			m_bounds.push_back(bounds);
+			m_alive.push_back(1);
+		}
+
+		m_pending.push_back(object);
+		++m_alive_count;
+
+		return object;
+	}
+
+	void bvh::remove(uint32_t object)
+	{
+		if(!alive(object)) return;
+
+		m_alive.at(object) = 0;
+		--m_alive_count;
+
+		/*  木に入っていなければすぐに番号を返せる  */
+		const auto& it = std::find(m_pending.begin(), m_pending.end(), object);
+		if(it != m_pending.end())
+		{
+			m_pending.erase(it);
+			m_free.push_back(object);
+			return;
+		}
+
+		// 木に残る間は refit() で親を広げないよう空にしておく
+		m_bounds.at(object) = empty_bounds();
+		m_removed.push_back(object);
+	}
+
+	void bvh::update(uint32_t object, const bvh_bounds& bounds)
+	{
+		Expects(alive(object));
+		m_bounds.at(object) = bounds;
+	}
+
+	void bvh::refit()
+	{
+		/*  子は親より後ろにあるので、後ろから詰め直せば1回で済む  */
+		for(auto i = m_nodes.size(); i-- > 0;)
+		{
+			auto& node = m_nodes[i];
+			for(auto lane = 0; lane < 4; ++lane)
+			{
+				const auto& child = node.child[lane];
+				if(child == EMPTY_CHILD) continue;
+
+				auto b = empty_bounds();
+				if(child & LEAF_FLAG)
+				{
+					const auto& first = child & ~LEAF_FLAG;
+					for(auto j = first; j < first + node.count[lane]; ++j) merge(b, m_bounds[m_refs[j]]);
+				}
+				else
+				{
+					const auto& sub = m_nodes[child];
+					for(auto k = 0; k < 4; ++k) merge(b, lane_bounds(sub, k));
+				}
+
+				set_lane(node, lane, b);
+			}
+		}
+	}
+
+	void bvh::rebuild()
+	{
+		m_free.insert(m_free.end(), m_removed.begin(), m_removed.end());
+		m_removed.clear();
+		m_pending.clear();
+
+		m_refs.clear();
+		m_refs.reserve(m_alive_count);
+		for(auto i = 0u; i < m_alive.size(); ++i)
+		{
+			if(m_alive[i] != 0) m_refs.push_back(i);
+		}
+
+		m_nodes.clear();
+		m_nodes.reserve(m_refs.size() / 2 + 1);
+
+		if(!m_refs.empty()) build_node(0, gsl::narrow<uint32_t>(m_refs.size()));
+
+		m_build_cost = cost();
+	}
+
+	bool bvh::maintain(float max_cost_ratio)
+	{
+		refit();
+
+		// 木の外の物体が増えすぎたか、動いて重なりが増えた
+		const auto& too_many_pending = m_pending.size() * 8 > std::max<size_t>(m_alive_count, 64);
+		if(!too_many_pending && cost() <= m_build_cost * max_cost_ratio) return false;
+
+		rebuild();
+		return true;
+	}
+
+	void bvh::query_frustum(gsl::span<const vector4, 6> planes, std::vector<uint32_t>& out) const
+	{
+		if(!m_nodes.empty())
+		{
+			std::array<uint32_t, 64> stack;
+			size_t top = 0;
+			stack[top++] = 0;
+
+			while(top > 0)
+			{
+				const auto& node = m_nodes[stack[--top]];
+				for(auto lane = 0; lane < 4; ++lane)
+				{
+					const auto& child = node.child[lane];
+					if(child == EMPTY_CHILD) continue;
+
+					const auto& result = classify(lane_bounds(node, lane), planes);
+					if(result == 0) continue;
+
+					if(child & LEAF_FLAG)
+					{
+						const auto& first = child & ~LEAF_FLAG;
+						for(auto j = first; j < first + node.count[lane]; ++j)
+						{
+							const auto& object = m_refs[j];
+							if(m_alive[object] != 0 && (result == 2 || classify(m_bounds[object], planes) != 0)) out.push_back(object);
+						}
+					}
+					else if(result == 2)
+					{
+						// 完全に内側なので判定せずにまとめて追加
+						collect(child, out);
+					}
+					else
+					{
+						Expects(top < stack.size());
+						stack[top++] = child;
+					}
+				}
+			}
+		}
+
+		for(const auto& object : m_pending)
+		{
+			if(classify(m_bounds[object], planes) != 0) out.push_back(object);
+		}
+	}
+
+	void bvh::query_aabb(const bvh_bounds& box, std::vector<uint32_t>& out) const
+	{
+		if(!m_nodes.empty())
+		{
+			std::array<uint32_t, 64> stack;
+			size_t top = 0;
+			stack[top++] = 0;
+
+			while(top > 0)
+			{
+				const auto& node = m_nodes[stack[--top]];
+				for(auto lane = 0; lane < 4; ++lane)
+				{
+					const auto& child = node.child[lane];
+					if(child == EMPTY_CHILD || !overlaps(lane_bounds(node, lane), box)) continue;
+
+					if(child & LEAF_FLAG)
+					{
+						const auto& first = child & ~LEAF_FLAG;
+						for(auto j = first; j < first + node.count[lane]; ++j)
+						{
+							const auto& object = m_refs[j];
+							if(m_alive[object] != 0 && overlaps(m_bounds[object], box)) out.push_back(object);
+						}
+					}
+					else
+					{
+						Expects(top < stack.size());
+						stack[top++] = child;
+					}
+				}
+			}
+		}
+
+		for(const auto& object : m_pending)
+		{
+			if(overlaps(m_bounds[object], box)) out.push_back(object);
+		}
+	}
+
+	void bvh::query_ray(const vector3& origin, const vector3& direction, float max_distance, std::vector<uint32_t>& out) const
+	{
+		const auto& r = make_ray(origin, direction, max_distance);
+		float t{};
+
+		if(!m_nodes.empty())
+		{
+			std::array<uint32_t, 64> stack;
+			size_t top = 0;
+			stack[top++] = 0;
+
+			while(top > 0)
+			{
+				const auto& node = m_nodes[stack[--top]];
+				for(auto lane = 0; lane < 4; ++lane)
+				{
+					const auto& child = node.child[lane];
+					if(child == EMPTY_CHILD || !intersect(r, lane_bounds(node, lane), t)) continue;
+
+					if(child & LEAF_FLAG)
+					{
+						const auto& first = child & ~LEAF_FLAG;
+						for(auto j = first; j < first + node.count[lane]; ++j)
+						{
+							const auto& object = m_refs[j];
+							if(m_alive[object] != 0 && intersect(r, m_bounds[object], t)) out.push_back(object);
+						}
+					}
+					else
+					{
+						Expects(top < stack.size());
+						stack[top++] = child;
+					}
+				}
+			}
+		}
+
+		for(const auto& object : m_pending)
+		{
+			if(intersect(r, m_bounds[object], t)) out.push_back(object);
+		}
+	}
+
+	bvh_hit bvh::raycast(const vector3& origin, const vector3& direction, float max_distance) const
+	{
+		auto r = make_ray(origin, direction, max_distance);
+		auto hit = bvh_hit{ INVALID_BVH_OBJECT, max_distance };
+		float t{};
+
+		auto test_object = [&](uint32_t object)
+		{
+			if(m_alive[object] == 0 || !intersect(r, m_bounds[object], t)) return;
+
+			// 以降はより手前だけを調べる
+			hit = bvh_hit{ object, t };
+			r.max_distance = t;
+		};
+
+		if(!m_nodes.empty())
+		{
+			std::array<uint32_t, 64> stack;
+			size_t top = 0;
+			stack[top++] = 0;
+
+			while(top > 0)
+			{
+				const auto& node = m_nodes[stack[--top]];
+				for(auto lane = 0; lane < 4; ++lane)
+				{
+					const auto& child = node.child[lane];
+					if(child == EMPTY_CHILD || !intersect(r, lane_bounds(node, lane), t)) continue;
+
+					if(child & LEAF_FLAG)
+					{
+						const auto& first = child & ~LEAF_FLAG;
+						for(auto j = first; j < first + node.count[lane]; ++j) test_object(m_refs[j]);
+					}
+					else
+					{
+						Expects(top < stack.size());
+						stack[top++] = child;
+					}
+				}
+			}
+		}
+
+		for(const auto& object : m_pending) test_object(object);
+
+		return hit;
+	}
+
+	float bvh::cost() const
+	{
+		if(m_nodes.empty()) return 0.0f;
+
+		const auto& root = m_nodes.front();
+		auto root_bounds = empty_bounds();
+		for(auto lane = 0; lane < 4; ++lane) merge(root_bounds, lane_bounds(root, lane));
+
+		const auto& root_area = surface_area(root_bounds);
+		if(root_area <= 0.0f) return 0.0f;
+
+		/*  子を調べる確率 (面積比) × 調べる数  */
+		auto total = 0.0f;
+		for(const auto& node : m_nodes)
+		{
+			for(auto lane = 0; lane < 4; ++lane)
+			{
+				const auto& child = node.child[lane];
+				if(child == EMPTY_CHILD) continue;
+
+				const auto& weight = (child & LEAF_FLAG) ? static_cast<float>(node.count[lane]) : 1.0f;
+				total += surface_area(lane_bounds(node, lane)) * weight;
+			}
+		}
+
+		return total / root_area;
+	}
+
+	uint32_t bvh::build_node(uint32_t begin, uint32_t end)
+	{
+		const auto& index = gsl::narrow<uint32_t>(m_nodes.size());
+		m_nodes.push_back(empty_node());
+
+		/*  2分割を繰り返して最大4つの範囲にする (葉に収まらない一番大きい範囲から割る)  */
+		std::array<std::pair<uint32_t, uint32_t>, 4> ranges = {};
+		ranges[0] = { begin, end };
+		size_t range_count = 1;
+
+		while(range_count < 4)
+		{
+			auto largest = range_count;
+			for(size_t i = 0; i < range_count; ++i)
+			{
+				const auto& size = ranges[i].second - ranges[i].first;
+				if(size > LEAF_SIZE && (largest == range_count || size > ranges[largest].second - ranges[largest].first)) largest = i;
+			}
+			if(largest == range_count) break;
+
+			const auto [first, last] = ranges[largest];
+			const auto& mid = split(first, last);
+
+			ranges[largest] = { first, mid };
+			ranges[range_count++] = { mid, last };
+		}
+
+		/*  各範囲を葉か子ノードにする  */
+		for(size_t lane = 0; lane < range_count; ++lane)
+		{
+			const auto [first, last] = ranges[lane];
+			const auto& bounds = range_bounds(first, last);
+
+			uint32_t child{};
+			uint32_t count{};
+			if(last - first <= LEAF_SIZE)
+			{
+				child = first | LEAF_FLAG;
+				count = last - first;
+			}
+			else
+			{
+				child = build_node(first, last);
+			}
+
+			// 再帰で配列が伸びているので番号で引き直す
+			auto& node = m_nodes.at(index);
+			set_lane(node, gsl::narrow_cast<int>(lane), bounds);
+			node.child[lane] = child;
+			node.count[lane] = count;
+		}
+
+		return index;
+	}
+
+	uint32_t bvh::split(uint32_t begin, uint32_t end)
+	{
+		/*  重心の範囲が最も広い軸で分ける  */
+		auto centroid_bounds = empty_bounds();
+		for(auto i = begin; i < end; ++i)
+		{
+			const auto& b = m_bounds[m_refs[i]];
+			for(auto axis = 0; axis < 3; ++axis)
+			{
+				const auto& c = centroid(b, axis);
+				centroid_bounds.min[axis] = std::min(centroid_bounds.min[axis], c);
+				centroid_bounds.max[axis] = std::max(centroid_bounds.max[axis], c);
+			}
+		}
+
+		auto axis = 0;
+		for(auto a = 1; a < 3; ++a)
+		{
+			if(centroid_bounds.max[a] - centroid_bounds.min[a] > centroid_bounds.max[axis] - centroid_bounds.min[axis]) axis = a;
+		}
+
+		const auto mid = begin + (end - begin) / 2;
+		const auto& extent = centroid_bounds.max[axis] - centroid_bounds.min[axis];
+
+		auto by_centroid = [&](uint32_t l, uint32_t r) { return centroid(m_bounds[l], axis) < centroid(m_bounds[r], axis); };
+
+		// 重心が全て同じなら半分に分けるしかない
+		if(!(extent > 0.0f))
+		{
+			return mid;
+		}
+
+		/*  ビンに分けて SAH コストが最小になる境界を探す  */
+		std::array<bvh_bounds, BIN_COUNT> bins;
+		std::array<uint32_t, BIN_COUNT> counts = {};
+		bins.fill(empty_bounds());
+
+		const auto& scale = BIN_COUNT / extent;
+		auto bin_of = [&](uint32_t object)
+		{
+			const auto& bin = static_cast<uint32_t>((centroid(m_bounds[object], axis) - centroid_bounds.min[axis]) * scale);
+			return std::min(bin, BIN_COUNT - 1);
+		};
+
+		for(auto i = begin; i < end; ++i)
+		{
+			const auto& object = m_refs[i];
+			const auto& bin = bin_of(object);
+			merge(bins[bin], m_bounds[object]);
+			++counts[bin];
+		}
+
+		// 右から累積した面積と数
+		std::array<float, BIN_COUNT> right_area = {};
+		std::array<uint32_t, BIN_COUNT> right_count = {};
+		{
+			auto b = empty_bounds();
+			uint32_t n = 0;
+			for(auto i = BIN_COUNT; i-- > 1;)
+			{
+				merge(b, bins[i]);
+				n += counts[i];
+				right_area[i] = surface_area(b);
+				right_count[i] = n;
+			}
+		}
+
+		auto best_cost = INF;
+		auto best_split = 0u;
+		{
+			auto b = empty_bounds();
+			uint32_t n = 0;
+			for(auto i = 1u; i < BIN_COUNT; ++i)
+			{
+				merge(b, bins[i - 1]);
+				n += counts[i - 1];
+				if(n == 0 || right_count[i] == 0) continue;
+
+				const auto& cost = surface_area(b) * n + right_area[i] * right_count[i];
+				if(cost < best_cost)
+				{
+					best_cost = cost;
+					best_split = i;
+				}
+			}
+		}
+
+		if(best_split == 0)
+		{
+			std::nth_element(m_refs.begin() + begin, m_refs.begin() + mid, m_refs.begin() + end, by_centroid);
+			return mid;
+		}
+
+		const auto& it = std::partition(m_refs.begin() + begin, m_refs.begin() + end, [&](uint32_t object) { return bin_of(object) < best_split; });
+		return gsl::narrow<uint32_t>(std::distance(m_refs.begin(), it));
+	}
+
+	bvh_bounds bvh::range_bounds(uint32_t begin, uint32_t end) const
+	{
+		auto b = empty_bounds();
+		for(auto i = begin; i < end; ++i) merge(b, m_bounds[m_refs[i]]);
+		return b;
+	}
+
+	void bvh::collect(uint32_t node, std::vector<uint32_t>& out) const
+	{
+		std::array<uint32_t, 64> stack;
+		size_t top = 0;
+		stack[top++] = node;
+
+		while(top > 0)
+		{
+			const auto& current = m_nodes[stack[--top]];
+			for(auto lane = 0; lane < 4; ++lane)
+			{
+				const auto& child = current.child[lane];
+				if(child == EMPTY_CHILD) continue;
+
+				if(child & LEAF_FLAG)
+				{
+					const auto& first = child & ~LEAF_FLAG;
+					for(auto j = first; j < first + current.count[lane]; ++j)
+					{
+						if(m_alive[m_refs[j]] != 0) out.push_back(m_refs[j]);
+					}
+				}
+				else
+				{
+					Expects(top < stack.size());
+					stack[top++] = child;
+				}
+			}
+		}
+	}
+}
\ No newline at end of file
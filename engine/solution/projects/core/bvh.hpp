@@ -0,0 +1,107 @@
+﻿#pragma once
+
+namespace core
+{
+	struct bvh_bounds
+	{
+		std::array<float, 3> min;
+		std::array<float, 3> max;
+	};
+
+	struct bvh_hit
+	{
+		uint32_t object;		// 当たらなければ INVALID_BVH_OBJECT
+		float distance;
+	};
+
+	inline constexpr uint32_t INVALID_BVH_OBJECT = std::numeric_limits<uint32_t>::max();
+
+	/*
+		4分木の BVH ノード (子4つの AABB を軸ごとに並べ、4レーン同時に判定できる形)
+		子が葉なら child は m_refs の先頭 | LEAF_FLAG、count は物体数
+	*/
+	struct alignas(64) bvh_node
+	{
+		std::array<float, 4> min_x;
+		std::array<float, 4> min_y;
+		std::array<float, 4> min_z;
+		std::array<float, 4> max_x;
+		std::array<float, 4> max_y;
+		std::array<float, 4> max_z;
+		std::array<uint32_t, 4> child;
+		std::array<uint32_t, 4> count;
+	};
+
+	/*
+		動的な物体の集合に対する BVH
+
+		・build()/rebuild() はビン分割の SAH で2分割を2回行い、4分木を作る
+		・update() で動いた物体は refit() で親の AABB を広げ直すだけにし、
+		  木の質 (SAH コスト) が落ちたら maintain() が作り直す
+		・insert() した物体は次の rebuild() まで木の外のリストで線形に判定する
+		・remove() した物体は次の rebuild() まで木に残るが、問い合わせの結果には出ない
+	*/
+	class bvh
+	{
+	public:
+		static constexpr uint32_t LEAF_SIZE = 4;
+		static constexpr uint32_t LEAF_FLAG = 0x80000000u;
+		static constexpr uint32_t EMPTY_CHILD = std::numeric_limits<uint32_t>::max();
+
+	public:
+		bvh() = default;
+
+	public:
+		// bounds[i] を物体 i として作り直す
+		void build(gsl::span<const bvh_bounds> bounds);
+
+		uint32_t insert(const bvh_bounds& bounds);
+		void remove(uint32_t object);
+		void update(uint32_t object, const bvh_bounds& bounds);
+
+		void refit();
+		void rebuild();
+
+		// refit() し、SAH コストが作り直した直後の max_cost_ratio 倍を超えていれば rebuild() する
+		bool maintain(float max_cost_ratio = 1.5f);
+
+	public:
+		// 視錐台 (xyz: 内向きの法線, w: 距離) と交わる物体。完全に内側の部分木は判定せずまとめて返す
+		void query_frustum(gsl::span<const vector4, 6> planes, std::vector<uint32_t>& out) const;
+		void query_aabb(const bvh_bounds& box, std::vector<uint32_t>& out) const;
+
+		// 線分 origin + direction * t (0 <= t <= max_distance) と AABB が交わる物体
+		void query_ray(const vector3& origin, const vector3& direction, float max_distance, std::vector<uint32_t>& out) const;
+
+		// AABB が最も手前で交わる物体
+		bvh_hit raycast(const vector3& origin, const vector3& direction, float max_distance) const;
+
+	public:
+		inline size_t node_count() const noexcept { return m_nodes.size(); }
+		inline size_t object_count() const noexcept { return m_alive_count; }
+		inline const bvh_bounds& bounds(uint32_t object) const { return m_bounds.at(object); }
+		inline bool alive(uint32_t object) const { return object < m_alive.size() && m_alive.at(object) != 0; }
+
+		// 葉の物体数と内部ノードの判定回数を表面積で重み付けした見積もり
+		float cost() const;
+
+	private:
+		uint32_t build_node(uint32_t begin, uint32_t end);
+		uint32_t split(uint32_t begin, uint32_t end);
+		bvh_bounds range_bounds(uint32_t begin, uint32_t end) const;
+		void collect(uint32_t node, std::vector<uint32_t>& out) const;
+
+	private:
+		std::vector<bvh_node> m_nodes;				// 親は子より前にある
+		std::vector<uint32_t> m_refs;				// 葉が参照する物体番号
+
+		std::vector<bvh_bounds> m_bounds;
+		std::vector<uint8_t> m_alive;
+		std::vector<uint32_t> m_pending;			// 木に入っていない物体
+		std::vector<uint32_t> m_free;				// rebuild() 後に再利用できる番号
+		std::vector<uint32_t> m_removed;			// 木に残っている削除済みの番号
+
+		size_t m_alive_count = 0;
+		float m_build_cost = 0.0f;
+	};
+}
\ No newline at end of file
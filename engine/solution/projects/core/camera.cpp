@@ -0,0 +1,187 @@
+﻿#include "include.hpp"
+
+namespace
+{
+	inline vector4 make_plane(const vector3& normal, const vector3& point) noexcept
+	{
+		return vector4(normal.x(), normal.y(), normal.z(), -normal.dot(point));
+	}
+}
+
+namespace core
+{
+	void camera::set_position(const vector3d& position) noexcept
+	{
+		m_position = position;
+		m_view_dirty = true;
+	}
+
+	void camera::set_direction(const vector3& forward, const vector3& up) noexcept
+	{
+		Expects(forward.length_square() > 0.0f);
+
+		m_forward = forward.normalized();
+		m_up = up;
+		m_view_dirty = true;
+	}
+
+	void camera::set_perspective(float fov_y, float aspect, float near_z, float far_z) noexcept
+	{
+		m_fov_y = fov_y;
+		m_aspect = aspect;
+		m_near = near_z;
+		m_far = far_z;
+		m_projection_dirty = true;
+	}
+
+	void camera::set_aspect(float aspect) noexcept
+	{
+		if(m_aspect == aspect) return;
+
+		m_aspect = aspect;
+		m_projection_dirty = true;
+	}
+
+	void camera::set_depth_mode(depth_mode mode) noexcept
+	{
+		if(m_depth_mode == mode) return;
+
+		m_depth_mode = mode;
+		m_projection_dirty = true;
+	}
+
+	void camera::set_rebase_distance(double distance) noexcept
+	{
+		m_rebase_distance = distance;
+		m_view_dirty = true;
+	}
+
+	bool camera::update()
+	{
+		if(!m_view_dirty && !m_projection_dirty) return false;
+
+		Expects(0.0f < m_near && m_near < m_far);
+		Expects(0.0f < m_aspect);
+
+		if(m_view_dirty) update_view();
+		if(m_projection_dirty) update_projection();
+
+		/*  射影行列は疎なので、0 でない項だけ掛ける  */
+		const auto& v = m_view;
+		const auto& p = m_projection;
+		for(auto row = 0u; row < 4; ++row)
+		{
+			const auto& x = v.at(row * 4 + 0);
+			const auto& y = v.at(row * 4 + 1);
+			const auto& z = v.at(row * 4 + 2);
+			const auto& w = v.at(row * 4 + 3);
+
+			m_view_projection.at(row * 4 + 0) = x * p.at(0u);
+			m_view_projection.at(row * 4 + 1) = y * p.at(5u);
+			m_view_projection.at(row * 4 + 2) = z * p.at(10u) + w * p.at(14u);
+			m_view_projection.at(row * 4 + 3) = z * p.at(11u);
+		}
+
+		update_frustum();
+
+		m_view_dirty = false;
+		m_projection_dirty = false;
+		++m_version;
+
+		return true;
+	}
+
+	void camera::update_view()
+	{
+		/*  原点から離れすぎたら原点を移す (float の精度が落ちないようにする)  */
+		const auto& offset = m_position - m_origin;
+		const auto& limit = m_rebase_distance;
+		if(std::abs(offset.x()) > limit || std::abs(offset.y()) > limit || std::abs(offset.z()) > limit)
+		{
+			m_origin = m_position;
+			++m_origin_epoch;
+		}
+
+		m_eye = to_local(m_position);
+
+		/*  XMMatrixLookToLH と同じ基底 (up が forward と平行なら、forward とほぼ直交する軸を代わりに使う)  */
+		auto right = m_up.cross(m_forward);
+		if(right.length_square() <= 1e-12f * m_up.length_square())
+		{
+			const auto& fallback = std::abs(m_forward.y()) < 0.9f ? vector3::up() : vector3::forward();
+			right = fallback.cross(m_forward);
+		}
+
+		m_right = right.normalized();
+		m_view_up = m_forward.cross(m_right);
+
+		const auto& r = m_right;
+		const auto& u = m_view_up;
+		const auto& f = m_forward;
+
+		m_view = matrix4x4
+		(
+			r.x(), u.x(), f.x(), 0,
+			r.y(), u.y(), f.y(), 0,
+			r.z(), u.z(), f.z(), 0,
+			-r.dot(m_eye), -u.dot(m_eye), -f.dot(m_eye), 1
+		);
+	}
+
+	void camera::update_projection()
+	{
+		const auto& y_scale = 1.0f / std::tan(m_fov_y * 0.5f);
+		const auto& x_scale = y_scale / m_aspect;
+		const auto& infinite = std::isinf(m_far);
+
+		/*
+			深度 = (z * a + b) / z
+			standard: near -> 0, far -> 1 / reversed: near -> 1, far -> 0
+			遠平面がない場合は far -> ∞ の極限を取る
+		*/
+		float a{};
+		float b{};
+		if(m_depth_mode == depth_mode::standard)
+		{
+			a = infinite ? 1.0f : m_far / (m_far - m_near);
+			b = -m_near * a;
+		}
+		else
+		{
+			a = infinite ? 0.0f : m_near / (m_near - m_far);
+			b = infinite ? m_near : -m_far * a;
+		}
+
+		m_projection = matrix4x4
+		(
+			x_scale, 0, 0, 0,
+			0, y_scale, 0, 0,
+			0, 0, a, 1,
+			0, 0, b, 0
+		);
+	}
+
+	void camera::update_frustum()
+	{
+		/*
+			行列から取り出すと遠平面のない射影で平面が潰れるので、基底と画角から直接作る
+			(同じ設定なら常に同じ平面になり、カリング結果が揺れない)
+		*/
+		const auto& tan_y = std::tan(m_fov_y * 0.5f);
+		const auto& tan_x = tan_y * m_aspect;
+
+		const auto& r = m_right;
+		const auto& u = m_view_up;
+		const auto& f = m_forward;
+
+		m_frustum =
+		{
+			make_plane((r + f * tan_x).normalized(), m_eye),			// left
+			make_plane((-r + f * tan_x).normalized(), m_eye),			// right
+			make_plane((u + f * tan_y).normalized(), m_eye),			// bottom
+			make_plane((-u + f * tan_y).normalized(), m_eye),			// top
+			make_plane(f, m_eye + f * m_near),						// near
+			std::isinf(m_far) ? vector4(0, 0, 0, 1) : make_plane(-f, m_eye + f * m_far),		// far
+		};
+	}
+}
\ No newline at end of file
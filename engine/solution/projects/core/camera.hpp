@@ -0,0 +1,97 @@
+﻿#pragma once
+
+namespace core
+{
+	enum class depth_mode : uint8_t
+	{
+		standard,		// 近 = 0, 遠 = 1
+		reversed,		// 近 = 1, 遠 = 0 (クリア値 0、比較は GREATER)
+	};
+
+	inline constexpr float INFINITE_FAR = std::numeric_limits<float>::infinity();
+
+	/*
+		カメラ
+
+		・位置は倍精度で持ち、描画に使う座標は原点 (origin) からの相対位置を float で表す
+		  カメラが原点から rebase_distance 以上離れたら原点をカメラの位置に移し、origin_epoch() を進める
+		  (エポックが変わったら、相対座標で持っている変換は to_local() で作り直す)
+		・行列は設定が変わったときだけ update() で作り直し、version() を進める
+		・行列は DirectXMath と同じ行ベクトル形式、行優先の16要素
+	*/
+	class camera
+	{
+	public:
+		camera() = default;
+
+	public:
+		void set_position(const vector3d& position) noexcept;
+		// up が forward と平行 (真上・真下を向く) なら y 軸か z 軸を代わりに使う
+		void set_direction(const vector3& forward, const vector3& up = vector3::up()) noexcept;
+
+		// far_z に INFINITE_FAR を渡すと遠平面のない射影になる
+		void set_perspective(float fov_y, float aspect, float near_z, float far_z = INFINITE_FAR) noexcept;
+		void set_aspect(float aspect) noexcept;
+		void set_depth_mode(depth_mode mode) noexcept;
+		void set_rebase_distance(double distance) noexcept;
+
+		// 変更があれば行列と視錐台を作り直す (作り直したら true)
+		bool update();
+
+	public:
+		inline const vector3d& position() const noexcept { return m_position; }
+		inline const vector3d& origin() const noexcept { return m_origin; }
+		inline const vector3& forward() const noexcept { return m_forward; }
+		inline depth_mode get_depth_mode() const noexcept { return m_depth_mode; }
+
+		inline const matrix4x4& view() const noexcept { return m_view; }
+		inline const matrix4x4& projection() const noexcept { return m_projection; }
+		inline const matrix4x4& view_projection() const noexcept { return m_view_projection; }
+
+		// 原点からの相対座標での視錐台 (xyz: 内向きの法線, w: 距離)。遠平面がない場合は常に内側になる平面を入れる
+		inline const std::array<vector4, 6>& frustum() const noexcept { return m_frustum; }
+
+		inline uint64_t version() const noexcept { return m_version; }
+		inline uint64_t origin_epoch() const noexcept { return m_origin_epoch; }
+
+		// ワールド座標を原点からの相対座標にする
+		inline vector3 to_local(const vector3d& world) const noexcept
+		{
+			return vector3(static_cast<float>(world.x() - m_origin.x()), static_cast<float>(world.y() - m_origin.y()), static_cast<float>(world.z() - m_origin.z()));
+		}
+
+	private:
+		void update_view();
+		void update_projection();
+		void update_frustum();
+
+	private:
+		vector3d m_position = vector3d(0, 0, 0);
+		vector3d m_origin = vector3d(0, 0, 0);
+		vector3 m_forward = vector3::forward();
+		vector3 m_up = vector3::up();
+
+		float m_fov_y = 90.0f * math::to_rad;
+		float m_aspect = 1.0f;
+		float m_near = 0.1f;
+		float m_far = INFINITE_FAR;
+		depth_mode m_depth_mode = depth_mode::reversed;
+		double m_rebase_distance = 4096.0;
+
+		matrix4x4 m_view = matrix4x4::identity();
+		matrix4x4 m_projection = matrix4x4::identity();
+		matrix4x4 m_view_projection = matrix4x4::identity();
+		std::array<vector4, 6> m_frustum;
+
+		// 作り直した後の基底と原点からの位置
+		vector3 m_eye = vector3(0, 0, 0);
+		vector3 m_right = vector3::right();
+		vector3 m_view_up = vector3::up();
+
+		bool m_view_dirty = true;
+		bool m_projection_dirty = true;
+
+		uint64_t m_version = 0;
+		uint64_t m_origin_epoch = 0;
+	};
+}
\ No newline at end of file
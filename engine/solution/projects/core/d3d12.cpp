@@ -16,6 +16,21 @@ namespace
 
 	D3D12_VIEWPORT viewport{};
 	D3D12_RECT scissor{};
+
+	constexpr uint32_t max_gpu_scopes = 64;
+
+	// 1フレームでデフラグのために移動する量の上限
+	constexpr uint64_t max_defrag_bytes = 4ull * 1024 * 1024;
+
+	inline void count_draw(uint32_t index_count, uint32_t instance_count)
+	{
+		using core::frame_counters;
+		using core::frame_counter;
+
+		frame_counters::add(frame_counter::draws, 1);
+		frame_counters::add(frame_counter::instances, instance_count);
+		frame_counters::add(frame_counter::triangles, static_cast<uint64_t>(index_count / 3) * instance_count);
+	}
 }
 
 void graphic_d3d12::create_devices()
@@ -32,6 +47,12 @@ void graphic_d3d12::create_devices()
 	m_device = create_device_11_0();
 	m_command_queue = create_command_queue(m_device.Get());
 
+	// create heaps (リソースは大きなヒープの中に配置する)
+	{
+		m_upload_heaps = std::make_unique<heap_allocator>(m_device.Get(), D3D12_HEAP_TYPE_UPLOAD, D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS);
+		m_default_heaps = std::make_unique<heap_allocator>(m_device.Get(), D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES);
+	}
+
 	// create swapchain
 	{
 		// create swapchain
@@ -54,15 +75,35 @@ void graphic_d3d12::create_devices()
 		m_command_list = create_command_list(m_device.Get(), m_command_allocator.at(m_frame_index).Get());
 	}
 
+	// create defragment commandlist
+	{
+		for (auto& command_allocator : m_defrag_allocator)
+		{
+			command_allocator = create_command_allocator(m_device.Get());
+		}
+
+		m_defrag_list = create_command_list(m_device.Get(), m_defrag_allocator.at(m_frame_index).Get());
+		m_defrag_list->Close();
+	}
+
+	// create gpu profiler
+	{
+		const auto& timestamps = core::gpu_profiler::timestamp_capacity(FRAME_COUNT, max_gpu_scopes);
+		const auto& statistics = core::gpu_profiler::statistics_capacity(FRAME_COUNT, max_gpu_scopes);
+
+		m_query_backend = std::make_unique<d3d12_query_backend>(m_device.Get(), m_command_queue.Get(), timestamps, statistics);
+		m_gpu_profiler = std::make_unique<core::gpu_profiler>(m_query_backend.get(), FRAME_COUNT, max_gpu_scopes);
+	}
+
 	// create render target view
 	{
-		m_heap_rtv = std::make_unique<descriptor_heap>(m_device.Get(), FRAME_COUNT, heap_type::rtv);
+		m_heap_rtv = m_descriptor_heaps.create(m_device.Get(), FRAME_COUNT, heap_type::rtv);
 
 		for (auto i = 0u; i < m_color_buffer.size(); ++i)
 		{
 			m_color_buffer.at(i) = get_color_buffer(m_swapchain.Get(), i);
 
-			m_heap_rtv->create_rtv(m_color_buffer.at(i).Get());
+			m_descriptor_heaps.at(m_heap_rtv).create_rtv(m_color_buffer.at(i).Get());
 		}
 	}
 
@@ -84,6 +125,9 @@ void graphic_d3d12::create_devices()
 
 		++m_fence_counter.at(m_frame_index);
 
+		// 最初のフレームで破棄されたものはこの値で待つ
+		m_release_queue.begin_frame(m_fence_counter.at(m_frame_index));
+
 		// create event
 		m_fence_event = CreateEvent(nullptr, false, false, nullptr);
 		Ensures(m_fence_event != nullptr);
@@ -96,11 +140,26 @@ void graphic_d3d12::create_pipelines()
 {
 	HRESULT hr{};
 
-	D3D12_ROOT_PARAMETER param{};
-	param.ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
-	param.Descriptor.ShaderRegister = 0;
-	param.Descriptor.RegisterSpace = 0;
-	param.ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+	std::array<D3D12_ROOT_PARAMETER, 3> params{};
+
+	// b0: カメラ
+	params.at(0).ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
+	params.at(0).Descriptor.ShaderRegister = 0;
+	params.at(0).Descriptor.RegisterSpace = 0;
+	params.at(0).ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+
+	// b1: インスタンスデータの先頭 (instance_vs)
+	params.at(1).ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+	params.at(1).Constants.ShaderRegister = 1;
+	params.at(1).Constants.RegisterSpace = 0;
+	params.at(1).Constants.Num32BitValues = 1;
+	params.at(1).ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+
+	// t0: インスタンスデータ (instance_vs)
+	params.at(2).ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+	params.at(2).Descriptor.ShaderRegister = 0;
+	params.at(2).Descriptor.RegisterSpace = 0;
+	params.at(2).ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
 
 	const auto flag =
 		D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT |
@@ -109,9 +168,9 @@ void graphic_d3d12::create_pipelines()
 		D3D12_ROOT_SIGNATURE_FLAG_DENY_GEOMETRY_SHADER_ROOT_ACCESS;
 
 	D3D12_ROOT_SIGNATURE_DESC desc{};
-	desc.NumParameters = 1;
+	desc.NumParameters = gsl::narrow<UINT>(params.size());
 	desc.NumStaticSamplers = 0;
-	desc.pParameters = &param;
+	desc.pParameters = params.data();
 	desc.pStaticSamplers = nullptr;
 	desc.Flags = flag;
 
@@ -134,65 +193,7 @@ void graphic_d3d12::create_pipelines()
 		IID_PPV_ARGS(m_root_signature.GetAddressOf()));
 
 	// パイプラインステート
-	const std::vector<D3D12_INPUT_ELEMENT_DESC> elements =
-	{
-		{
-			"POSITION",
-			0,
-			DXGI_FORMAT_R32G32B32_FLOAT,
-			0,
-			D3D12_APPEND_ALIGNED_ELEMENT,
-			D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
-			0
-		},
-
-		{
-			"COLOR",
-			0,
-			DXGI_FORMAT_R32G32B32_FLOAT,
-			0,
-			D3D12_APPEND_ALIGNED_ELEMENT,
-			D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
-			0
-		},
-
-		{
-			"WORLD",
-			0,
-			DXGI_FORMAT_R32G32B32A32_FLOAT,
-			1,
-			D3D12_APPEND_ALIGNED_ELEMENT,
-			D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA,
-			1
-		},
-		{
-			"WORLD",
-			1,
-			DXGI_FORMAT_R32G32B32A32_FLOAT,
-			1,
-			D3D12_APPEND_ALIGNED_ELEMENT,
-			D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA,
-			1
-		},
-		{
-			"WORLD",
-			2,
-			DXGI_FORMAT_R32G32B32A32_FLOAT,
-			1,
-			D3D12_APPEND_ALIGNED_ELEMENT,
-			D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA,
-			1
-		},
-		{
-			"WORLD",
-			3,
-			DXGI_FORMAT_R32G32B32A32_FLOAT,
-			1,
-			D3D12_APPEND_ALIGNED_ELEMENT,
-			D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA,
-			1
-		},
-	};
+	static constexpr auto elements = input_layout<vertex_layout, world_instance_stream>::elements();
 
 	/*  ラスタライザの設定  */
 	auto descRS = CD3DX12_RASTERIZER_DESC(CD3DX12_DEFAULT());
@@ -229,7 +230,22 @@ void graphic_d3d12::create_pipelines()
 	desc_pipeline_state.SampleDesc.Count = 1;
 	desc_pipeline_state.SampleDesc.Quality = 0;
 
-	hr = m_device->CreateGraphicsPipelineState(&desc_pipeline_state, IID_PPV_ARGS(m_pipeline.GetAddressOf()));
+	m_pipeline = m_pipelines.create();
+	hr = m_device->CreateGraphicsPipelineState(&desc_pipeline_state, IID_PPV_ARGS(m_pipelines.at(m_pipeline).GetAddressOf()));
+	Ensures(SUCCEEDED(hr));
+
+	/*  インスタンスデータを StructuredBuffer から読むパイプライン (頂点ストリームはスロット 0 のみ)  */
+	static constexpr auto instanced_elements = input_layout<vertex_layout>::elements();
+
+	ComPtr<ID3DBlob> instance_vs_blob;
+	hr = D3DReadFileToBlob(L"instance_vs.cso", instance_vs_blob.GetAddressOf());
+	Ensures(SUCCEEDED(hr));
+
+	desc_pipeline_state.InputLayout = D3D12_INPUT_LAYOUT_DESC{ instanced_elements.data(),gsl::narrow<UINT>(instanced_elements.size()) };
+	desc_pipeline_state.VS = CD3DX12_SHADER_BYTECODE(instance_vs_blob.Get());
+
+	m_pipeline_instanced = m_pipelines.create();
+	hr = m_device->CreateGraphicsPipelineState(&desc_pipeline_state, IID_PPV_ARGS(m_pipelines.at(m_pipeline_instanced).GetAddressOf()));
 	Ensures(SUCCEEDED(hr));
 
 	/*  ビューポートの設定  */
@@ -250,64 +266,82 @@ void graphic_d3d12::create_cbv()
 		DirectX::XMMatrixTranslation(1,0,0),
 	};
 
-	const auto& eye_pos = DirectX::XMVectorSet(0.0f, 0.0f, -5.0f, 0.0f);
-	const auto& dir = DirectX::XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f);
-	const auto& up_ward = DirectX::XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
-	const auto& fov_y = DirectX::XMConvertToRadians(90);
-	const auto& aspect = static_cast<float>(m_winapp->get_width()) / static_cast<float>(m_winapp->get_height());
-
-	camera_mat _trans{};
+	/*  中身は update_camera() で書く  */
+	const camera_mat _trans{ matrix4x4::identity() };
 	for (auto& buffer : m_constant_buffers)
 	{
-		buffer = std::make_unique<gpu_buffer<camera_mat>>(m_device.Get(), sizeof(camera_mat));
-		buffer->map(_trans);
-
-		buffer->data()->view = DirectX::XMMatrixLookToLH(eye_pos, dir, up_ward);
-		buffer->data()->proj = DirectX::XMMatrixPerspectiveFovLH(fov_y, aspect, 0.0001f, 100);
+		buffer = gpu_buffer<camera_mat>(m_upload_heaps.get(), sizeof(camera_mat));
+		buffer.map(_trans);
 	}
 
+	// 版 0 のカメラも必ず1回は書く
+	m_camera_versions.fill(std::numeric_limits<uint64_t>::max());
+
 	// bind heap
-	m_heap_cbv = std::make_unique<descriptor_heap>(m_device.Get(), FRAME_COUNT, heap_type::cbv_srv_uav, heap_flag::shader_visible);
+	m_heap_cbv = m_descriptor_heaps.create(m_device.Get(), FRAME_COUNT, heap_type::cbv_srv_uav, heap_flag::shader_visible);
 	for (auto& buffer : m_constant_buffers)
-		m_heap_cbv->create_cbv(buffer->get_resource());
+		m_descriptor_heaps.at(m_heap_cbv).create_cbv(buffer.get_resource());
 }
 
 void graphic_d3d12::render_begin()
 {
+	PROFILE_SCOPE("render_begin");
+
 	// start commandt
 	m_command_allocator.at(m_frame_index)->Reset();
 	m_command_list->Reset(m_command_allocator.at(m_frame_index).Get(), nullptr);
+	m_bound_pipeline = nullptr;
+
+	/*  このバッファの前回の計測結果を読み、フレーム全体の計測を始める  */
+	m_query_backend->set_command_list(m_command_list.Get());
+	m_gpu_profiler->begin_frame(m_frame_index);
+	m_gpu_profiler->begin_scope("gpu frame", true);
 
 	resource_barrier(D3D12_RESOURCE_STATE_RENDER_TARGET);
 
-	const auto& aa = m_heap_rtv->at(m_frame_index).cpu_handle;
-	m_command_list->OMSetRenderTargets(1, &aa, FALSE, nullptr);
+	const auto& rtv = m_descriptor_heaps.at(m_heap_rtv).at(m_frame_index).cpu_handle;
+	m_command_list->OMSetRenderTargets(1, &rtv, FALSE, nullptr);
 
 	constexpr const std::array<float, 4> clear_color = { 0.125f,0.1f,0.1f,1.0f };
 
-	m_command_list->ClearRenderTargetView(m_heap_rtv->at(m_frame_index).cpu_handle, clear_color.data(), 0, nullptr);
+	m_command_list->ClearRenderTargetView(rtv, clear_color.data(), 0, nullptr);
 }
 
 void graphic_d3d12::render_init()
 {
 	m_command_list->SetGraphicsRootSignature(m_root_signature.Get());
-	m_command_list->SetPipelineState(m_pipeline.Get());
+	set_pipeline(m_pipelines.at(m_pipeline).Get());
 	m_command_list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	m_command_list->RSSetViewports(1, &viewport);
 	m_command_list->RSSetScissorRects(1, &scissor);
 	
-	m_command_list->SetDescriptorHeaps(1, m_heap_cbv->get_address());
-	m_command_list->SetGraphicsRootConstantBufferView(0, m_heap_cbv->get_cbv_view_desc().BufferLocation);
+	m_command_list->SetDescriptorHeaps(1, m_descriptor_heaps.at(m_heap_cbv).get_address());
+	m_command_list->SetGraphicsRootConstantBufferView(0, m_constant_buffers.at(m_frame_index).get_resource()->GetGPUVirtualAddress());
 }
 
 void graphic_d3d12::set_constantbuffer(const gsl::not_null<descriptor_heap*> heap)
 {
 }
 
+void graphic_d3d12::update_camera(const core::camera& camera)
+{
+	/*  このフレームのバッファに書いた後でカメラが変わっていなければ何もしない  */
+	auto& version = m_camera_versions.at(m_frame_index);
+	if (version == camera.version()) return;
+
+	// present() でこのフレームのフェンスは待ち終わっているので直接書ける
+	m_constant_buffers.at(m_frame_index).data()->view_proj = camera.view_projection();
+	version = camera.version();
+
+	core::frame_counters::add(core::frame_counter::upload_bytes, sizeof(matrix4x4));
+}
+
 void graphic_d3d12::render(const D3D12_VERTEX_BUFFER_VIEW& vbv)
 {
 	m_command_list->IASetVertexBuffers(0, 1, &vbv);
 	m_command_list->DrawInstanced(vbv.SizeInBytes / vbv.StrideInBytes, 1, 0, 0);
+
+	count_draw(vbv.SizeInBytes / vbv.StrideInBytes, 1);
 }
 
 void graphic_d3d12::render(const D3D12_VERTEX_BUFFER_VIEW& vbv, const D3D12_INDEX_BUFFER_VIEW& ibv)
@@ -315,6 +349,8 @@ void graphic_d3d12::render(const D3D12_VERTEX_BUFFER_VIEW& vbv, const D3D12_INDE
 	m_command_list->IASetVertexBuffers(0, 1, &vbv);
 	m_command_list->IASetIndexBuffer(&ibv);
 	m_command_list->DrawIndexedInstanced(ibv.SizeInBytes / sizeof(uint32_t), 1, 0, 0, 0);
+
+	count_draw(ibv.SizeInBytes / sizeof(uint32_t), 1);
 }
 
 void graphic_d3d12::render(gsl::span<D3D12_VERTEX_BUFFER_VIEW> views, const D3D12_INDEX_BUFFER_VIEW& ibv)
@@ -322,12 +358,48 @@ void graphic_d3d12::render(gsl::span<D3D12_VERTEX_BUFFER_VIEW> views, const D3D1
 	m_command_list->IASetVertexBuffers(0, gsl::narrow<uint32_t>(views.size()), views.data());
 	m_command_list->IASetIndexBuffer(&ibv);
 	m_command_list->DrawIndexedInstanced(ibv.SizeInBytes / sizeof(uint32_t), 100, 0, 0, 0);
+
+	count_draw(ibv.SizeInBytes / sizeof(uint32_t), 100);
+}
+
+void graphic_d3d12::render(gsl::span<D3D12_VERTEX_BUFFER_VIEW> views, const D3D12_INDEX_BUFFER_VIEW& ibv, const core::lod_level& level, uint32_t instance_count, uint32_t start_instance)
+{
+	/*  LOD ごとにまとめたインスタンスを1回で描画する  */
+	if(instance_count == 0) return;
+
+	m_command_list->IASetVertexBuffers(0, gsl::narrow<uint32_t>(views.size()), views.data());
+	m_command_list->IASetIndexBuffer(&ibv);
+	m_command_list->DrawIndexedInstanced(level.index_count, instance_count, level.index_offset, 0, start_instance);
+
+	count_draw(level.index_count, instance_count);
+}
+
+void graphic_d3d12::render_instances(const D3D12_VERTEX_BUFFER_VIEW& vbv, const D3D12_INDEX_BUFFER_VIEW& ibv, D3D12_GPU_VIRTUAL_ADDRESS instances, uint32_t instance_base, uint32_t instance_count)
+{
+	/*  instances[instance_base + SV_InstanceID] を読むので、並べ替えた一覧も先頭を変えるだけで描ける  */
+	if(instance_count == 0) return;
+
+	// 以降の描画もこのパイプラインになる (頂点ストリーム版に戻すときは render_init() から)
+	set_pipeline(m_pipelines.at(m_pipeline_instanced).Get());
+	m_command_list->SetGraphicsRootShaderResourceView(2, instances);
+	m_command_list->SetGraphicsRoot32BitConstant(1, instance_base, 0);
+
+	m_command_list->IASetVertexBuffers(0, 1, &vbv);
+	m_command_list->IASetIndexBuffer(&ibv);
+	m_command_list->DrawIndexedInstanced(ibv.SizeInBytes / sizeof(uint32_t), instance_count, 0, 0, 0);
+
+	count_draw(ibv.SizeInBytes / sizeof(uint32_t), instance_count);
 }
 
 void graphic_d3d12::render_end()
 {
+	PROFILE_SCOPE("render_end");
+
 	resource_barrier(D3D12_RESOURCE_STATE_PRESENT);
 
+	m_gpu_profiler->end_scope();
+	m_gpu_profiler->end_frame();
+
 	// close command
 	m_command_list->Close();
 
@@ -338,6 +410,8 @@ void graphic_d3d12::render_end()
 
 void graphic_d3d12::present()
 {
+	PROFILE_SCOPE("present");
+
 	/*  画面に表示  */
 	constexpr uint32_t interval = 1;
 	m_swapchain->Present(interval, 0);
@@ -353,12 +427,30 @@ void graphic_d3d12::present()
 	/*  次のフレームの描画準備がまだであれば待機する  */
 	if (m_fence->GetCompletedValue() < m_fence_counter.at(m_frame_index))
 	{
+		PROFILE_SCOPE("wait fence");
 		m_fence->SetEventOnCompletion(m_fence_counter.at(m_frame_index), m_fence_event);
+
+		const auto& begin = core::profile_clock();
 		WaitForSingleObjectEx(m_fence_event, INFINITE, false);
+
+		const auto& wait_ns = static_cast<double>(core::profile_clock() - begin) * 1e9 / core::profiler::get().ticks_per_second();
+		core::frame_counters::add(core::frame_counter::present_wait_ns, static_cast<uint64_t>(wait_ns));
 	}
 
 	/* 次のフレームのフェンスカウンターを増やす */
 	m_fence_counter.at(m_frame_index) = currentValue + 1;
+
+	/*  完了したフレームで破棄されたものを解放し、次のフレームの分を受け付ける  */
+	const auto& completed = m_fence->GetCompletedValue();
+	m_release_queue.collect(completed);
+
+	const auto& release = m_release_queue.get_stats();
+	core::frame_counters::get().set(core::frame_counter::release_queued, release.queued);
+	core::frame_counters::get().set(core::frame_counter::release_pending, release.pending);
+
+	defragment_heaps(completed);
+
+	m_release_queue.begin_frame(m_fence_counter.at(m_frame_index));
 }
 
 void graphic_d3d12::wait_gpu()
@@ -370,6 +462,12 @@ void graphic_d3d12::wait_gpu()
 	WaitForSingleObjectEx(m_fence_event, INFINITE, false);
 
 	++m_fence_counter.at(m_frame_index);
+
+	/*  GPU が止まっているので、待っていたものは全て解放できる  */
+	m_release_queue.collect(m_fence->GetCompletedValue());
+	m_upload_heaps->retire(m_fence->GetCompletedValue());
+	m_default_heaps->retire(m_fence->GetCompletedValue());
+	m_release_queue.begin_frame(m_fence_counter.at(m_frame_index));
 }
 
 void graphic_d3d12::resource_barrier(const D3D12_RESOURCE_STATES state)
@@ -384,7 +482,45 @@ void graphic_d3d12::resource_barrier(const D3D12_RESOURCE_STATES state)
 
 	/*  リソースバリア  */
 	m_command_list->ResourceBarrier(1, &barrier);
+	core::frame_counters::add(core::frame_counter::barriers, 1);
 
 	/*  状態の更新  */
 	prev_state = state;
 }
+
+void graphic_d3d12::set_pipeline(ID3D12PipelineState* pipeline)
+{
+	/*  同じパイプラインの設定し直しは省く (コマンドリストの Reset() で未設定に戻る)  */
+	if (m_bound_pipeline == pipeline) return;
+
+	m_command_list->SetPipelineState(pipeline);
+	m_bound_pipeline = pipeline;
+
+	core::frame_counters::add(core::frame_counter::pipeline_switches, 1);
+}
+
+void graphic_d3d12::defragment_heaps(uint64_t completed_fence_value)
+{
+	PROFILE_SCOPE("defragment");
+
+	/*  コピーの終わったデフラグ元の範囲と、空になったヒープを返す  */
+	m_upload_heaps->retire(completed_fence_value);
+	m_default_heaps->retire(completed_fence_value);
+
+	// アップロードヒープは GPU のコピー先にできず、gpu_buffer はマップしたまま使うので動かさない
+	if (m_default_heaps->get_stats().heap_count < 2) return;
+
+	/*  使用量の少ないヒープの中身を他のヒープへ移す  */
+	auto& allocator = m_defrag_allocator.at(m_frame_index);
+	allocator->Reset();
+	m_defrag_list->Reset(allocator.Get(), nullptr);
+
+	// 次のフレームの描画より先に実行するので、そのフェンス値でコピーの完了が分かる
+	const auto& moved = m_default_heaps->defragment(m_defrag_list.Get(), max_defrag_bytes, m_fence_counter.at(m_frame_index));
+	m_defrag_list->Close();
+
+	if (moved == 0) return;
+
+	std::array<ID3D12CommandList*, 1> ppCmdLists = { m_defrag_list.Get() };
+	m_command_queue->ExecuteCommandLists(1, ppCmdLists.data());
+}
\ No newline at end of file
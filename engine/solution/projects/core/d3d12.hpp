@@ -3,14 +3,17 @@
 #include "vertex.hpp"
 #include "d3d12_define.hpp"
 #include "d3d12_gpu_buffer.hpp"
+#include "d3d12_descriptor_heap.hpp"
+#include "deferred_release.hpp"
+#include "object_pool.hpp"
+#include "gpu_profiler.hpp"
 
 struct alignas(256) camera_mat
 {
-	DirectX::XMMATRIX view;
-	DirectX::XMMATRIX proj;
+	matrix4x4 view_proj;		// ビュー * 射影 (頂点ごとの行列の積を1回減らす)
 };
 
-class descriptor_heap;
+class d3d12_query_backend;
 
 class graphic_d3d12
 {
@@ -40,9 +43,12 @@ public:
 	void render_begin();
 	void render_init();
 	void set_constantbuffer(const gsl::not_null<descriptor_heap*> heap);
+	void update_camera(const core::camera& camera);
 	void render(const D3D12_VERTEX_BUFFER_VIEW& vbv);
 	void render(const D3D12_VERTEX_BUFFER_VIEW& vbv, const D3D12_INDEX_BUFFER_VIEW& ibv);
 	void render(gsl::span<D3D12_VERTEX_BUFFER_VIEW> views, const D3D12_INDEX_BUFFER_VIEW& ibv);
+	void render(gsl::span<D3D12_VERTEX_BUFFER_VIEW> views, const D3D12_INDEX_BUFFER_VIEW& ibv, const core::lod_level& level, uint32_t instance_count, uint32_t start_instance);
+	void render_instances(const D3D12_VERTEX_BUFFER_VIEW& vbv, const D3D12_INDEX_BUFFER_VIEW& ibv, D3D12_GPU_VIRTUAL_ADDRESS instances, uint32_t instance_base, uint32_t instance_count);
 	void render_end();
 	void present();
 	void wait_gpu();
@@ -51,13 +57,30 @@ public:
 	inline const gsl::not_null<ID3D12Device*> get_device() const noexcept { return m_device.Get(); }
 	inline const uint32_t get_frame_index() const noexcept { return m_frame_index; }
 
+	// gpu_buffer (CPU から書くバッファ) を配置するヒープ
+	inline gsl::not_null<heap_allocator*> get_upload_heaps() noexcept { return m_upload_heaps.get(); }
+
+	// GPU だけが読むリソース (テクスチャなど) を配置するヒープ。present() で少しずつデフラグする
+	inline gsl::not_null<heap_allocator*> get_default_heaps() noexcept { return m_default_heaps.get(); }
+
+	// GPU が使っているかもしれないリソースはここに渡して破棄する
+	inline core::deferred_release_queue& get_release_queue() noexcept { return m_release_queue; }
+
+	// render_begin() から render_end() の間でパスを計測する (結果は FRAME_COUNT フレーム後)
+	inline core::gpu_profiler& get_gpu_profiler() noexcept { return *m_gpu_profiler; }
+
 private:
 	void resource_barrier(const D3D12_RESOURCE_STATES state);
+	void set_pipeline(ID3D12PipelineState* pipeline);
+	void defragment_heaps(uint64_t completed_fence_value);
 
 private:
 	winapp* m_winapp;
 
 	Microsoft::WRL::ComPtr<ID3D12Device> m_device;
+	std::unique_ptr<heap_allocator> m_upload_heaps;		// 配置したバッファ (解放キューや定数バッファ) より後に破棄する
+	std::unique_ptr<heap_allocator> m_default_heaps;
+	core::deferred_release_queue m_release_queue;		// デバイスより先に破棄する
 	Microsoft::WRL::ComPtr<ID3D12CommandQueue> m_command_queue;
 	Microsoft::WRL::ComPtr<IDXGISwapChain3> m_swapchain;
 
@@ -65,12 +88,26 @@ private:
 	std::array<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>, FRAME_COUNT> m_command_allocator;
 
 	Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> m_command_list;
-	std::unique_ptr<descriptor_heap> m_heap_rtv;
+
+	// デフラグのコピー用 (次のフレームの描画より先に実行する)
+	std::array<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>, FRAME_COUNT> m_defrag_allocator;
+	Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> m_defrag_list;
+
+	// ディスクリプタヒープとパイプラインもバッファと同じく型ごとのプールに置き、ハンドルで参照する
+	core::object_pool<descriptor_heap> m_descriptor_heaps;
+	core::object_pool<Microsoft::WRL::ComPtr<ID3D12PipelineState>> m_pipelines;
+
+	core::object_pool<descriptor_heap>::handle_type m_heap_rtv;
+	core::object_pool<descriptor_heap>::handle_type m_heap_cbv;
 	Microsoft::WRL::ComPtr<ID3D12Fence> m_fence;
 	Microsoft::WRL::ComPtr<ID3D12RootSignature> m_root_signature;
-	Microsoft::WRL::ComPtr<ID3D12PipelineState> m_pipeline;
-	std::unique_ptr<descriptor_heap> m_heap_cbv;
-	std::array< std::unique_ptr<gpu_buffer<camera_mat>>, FRAME_COUNT> m_constant_buffers;
+	core::object_pool<Microsoft::WRL::ComPtr<ID3D12PipelineState>>::handle_type m_pipeline;
+	core::object_pool<Microsoft::WRL::ComPtr<ID3D12PipelineState>>::handle_type m_pipeline_instanced;		// instance_vs (StructuredBuffer)
+	ID3D12PipelineState* m_bound_pipeline = nullptr;						// コマンドリストに設定中のもの
+	std::unique_ptr<d3d12_query_backend> m_query_backend;
+	std::unique_ptr<core::gpu_profiler> m_gpu_profiler;
+	std::array<gpu_buffer<camera_mat>, FRAME_COUNT> m_constant_buffers;	// フレームごと (m_frame_index で引く)
+	std::array<uint64_t, FRAME_COUNT> m_camera_versions = {};		// 各フレームのバッファに書いたカメラの版
 
 
 	HANDLE m_fence_event = {};
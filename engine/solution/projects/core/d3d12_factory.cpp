@@ -43,6 +43,18 @@ namespace d3d12_factory
 		return factory;
 	}
 
+	ComPtr<IDXGIAdapter3> get_adapter(gsl::not_null<ID3D12Device*> pDevice)
+	{
+		// デバイスを作ったアダプタを LUID で探す
+		const auto& factory = create_factory();
+
+		ComPtr<IDXGIAdapter3> adapter;
+		const auto& hr = factory->EnumAdapterByLuid(pDevice->GetAdapterLuid(), IID_PPV_ARGS(adapter.GetAddressOf()));
+		Ensures(SUCCEEDED(hr));
+
+		return adapter;
+	}
+
 	ComPtr<IDXGISwapChain3> create_swapchain(gsl::not_null<ID3D12CommandQueue*> pQueue, uint32_t width, uint32_t height, uint32_t buffer_count, HWND hwnd)
 	{
 		// create factory
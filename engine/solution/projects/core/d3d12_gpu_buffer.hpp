@@ -1,79 +1,100 @@
 ﻿#pragma once
 #include "vertex.hpp"
+#include "d3d12_heap_allocator.hpp"
 
+/*
+	アップロードヒープに配置したバッファ (CPU からマップして書く)
+	アップロードヒープはデフラグで動かさないので、マップしたポインタやビューを持ち続けてよい
+*/
 template<class T> class gpu_buffer
 {
 public:
 	gpu_buffer() noexcept
-		: m_buffer_size(0)
-		, m_resource(nullptr)
+		: m_allocator(nullptr)
+		, m_allocation(nullptr)
 		, m_ptr(nullptr)
+		, m_buffer_size(0)
 	{
 	}
 
-	gpu_buffer(gsl::not_null<ID3D12Device*> pDevice, size_t buffer_size)
-		: m_buffer_size(buffer_size)
-		, m_resource(nullptr)
+	gpu_buffer(gsl::not_null<heap_allocator*> allocator, size_t buffer_size)
+		: m_allocator(allocator)
+		, m_allocation(nullptr)
 		, m_ptr(nullptr)
+		, m_buffer_size(buffer_size)
 	{
-		/*  ヒープ設定  */
-		const auto& prop = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-
 		/*  リソース設定  */
 		const auto& desc = CD3DX12_RESOURCE_DESC::Buffer(m_buffer_size);
 
-		// create resource
-		const auto& hr = pDevice->CreateCommittedResource(
-			&prop,
-			D3D12_HEAP_FLAG_NONE,
-			&desc,
-			D3D12_RESOURCE_STATE_GENERIC_READ,
-			nullptr,
-			IID_PPV_ARGS(m_resource.GetAddressOf())
-		);
-		Ensures(SUCCEEDED(hr));
+		// ヒープの中に配置する
+		m_allocation = m_allocator->create_resource(desc, D3D12_RESOURCE_STATE_GENERIC_READ);
 	}
 
 	~gpu_buffer()
 	{
+		// ムーブ元 (プールの詰め直しなど) はリソースを持たない
+		if(m_allocation == nullptr) return;
+
 		unmap();
+		m_allocator->release(m_allocation);
 	}
 
 public:
 	gpu_buffer(const gpu_buffer&) = delete;
 	gpu_buffer& operator=(const gpu_buffer&) = delete;
 
-	gpu_buffer(gpu_buffer&&) = default;
-	gpu_buffer& operator=(gpu_buffer&&) = default;
+	gpu_buffer(gpu_buffer&& other) noexcept
+		: m_allocator(std::exchange(other.m_allocator, nullptr))
+		, m_allocation(std::exchange(other.m_allocation, nullptr))
+		, m_ptr(std::exchange(other.m_ptr, nullptr))
+		, m_buffer_size(std::exchange(other.m_buffer_size, 0))
+	{
+	}
+
+	gpu_buffer& operator=(gpu_buffer&& other) noexcept
+	{
+		if(this == &other) return *this;
+
+		// 今持っているバッファは一時オブジェクトと一緒に解放する
+		gpu_buffer released(std::move(*this));
+
+		m_allocator = std::exchange(other.m_allocator, nullptr);
+		m_allocation = std::exchange(other.m_allocation, nullptr);
+		m_ptr = std::exchange(other.m_ptr, nullptr);
+		m_buffer_size = std::exchange(other.m_buffer_size, 0);
+		return *this;
+	}
 
 public:
-	inline void map(const gsl::span<T> span)
+	inline void map(const gsl::span<const T> span)
 	{
 		/*  マップに失敗したか  */
-		Ensures(SUCCEEDED(m_resource->Map(0, nullptr, reinterpret_cast<void**>(&m_ptr))));
+		Ensures(SUCCEEDED(get_resource()->Map(0, nullptr, reinterpret_cast<void**>(&m_ptr))));
 
 		/*  マップするデータとサイズは同じか  */
 		Expects(span.size_bytes() == m_buffer_size);
 
 		/*  指定されたデータのメモリをコピーする  */
 		memcpy_s(m_ptr, m_buffer_size, span.data(), m_buffer_size);
+		core::frame_counters::add(core::frame_counter::upload_bytes, m_buffer_size);
 	}
 
 	inline void map(const T& value)
 	{
 		/*  マップに失敗したか  */
-		Ensures(SUCCEEDED(m_resource->Map(0, nullptr, reinterpret_cast<void**>(&m_ptr))));
+		Ensures(SUCCEEDED(get_resource()->Map(0, nullptr, reinterpret_cast<void**>(&m_ptr))));
 
 		/*  マップするデータとサイズは同じか  */
 		Expects(sizeof(value) == m_buffer_size);
 
 		/*  指定されたデータのメモリをコピーする  */
 		memcpy_s(m_ptr, m_buffer_size, &value, m_buffer_size);
+		core::frame_counters::add(core::frame_counter::upload_bytes, m_buffer_size);
 	}
 
 	inline void unmap() const
 	{
-		m_resource->Unmap(0, nullptr);
+		get_resource()->Unmap(0, nullptr);
 	}
 
 	inline gsl::not_null<T*> data() { return m_ptr; }
@@ -82,7 +103,7 @@ public:
 	inline D3D12_VERTEX_BUFFER_VIEW get_vbv() const
 	{
 		D3D12_VERTEX_BUFFER_VIEW vbv{};
-		vbv.BufferLocation = m_resource->GetGPUVirtualAddress();
+		vbv.BufferLocation = get_resource()->GetGPUVirtualAddress();
 		vbv.SizeInBytes = gsl::narrow<UINT>(m_buffer_size);
 		vbv.StrideInBytes = gsl::narrow<UINT>(sizeof(T));
 		return vbv;
@@ -92,17 +113,18 @@ public:
 	inline D3D12_INDEX_BUFFER_VIEW get_ibv() const
 	{
 		D3D12_INDEX_BUFFER_VIEW ibv{};
-		ibv.BufferLocation = m_resource->GetGPUVirtualAddress();
+		ibv.BufferLocation = get_resource()->GetGPUVirtualAddress();
 		ibv.SizeInBytes = gsl::narrow<UINT>(m_buffer_size);
 		ibv.Format = DXGI_FORMAT_R32_UINT;
 		return ibv;
 	}
 
 public:
-	inline gsl::not_null<ID3D12Resource*> get_resource() { return m_resource.Get(); }
+	inline gsl::not_null<ID3D12Resource*> get_resource() const { return m_allocation->resource.Get(); }
 
 private:
-	Microsoft::WRL::ComPtr<ID3D12Resource> m_resource;
+	heap_allocator* m_allocator;
+	gpu_allocation* m_allocation;
 	T* m_ptr;
 
 	size_t m_buffer_size;
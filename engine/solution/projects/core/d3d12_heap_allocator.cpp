@@ -0,0 +1,255 @@
+﻿#include "include.hpp"
+
+using namespace Microsoft::WRL;
+
+heap_allocator::heap_allocator(gsl::not_null<ID3D12Device*> pDevice, D3D12_HEAP_TYPE type, D3D12_HEAP_FLAGS flags, uint64_t heap_size)
+	: m_device(pDevice)
+	, m_type(type)
+	, m_flags(flags)
+	, m_heap_size(heap_size)
+{
+	Expects(heap_size % D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT == 0);
+}
+
+heap_allocator::~heap_allocator()
+{
+	m_retired.clear();
+
+	for(auto i = 0u; i < m_heaps.size(); ++i)
+	{
+		if(m_heaps.at(i) == nullptr) continue;
+		for(auto* allocation : collect_allocations(i)) delete allocation;
+	}
+}
+
+gsl::not_null<gpu_allocation*> heap_allocator::create_resource(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initial_state, const D3D12_CLEAR_VALUE* clear_value)
+{
+	auto allocation = std::make_unique<gpu_allocation>();
+	allocation->desc = desc;
+	allocation->state = initial_state;
+
+	const auto& info = get_allocation_info(allocation->desc);
+
+	/*  既存のヒープに置く  */
+	auto placed = false;
+	for(auto i = 0u; i < m_heaps.size() && !placed; ++i)
+	{
+		if(m_heaps.at(i) == nullptr) continue;
+		placed = place(*allocation, info, i, clear_value, initial_state);
+	}
+
+	/*  入らなければヒープを追加する (大きいリソースは専用サイズ)  */
+	if(!placed)
+	{
+		const auto& size = (info.SizeInBytes + D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1) & ~uint64_t(D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1);
+		const auto& heap = create_heap(std::max(m_heap_size, size));
+
+		placed = place(*allocation, info, heap, clear_value, initial_state);
+		Ensures(placed);
+	}
+
+	return allocation.release();
+}
+
+void heap_allocator::release(gsl::not_null<gpu_allocation*> allocation)
+{
+	allocation->resource.Reset();
+	m_heaps.at(allocation->heap)->allocator.free(allocation->range);
+
+	delete allocation.get();
+}
+
+uint64_t heap_allocator::defragment(gsl::not_null<ID3D12GraphicsCommandList*> pCommandList, uint64_t max_bytes, uint64_t fence_value)
+{
+	// アップロードヒープは GPU からコピー先にできない
+	if(m_type != D3D12_HEAP_TYPE_DEFAULT) return 0;
+
+	/*  移動元: 使用量が一番少ないヒープ  */
+	auto source = core::INVALID_TLSF_BLOCK;
+	auto live_heaps = 0u;
+	for(auto i = 0u; i < m_heaps.size(); ++i)
+	{
+		if(m_heaps.at(i) == nullptr) continue;
+		++live_heaps;
+
+		const auto& allocator = m_heaps.at(i)->allocator;
+		if(allocator.empty()) continue;
+		if(source == core::INVALID_TLSF_BLOCK || allocator.used() < m_heaps.at(source)->allocator.used()) source = i;
+	}
+	if(live_heaps < 2 || source == core::INVALID_TLSF_BLOCK) return 0;
+
+	/*  他のヒープへ置き直す (このフレームの分は新しい配置だけ決めておく)  */
+	std::vector<D3D12_RESOURCE_BARRIER> before;
+	std::vector<D3D12_RESOURCE_BARRIER> after;
+	std::vector<std::pair<ID3D12Resource*, ID3D12Resource*>> copies;
+
+	uint64_t moved = 0;
+	for(auto* allocation : collect_allocations(source))
+	{
+		if(moved >= max_bytes) break;
+
+		const auto& info = m_device->GetResourceAllocationInfo(0, 1, &allocation->desc);
+		auto old = retired_range{ allocation->resource, allocation->heap, allocation->range, fence_value };
+
+		auto placed = false;
+		for(auto i = 0u; i < m_heaps.size() && !placed; ++i)
+		{
+			if(i == source || m_heaps.at(i) == nullptr) continue;
+			placed = place(*allocation, info, i, nullptr, D3D12_RESOURCE_STATE_COPY_DEST);
+		}
+
+		// 他のヒープに空きがない
+		if(!placed) break;
+
+		const auto& state = allocation->state;
+		if((state & D3D12_RESOURCE_STATE_COPY_SOURCE) == 0)
+		{
+			before.push_back(CD3DX12_RESOURCE_BARRIER::Transition(old.resource.Get(), state, D3D12_RESOURCE_STATE_COPY_SOURCE));
+		}
+		if(state != D3D12_RESOURCE_STATE_COPY_DEST)
+		{
+			after.push_back(CD3DX12_RESOURCE_BARRIER::Transition(allocation->resource.Get(), D3D12_RESOURCE_STATE_COPY_DEST, state));
+		}
+		copies.emplace_back(allocation->resource.Get(), old.resource.Get());
+
+		// 古い範囲はコピーが終わるまで確保したままにする
+		m_heaps.at(source)->allocator.set_user_data(old.range, 0);
+		m_retired.push_back(std::move(old));
+
+		moved += allocation->range.size;
+	}
+
+	/*  コピーを積む  */
+	if(!before.empty()) pCommandList->ResourceBarrier(gsl::narrow<UINT>(before.size()), before.data());
+	for(const auto& [destination, source_resource] : copies) pCommandList->CopyResource(destination, source_resource);
+	if(!after.empty()) pCommandList->ResourceBarrier(gsl::narrow<UINT>(after.size()), after.data());
+
+	m_moved_bytes += moved;
+	return moved;
+}
+
+void heap_allocator::retire(uint64_t completed_fence_value)
+{
+	/*  コピーの終わった移動元の範囲を返す  */
+	std::erase_if(m_retired, [&](const retired_range& retired)
+	{
+		if(retired.fence_value > completed_fence_value) return false;
+
+		m_heaps.at(retired.heap)->allocator.free(retired.range);
+		return true;
+	});
+
+	/*  空になったヒープを解放する (最低1つは残す)  */
+	auto live_heaps = std::count_if(m_heaps.begin(), m_heaps.end(), [](const auto& heap) { return heap != nullptr; });
+	for(auto& heap : m_heaps)
+	{
+		if(live_heaps <= 1) break;
+		if(heap == nullptr || !heap->allocator.empty()) continue;
+
+		heap.reset();
+		--live_heaps;
+	}
+}
+
+heap_allocator_stats heap_allocator::get_stats() const
+{
+	heap_allocator_stats stats{};
+	stats.moved_bytes = m_moved_bytes;
+
+	for(const auto& heap : m_heaps)
+	{
+		if(heap == nullptr) continue;
+
+		++stats.heap_count;
+		stats.allocation_count += heap->allocator.allocation_count();
+		stats.heap_bytes += heap->allocator.capacity();
+		stats.used_bytes += heap->allocator.used();
+	}
+
+	// 移動待ちの古い範囲は割り当て数に含めない
+	stats.allocation_count -= gsl::narrow<uint32_t>(m_retired.size());
+
+	return stats;
+}
+
+D3D12_RESOURCE_ALLOCATION_INFO heap_allocator::get_allocation_info(D3D12_RESOURCE_DESC& desc) const
+{
+	/*  レンダーターゲット・深度以外のテクスチャは 4 KiB 整列を試す  */
+	constexpr auto target_flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
+
+	if(desc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER && (desc.Flags & target_flags) == 0 && desc.SampleDesc.Count == 1)
+	{
+		desc.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+
+		const auto& info = m_device->GetResourceAllocationInfo(0, 1, &desc);
+		if(info.Alignment == D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT) return info;
+	}
+
+	// 64 KiB を超える場合などは通常の整列に戻す
+	desc.Alignment = 0;
+	return m_device->GetResourceAllocationInfo(0, 1, &desc);
+}
+
+bool heap_allocator::place(gpu_allocation& allocation, const D3D12_RESOURCE_ALLOCATION_INFO& info, uint32_t heap, const D3D12_CLEAR_VALUE* clear_value, D3D12_RESOURCE_STATES state)
+{
+	auto& block = *m_heaps.at(heap);
+
+	const auto& range = block.allocator.allocate(info.SizeInBytes, info.Alignment, reinterpret_cast<uint64_t>(&allocation));
+	if(!range.valid()) return false;
+
+	ComPtr<ID3D12Resource> resource;
+	const auto& hr = m_device->CreatePlacedResource(
+		block.heap.Get(),
+		range.offset,
+		&allocation.desc,
+		state,
+		clear_value,
+		IID_PPV_ARGS(resource.GetAddressOf())
+	);
+	Ensures(SUCCEEDED(hr));
+
+	allocation.resource = std::move(resource);
+	allocation.heap = heap;
+	allocation.range = range;
+
+	return true;
+}
+
+uint32_t heap_allocator::create_heap(uint64_t size)
+{
+	D3D12_HEAP_DESC desc{};
+	desc.SizeInBytes = size;
+	desc.Properties = CD3DX12_HEAP_PROPERTIES(m_type);
+	desc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+	desc.Flags = m_flags;
+
+	auto block = std::make_unique<heap_block>();
+	const auto& hr = m_device->CreateHeap(&desc, IID_PPV_ARGS(block->heap.GetAddressOf()));
+	Ensures(SUCCEEDED(hr));
+
+	block->allocator = core::tlsf_allocator(size, D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT);
+
+	/*  解放済みのスロットを再利用する  */
+	const auto& it = std::find(m_heaps.begin(), m_heaps.end(), nullptr);
+	if(it != m_heaps.end())
+	{
+		*it = std::move(block);
+		return gsl::narrow<uint32_t>(std::distance(m_heaps.begin(), it));
+	}
+
+	m_heaps.push_back(std::move(block));
+	return gsl::narrow<uint32_t>(m_heaps.size() - 1);
+}
+
+std::vector<gpu_allocation*> heap_allocator::collect_allocations(uint32_t heap) const
+{
+	std::vector<gpu_allocation*> allocations;
+
+	// 移動待ちの古い範囲はユーザーデータが 0
+	m_heaps.at(heap)->allocator.for_each_allocation([&](const core::tlsf_allocation&, uint64_t user_data)
+	{
+		if(user_data != 0) allocations.push_back(reinterpret_cast<gpu_allocation*>(user_data));
+	});
+
+	return allocations;
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+﻿#pragma once
+#include "tlsf_allocator.hpp"
+
+/*  配置済みリソース (デフラグで作り直されることがあるので、リソースと GPU アドレスは毎回ここから取る)  */
+struct gpu_allocation
+{
+	Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+	D3D12_RESOURCE_DESC desc;
+	D3D12_RESOURCE_STATES state;		// コマンドリストの外での状態 (デフラグのコピー後もこの状態に戻す)
+
+	uint32_t heap;
+	core::tlsf_allocation range;
+};
+
+struct heap_allocator_stats
+{
+	uint32_t heap_count;
+	uint32_t allocation_count;
+	uint64_t heap_bytes;
+	uint64_t used_bytes;
+	uint64_t moved_bytes;		// デフラグで移動した累計
+};
+
+/*
+	ID3D12Heap を大きな単位で確保し、CreatePlacedResource で中に配置する
+	・ヒープ内の割り当ては core::tlsf_allocator (4 KiB 単位)。範囲のユーザーデータに gpu_allocation* を持つ
+	・小さいテクスチャは 4 KiB 整列を試し、使えなければ通常の 64 KiB 整列にする
+	・defragment() で使用量の少ないヒープの中身を他のヒープへ GPU コピーで移し、空いたヒープを返す
+*/
+class heap_allocator
+{
+public:
+	static constexpr uint64_t DEFAULT_HEAP_SIZE = 64ull * 1024 * 1024;
+
+public:
+	heap_allocator(gsl::not_null<ID3D12Device*> pDevice, D3D12_HEAP_TYPE type, D3D12_HEAP_FLAGS flags, uint64_t heap_size = DEFAULT_HEAP_SIZE);
+	~heap_allocator();
+
+	heap_allocator(const heap_allocator&) = delete;
+	heap_allocator& operator=(const heap_allocator&) = delete;
+
+public:
+	gsl::not_null<gpu_allocation*> create_resource(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initial_state, const D3D12_CLEAR_VALUE* clear_value = nullptr);
+
+	// GPU が使い終わってから呼ぶこと
+	void release(gsl::not_null<gpu_allocation*> allocation);
+
+	// 最大 max_bytes 分のリソースを移動するコピーを積む。fence_value はこのコマンドリストの完了を示すフェンス値
+	uint64_t defragment(gsl::not_null<ID3D12GraphicsCommandList*> pCommandList, uint64_t max_bytes, uint64_t fence_value);
+
+	// 完了したフェンス値までのデフラグ元を解放する
+	void retire(uint64_t completed_fence_value);
+
+	heap_allocator_stats get_stats() const;
+
+private:
+	struct heap_block
+	{
+		Microsoft::WRL::ComPtr<ID3D12Heap> heap;
+		core::tlsf_allocator allocator;
+	};
+
+	struct retired_range
+	{
+		Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+		uint32_t heap;
+		core::tlsf_allocation range;
+		uint64_t fence_value;
+	};
+
+private:
+	D3D12_RESOURCE_ALLOCATION_INFO get_allocation_info(D3D12_RESOURCE_DESC& desc) const;
+	bool place(gpu_allocation& allocation, const D3D12_RESOURCE_ALLOCATION_INFO& info, uint32_t heap, const D3D12_CLEAR_VALUE* clear_value, D3D12_RESOURCE_STATES state);
+	uint32_t create_heap(uint64_t size);
+	std::vector<gpu_allocation*> collect_allocations(uint32_t heap) const;
+
+private:
+	ID3D12Device* m_device;
+	D3D12_HEAP_TYPE m_type;
+	D3D12_HEAP_FLAGS m_flags;
+	uint64_t m_heap_size;
+
+	std::vector<std::unique_ptr<heap_block>> m_heaps;		// 解放したヒープは nullptr
+	std::vector<retired_range> m_retired;
+
+	uint64_t m_moved_bytes = 0;
+};
\ No newline at end of file
@@ -0,0 +1,15 @@
+﻿#include "include.hpp"
+
+d3d12_memory_budget::d3d12_memory_budget(gsl::not_null<ID3D12Device*> pDevice)
+	: m_adapter(d3d12_factory::get_adapter(pDevice))
+{
+}
+
+core::memory_budget_info d3d12_memory_budget::query()
+{
+	DXGI_QUERY_VIDEO_MEMORY_INFO info{};
+	const auto& hr = m_adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &info);
+	Ensures(SUCCEEDED(hr));
+
+	return core::memory_budget_info{ info.Budget, info.CurrentUsage };
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+﻿#pragma once
+#include "memory_budget.hpp"
+
+/*  DXGI から取得する VRAM 予算 (ローカルセグメント)  */
+class d3d12_memory_budget final : public core::memory_budget_source
+{
+public:
+	explicit d3d12_memory_budget(gsl::not_null<ID3D12Device*> pDevice);
+
+public:
+	core::memory_budget_info query() override;
+
+private:
+	Microsoft::WRL::ComPtr<IDXGIAdapter3> m_adapter;
+};
\ No newline at end of file
@@ -0,0 +1,117 @@
+﻿#include "include.hpp"
+
+static_assert(sizeof(core::gpu_pipeline_stats) == sizeof(D3D12_QUERY_DATA_PIPELINE_STATISTICS), "gpu_pipeline_stats の並びが D3D12 と一致しない");
+
+d3d12_query_backend::d3d12_query_backend(gsl::not_null<ID3D12Device*> pDevice, gsl::not_null<ID3D12CommandQueue*> pQueue, uint32_t timestamp_count, uint32_t statistics_count)
+	: m_queue(pQueue)
+	, m_statistics_offset(static_cast<uint64_t>(timestamp_count) * sizeof(uint64_t))
+{
+	HRESULT hr{};
+
+	/*  クエリヒープ  */
+	D3D12_QUERY_HEAP_DESC desc{};
+	desc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+	desc.Count = timestamp_count;
+	hr = pDevice->CreateQueryHeap(&desc, IID_PPV_ARGS(m_timestamp_heap.GetAddressOf()));
+	Ensures(SUCCEEDED(hr));
+
+	desc.Type = D3D12_QUERY_HEAP_TYPE_PIPELINE_STATISTICS;
+	desc.Count = statistics_count;
+	hr = pDevice->CreateQueryHeap(&desc, IID_PPV_ARGS(m_statistics_heap.GetAddressOf()));
+	Ensures(SUCCEEDED(hr));
+
+	/*  リードバックバッファ  */
+	const auto& prop = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK);
+	const auto& buffer = CD3DX12_RESOURCE_DESC::Buffer(m_statistics_offset + statistics_count * sizeof(D3D12_QUERY_DATA_PIPELINE_STATISTICS));
+
+	hr = pDevice->CreateCommittedResource(
+		&prop,
+		D3D12_HEAP_FLAG_NONE,
+		&buffer,
+		D3D12_RESOURCE_STATE_COPY_DEST,
+		nullptr,
+		IID_PPV_ARGS(m_readback.GetAddressOf())
+	);
+	Ensures(SUCCEEDED(hr));
+
+	hr = m_queue->GetTimestampFrequency(&m_frequency);
+	Ensures(SUCCEEDED(hr));
+
+	LARGE_INTEGER qpc{};
+	QueryPerformanceFrequency(&qpc);
+	m_qpc_frequency = gsl::narrow_cast<uint64_t>(qpc.QuadPart);
+}
+
+void d3d12_query_backend::timestamp(uint32_t index)
+{
+	Expects(m_command_list != nullptr);
+	m_command_list->EndQuery(m_timestamp_heap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, index);
+}
+
+void d3d12_query_backend::begin_statistics(uint32_t index)
+{
+	Expects(m_command_list != nullptr);
+	m_command_list->BeginQuery(m_statistics_heap.Get(), D3D12_QUERY_TYPE_PIPELINE_STATISTICS, index);
+}
+
+void d3d12_query_backend::end_statistics(uint32_t index)
+{
+	Expects(m_command_list != nullptr);
+	m_command_list->EndQuery(m_statistics_heap.Get(), D3D12_QUERY_TYPE_PIPELINE_STATISTICS, index);
+}
+
+void d3d12_query_backend::resolve(uint32_t first_timestamp, uint32_t timestamp_count, uint32_t first_statistics, uint32_t statistics_count)
+{
+	Expects(m_command_list != nullptr);
+
+	if (timestamp_count > 0)
+	{
+		m_command_list->ResolveQueryData(m_timestamp_heap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, first_timestamp, timestamp_count, m_readback.Get(), first_timestamp * sizeof(uint64_t));
+	}
+
+	if (statistics_count > 0)
+	{
+		const auto& offset = m_statistics_offset + first_statistics * sizeof(D3D12_QUERY_DATA_PIPELINE_STATISTICS);
+		m_command_list->ResolveQueryData(m_statistics_heap.Get(), D3D12_QUERY_TYPE_PIPELINE_STATISTICS, first_statistics, statistics_count, m_readback.Get(), offset);
+	}
+}
+
+void d3d12_query_backend::read(uint32_t first_timestamp, gsl::span<uint64_t> timestamps, uint32_t first_statistics, gsl::span<core::gpu_pipeline_stats> statistics)
+{
+	/*  読む範囲だけマップする (CPU から書かないので Unmap の範囲は空)  */
+	auto copy = [&](uint64_t offset, gsl::span<std::byte> out)
+	{
+		if (out.empty()) return;
+
+		const D3D12_RANGE range{ gsl::narrow<SIZE_T>(offset), gsl::narrow<SIZE_T>(offset + out.size()) };
+		const D3D12_RANGE written{ 0, 0 };
+
+		std::byte* ptr = nullptr;
+		Ensures(SUCCEEDED(m_readback->Map(0, &range, reinterpret_cast<void**>(&ptr))));
+		std::memcpy(out.data(), ptr + offset, out.size());
+		m_readback->Unmap(0, &written);
+	};
+
+	copy(first_timestamp * sizeof(uint64_t), gsl::as_writable_bytes(timestamps));
+	copy(m_statistics_offset + first_statistics * sizeof(D3D12_QUERY_DATA_PIPELINE_STATISTICS), gsl::as_writable_bytes(statistics));
+}
+
+uint64_t d3d12_query_backend::frequency()
+{
+	return m_frequency;
+}
+
+void d3d12_query_backend::calibrate(uint64_t& gpu_timestamp, uint64_t& cpu_ticks)
+{
+	/*  GPU と QPC の組を取り、取得からの経過分を引いて profile_clock() に直す  */
+	uint64_t qpc_at_calibration{};
+	const auto& hr = m_queue->GetClockCalibration(&gpu_timestamp, &qpc_at_calibration);
+	Ensures(SUCCEEDED(hr));
+
+	LARGE_INTEGER qpc_now{};
+	QueryPerformanceCounter(&qpc_now);
+	const auto& now = core::profile_clock();
+
+	const auto& elapsed = static_cast<double>(gsl::narrow_cast<uint64_t>(qpc_now.QuadPart) - qpc_at_calibration) / m_qpc_frequency;
+	cpu_ticks = now - static_cast<uint64_t>(elapsed * core::profiler::get().ticks_per_second());
+}
\ No newline at end of file
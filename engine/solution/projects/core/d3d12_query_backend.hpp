@@ -0,0 +1,38 @@
+﻿#pragma once
+#include "gpu_profiler.hpp"
+
+/*
+	ID3D12QueryHeap によるタイムスタンプ・パイプライン統計
+	resolve はリードバックバッファ (タイムスタンプ -> 統計の順) の同じ位置に書く
+*/
+class d3d12_query_backend final : public core::gpu_query_backend
+{
+public:
+	d3d12_query_backend(gsl::not_null<ID3D12Device*> pDevice, gsl::not_null<ID3D12CommandQueue*> pQueue, uint32_t timestamp_count, uint32_t statistics_count);
+
+public:
+	// 以降のクエリを積むコマンドリスト (毎フレーム Reset の後に設定する)
+	inline void set_command_list(gsl::not_null<ID3D12GraphicsCommandList*> pCommandList) noexcept { m_command_list = pCommandList; }
+
+public:
+	void timestamp(uint32_t index) override;
+	void begin_statistics(uint32_t index) override;
+	void end_statistics(uint32_t index) override;
+
+	void resolve(uint32_t first_timestamp, uint32_t timestamp_count, uint32_t first_statistics, uint32_t statistics_count) override;
+	void read(uint32_t first_timestamp, gsl::span<uint64_t> timestamps, uint32_t first_statistics, gsl::span<core::gpu_pipeline_stats> statistics) override;
+
+	uint64_t frequency() override;
+	void calibrate(uint64_t& gpu_timestamp, uint64_t& cpu_ticks) override;
+
+private:
+	Microsoft::WRL::ComPtr<ID3D12QueryHeap> m_timestamp_heap;
+	Microsoft::WRL::ComPtr<ID3D12QueryHeap> m_statistics_heap;
+	Microsoft::WRL::ComPtr<ID3D12Resource> m_readback;
+	ID3D12CommandQueue* m_queue;
+	ID3D12GraphicsCommandList* m_command_list = nullptr;
+
+	uint64_t m_statistics_offset;		// リードバックバッファ内の統計の先頭
+	uint64_t m_frequency = 0;
+	uint64_t m_qpc_frequency = 0;
+};
\ No newline at end of file
@@ -0,0 +1,79 @@
+﻿#include "pch.hpp"
+#include "deferred_release.hpp"
+
+namespace core
+{
+	deferred_release_queue::~deferred_release_queue()
+	{
+		flush();
+	}
+
+	void deferred_release_queue::begin_frame(uint64_t fence_value)
+	{
+		m_fence_value.store(fence_value, std::memory_order_release);
+		m_queued.store(0, std::memory_order_relaxed);
+	}
+
+	uint32_t deferred_release_queue::collect(uint64_t completed_fence_value)
+	{
+		drain();
+
+		/*  完了したものを後ろに集めてまとめて破棄する  */
+		const auto& it = std::partition(m_pending.begin(), m_pending.end(), [completed_fence_value](const std::unique_ptr<entry>& entry)
+		{
+			return entry->fence_value > completed_fence_value;
+		});
+
+		const auto& count = gsl::narrow<uint32_t>(std::distance(it, m_pending.end()));
+		m_pending.erase(it, m_pending.end());
+
+		m_released = count;
+		m_total_released += count;
+
+		return count;
+	}
+
+	void deferred_release_queue::flush()
+	{
+		drain();
+
+		m_released = m_pending.size();
+		m_total_released += m_pending.size();
+		m_pending.clear();
+	}
+
+	deferred_release_stats deferred_release_queue::get_stats() const
+	{
+		deferred_release_stats stats{};
+		stats.queued = m_queued.load(std::memory_order_relaxed);
+		stats.released = m_released;
+		stats.total_released = m_total_released;
+		stats.pending = gsl::narrow_cast<uint32_t>(m_pending.size());
+		return stats;
+	}
+
+	void deferred_release_queue::push(entry* node) noexcept
+	{
+		node->fence_value = m_fence_value.load(std::memory_order_acquire);
+		node->next = m_head.load(std::memory_order_relaxed);
+
+		while(!m_head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+		{
+		}
+
+		m_queued.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void deferred_release_queue::drain()
+	{
+		// スタックごと取り出すので ABA は起きない
+		auto* node = m_head.exchange(nullptr, std::memory_order_acquire);
+
+		while(node != nullptr)
+		{
+			auto* next = node->next;
+			m_pending.emplace_back(node);
+			node = next;
+		}
+	}
+}
\ No newline at end of file
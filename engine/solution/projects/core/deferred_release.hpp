@@ -0,0 +1,77 @@
+﻿#pragma once
+
+namespace core
+{
+	struct deferred_release_stats
+	{
+		uint64_t queued;			// 今のフレームで release() されたもの
+		uint64_t released;			// 直前の collect() で実際に解放したもの
+		uint64_t total_released;
+		uint32_t pending;			// GPU の完了待ち
+	};
+
+	/*
+		GPU が使い終わるまでオブジェクトの破棄を遅らせる
+		・release() はどのスレッドからでも呼べる (ロックなしのスタックに積む)
+		・フレーム N に積まれたものは、フレーム N のフェンス値が完了した collect() でまとめて破棄する
+		・フェンス値は呼び出し側が渡すので、GPU なしでも値を進めるだけで試せる
+	*/
+	class deferred_release_queue
+	{
+	public:
+		deferred_release_queue() = default;
+		~deferred_release_queue();
+
+		deferred_release_queue(const deferred_release_queue&) = delete;
+		deferred_release_queue& operator=(const deferred_release_queue&) = delete;
+
+	public:
+		// ComPtr, unique_ptr, gpu_buffer など、破棄で解放されるものを渡す
+		template<class T> void release(T&& object)
+		{
+			push(new holder<std::decay_t<T>>(std::forward<T>(object)));
+		}
+
+		// 描画スレッドから呼ぶ: これから積まれるものに付けるフェンス値 (このフレームの終わりにシグナルする値)
+		void begin_frame(uint64_t fence_value);
+
+		// 描画スレッドから呼ぶ: completed_fence_value 以下のものを破棄し、その数を返す
+		uint32_t collect(uint64_t completed_fence_value);
+
+		// 全て破棄する (GPU の待機後に呼ぶ)
+		void flush();
+
+		deferred_release_stats get_stats() const;
+
+	private:
+		struct entry
+		{
+			virtual ~entry() = default;
+
+			entry* next = nullptr;
+			uint64_t fence_value = 0;
+		};
+
+		template<class T> struct holder final : entry
+		{
+			explicit holder(T&& value) : object(std::move(value)) {}
+			explicit holder(const T& value) : object(value) {}
+
+			T object;
+		};
+
+	private:
+		void push(entry* node) noexcept;
+		void drain();
+
+	private:
+		std::atomic<entry*> m_head = nullptr;
+		std::atomic<uint64_t> m_fence_value = 0;
+		std::atomic<uint64_t> m_queued = 0;
+
+		// 以下は描画スレッドのみ
+		std::vector<std::unique_ptr<entry>> m_pending;
+		uint64_t m_released = 0;
+		uint64_t m_total_released = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,207 @@
+﻿#include "pch.hpp"
+#include "entity_world.hpp"
+
+namespace
+{
+	std::mutex g_component_mutex;
+	std::vector<core::component_info> g_components;
+}
+
+namespace core
+{
+	uint32_t register_component(size_t size, size_t alignment)
+	{
+		std::lock_guard lock(g_component_mutex);
+
+		Expects(g_components.size() < MAX_COMPONENTS);
+
+		// 登録後に配列が伸びても参照が無効にならないよう、最初に確保しておく
+		g_components.reserve(MAX_COMPONENTS);
+		g_components.push_back(component_info{ size, alignment });
+
+		return gsl::narrow<uint32_t>(g_components.size() - 1);
+	}
+
+	const component_info& get_component_info(uint32_t id)
+	{
+		return g_components.at(id);
+	}
+
+	archetype::archetype(component_mask mask)
+		: m_mask(mask)
+	{
+		/*  1行あたりのサイズから容量を見積もり、整列の詰め物で溢れる間は減らす  */
+		auto row_size = sizeof(entity);
+		for(auto id = 0u; id < MAX_COMPONENTS; ++id)
+		{
+			if(has(id)) row_size += get_component_info(id).size;
+		}
+
+		for(auto capacity = gsl::narrow<uint32_t>(CHUNK_SIZE / row_size); capacity > 0; --capacity)
+		{
+			size_t offset = sizeof(entity) * capacity;
+			for(auto id = 0u; id < MAX_COMPONENTS; ++id)
+			{
+				if(!has(id)) continue;
+
+				const auto& info = get_component_info(id);
+				offset = (offset + info.alignment - 1) & ~(info.alignment - 1);
+				m_offsets.at(id) = gsl::narrow<uint32_t>(offset);
+				offset += info.size * capacity;
+			}
+
+			if(offset <= CHUNK_SIZE)
+			{
+				m_capacity = capacity;
+				break;
+			}
+		}
+
+		Ensures(m_capacity > 0);
+	}
+
+	archetype::location archetype::push(entity e)
+	{
+		if(m_counts.empty() || m_counts.back() == m_capacity)
+		{
+			m_chunks.push_back(std::make_unique<chunk>());
+			m_counts.push_back(0);
+		}
+
+		const auto& chunk = gsl::narrow<uint32_t>(m_counts.size() - 1);
+		const auto row = m_counts.back()++;
+
+		entities(chunk)[row] = e;
+		++m_size;
+
+		return location{ chunk, row };
+	}
+
+	entity archetype::erase(const location& at)
+	{
+		const auto& last_chunk = m_counts.size() - 1;
+		const auto& last_row = m_counts.back() - 1;
+
+		/*  末尾の行を空いた位置へコピー  */
+		entity moved{};
+		if(at.chunk != last_chunk || at.row != last_row)
+		{
+			moved = entities(last_chunk)[last_row];
+			entities(at.chunk)[at.row] = moved;
+
+			for(auto id = 0u; id < MAX_COMPONENTS; ++id)
+			{
+				if(!has(id)) continue;
+
+				const auto& size = get_component_info(id).size;
+				std::memcpy(component_array(id, at.chunk) + size * at.row, component_array(id, last_chunk) + size * last_row, size);
+			}
+		}
+
+		--m_size;
+		if(--m_counts.back() == 0)
+		{
+			m_chunks.pop_back();
+			m_counts.pop_back();
+		}
+
+		return moved;
+	}
+
+	void entity_world::destroy(entity e)
+	{
+		if(!alive(e)) return;
+
+		auto& record = m_records.at(e.index());
+		const auto& moved = m_archetypes.at(record.archetype)->erase(record.location);
+		if(moved.valid()) m_records.at(moved.index()).location = record.location;
+
+		record.generation = (record.generation + 1) & entity::GENERATION_MASK;
+		if(record.generation == 0) record.generation = 1;
+
+		m_free_records.push_back(e.index());
+		--m_size;
+	}
+
+	bool entity_world::alive(entity e) const noexcept
+	{
+		return e.valid() && e.index() < m_records.size() && m_records[e.index()].generation == e.generation();
+	}
+
+	std::pmr::vector<std::pair<archetype*, size_t>> entity_world::collect_chunks(component_mask required, std::pmr::memory_resource* resource)
+	{
+		std::pmr::vector<std::pair<archetype*, size_t>> chunks(resource);
+		for(auto& type : m_archetypes)
+		{
+			if((type->mask() & required) != required) continue;
+
+			for(size_t i = 0; i < type->chunk_count(); ++i) chunks.emplace_back(type.get(), i);
+		}
+		return chunks;
+	}
+
+	entity entity_world::create_entity(component_mask mask)
+	{
+		uint32_t index{};
+		if(!m_free_records.empty())
+		{
+			index = m_free_records.back();
+			m_free_records.pop_back();
+		}
+		else
+		{
+			index = gsl::narrow<uint32_t>(m_records.size());
+			Expects(index <= entity::INDEX_MASK);
+
+			m_records.push_back(record{ 0, {}, 1 });
+		}
+
+		auto& record = m_records.at(index);
+		const auto& e = entity::make(index, record.generation);
+
+		record.archetype = find_archetype(mask);
+		record.location = m_archetypes.at(record.archetype)->push(e);
+		++m_size;
+
+		return e;
+	}
+
+	void entity_world::move_entity(entity e, component_mask new_mask)
+	{
+		const auto& target = find_archetype(new_mask);
+
+		auto& record = m_records.at(e.index());
+		auto& from = *m_archetypes.at(record.archetype);
+		auto& to = *m_archetypes.at(target);
+
+		/*  共通するコンポーネントを新しいアーキタイプへコピーしてから元の行を消す  */
+		const auto& location = to.push(e);
+		const auto& common = from.mask() & to.mask();
+
+		for(auto id = 0u; id < MAX_COMPONENTS; ++id)
+		{
+			if(((common >> id) & 1) == 0) continue;
+
+			const auto& size = get_component_info(id).size;
+			std::memcpy(to.component_array(id, location.chunk) + size * location.row, from.component_array(id, record.location.chunk) + size * record.location.row, size);
+		}
+
+		const auto& moved = from.erase(record.location);
+		if(moved.valid()) m_records.at(moved.index()).location = record.location;
+
+		record.archetype = target;
+		record.location = location;
+	}
+
+	uint32_t entity_world::find_archetype(component_mask mask)
+	{
+		const auto& it = m_archetype_lookup.find(mask);
+		if(it != m_archetype_lookup.end()) return it->second;
+
+		const auto& index = gsl::narrow<uint32_t>(m_archetypes.size());
+		m_archetypes.push_back(std::make_unique<archetype>(mask));
+		m_archetype_lookup.emplace(mask, index);
+
+		return index;
+	}
+}
\ No newline at end of file
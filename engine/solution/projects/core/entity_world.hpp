@@ -0,0 +1,234 @@
+﻿#pragma once
+#include "object_pool.hpp"
+#include "job_system.hpp"
+
+/*
+	アーキタイプ / チャンク方式のエンティティ管理
+
+	・同じコンポーネントの組み合わせ (アーキタイプ) を持つエンティティを 16 KiB のチャンクにまとめる
+	・チャンク内は SoA ([entity...][A...][B...]) で、クエリはチャンクごとに配列をそのまま渡す
+	・チャンクは常に先頭から詰めておき (削除は末尾と入れ替え)、走査に隙間を作らない
+	・コンポーネントは memcpy で移動するので trivially copyable に限る
+*/
+
+namespace core
+{
+	using entity = handle<struct entity_tag>;
+	using component_mask = uint64_t;
+
+	inline constexpr uint32_t MAX_COMPONENTS = 64;
+	inline constexpr size_t CHUNK_SIZE = 16 * 1024;
+
+	struct component_info
+	{
+		size_t size;
+		size_t alignment;
+	};
+
+	uint32_t register_component(size_t size, size_t alignment);
+	const component_info& get_component_info(uint32_t id);
+
+	// 型ごとの番号 (初めて使われた順に振る)
+	template<class T> inline uint32_t component_id()
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "components are moved with memcpy");
+
+		static const uint32_t id = register_component(sizeof(T), alignof(T));
+		return id;
+	}
+
+	template<class... Components> inline component_mask make_component_mask()
+	{
+		return (component_mask(0) | ... | (component_mask(1) << component_id<Components>()));
+	}
+
+	/*  -----  アーキタイプ  -----------------------------------  */
+
+	struct alignas(64) chunk
+	{
+		std::array<std::byte, CHUNK_SIZE> data;
+	};
+
+	class archetype
+	{
+	public:
+		explicit archetype(component_mask mask);
+
+	public:
+		inline component_mask mask() const noexcept { return m_mask; }
+		inline uint32_t capacity() const noexcept { return m_capacity; }
+		inline size_t chunk_count() const noexcept { return m_counts.size(); }
+		inline uint32_t chunk_size(size_t chunk) const { return m_counts.at(chunk); }
+		inline size_t size() const noexcept { return m_size; }
+		inline bool has(uint32_t id) const noexcept { return (m_mask >> id) & 1; }
+
+		inline entity* entities(size_t chunk) { return reinterpret_cast<entity*>(m_chunks.at(chunk)->data.data()); }
+
+		inline std::byte* component_array(uint32_t id, size_t chunk)
+		{
+			Expects(has(id));
+			return m_chunks.at(chunk)->data.data() + m_offsets.at(id);
+		}
+
+		template<class T> inline T* components(size_t chunk) { return reinterpret_cast<T*>(component_array(component_id<T>(), chunk)); }
+
+	public:
+		struct location
+		{
+			uint32_t chunk;
+			uint32_t row;
+		};
+
+		// 末尾に行を追加する (コンポーネントは未初期化)
+		location push(entity e);
+
+		// 行を削除し、空いた位置へ末尾の行を移す。移したエンティティを返す (なければ無効なハンドル)
+		entity erase(const location& at);
+
+	private:
+		component_mask m_mask;
+		std::array<uint32_t, MAX_COMPONENTS> m_offsets = {};
+		uint32_t m_capacity = 0;
+
+		std::vector<std::unique_ptr<chunk>> m_chunks;
+		std::vector<uint32_t> m_counts;
+		size_t m_size = 0;
+	};
+
+	/*  -----  ワールド  -----------------------------------  */
+
+	class entity_world
+	{
+	public:
+		entity_world() = default;
+
+		entity_world(const entity_world&) = delete;
+		entity_world& operator=(const entity_world&) = delete;
+
+	public:
+		template<class... Components> entity create(const Components&... components)
+		{
+			const auto& e = create_entity(make_component_mask<Components...>());
+			(write(e, components), ...);
+			return e;
+		}
+
+		void destroy(entity e);
+		bool alive(entity e) const noexcept;
+
+		// 既に持っていれば上書きする。破棄したエンティティには使えない
+		template<class T> void add(entity e, const T& component)
+		{
+			Expects(alive(e));
+
+			const auto& id = component_id<T>();
+			if(!has(e, id)) move_entity(e, mask(e) | (component_mask(1) << id));
+			write(e, component);
+		}
+
+		template<class T> void remove(entity e)
+		{
+			Expects(alive(e));
+
+			const auto& id = component_id<T>();
+			if(has(e, id)) move_entity(e, mask(e) & ~(component_mask(1) << id));
+		}
+
+		template<class T> T* get(entity e)
+		{
+			const auto& id = component_id<T>();
+			if(!alive(e) || !has(e, id)) return nullptr;
+
+			const auto& record = m_records.at(e.index());
+			return reinterpret_cast<T*>(component_pointer(record, id));
+		}
+
+		template<class T> bool has(entity e) const { return alive(e) && has(e, component_id<T>()); }
+
+		inline size_t size() const noexcept { return m_size; }
+
+	public:
+		/*
+			指定したコンポーネントを全て持つチャンクごとに呼ぶ
+			func(gsl::span<const entity>, gsl::span<Components>...)
+		*/
+		template<class... Components, class F> void each(F&& func)
+		{
+			const auto& required = make_component_mask<Components...>();
+
+			for(auto& type : m_archetypes)
+			{
+				if((type->mask() & required) != required) continue;
+
+				for(size_t i = 0; i < type->chunk_count(); ++i) invoke<Components...>(*type, i, func);
+			}
+		}
+
+		// each() をチャンク単位でジョブに分けて実行する (func は複数のスレッドから同時に呼ばれる)。チャンクの一覧は scratch に置く
+		template<class... Components, class F> void parallel_each(job_system& jobs, F&& func, std::pmr::memory_resource* scratch = std::pmr::get_default_resource())
+		{
+			const auto& chunks = collect_chunks(make_component_mask<Components...>(), scratch);
+
+			jobs.parallel_for(chunks.size(), 1, [&](size_t begin, size_t end)
+			{
+				for(auto i = begin; i < end; ++i) invoke<Components...>(*chunks.at(i).first, chunks.at(i).second, func);
+			});
+		}
+
+		template<class... Components> size_t count() const
+		{
+			const auto& required = make_component_mask<Components...>();
+
+			size_t total = 0;
+			for(const auto& type : m_archetypes)
+			{
+				if((type->mask() & required) == required) total += type->size();
+			}
+			return total;
+		}
+
+		// 条件に合うチャンクの一覧 (アーキタイプ, チャンク番号)。毎フレーム呼ぶならフレームのアリーナを渡す
+		std::pmr::vector<std::pair<archetype*, size_t>> collect_chunks(component_mask required, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+	private:
+		struct record
+		{
+			uint32_t archetype;
+			archetype::location location;
+			uint32_t generation;
+		};
+
+	private:
+		entity create_entity(component_mask mask);
+		void move_entity(entity e, component_mask new_mask);
+		uint32_t find_archetype(component_mask mask);
+
+		inline component_mask mask(entity e) const { return m_archetypes.at(m_records.at(e.index()).archetype)->mask(); }
+		inline bool has(entity e, uint32_t id) const { return (mask(e) >> id) & 1; }
+
+		inline std::byte* component_pointer(const record& record, uint32_t id)
+		{
+			auto& type = *m_archetypes.at(record.archetype);
+			return type.component_array(id, record.location.chunk) + get_component_info(id).size * record.location.row;
+		}
+
+		template<class T> inline void write(entity e, const T& component)
+		{
+			std::memcpy(component_pointer(m_records.at(e.index()), component_id<T>()), &component, sizeof(T));
+		}
+
+		template<class... Components, class F> static inline void invoke(archetype& type, size_t chunk, F& func)
+		{
+			const auto& count = type.chunk_size(chunk);
+			func(gsl::span<const entity>(type.entities(chunk), count), gsl::span<Components>(type.components<Components>(chunk), count)...);
+		}
+
+	private:
+		std::vector<std::unique_ptr<archetype>> m_archetypes;
+		std::unordered_map<component_mask, uint32_t> m_archetype_lookup;
+
+		std::vector<record> m_records;
+		std::vector<uint32_t> m_free_records;
+		size_t m_size = 0;
+	};
+}
\ No newline at end of file
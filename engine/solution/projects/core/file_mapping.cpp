@@ -0,0 +1,106 @@
+﻿#include "pch.hpp"
+#include "file_mapping.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace core
+{
+	mapped_file::mapped_file(const std::string& path)
+	{
+#ifdef _WIN32
+		m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if(m_file == INVALID_HANDLE_VALUE) return;
+
+		LARGE_INTEGER size{};
+		if(!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+		{
+			close();
+			return;
+		}
+
+		m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if(m_mapping == nullptr)
+		{
+			close();
+			return;
+		}
+
+		m_data = static_cast<const std::byte*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+		m_size = m_data != nullptr ? gsl::narrow<size_t>(size.QuadPart) : 0;
+#else
+		m_file = open(path.c_str(), O_RDONLY);
+		if(m_file < 0) return;
+
+		struct stat status{};
+		if(fstat(m_file, &status) != 0 || status.st_size == 0)
+		{
+			close();
+			return;
+		}
+
+		auto* ptr = mmap(nullptr, gsl::narrow<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, m_file, 0);
+		if(ptr == MAP_FAILED)
+		{
+			close();
+			return;
+		}
+
+		m_data = static_cast<const std::byte*>(ptr);
+		m_size = gsl::narrow<size_t>(status.st_size);
+#endif
+	}
+
+	mapped_file::~mapped_file()
+	{
+		close();
+	}
+
+	mapped_file::mapped_file(mapped_file&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	mapped_file& mapped_file::operator=(mapped_file&& other) noexcept
+	{
+		if(this == &other) return *this;
+
+		close();
+
+		m_data = std::exchange(other.m_data, nullptr);
+		m_size = std::exchange(other.m_size, 0);
+
+#ifdef _WIN32
+		m_file = std::exchange(other.m_file, INVALID_HANDLE_VALUE);
+		m_mapping = std::exchange(other.m_mapping, nullptr);
+#else
+		m_file = std::exchange(other.m_file, -1);
+#endif
+
+		return *this;
+	}
+
+	void mapped_file::close() noexcept
+	{
+#ifdef _WIN32
+		if(m_data != nullptr) UnmapViewOfFile(m_data);
+		if(m_mapping != nullptr) CloseHandle(m_mapping);
+		if(m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+
+		m_mapping = nullptr;
+		m_file = INVALID_HANDLE_VALUE;
+#else
+		if(m_data != nullptr) munmap(const_cast<std::byte*>(m_data), m_size);
+		if(m_file >= 0) ::close(m_file);
+
+		m_file = -1;
+#endif
+
+		m_data = nullptr;
+		m_size = 0;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+﻿#pragma once
+
+namespace core
+{
+	/*  読み取り専用のメモリマップドファイル  */
+	class mapped_file
+	{
+	public:
+		mapped_file() noexcept = default;
+		explicit mapped_file(const std::string& path);
+		~mapped_file();
+
+	public:
+		mapped_file(mapped_file&& other) noexcept;
+		mapped_file& operator=(mapped_file&& other) noexcept;
+
+	public:
+		mapped_file(const mapped_file&) = delete;
+		mapped_file& operator=(const mapped_file&) = delete;
+
+	public:
+		inline bool is_open() const noexcept { return m_data != nullptr; }
+		inline size_t size() const noexcept { return m_size; }
+		inline gsl::span<const std::byte> data() const noexcept { return { m_data, m_size }; }
+
+	private:
+		void close() noexcept;
+
+	private:
+		const std::byte* m_data = nullptr;
+		size_t m_size = 0;
+
+#ifdef _WIN32
+		HANDLE m_file = INVALID_HANDLE_VALUE;
+		HANDLE m_mapping = nullptr;
+#else
+		int m_file = -1;
+#endif
+	};
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+﻿#include "pch.hpp"
+#include "frame_arena.hpp"
+
+namespace core
+{
+	void* counting_resource::do_allocate(size_t bytes, size_t alignment)
+	{
+		m_allocations.fetch_add(1, std::memory_order_relaxed);
+		m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+		return m_upstream->allocate(bytes, alignment);
+	}
+
+	void counting_resource::do_deallocate(void* p, size_t bytes, size_t alignment)
+	{
+		m_deallocations.fetch_add(1, std::memory_order_relaxed);
+		m_upstream->deallocate(p, bytes, alignment);
+	}
+
+	counting_resource& heap_counter() noexcept
+	{
+		static counting_resource counter;
+		return counter;
+	}
+
+	linear_arena::linear_arena(size_t capacity, std::pmr::memory_resource* upstream)
+		: m_upstream(upstream)
+	{
+		Expects(m_upstream != nullptr);
+		Expects(capacity > 0);
+
+		m_chunks.reserve(8);
+		add_chunk(capacity);
+	}
+
+	linear_arena::~linear_arena()
+	{
+		release_chunks();
+	}
+
+	void linear_arena::reset()
+	{
+		m_high_water = std::max(m_high_water, m_bytes);
+
+		/*  あふれたフレームがあれば、最大使用量が1チャンクに収まるように作り直す  */
+		if(m_chunks.size() > 1)
+		{
+			release_chunks();
+			add_chunk(gsl::narrow<size_t>(m_high_water));
+		}
+
+		m_offset = 0;
+		m_allocations = 0;
+		m_bytes = 0;
+	}
+
+	void* linear_arena::do_allocate(size_t bytes, size_t alignment)
+	{
+		Expects(std::has_single_bit(alignment));
+
+		auto* current = &m_chunks.back();
+		auto aligned = (reinterpret_cast<uintptr_t>(current->data) + m_offset + alignment - 1) & ~(uintptr_t(alignment) - 1);
+		auto end = aligned + bytes - reinterpret_cast<uintptr_t>(current->data);
+
+		/*  入らなければ新しいチャンクへ (今のチャンク以上の大きさにする)  */
+		if(end > current->size)
+		{
+			add_chunk(std::max(current->size, bytes + alignment));
+
+			current = &m_chunks.back();
+			aligned = (reinterpret_cast<uintptr_t>(current->data) + alignment - 1) & ~(uintptr_t(alignment) - 1);
+			end = aligned + bytes - reinterpret_cast<uintptr_t>(current->data);
+		}
+
+		m_bytes += end - m_offset;
+		m_offset = end;
+		++m_allocations;
+
+		return reinterpret_cast<void*>(aligned);
+	}
+
+	void linear_arena::add_chunk(size_t size)
+	{
+		// 前のチャンクの残りは使用量として数える (まとめ直すときの大きさに含める)
+		if(!m_chunks.empty()) m_bytes += m_chunks.back().size - m_offset;
+
+		auto* data = static_cast<std::byte*>(m_upstream->allocate(size, alignof(std::max_align_t)));
+		m_chunks.push_back(chunk{ data, size });
+		m_offset = 0;
+
+		++m_upstream_allocations;
+	}
+
+	void linear_arena::release_chunks()
+	{
+		for(const auto& chunk : m_chunks) m_upstream->deallocate(chunk.data, chunk.size, alignof(std::max_align_t));
+		m_chunks.clear();
+	}
+}
\ No newline at end of file
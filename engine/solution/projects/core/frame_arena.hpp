@@ -0,0 +1,86 @@
+﻿#pragma once
+
+namespace core
+{
+	/*  上流 (malloc) への割り当てを数える  */
+	class counting_resource final : public std::pmr::memory_resource
+	{
+	public:
+		explicit counting_resource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) noexcept : m_upstream(upstream) {}
+
+	public:
+		inline uint64_t allocations() const noexcept { return m_allocations.load(std::memory_order_relaxed); }
+		inline uint64_t deallocations() const noexcept { return m_deallocations.load(std::memory_order_relaxed); }
+		inline uint64_t bytes() const noexcept { return m_bytes.load(std::memory_order_relaxed); }
+
+	private:
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+	private:
+		std::pmr::memory_resource* m_upstream;
+		std::atomic<uint64_t> m_allocations = 0;
+		std::atomic<uint64_t> m_deallocations = 0;
+		std::atomic<uint64_t> m_bytes = 0;
+	};
+
+	// アリーナが既定で使う上流。allocations() が増えなければヒープに触れていない
+	counting_resource& heap_counter() noexcept;
+
+	struct arena_stats
+	{
+		uint64_t allocations;			// reset() 以降の割り当て回数
+		uint64_t bytes;					// reset() 以降の使用量 (整列の詰め物を含む)
+		uint64_t high_water;			// 1フレームの最大使用量
+		uint64_t upstream_allocations;	// チャンクを上流から取った回数 (累計)
+	};
+
+	/*
+		線形アリーナ
+		・確保はポインタを進めるだけで、個別の解放はしない (reset() でまとめて戻す)
+		・足りなくなったらチャンクを追加し、reset() 時に最大使用量の1チャンクへまとめ直す
+		  → 使用量が安定すれば上流への割り当ては 0 回になる
+	*/
+	class linear_arena final : public std::pmr::memory_resource
+	{
+	public:
+		explicit linear_arena(size_t capacity, std::pmr::memory_resource* upstream = &heap_counter());
+		~linear_arena();
+
+		linear_arena(const linear_arena&) = delete;
+		linear_arena& operator=(const linear_arena&) = delete;
+
+	public:
+		void reset();
+
+		inline arena_stats get_stats() const noexcept { return arena_stats{ m_allocations, m_bytes, m_high_water, m_upstream_allocations }; }
+
+	private:
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void*, size_t, size_t) override {}
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+	private:
+		struct chunk
+		{
+			std::byte* data;
+			size_t size;
+		};
+
+	private:
+		void add_chunk(size_t size);
+		void release_chunks();
+
+	private:
+		std::pmr::memory_resource* m_upstream;
+		std::vector<chunk> m_chunks;
+
+		size_t m_offset = 0;	// 最後のチャンク内の位置
+
+		uint64_t m_allocations = 0;
+		uint64_t m_bytes = 0;
+		uint64_t m_high_water = 0;
+		uint64_t m_upstream_allocations = 0;
+	};
+}
\ No newline at end of file
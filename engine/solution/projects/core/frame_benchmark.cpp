@@ -0,0 +1,176 @@
+﻿#include "include.hpp"
+
+namespace core
+{
+	namespace
+	{
+		inline bvh_bounds box_bounds(const matrix4x4& world, float half_size) noexcept
+		{
+			const auto& x = world.at(12u);
+			const auto& y = world.at(13u);
+			const auto& z = world.at(14u);
+			return bvh_bounds{ { x - half_size, y - half_size, z - half_size }, { x + half_size, y + half_size, z + half_size } };
+		}
+	}
+
+	frame_stats_report run_frame_benchmark(const frame_benchmark_desc& desc, job_system& jobs)
+	{
+		Expects(desc.instance_count > 0);
+		Expects(desc.frame_count > desc.warmup_frames);
+
+		constexpr float half_size = 1.0f;
+		constexpr float speed = 0.5f;
+
+		/*  シーン (BVH の物体番号 = entities の添字)  */
+		boost::random::mt19937 random(desc.seed);
+		boost::random::uniform_real_distribution<float> position(-desc.world_extent, desc.world_extent);
+		boost::random::uniform_real_distribution<float> direction(-speed, speed);
+
+		entity_world world;
+		std::vector<entity> entities;
+		std::vector<bvh_bounds> bounds;
+		std::vector<std::array<float, 3>> velocities;
+
+		entities.reserve(desc.instance_count);
+		bounds.reserve(desc.instance_count);
+		velocities.reserve(desc.instance_count);
+
+		for(auto i = 0u; i < desc.instance_count; ++i)
+		{
+			auto transform = matrix4x4::identity();
+			transform.at(12u) = position(random);
+			transform.at(13u) = position(random);
+			transform.at(14u) = position(random);
+
+			entities.push_back(world.create(world_transform{ transform }, world_bounds{ { transform.at(12u), transform.at(13u), transform.at(14u) }, half_size * 1.75f }, mesh_component{}));
+			bounds.push_back(box_bounds(transform, half_size));
+			velocities.push_back({ direction(random), direction(random), direction(random) });
+		}
+
+		bvh tree;
+		tree.build(bounds);
+
+		/*  中心から周りを見回すカメラ (遠平面までで全体の一部だけが見える)  */
+		camera camera;
+		camera.set_position(vector3d(0.0, 0.0, 0.0));
+		camera.set_perspective(60.0f * math::to_rad, 16.0f / 9.0f, 0.1f, desc.world_extent * 0.5f);
+
+		constexpr uint32_t buffer_count = 2;		// FRAME_COUNT と同じ
+		null_render_backend backend(buffer_count, desc.instance_count);
+
+		std::vector<uint32_t> visible;
+		std::vector<instance_record> records(desc.instance_count);
+		visible.reserve(desc.instance_count);
+
+		frame_stats stats(desc.frame_count);
+		const auto& simulate_stage = stats.add_stage("simulate");
+		const auto& bvh_stage = stats.add_stage("bvh");
+		const auto& cull_stage = stats.add_stage("cull");
+		const auto& extract_stage = stats.add_stage("extract");
+		const auto& submit_stage = stats.add_stage("submit");
+
+		const auto moving = std::max<size_t>(static_cast<size_t>(desc.instance_count * desc.moving_ratio), 1);
+		size_t moving_begin = 0;
+
+		for(auto frame = 0u; frame < desc.frame_count; ++frame)
+		{
+			if(frame == desc.warmup_frames) stats.clear();
+
+			PROFILE_FRAME();
+			stats.begin_frame();
+
+			/*  一部のインスタンスを動かす (範囲の外に出たら跳ね返す)  */
+			{
+				stage_timer timer(stats, simulate_stage);
+
+				for(size_t n = 0; n < moving; ++n)
+				{
+					const auto& i = (moving_begin + n) % desc.instance_count;
+					auto& transform = world.get<world_transform>(entities.at(i))->world;
+					auto& velocity = velocities.at(i);
+
+					for(auto axis = 0u; axis < 3; ++axis)
+					{
+						auto& value = transform.at(12u + axis);
+						value += velocity.at(axis);
+						if(std::abs(value) > desc.world_extent) velocity.at(axis) = -velocity.at(axis);
+					}
+
+					tree.update(gsl::narrow_cast<uint32_t>(i), box_bounds(transform, half_size));
+				}
+
+				moving_begin = (moving_begin + moving) % desc.instance_count;
+			}
+
+			{
+				stage_timer timer(stats, bvh_stage);
+				tree.maintain();
+			}
+
+			{
+				stage_timer timer(stats, cull_stage);
+
+				const auto& angle = frame * 0.02f;
+				camera.set_direction(vector3(std::sin(angle), 0.0f, std::cos(angle)));
+				camera.update();
+
+				visible.clear();
+				tree.query_frustum(camera.frustum(), visible);
+			}
+
+			{
+				stage_timer timer(stats, extract_stage);
+
+				jobs.parallel_for(visible.size(), 4096, [&](size_t begin, size_t end)
+				{
+					for(auto i = begin; i < end; ++i)
+					{
+						records[i] = pack_instance(world.get<world_transform>(entities[visible[i]])->world);
+					}
+				});
+			}
+
+			{
+				stage_timer timer(stats, submit_stage);
+
+				backend.render_begin();
+				backend.update_camera(camera);
+				backend.render_instances(gsl::span<const instance_record>(records).first(visible.size()));
+				backend.render_end();
+				backend.present();
+			}
+
+			stats.end_frame(desc.instance_count, visible.size());
+		}
+
+		return frame_stats_report{ desc.name, desc.instance_count, stats.summary() };
+	}
+
+	bool run_frame_benchmarks(const std::string& path, job_system& jobs)
+	{
+		const std::array<frame_benchmark_desc, 3> benchmarks =
+		{
+			frame_benchmark_desc{ "10k", 10000, 240, 20 },
+			frame_benchmark_desc{ "100k", 100000, 120, 10 },
+			frame_benchmark_desc{ "1m", 1000000, 30, 3 },
+		};
+
+		return run_frame_benchmarks(path, jobs, benchmarks);
+	}
+
+	bool run_frame_benchmarks(const std::string& path, job_system& jobs, gsl::span<const frame_benchmark_desc> benchmarks)
+	{
+		std::vector<frame_stats_report> reports;
+		for(const auto& desc : benchmarks)
+		{
+			reports.push_back(run_frame_benchmark(desc, jobs));
+
+			const auto& summary = reports.back().summary;
+			std::cout << boost::format("%-6s %9.1f fps  avg %10.0f ns  p99 %10.0f ns") % desc.name % summary.fps % summary.avg_ns % summary.p99_ns;
+			if(summary.allocations_tracked) std::cout << boost::format("  alloc/frame %.1f") % summary.allocations_per_frame;
+			std::cout << '\n';
+		}
+
+		return write_frame_stats_json(path, reports);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+﻿#pragma once
+#include "frame_stats.hpp"
+
+namespace core
+{
+	class job_system;
+
+	struct frame_benchmark_desc
+	{
+		const char* name;
+		uint32_t instance_count;
+		uint32_t frame_count = 120;
+		uint32_t warmup_frames = 10;		// 集計から外す最初のフレーム数
+		float moving_ratio = 0.1f;			// 毎フレーム動かすインスタンスの割合
+		float world_extent = 1000.0f;		// インスタンスを置く立方体の半径
+		uint32_t seed = 1;
+	};
+
+	/*
+		ウィンドウと GPU を使わずに CPU 側の1フレームを回す
+
+		合成したシーン (instance_count 個の箱) をエンティティと BVH に登録し、毎フレーム
+		simulate (一部を動かす) -> bvh (refit / 作り直し) -> cull (回転するカメラの視錐台) -> extract (instance_record に詰める) -> submit (null_render_backend)
+		の順に実行して段階ごとの時間を計る。乱数の種が同じなら毎回同じシーンになる
+	*/
+	frame_stats_report run_frame_benchmark(const frame_benchmark_desc& desc, job_system& jobs);
+
+	// 10k / 100k / 1M インスタンスの一式を実行し、path に JSON で書き出す
+	bool run_frame_benchmarks(const std::string& path, job_system& jobs);
+	bool run_frame_benchmarks(const std::string& path, job_system& jobs, gsl::span<const frame_benchmark_desc> benchmarks);
+}
\ No newline at end of file
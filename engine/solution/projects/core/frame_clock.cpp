@@ -0,0 +1,185 @@
+﻿#include "pch.hpp"
+#include "frame_clock.hpp"
+
+namespace core
+{
+	steady_clock_source& steady_clock_source::get()
+	{
+		static steady_clock_source instance;
+		return instance;
+	}
+
+	bool steady_clock_source::wait_until(std::chrono::nanoseconds deadline, const std::atomic<bool>& cancel)
+	{
+		const auto& time = std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(deadline));
+
+		std::unique_lock lock(m_mutex);
+		return m_wake.wait_until(lock, time, [&] { return cancel.load(std::memory_order_acquire); });
+	}
+
+	void steady_clock_source::wake()
+	{
+		// 待つ側が cancel を確かめてから眠るまでの間に起こさないよう、ロックを通してから知らせる
+		{
+			std::lock_guard lock(m_mutex);
+		}
+		m_wake.notify_all();
+	}
+
+	/*  -----  manual_clock  -----------------------------------  */
+
+	void manual_clock::advance(std::chrono::nanoseconds duration)
+	{
+		{
+			std::lock_guard lock(m_mutex);
+			m_now.fetch_add(duration.count(), std::memory_order_acq_rel);
+		}
+		m_changed.notify_all();
+	}
+
+	bool manual_clock::wait_until(std::chrono::nanoseconds deadline, const std::atomic<bool>& cancel)
+	{
+		std::unique_lock lock(m_mutex);
+
+		auto ready = [&] { return cancel.load(std::memory_order_acquire) || now() >= deadline; };
+		if(!ready())
+		{
+			++m_sleeps;
+			m_changed.notify_all();
+			m_changed.wait(lock, ready);
+		}
+
+		return cancel.load(std::memory_order_acquire);
+	}
+
+	void manual_clock::wake()
+	{
+		{
+			std::lock_guard lock(m_mutex);
+		}
+		m_changed.notify_all();
+	}
+
+	uint64_t manual_clock::sleep_count()
+	{
+		std::lock_guard lock(m_mutex);
+		return m_sleeps;
+	}
+
+	void manual_clock::wait_for_sleeps(uint64_t count)
+	{
+		std::unique_lock lock(m_mutex);
+		m_changed.wait(lock, [&] { return m_sleeps >= count; });
+	}
+
+	/*  -----  frame_time_histogram  -----------------------------------  */
+
+	void frame_time_histogram::add(std::chrono::nanoseconds duration) noexcept
+	{
+		const auto& index = static_cast<size_t>(std::clamp<int64_t>(duration / BUCKET_WIDTH, 0, BUCKET_COUNT - 1));
+		++m_buckets[index];
+		++m_count;
+		m_total += duration;
+		m_min = std::min(m_min, duration);
+		m_max = std::max(m_max, duration);
+	}
+
+	void frame_time_histogram::clear() noexcept
+	{
+		*this = frame_time_histogram{};
+	}
+
+	std::chrono::nanoseconds frame_time_histogram::percentile(double ratio) const noexcept
+	{
+		if(m_count == 0) return std::chrono::nanoseconds(0);
+
+		const auto& target = static_cast<uint64_t>(std::ceil(std::clamp(ratio, 0.0, 1.0) * static_cast<double>(m_count)));
+
+		uint64_t sum = 0;
+		for(auto i = 0u; i < BUCKET_COUNT; ++i)
+		{
+			sum += m_buckets[i];
+			if(sum >= std::max<uint64_t>(target, 1)) return i + 1 < BUCKET_COUNT ? BUCKET_WIDTH * (i + 1) : m_max;
+		}
+		return m_max;
+	}
+
+	uint64_t frame_time_histogram::count_over(std::chrono::nanoseconds limit) const noexcept
+	{
+		const auto& first = static_cast<uint32_t>(std::clamp<int64_t>((limit + BUCKET_WIDTH - std::chrono::nanoseconds(1)) / BUCKET_WIDTH, 0, BUCKET_COUNT));
+
+		uint64_t count = 0;
+		for(auto i = first; i < BUCKET_COUNT; ++i) count += m_buckets[i];
+		return count;
+	}
+
+	bool frame_time_histogram::write_csv(const std::string& path) const
+	{
+		std::ofstream file(path);
+		if(!file) return false;
+
+		file << "ms,count\n";
+		for(auto i = 0u; i < BUCKET_COUNT; ++i)
+		{
+			file << std::chrono::duration<double, std::milli>(BUCKET_WIDTH * i).count() << ',' << m_buckets[i] << '\n';
+		}
+
+		return file.good();
+	}
+
+	/*  -----  frame_clock  -----------------------------------  */
+
+	frame_clock::frame_clock(clock_source& clock, double smoothing, std::chrono::nanoseconds max_delta)
+		: m_clock(&clock)
+		, m_smoothing(smoothing)
+		, m_max_delta(max_delta)
+	{
+		Expects(0.0 < smoothing && smoothing <= 1.0);
+		Expects(max_delta.count() > 0);
+	}
+
+	std::chrono::nanoseconds frame_clock::tick()
+	{
+		const auto& now = m_clock->now();
+		const auto& elapsed = m_frame_count > 0 ? now - m_last : std::chrono::nanoseconds(0);
+		m_last = now;
+
+		if(m_frame_count > 0) m_histogram.add(elapsed);
+
+		m_delta = std::chrono::duration<double>(std::min(elapsed, m_max_delta)).count();
+
+		// 最初の1回は平均の初期値にする
+		m_smoothed_delta = m_frame_count > 1 ? m_smoothed_delta + (m_delta - m_smoothed_delta) * m_smoothing : m_delta;
+
+		++m_frame_count;
+		return elapsed;
+	}
+
+	/*  -----  fixed_timestep  -----------------------------------  */
+
+	fixed_timestep::fixed_timestep(std::chrono::nanoseconds step, uint32_t max_steps)
+		: m_step(step)
+		, m_max_steps(max_steps)
+	{
+		Expects(step.count() > 0);
+		Expects(max_steps > 0);
+	}
+
+	uint32_t fixed_timestep::advance(std::chrono::nanoseconds elapsed) noexcept
+	{
+		m_accumulator += std::max(elapsed, std::chrono::nanoseconds(0));
+
+		auto steps = static_cast<uint64_t>(m_accumulator / m_step);
+		if(steps > m_max_steps)
+		{
+			// 間に合わない分は捨て、端数だけ残す
+			m_dropped += m_step * static_cast<int64_t>(steps - m_max_steps);
+			steps = m_max_steps;
+		}
+
+		m_accumulator = m_accumulator % m_step;
+		m_total_steps += steps;
+
+		return static_cast<uint32_t>(steps);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,179 @@
+﻿#pragma once
+
+namespace core
+{
+	/*  -----  時刻の取得元  -----------------------------------  */
+
+	/*  単調増加する時刻 (テストでは manual_clock に差し替える)  */
+	class clock_source
+	{
+	public:
+		virtual ~clock_source() = default;
+
+	public:
+		virtual std::chrono::nanoseconds now() = 0;
+
+		/*
+			now() が deadline に達するか cancel が true になるまで待ち、cancel の値を返す
+			cancel を書き換えたら wake() を呼ぶ (待っているスレッドに確かめ直させる)
+		*/
+		virtual bool wait_until(std::chrono::nanoseconds deadline, const std::atomic<bool>& cancel) = 0;
+		virtual void wake() = 0;
+	};
+
+	class steady_clock_source final : public clock_source
+	{
+	public:
+		inline std::chrono::nanoseconds now() override { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()); }
+
+		bool wait_until(std::chrono::nanoseconds deadline, const std::atomic<bool>& cancel) override;
+		void wake() override;
+
+	public:
+		static steady_clock_source& get();
+
+	private:
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+	};
+
+	/*
+		advance() したぶんだけ進む時刻 (複数のスレッドから読める)
+		wait_until() は実時間では待たず、advance() で deadline を過ぎるまで眠る
+	*/
+	class manual_clock final : public clock_source
+	{
+	public:
+		inline std::chrono::nanoseconds now() override { return std::chrono::nanoseconds(m_now.load(std::memory_order_acquire)); }
+		void advance(std::chrono::nanoseconds duration);
+
+		bool wait_until(std::chrono::nanoseconds deadline, const std::atomic<bool>& cancel) override;
+		void wake() override;
+
+	public:
+		// wait_until() で眠った回数 (テストで相手のスレッドが次の待ちに入ったことを確かめる用)
+		uint64_t sleep_count();
+
+		// sleep_count() が count に達するまで待つ
+		void wait_for_sleeps(uint64_t count);
+
+	private:
+		std::atomic<int64_t> m_now = 0;
+
+		std::mutex m_mutex;
+		std::condition_variable m_changed;
+		uint64_t m_sleeps = 0;
+	};
+
+	/*  -----  フレーム時間の分布  -----------------------------------  */
+
+	/*
+		BUCKET_WIDTH 刻みのヒストグラム (最後のバケットはそれより長いもの全て)
+		フレームの間隔が揃っているか (60Hz なら 16.6ms に集まっているか) を見る用
+	*/
+	class frame_time_histogram
+	{
+	public:
+		static constexpr uint32_t BUCKET_COUNT = 100;
+		static constexpr std::chrono::nanoseconds BUCKET_WIDTH = std::chrono::microseconds(500);
+
+	public:
+		void add(std::chrono::nanoseconds duration) noexcept;
+		void clear() noexcept;
+
+	public:
+		inline uint64_t count() const noexcept { return m_count; }
+		inline uint64_t bucket(uint32_t index) const { return m_buckets.at(index); }
+		inline std::chrono::nanoseconds min() const noexcept { return m_count > 0 ? m_min : std::chrono::nanoseconds(0); }
+		inline std::chrono::nanoseconds max() const noexcept { return m_max; }
+		inline std::chrono::nanoseconds average() const noexcept { return m_count > 0 ? m_total / static_cast<int64_t>(m_count) : std::chrono::nanoseconds(0); }
+
+		// 割合 ratio (0..1) が収まるバケットの上端
+		std::chrono::nanoseconds percentile(double ratio) const noexcept;
+
+		// limit より長かった数 (バケット単位で数えるので limit は BUCKET_WIDTH に切り上げる)
+		uint64_t count_over(std::chrono::nanoseconds limit) const noexcept;
+
+		// バケットの下端 (ms) と数
+		bool write_csv(const std::string& path) const;
+
+	private:
+		std::array<uint64_t, BUCKET_COUNT> m_buckets = {};
+		uint64_t m_count = 0;
+		std::chrono::nanoseconds m_total{ 0 };
+		std::chrono::nanoseconds m_min{ std::chrono::nanoseconds::max() };
+		std::chrono::nanoseconds m_max{ 0 };
+	};
+
+	/*  -----  描画フレームの時間  -----------------------------------  */
+
+	/*
+		tick() ごとの経過時間
+		・delta() は max_delta で切り詰めた値 (デバッガで止めた後などに大きく飛ばない)
+		・smoothed_delta() は指数移動平均 (smoothing が大きいほど新しい値に早く追従する)
+		・ヒストグラムには切り詰める前の値を入れる
+	*/
+	class frame_clock
+	{
+	public:
+		explicit frame_clock(clock_source& clock, double smoothing = 0.1, std::chrono::nanoseconds max_delta = std::chrono::milliseconds(250));
+
+	public:
+		// フレームの最初に呼ぶ。前回からの経過時間 (最初の呼び出しは 0) を返す
+		std::chrono::nanoseconds tick();
+
+	public:
+		inline std::chrono::nanoseconds now() const { return m_clock->now(); }
+		inline double delta() const noexcept { return m_delta; }
+		inline double smoothed_delta() const noexcept { return m_smoothed_delta; }
+		inline uint64_t frame_count() const noexcept { return m_frame_count; }
+		inline const frame_time_histogram& histogram() const noexcept { return m_histogram; }
+		inline frame_time_histogram& histogram() noexcept { return m_histogram; }
+
+	private:
+		gsl::not_null<clock_source*> m_clock;
+		double m_smoothing;
+		std::chrono::nanoseconds m_max_delta;
+
+		std::chrono::nanoseconds m_last{ 0 };
+		double m_delta = 0.0;
+		double m_smoothed_delta = 0.0;
+		uint64_t m_frame_count = 0;
+
+		frame_time_histogram m_histogram;
+	};
+
+	/*  -----  固定ステップ  -----------------------------------  */
+
+	/*
+		経過時間をためて step ごとに区切る
+		・advance() が返した回数だけ step 秒ずつシミュレーションを進める
+		・1回で max_steps を超える分は捨てる (処理が間に合わないとき、追いつこうとして更に遅れるのを防ぐ)
+		・alpha() はたまっている端数 / step。前後の状態の補間に使う
+	*/
+	class fixed_timestep
+	{
+	public:
+		explicit fixed_timestep(std::chrono::nanoseconds step, uint32_t max_steps = 5);
+
+	public:
+		uint32_t advance(std::chrono::nanoseconds elapsed) noexcept;
+
+	public:
+		inline double alpha() const noexcept { return static_cast<double>(m_accumulator.count()) / static_cast<double>(m_step.count()); }
+		inline std::chrono::nanoseconds step() const noexcept { return m_step; }
+		inline double step_seconds() const noexcept { return std::chrono::duration<double>(m_step).count(); }
+		inline std::chrono::nanoseconds until_next() const noexcept { return m_step - m_accumulator; }
+
+		inline uint64_t total_steps() const noexcept { return m_total_steps; }
+		inline std::chrono::nanoseconds dropped() const noexcept { return m_dropped; }
+
+	private:
+		std::chrono::nanoseconds m_step;
+		uint32_t m_max_steps;
+
+		std::chrono::nanoseconds m_accumulator{ 0 };
+		uint64_t m_total_steps = 0;
+		std::chrono::nanoseconds m_dropped{ 0 };
+	};
+}
\ No newline at end of file
@@ -0,0 +1,153 @@
+﻿#include "pch.hpp"
+#include "frame_counters.hpp"
+
+namespace core
+{
+	frame_counters& frame_counters::get()
+	{
+		static frame_counters instance;
+		return instance;
+	}
+
+	frame_counters::frame_counters()
+		: m_history(HISTORY * MAX_COUNTERS)
+	{
+		constexpr std::array<counter_info, static_cast<size_t>(frame_counter::builtin_count)> builtin =
+		{
+			counter_info{ "draws", counter_kind::sum },
+			counter_info{ "instances", counter_kind::sum },
+			counter_info{ "triangles", counter_kind::sum },
+			counter_info{ "barriers", counter_kind::sum },
+			counter_info{ "pipeline_switches", counter_kind::sum },
+			counter_info{ "upload_bytes", counter_kind::sum },
+			counter_info{ "present_wait_ns", counter_kind::sum },
+			counter_info{ "release_queued", counter_kind::gauge },
+			counter_info{ "release_pending", counter_kind::gauge },
+			counter_info{ "stream_bytes", counter_kind::sum },
+			counter_info{ "stream_pending", counter_kind::gauge },
+		};
+
+		std::copy(builtin.begin(), builtin.end(), m_counters.begin());
+		m_counter_count.store(gsl::narrow_cast<uint32_t>(builtin.size()), std::memory_order_release);
+	}
+
+	uint32_t frame_counters::register_counter(const char* name, counter_kind kind)
+	{
+		std::lock_guard lock(m_mutex);
+
+		const auto& count = m_counter_count.load(std::memory_order_relaxed);
+		Expects(count < MAX_COUNTERS);
+
+		m_counters.at(count) = counter_info{ name, kind };
+		m_counter_count.store(count + 1, std::memory_order_release);
+
+		return count;
+	}
+
+	void frame_counters::end_frame()
+	{
+		std::lock_guard lock(m_mutex);
+
+		const auto& count = m_counter_count.load(std::memory_order_relaxed);
+		auto* values = m_history.data() + (m_frame_count % HISTORY) * MAX_COUNTERS;
+
+		std::fill_n(values, MAX_COUNTERS, 0ull);
+
+		/*  各スレッドの前回からの増分を足す  */
+		for(auto& block : m_threads)
+		{
+			for(auto i = 0u; i < count; ++i)
+			{
+				const auto& current = block->values[i].load(std::memory_order_relaxed);
+				values[i] += current - block->consumed[i];
+				block->consumed[i] = current;
+			}
+		}
+
+		for(auto i = 0u; i < count; ++i)
+		{
+			if(m_counters[i].kind == counter_kind::gauge) values[i] = m_gauges[i].load(std::memory_order_relaxed);
+		}
+
+		++m_frame_count;
+	}
+
+	const char* frame_counters::name(uint32_t counter) const
+	{
+		Expects(counter < counter_count());
+		return m_counters.at(counter).name;
+	}
+
+	counter_snapshot frame_counters::snapshot(size_t age) const
+	{
+		std::lock_guard lock(m_mutex);
+
+		if(age >= std::min<uint64_t>(m_frame_count, HISTORY)) return counter_snapshot{ 0, {} };
+
+		const auto& frame = m_frame_count - 1 - age;
+		const auto* values = m_history.data() + (frame % HISTORY) * MAX_COUNTERS;
+		return counter_snapshot{ frame, std::vector<uint64_t>(values, values + m_counter_count.load(std::memory_order_relaxed)) };
+	}
+
+	uint64_t frame_counters::value(uint32_t counter, size_t age) const
+	{
+		std::lock_guard lock(m_mutex);
+
+		if(counter >= m_counter_count.load(std::memory_order_relaxed)) return 0;
+		if(age >= std::min<uint64_t>(m_frame_count, HISTORY)) return 0;
+
+		return m_history.at(((m_frame_count - 1 - age) % HISTORY) * MAX_COUNTERS + counter);
+	}
+
+	double frame_counters::average(uint32_t counter, size_t frames) const
+	{
+		Expects(counter < MAX_COUNTERS);
+
+		std::lock_guard lock(m_mutex);
+
+		const auto& available = std::min<uint64_t>({ frames, m_frame_count, HISTORY });
+		if(available == 0) return 0.0;
+
+		uint64_t total = 0;
+		for(uint64_t age = 0; age < available; ++age)
+		{
+			total += m_history.at(((m_frame_count - 1 - age) % HISTORY) * MAX_COUNTERS + counter);
+		}
+
+		return static_cast<double>(total) / static_cast<double>(available);
+	}
+
+	bool frame_counters::write_csv(const std::string& path) const
+	{
+		std::ofstream file(path);
+		if(!file) return false;
+
+		std::lock_guard lock(m_mutex);
+
+		const auto& count = m_counter_count.load(std::memory_order_relaxed);
+
+		file << "frame";
+		for(auto i = 0u; i < count; ++i) file << ',' << m_counters.at(i).name;
+		file << '\n';
+
+		const auto& oldest = m_frame_count > HISTORY ? m_frame_count - HISTORY : 0;
+		for(auto frame = oldest; frame < m_frame_count; ++frame)
+		{
+			const auto* values = m_history.data() + (frame % HISTORY) * MAX_COUNTERS;
+
+			file << frame;
+			for(auto i = 0u; i < count; ++i) file << ',' << values[i];
+			file << '\n';
+		}
+
+		return file.good();
+	}
+
+	frame_counters::thread_block& frame_counters::register_thread()
+	{
+		std::lock_guard lock(m_mutex);
+
+		m_threads.push_back(std::make_unique<thread_block>());
+		return *m_threads.back();
+	}
+}
\ No newline at end of file
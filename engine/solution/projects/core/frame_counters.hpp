@@ -0,0 +1,131 @@
+﻿#pragma once
+
+/*
+	フレーム単位のカウンタ (描画数・アップロード量など)
+
+	add() は呼び出したスレッド専用の値を増やすだけ (ロックも共有の書き込みもしない)
+	end_frame() で全スレッドの前回からの増分を集めて1フレーム分のスナップショットにし、直近 HISTORY フレーム分を残す
+	set() はフレームの終わりの値をそのまま残すもの (待ち行列の長さなど) に使う
+*/
+
+namespace core
+{
+	// 組み込みのカウンタ (register_counter() で追加したものはこの後ろに並ぶ)
+	enum class frame_counter : uint32_t
+	{
+		draws,
+		instances,
+		triangles,
+		barriers,
+		pipeline_switches,
+		upload_bytes,
+		present_wait_ns,		// present() でフェンスを待った時間
+		release_queued,			// このフレームで deferred_release_queue に積まれた数
+		release_pending,		// GPU の完了待ちで残っている数
+		stream_bytes,			// asset_streamer が渡したバイト数
+		stream_pending,			// 読み込み待ちの要求数
+
+		builtin_count,
+	};
+
+	enum class counter_kind : uint8_t
+	{
+		sum,		// フレーム内の合計
+		gauge,		// フレームの終わりの値
+	};
+
+	struct counter_snapshot
+	{
+		uint64_t frame;
+		std::vector<uint64_t> values;		// カウンタ番号順 (end_frame() が履歴を上書きしても変わらないようにコピーで持つ)
+	};
+
+	class frame_counters
+	{
+	public:
+		static constexpr uint32_t MAX_COUNTERS = 32;
+		static constexpr size_t HISTORY = 256;
+
+	public:
+		static frame_counters& get();
+
+		frame_counters(const frame_counters&) = delete;
+		frame_counters& operator=(const frame_counters&) = delete;
+
+	public:
+		// 呼び出したスレッドの値を増やす (スレッドの初回だけ登録のためにロックする)
+		static inline void add(uint32_t counter, uint64_t value)
+		{
+			Expects(counter < MAX_COUNTERS);
+
+			// 書くのはこのスレッドだけなので、読み出しと書き込みを分けても失われない
+			auto& slot = local_block().values[counter];
+			slot.store(slot.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+		}
+
+		static inline void add(frame_counter counter, uint64_t value) { add(static_cast<uint32_t>(counter), value); }
+
+		inline void set(uint32_t counter, uint64_t value) { m_gauges.at(counter).store(value, std::memory_order_relaxed); }
+		inline void set(frame_counter counter, uint64_t value) { set(static_cast<uint32_t>(counter), value); }
+
+		// 名前はプログラムの終了まで有効なものを渡す
+		uint32_t register_counter(const char* name, counter_kind kind = counter_kind::sum);
+
+		// フレームの区切り。各スレッドの増分を集めて履歴に入れる
+		void end_frame();
+
+	public:
+		inline uint32_t counter_count() const noexcept { return m_counter_count.load(std::memory_order_acquire); }
+		const char* name(uint32_t counter) const;
+
+		// age フレーム前 (0 が直前に閉じたフレーム) のスナップショットのコピー。履歴の範囲外なら values は空
+		counter_snapshot snapshot(size_t age = 0) const;
+
+		inline uint64_t value(frame_counter counter, size_t age = 0) const { return value(static_cast<uint32_t>(counter), age); }
+		uint64_t value(uint32_t counter, size_t age = 0) const;
+
+		// 直近 frames フレームの平均
+		double average(uint32_t counter, size_t frames) const;
+
+		// 履歴を古い順に CSV で書き出す (1行目はカウンタ名)
+		bool write_csv(const std::string& path) const;
+
+	private:
+		struct alignas(64) thread_block
+		{
+			std::array<std::atomic<uint64_t>, MAX_COUNTERS> values = {};		// 書き込みはそのスレッドだけ
+			std::array<uint64_t, MAX_COUNTERS> consumed = {};					// end_frame() が集計済みの値
+		};
+
+		struct counter_info
+		{
+			const char* name;
+			counter_kind kind;
+		};
+
+	private:
+		frame_counters();
+
+		static inline thread_block& local_block()
+		{
+			if(s_local == nullptr) s_local = &get().register_thread();
+			return *s_local;
+		}
+
+		thread_block& register_thread();
+
+	private:
+		static inline thread_local thread_block* s_local = nullptr;
+
+		mutable std::mutex m_mutex;
+		std::vector<std::unique_ptr<thread_block>> m_threads;		// スレッドが終了しても値は残す
+
+		std::array<counter_info, MAX_COUNTERS> m_counters = {};
+		std::atomic<uint32_t> m_counter_count = 0;
+		std::array<std::atomic<uint64_t>, MAX_COUNTERS> m_gauges = {};
+
+		// 履歴 (フレームごとに MAX_COUNTERS 個ずつ並べたリング)
+		std::vector<uint64_t> m_history;
+		uint64_t m_frame_count = 0;
+	};
+}
\ No newline at end of file
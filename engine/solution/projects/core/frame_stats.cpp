@@ -0,0 +1,177 @@
+﻿#include "pch.hpp"
+#include "frame_stats.hpp"
+
+namespace core
+{
+	namespace
+	{
+		// operator new から呼ばれるので、動的な初期化を待たずに使えるようにする
+		constinit std::atomic<uint64_t> g_heap_allocations = 0;
+		constinit std::atomic<bool> g_heap_allocation_tracking = false;
+
+		double sum(const std::vector<double>& values)
+		{
+			auto total = 0.0;
+			for(const auto& value : values) total += value;
+			return total;
+		}
+
+		// 昇順に並べた値の 99 パーセンタイル
+		double percentile_99(const std::vector<double>& sorted)
+		{
+			if(sorted.empty()) return 0.0;
+			return sorted.at(std::min(sorted.size() - 1, sorted.size() * 99 / 100));
+		}
+
+		void write_string(std::ostream& stream, std::string_view text)
+		{
+			stream << '"';
+			for(const auto& c : text)
+			{
+				if(c == '"' || c == '\\') stream << '\\';
+				stream << c;
+			}
+			stream << '"';
+		}
+	}
+
+	void count_heap_allocation() noexcept
+	{
+		g_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void set_heap_allocation_tracking(bool enabled) noexcept
+	{
+		g_heap_allocation_tracking.store(enabled, std::memory_order_relaxed);
+	}
+
+	bool heap_allocation_tracking() noexcept
+	{
+		return g_heap_allocation_tracking.load(std::memory_order_relaxed);
+	}
+
+	uint64_t heap_allocations() noexcept
+	{
+		return g_heap_allocations.load(std::memory_order_relaxed);
+	}
+
+	frame_stats::frame_stats(size_t reserve_frames)
+	{
+		m_samples.reserve(reserve_frames);
+	}
+
+	uint32_t frame_stats::add_stage(const char* name)
+	{
+		Expects(m_stages.size() < MAX_FRAME_STAGES);
+
+		m_stages.push_back(name);
+		return gsl::narrow_cast<uint32_t>(m_stages.size() - 1);
+	}
+
+	void frame_stats::begin_frame()
+	{
+		m_current = frame_sample{};
+		m_allocations_begin = heap_allocations();
+		m_frame_begin = profile_clock();
+	}
+
+	void frame_stats::end_frame(uint64_t instances, uint64_t visible)
+	{
+		m_current.ticks = profile_clock() - m_frame_begin;
+		m_current.allocations = heap_allocations() - m_allocations_begin;
+		m_current.instances = instances;
+		m_current.visible = visible;
+
+		m_samples.push_back(m_current);
+	}
+
+	frame_stats_summary frame_stats::summary() const
+	{
+		frame_stats_summary summary{};
+		summary.frames = m_samples.size();
+		if(m_samples.empty()) return summary;
+
+		const auto& to_ns = 1e9 / profiler::get().ticks_per_second();
+		const auto& count = static_cast<double>(m_samples.size());
+
+		/*  フレーム全体  */
+		std::vector<double> times;
+		times.reserve(m_samples.size());
+
+		uint64_t allocations = 0;
+		uint64_t visible = 0;
+		for(const auto& sample : m_samples)
+		{
+			times.push_back(sample.ticks * to_ns);
+			allocations += sample.allocations;
+			visible += sample.visible;
+		}
+		std::sort(times.begin(), times.end());
+
+		const auto& total = sum(times);
+		summary.fps = total > 0.0 ? count * 1e9 / total : 0.0;
+		summary.min_ns = times.front();
+		summary.avg_ns = total / count;
+		summary.p99_ns = percentile_99(times);
+		summary.max_ns = times.back();
+		summary.allocations_tracked = heap_allocation_tracking();
+		summary.allocations_per_frame = allocations / count;
+		summary.visible_per_frame = visible / count;
+
+		/*  段階ごと  */
+		for(size_t stage = 0; stage < m_stages.size(); ++stage)
+		{
+			times.clear();
+			for(const auto& sample : m_samples) times.push_back(sample.stages.at(stage) * to_ns);
+			std::sort(times.begin(), times.end());
+
+			summary.stages.push_back(frame_stage_summary{ m_stages.at(stage), sum(times) / count, percentile_99(times) });
+		}
+
+		return summary;
+	}
+
+	bool write_frame_stats_json(const std::string& path, gsl::span<const frame_stats_report> reports)
+	{
+		std::ofstream file(path);
+		if(!file) return false;
+
+		file << std::fixed;
+		file.precision(1);
+
+		file << "{\"benchmarks\":[";
+
+		for(size_t i = 0; i < reports.size(); ++i)
+		{
+			const auto& report = reports[i];
+			const auto& summary = report.summary;
+
+			file << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+			write_string(file, report.name);
+			file << ",\"instances\":" << report.instances
+				<< ",\"frames\":" << summary.frames
+				<< ",\"fps\":" << summary.fps
+				<< ",\"frame_ns\":{\"min\":" << summary.min_ns << ",\"avg\":" << summary.avg_ns << ",\"p99\":" << summary.p99_ns << ",\"max\":" << summary.max_ns << "}"
+				<< ",\"visible_per_frame\":" << summary.visible_per_frame;
+
+			// 数えていないときは書かない (0 回と区別する)
+			if(summary.allocations_tracked) file << ",\"allocations_per_frame\":" << summary.allocations_per_frame;
+
+			file << ",\"stages\":{";
+
+			for(size_t stage = 0; stage < summary.stages.size(); ++stage)
+			{
+				const auto& entry = summary.stages.at(stage);
+				if(stage != 0) file << ",";
+				write_string(file, entry.name);
+				file << ":{\"avg_ns\":" << entry.avg_ns << ",\"p99_ns\":" << entry.p99_ns << "}";
+			}
+
+			file << "}}";
+		}
+
+		file << "\n]}\n";
+
+		return file.good();
+	}
+}
\ No newline at end of file
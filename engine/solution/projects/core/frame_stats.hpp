@@ -0,0 +1,108 @@
+﻿#pragma once
+#include "profiler.hpp"
+
+namespace core
+{
+	inline constexpr uint32_t MAX_FRAME_STAGES = 8u;
+
+	/*
+		プロセス全体の operator new の呼び出し回数
+		実行ファイルが operator new を置き換えて count_heap_allocation() を呼ぶときだけ数える
+		(core_benchmark / core_tests は allocation_hooks.cpp で置き換える。置き換えていなければ tracking は false のまま)
+	*/
+	void count_heap_allocation() noexcept;
+	void set_heap_allocation_tracking(bool enabled) noexcept;
+	bool heap_allocation_tracking() noexcept;
+	uint64_t heap_allocations() noexcept;
+
+	struct frame_sample
+	{
+		uint64_t ticks;									// profile_clock() での1フレームの長さ
+		std::array<uint64_t, MAX_FRAME_STAGES> stages;
+		uint64_t allocations;							// heap_allocations() の差分
+		uint64_t instances;
+		uint64_t visible;
+	};
+
+	struct frame_stage_summary
+	{
+		const char* name;
+		double avg_ns;
+		double p99_ns;
+	};
+
+	struct frame_stats_summary
+	{
+		uint64_t frames;
+		double fps;
+		double min_ns;
+		double avg_ns;
+		double p99_ns;
+		double max_ns;
+		bool allocations_tracked;						// false なら allocations_per_frame は数えていない
+		double allocations_per_frame;
+		double visible_per_frame;
+		std::vector<frame_stage_summary> stages;
+	};
+
+	/*  ベンチマーク1件分の結果 (JSON の1要素)  */
+	struct frame_stats_report
+	{
+		std::string name;
+		uint64_t instances;
+		frame_stats_summary summary;
+	};
+
+	/*
+		フレームごとの計測値を溜めて集計する
+
+		begin_frame() と end_frame() の間で段階 (add_stage() で登録) ごとの時間を足していく
+		割り当て回数は heap_allocations() の差分 (operator new を置き換えていない実行ファイルでは 0)
+	*/
+	class frame_stats
+	{
+	public:
+		explicit frame_stats(size_t reserve_frames = 0);
+
+	public:
+		uint32_t add_stage(const char* name);
+
+		void begin_frame();
+		inline void add_stage_time(uint32_t stage, uint64_t ticks) { m_current.stages.at(stage) += ticks; }
+		void end_frame(uint64_t instances, uint64_t visible);
+
+		// 捨てたいフレーム (ウォームアップ) の後に呼ぶ
+		inline void clear() noexcept { m_samples.clear(); }
+
+	public:
+		frame_stats_summary summary() const;
+		inline gsl::span<const frame_sample> samples() const noexcept { return m_samples; }
+
+	private:
+		std::vector<const char*> m_stages;
+		std::vector<frame_sample> m_samples;
+
+		frame_sample m_current = {};
+		uint64_t m_frame_begin = 0;
+		uint64_t m_allocations_begin = 0;
+	};
+
+	/*  段階の時間を計る (スコープを抜けるときに足す)  */
+	class stage_timer
+	{
+	public:
+		stage_timer(frame_stats& stats, uint32_t stage) noexcept : m_stats(stats), m_stage(stage), m_begin(profile_clock()) {}
+		~stage_timer() { m_stats.add_stage_time(m_stage, profile_clock() - m_begin); }
+
+		stage_timer(const stage_timer&) = delete;
+		stage_timer& operator=(const stage_timer&) = delete;
+
+	private:
+		frame_stats& m_stats;
+		uint32_t m_stage;
+		uint64_t m_begin;
+	};
+
+	/*  コミット間で比べられるように結果を JSON で書き出す  */
+	bool write_frame_stats_json(const std::string& path, gsl::span<const frame_stats_report> reports);
+}
\ No newline at end of file
@@ -0,0 +1,141 @@
+﻿#include "pch.hpp"
+#include "gpu_profiler.hpp"
+
+namespace core
+{
+	gpu_profiler::gpu_profiler(gsl::not_null<gpu_query_backend*> backend, uint32_t frame_count, uint32_t max_scopes)
+		: m_backend(backend)
+		, m_max_scopes(max_scopes)
+		, m_frames(frame_count)
+	{
+		Expects(frame_count > 0 && max_scopes > 0);
+
+		for(auto& slot : m_frames) slot.scopes.reserve(max_scopes);
+		m_timestamps.resize(static_cast<size_t>(max_scopes) * 2);
+		m_statistics.resize(max_scopes);
+
+#if CORE_PROFILE
+		m_track = profiler::get().create_track("gpu");
+#endif
+	}
+
+	void gpu_profiler::begin_frame(uint32_t frame)
+	{
+		Expects(!m_recording);
+
+		/*  このバッファを前に使ったフレームの結果を読む  */
+		auto& slot = m_frames.at(frame);
+		if(slot.resolved) read(slot);
+
+		slot.scopes.clear();
+		slot.statistics_count = 0;
+		slot.resolved = false;
+
+		m_current = frame;
+		m_recording = true;
+	}
+
+	void gpu_profiler::end_frame()
+	{
+		Expects(m_recording);
+		Expects(m_stack.empty());
+
+		auto& slot = m_frames.at(m_current);
+		if(!slot.scopes.empty())
+		{
+			m_backend->resolve(m_current * m_max_scopes * 2, gsl::narrow<uint32_t>(slot.scopes.size() * 2), m_current * m_max_scopes, slot.statistics_count);
+			slot.resolved = true;
+		}
+
+		m_recording = false;
+	}
+
+	void gpu_profiler::begin_scope(const char* name, bool statistics)
+	{
+		Expects(m_recording);
+
+		auto& slot = m_frames.at(m_current);
+		if(slot.scopes.size() >= m_max_scopes)
+		{
+			m_stack.push_back(NO_SCOPE);
+			++m_dropped;
+			return;
+		}
+
+		const auto& index = gsl::narrow<uint32_t>(slot.scopes.size());
+		const auto& depth = gsl::narrow<uint32_t>(m_stack.size());
+		const auto& query = statistics ? slot.statistics_count++ : NO_SCOPE;
+
+		slot.scopes.push_back(scope{ name, depth, query });
+		m_stack.push_back(index);
+
+		m_backend->timestamp((m_current * m_max_scopes + index) * 2);
+		if(query != NO_SCOPE) m_backend->begin_statistics(m_current * m_max_scopes + query);
+	}
+
+	void gpu_profiler::end_scope()
+	{
+		Expects(!m_stack.empty());
+
+		const auto index = m_stack.back();
+		m_stack.pop_back();
+		if(index == NO_SCOPE) return;
+
+		// 統計はタイムスタンプの内側で閉じる
+		const auto& query = m_frames.at(m_current).scopes.at(index).statistics;
+		if(query != NO_SCOPE) m_backend->end_statistics(m_current * m_max_scopes + query);
+
+		m_backend->timestamp((m_current * m_max_scopes + index) * 2 + 1);
+	}
+
+	void gpu_profiler::read(frame_slot& slot)
+	{
+		const auto& frame = gsl::narrow<uint32_t>(&slot - m_frames.data());
+		const auto& scope_count = slot.scopes.size();
+
+		const auto& timestamps = gsl::span<uint64_t>(m_timestamps).first(scope_count * 2);
+		const auto& statistics = gsl::span<gpu_pipeline_stats>(m_statistics).first(slot.statistics_count);
+		m_backend->read(frame * m_max_scopes * 2, timestamps, frame * m_max_scopes, statistics);
+
+		/*  GPU の時刻を ms と profile_clock() に直す  */
+		const auto& frequency = static_cast<double>(m_backend->frequency());
+		const auto& to_ms = 1000.0 / frequency;
+		const auto& origin = timestamps[0];
+
+#if CORE_PROFILE
+		uint64_t gpu_anchor{};
+		uint64_t cpu_anchor{};
+		m_backend->calibrate(gpu_anchor, cpu_anchor);
+
+		const auto& to_ticks = profiler::get().ticks_per_second() / frequency;
+		auto to_cpu = [&](uint64_t gpu)
+		{
+			const auto& delta = (static_cast<double>(gpu) - static_cast<double>(gpu_anchor)) * to_ticks;
+			return static_cast<uint64_t>(static_cast<double>(cpu_anchor) + delta);
+		};
+#endif
+
+		m_results.clear();
+		for(size_t i = 0; i < scope_count; ++i)
+		{
+			const auto& info = slot.scopes[i];
+			const auto& begin = timestamps[i * 2];
+			const auto& end = timestamps[i * 2 + 1];
+
+			// 途中でデバイスがリセットされたなどで壊れた値は捨てる
+			if(end < begin || begin < origin) continue;
+
+			auto& result = m_results.emplace_back();
+			result.name = info.name;
+			result.depth = info.depth;
+			result.begin_ms = (begin - origin) * to_ms;
+			result.duration_ms = (end - begin) * to_ms;
+			result.has_statistics = info.statistics != NO_SCOPE;
+			result.statistics = result.has_statistics ? statistics[info.statistics] : gpu_pipeline_stats{};
+
+#if CORE_PROFILE
+			profiler::get().record(m_track, profile_event{ info.name, to_cpu(begin), to_cpu(end), info.depth });
+#endif
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+﻿#pragma once
+#include "profiler.hpp"
+
+namespace core
+{
+	/*  パイプライン統計 (D3D12_QUERY_DATA_PIPELINE_STATISTICS と同じ並び)  */
+	struct gpu_pipeline_stats
+	{
+		uint64_t ia_vertices;
+		uint64_t ia_primitives;
+		uint64_t vs_invocations;
+		uint64_t gs_invocations;
+		uint64_t gs_primitives;
+		uint64_t c_invocations;
+		uint64_t c_primitives;
+		uint64_t ps_invocations;
+		uint64_t hs_invocations;
+		uint64_t ds_invocations;
+		uint64_t cs_invocations;
+	};
+
+	/*
+		GPU のクエリを発行する側
+		番号はクエリヒープ全体での位置。resolve() はコマンドリストに積み、read() は GPU の完了後に呼ばれる
+	*/
+	class gpu_query_backend
+	{
+	public:
+		virtual ~gpu_query_backend() = default;
+
+	public:
+		virtual void timestamp(uint32_t index) = 0;
+		virtual void begin_statistics(uint32_t index) = 0;
+		virtual void end_statistics(uint32_t index) = 0;
+
+		virtual void resolve(uint32_t first_timestamp, uint32_t timestamp_count, uint32_t first_statistics, uint32_t statistics_count) = 0;
+		virtual void read(uint32_t first_timestamp, gsl::span<uint64_t> timestamps, uint32_t first_statistics, gsl::span<gpu_pipeline_stats> statistics) = 0;
+
+		// タイムスタンプの 1 秒あたりの値
+		virtual uint64_t frequency() = 0;
+
+		// 同じ瞬間の GPU のタイムスタンプと profile_clock() の値
+		virtual void calibrate(uint64_t& gpu_timestamp, uint64_t& cpu_ticks) = 0;
+	};
+
+	struct gpu_scope_result
+	{
+		const char* name;
+		uint32_t depth;
+		double begin_ms;			// フレームの最初のスコープの開始から
+		double duration_ms;
+		bool has_statistics;
+		gpu_pipeline_stats statistics;
+	};
+
+	/*
+		GPU のパス単位の計測
+
+		・begin_scope() / end_scope() の前後にタイムスタンプを打ち、end_frame() でまとめて resolve する
+		・結果はフレームのバッファごとに持ち、同じバッファの次の begin_frame() (= フェンスを待った後) で読む
+		  (GPU を待たずに読めるのは frame_count フレーム後。その間に描画中のフレームは1つ)
+		・読んだ結果は results() と、プロファイラの "gpu" トラックに入る
+	*/
+	class gpu_profiler
+	{
+	public:
+		gpu_profiler(gsl::not_null<gpu_query_backend*> backend, uint32_t frame_count, uint32_t max_scopes);
+
+		gpu_profiler(const gpu_profiler&) = delete;
+		gpu_profiler& operator=(const gpu_profiler&) = delete;
+
+	public:
+		// frame のバッファが GPU で使い終わっていること (フェンス待ちの後に呼ぶ)
+		void begin_frame(uint32_t frame);
+		void end_frame();
+
+		// max_scopes を超えたスコープは計測しない
+		void begin_scope(const char* name, bool statistics = false);
+		void end_scope();
+
+		// バックエンドのクエリヒープに必要な数
+		static inline uint32_t timestamp_capacity(uint32_t frame_count, uint32_t max_scopes) noexcept { return frame_count * max_scopes * 2; }
+		static inline uint32_t statistics_capacity(uint32_t frame_count, uint32_t max_scopes) noexcept { return frame_count * max_scopes; }
+
+	public:
+		inline const std::vector<gpu_scope_result>& results() const noexcept { return m_results; }
+		inline uint64_t dropped() const noexcept { return m_dropped; }
+
+	private:
+		static constexpr uint32_t NO_SCOPE = std::numeric_limits<uint32_t>::max();
+
+		struct scope
+		{
+			const char* name;
+			uint32_t depth;
+			uint32_t statistics;		// 統計クエリの番号 (なければ NO_SCOPE)
+		};
+
+		struct frame_slot
+		{
+			std::vector<scope> scopes;
+			uint32_t statistics_count = 0;
+			bool resolved = false;
+		};
+
+	private:
+		void read(frame_slot& slot);
+
+	private:
+		gpu_query_backend* m_backend;
+		uint32_t m_max_scopes;
+
+		std::vector<frame_slot> m_frames;
+		uint32_t m_current = 0;
+		bool m_recording = false;
+
+		std::vector<uint32_t> m_stack;		// 開いているスコープ (計測しないものは NO_SCOPE)
+		std::vector<gpu_scope_result> m_results;
+		uint64_t m_dropped = 0;
+
+		// read() の作業領域
+		std::vector<uint64_t> m_timestamps;
+		std::vector<gpu_pipeline_stats> m_statistics;
+
+		uint32_t m_track = 0;
+	};
+
+	/*  スコープの間を計測する  */
+	class gpu_profile_zone
+	{
+	public:
+		gpu_profile_zone(gpu_profiler& profiler, const char* name, bool statistics = false)
+			: m_profiler(profiler)
+		{
+			m_profiler.begin_scope(name, statistics);
+		}
+
+		~gpu_profile_zone() { m_profiler.end_scope(); }
+
+		gpu_profile_zone(const gpu_profile_zone&) = delete;
+		gpu_profile_zone& operator=(const gpu_profile_zone&) = delete;
+
+	private:
+		gpu_profiler& m_profiler;
+	};
+}
+
+#if CORE_PROFILE
+#define GPU_PROFILE_SCOPE(profiler, name) const core::gpu_profile_zone PROFILE_CONCAT(gpu_profile_zone_, __COUNTER__)(profiler, name)
+#else
+#define GPU_PROFILE_SCOPE(profiler, name) ((void)0)
+#endif
\ No newline at end of file
@@ -2,20 +2,70 @@
 
 /*  core  */
 #include "core.hpp"
+#include "platform_window.hpp"
+#ifdef _WIN32
 #include "winapp.hpp"
+#endif
+#include "tlsf_allocator.hpp"
+#include "frame_arena.hpp"
+#include "object_pool.hpp"
+#include "deferred_release.hpp"
+#include "job_system.hpp"
+#include "triple_buffer.hpp"
+#include "frame_clock.hpp"
+#include "simulation_thread.hpp"
+#include "profiler.hpp"
+#include "frame_counters.hpp"
+#include "gpu_profiler.hpp"
 
 /*  math  */
 #include "math.hpp"
+#include "basic_vector.hpp"
+#include "basic_matrix.hpp"
 #include "matrix4x4.hpp"
 #include "vector2.hpp"
 #include "vector3.hpp"
 #include "vector4.hpp"
+#include "affine3x4.hpp"
+#include "bounds.hpp"
+#include "quantize.hpp"
+#include "random.hpp"
 
 using namespace math;
 
-/*  d3d12  */
+/*  scene  */
+#include "entity_world.hpp"
+#include "render_components.hpp"
+#include "transform_hierarchy.hpp"
+#include "bvh.hpp"
+#include "camera.hpp"
+
+/*  mesh  */
+#include "mesh_lod.hpp"
+#include "meshlet.hpp"
+
+/*  d3d12 (Windows のみ)  */
+#ifdef _WIN32
 #include "d3d12.hpp"
 #include "d3d12_factory.hpp"
 #include "d3d12_descriptor_heap.hpp"
 #include "d3d12_gpu_buffer.hpp"
-#include "vertex.hpp"
\ No newline at end of file
+#include "d3d12_memory_budget.hpp"
+#include "d3d12_heap_allocator.hpp"
+#include "d3d12_query_backend.hpp"
+#endif
+#include "vertex_format.hpp"
+#include "vertex.hpp"
+
+/*  asset  */
+#include "file_mapping.hpp"
+#include "mesh_asset.hpp"
+#include "asset_streamer.hpp"
+#include "memory_budget.hpp"
+#include "texture_residency.hpp"
+#include "texture_asset.hpp"
+
+/*  benchmark  */
+#include "frame_stats.hpp"
+#include "null_render_backend.hpp"
+#include "frame_benchmark.hpp"
\ No newline at end of file
@@ -0,0 +1,48 @@
+struct vs_input
+{
+    float3 position : POSITION;
+    float4 color : COLOR;
+    uint instance_id : SV_InstanceID;
+};
+
+struct vs_output
+{
+    float4 position : SV_POSITION;
+    float4 color : COLOR;
+};
+
+// core::instance_record と同じ並び (転置した 3x4)
+struct instance_record
+{
+    float4 row_0;
+    float4 row_1;
+    float4 row_2;
+};
+
+cbuffer transform : register(b0)
+{
+    float4x4 view_proj : packoffset(c0);
+}
+
+// SV_InstanceID は StartInstanceLocation を含まないので先頭はルート定数で渡す
+cbuffer draw_constants : register(b1)
+{
+    uint instance_base;
+}
+
+StructuredBuffer<instance_record> instances : register(t0);
+
+vs_output main(vs_input input)
+{
+    vs_output output = (vs_output) 0;
+
+    const instance_record instance = instances[instance_base + input.instance_id];
+
+    float4 local_pos = float4(input.position, 1.0f);
+    float4 world_pos = float4(dot(instance.row_0, local_pos), dot(instance.row_1, local_pos), dot(instance.row_2, local_pos), 1.0f);
+
+    output.position = mul(view_proj, world_pos);
+    output.color = input.color;
+
+    return output;
+}
\ No newline at end of file
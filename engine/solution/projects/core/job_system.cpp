@@ -0,0 +1,145 @@
+﻿#include "pch.hpp"
+#include "job_system.hpp"
+#include "profiler.hpp"
+
+namespace
+{
+	// ワーカー上、またはジョブの実行中なら true
+	thread_local bool t_in_job = false;
+}
+
+namespace core
+{
+	job_system::job_system(uint32_t worker_count)
+	{
+		for(auto i = 0u; i < worker_count; ++i)
+		{
+			m_threads.emplace_back([this] { worker(); });
+		}
+
+		// 起動時の登録 (プロファイラのバッファなど) を最初のジョブに持ち込まない
+		std::unique_lock lock(m_mutex);
+		m_finished.wait(lock, [&] { return m_started == worker_count; });
+	}
+
+	job_system::~job_system()
+	{
+		{
+			std::lock_guard lock(m_mutex);
+			m_exit = true;
+		}
+		m_wake.notify_all();
+
+		for(auto& thread : m_threads) thread.join();
+	}
+
+	uint32_t job_system::default_worker_count() noexcept
+	{
+		const auto& cores = std::thread::hardware_concurrency();
+		return cores > 1 ? cores - 1 : 0;
+	}
+
+	void job_system::parallel_for(size_t count, size_t grain, const range_function& func)
+	{
+		if(count == 0) return;
+
+		const auto chunk = std::max(grain, size_t(1));
+
+		/*  ワーカーがない・入れ子・他のスレッドが使用中なら、その場で実行する  */
+		auto inline_run = m_threads.empty() || t_in_job || count <= chunk;
+		if(!inline_run)
+		{
+			std::lock_guard lock(m_mutex);
+			inline_run = m_busy;
+			m_busy = !inline_run;
+		}
+
+		if(inline_run)
+		{
+			for(size_t begin = 0; begin < count; begin += chunk) func(begin, std::min(begin + chunk, count));
+			return;
+		}
+
+		/*  前の batch を実行中のワーカー (遅れて起きてタスクが残っていないもの) が抜けてから書き換える  */
+		{
+			std::unique_lock lock(m_mutex);
+			m_finished.wait(lock, [&] { return m_active == 0; });
+
+			m_batch.func = &func;
+			m_batch.count = count;
+			m_batch.grain = chunk;
+			m_batch.task_count = (count + chunk - 1) / chunk;
+			m_batch.next.store(0, std::memory_order_relaxed);
+			m_batch.done.store(0, std::memory_order_relaxed);
+
+			++m_generation;
+		}
+		m_wake.notify_all();
+
+		/*  自分も実行し、全タスクの完了を待つ  */
+		t_in_job = true;
+		run(m_batch);
+		t_in_job = false;
+
+		{
+			std::unique_lock lock(m_mutex);
+			m_finished.wait(lock, [&] { return m_batch.done.load(std::memory_order_acquire) == m_batch.task_count; });
+			m_busy = false;
+		}
+	}
+
+	void job_system::worker()
+	{
+		PROFILE_THREAD("job worker");
+		t_in_job = true;
+
+		{
+			std::lock_guard lock(m_mutex);
+			++m_started;
+		}
+		m_finished.notify_all();
+
+		uint64_t generation = 0;
+		while(true)
+		{
+			{
+				std::unique_lock lock(m_mutex);
+				m_wake.wait(lock, [&] { return m_exit || m_generation != generation; });
+				if(m_exit) return;
+
+				generation = m_generation;
+				++m_active;
+			}
+
+			run(m_batch);
+
+			{
+				std::lock_guard lock(m_mutex);
+				--m_active;
+			}
+			m_finished.notify_all();
+		}
+	}
+
+	void job_system::run(batch& work)
+	{
+		while(true)
+		{
+			const auto& task = work.next.fetch_add(1, std::memory_order_relaxed);
+			if(task >= work.task_count) return;
+
+			const auto& begin = task * work.grain;
+			{
+				PROFILE_SCOPE("job");
+				(*work.func)(begin, std::min(begin + work.grain, work.count));
+			}
+
+			// 最後のタスクを終えたスレッドが待機中の呼び出し元を起こす
+			if(work.done.fetch_add(1, std::memory_order_acq_rel) + 1 == work.task_count)
+			{
+				std::lock_guard lock(m_mutex);
+				m_finished.notify_all();
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+﻿#pragma once
+
+namespace core
+{
+	/*
+		ワーカースレッドのプール
+		・parallel_for() は範囲を grain ごとのタスクに分け、呼び出したスレッドも含めて実行する
+		・ジョブの中から parallel_for() を呼んだ場合や、他のスレッドが実行中の場合はその場で順に実行する
+		・コンストラクタはワーカーが起動し終わるまで待つので、以降の parallel_for() はヒープに触れない
+	*/
+	class job_system
+	{
+	public:
+		using range_function = std::function<void(size_t begin, size_t end)>;
+
+	public:
+		explicit job_system(uint32_t worker_count = default_worker_count());
+		~job_system();
+
+		job_system(const job_system&) = delete;
+		job_system& operator=(const job_system&) = delete;
+
+	public:
+		void parallel_for(size_t count, size_t grain, const range_function& func);
+
+		// ラムダは参照で包んで渡す (キャプチャが大きくても std::function がヒープを使わない)
+		template<class F> requires (!std::is_same_v<std::remove_cvref_t<F>, range_function>) void parallel_for(size_t count, size_t grain, F&& func)
+		{
+			parallel_for(count, grain, range_function(std::ref(func)));
+		}
+
+		inline uint32_t worker_count() const noexcept { return gsl::narrow_cast<uint32_t>(m_threads.size()); }
+
+		// 論理コア数 - 1 (呼び出しスレッドの分)
+		static uint32_t default_worker_count() noexcept;
+
+	private:
+		struct batch
+		{
+			const range_function* func;
+			size_t count;
+			size_t grain;
+			size_t task_count;
+
+			std::atomic<size_t> next = 0;
+			std::atomic<size_t> done = 0;
+		};
+
+	private:
+		void worker();
+		void run(batch& batch);
+
+	private:
+		std::vector<std::thread> m_threads;
+
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		std::condition_variable m_finished;
+
+		batch m_batch;						// 使い回す (実行中のワーカーがいなくなってから書き換える)
+		uint32_t m_active = 0;				// m_batch を実行中のワーカー
+		uint32_t m_started = 0;
+		uint64_t m_generation = 0;
+		bool m_busy = false;
+		bool m_exit = false;
+	};
+}
\ No newline at end of file
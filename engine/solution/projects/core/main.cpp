@@ -1,11 +1,20 @@
 ﻿#include "include.hpp"
 
-int32_t main()
+int32_t main(int32_t argc, char** argv)
 {
 #ifdef _DEBUG
 	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
 #endif
 
+	PROFILE_THREAD("main");
+
+	/*  --benchmark [出力先]: ウィンドウを作らずに CPU 側のフレームを計測して終わる  */
+	if(argc > 1 && std::string_view(argv[1]) == "--benchmark")
+	{
+		core::job_system jobs;
+		return core::run_frame_benchmarks(argc > 2 ? argv[2] : "frame_benchmark.json", jobs) ? 0 : 1;
+	}
+
 	const auto& app = std::make_unique<winapp>(800, 450);
 	const auto& d3d12 = graphic_d3d12::create(app.get());
 
@@ -13,11 +22,27 @@ int32_t main()
 	d3d12->create_pipelines();
 	d3d12->create_cbv();
 
-	std::unique_ptr<gpu_buffer<vertex>> m_vertex_buffer;
-	std::unique_ptr<gpu_buffer<uint32_t>> index_buffer;
-	std::unique_ptr<gpu_buffer<DirectX::XMMATRIX>> vertex_stream;
+	/*  カメラ (リバース Z、遠平面なし)  */
+	core::camera camera;
+	camera.set_position(vector3d(0.0, 0.0, -5.0));
+	camera.set_direction(vector3::forward());
+	camera.set_perspective(90.0f * math::to_rad, static_cast<float>(app->get_width()) / static_cast<float>(app->get_height()), 0.1f);
+
+	/*  非同期読み込み (完了コールバックはループ内の dispatch で呼ばれる)  */
+	constexpr uint64_t stream_upload_budget = 4ull * 1024 * 1024;
+	core::asset_streamer streamer(std::make_unique<core::std_file_backend>());
+
+	/*  バッファは型ごとのプールに置き、ハンドルで参照する  */
+	core::object_pool<gpu_buffer<vertex>> vertex_buffers;
+	core::object_pool<gpu_buffer<uint32_t>> index_buffers;
+	core::object_pool<gpu_buffer<DirectX::XMMATRIX>> instance_buffers;
+	core::object_pool<gpu_buffer<core::instance_record>> record_buffers;
 
-	const auto& device = d3d12->get_device();
+	// true: StructuredBuffer (48 bytes / インスタンス) / false: 頂点ストリーム WORLD0..3 (64 bytes / インスタンス)
+	constexpr bool use_instance_records = true;
+
+	// バッファはアップロードヒープにまとめて配置する
+	const auto& upload_heaps = d3d12->get_upload_heaps();
 
 	std::vector<vertex> vertices =
 	{
@@ -38,41 +63,196 @@ int32_t main()
 
 	aaaaa.resize(100);
 
-	m_vertex_buffer = std::make_unique<gpu_buffer<vertex>>(device, vertices.size() * sizeof(vertex));
-	m_vertex_buffer->map(vertices);
+	const auto& vertex_buffer = vertex_buffers.create(upload_heaps, vertices.size() * sizeof(vertex));
+	vertex_buffers.at(vertex_buffer).map(vertices);
+
+	const auto& index_buffer = index_buffers.create(upload_heaps, indices.size() * sizeof(uint32_t));
+	index_buffers.at(index_buffer).map(indices);
 
-	index_buffer = std::make_unique<gpu_buffer<uint32_t>>(device, indices.size() * sizeof(uint32_t));
-	index_buffer->map(indices);
+	const auto& vertex_stream = instance_buffers.create(upload_heaps, aaaaa.size() * sizeof(DirectX::XMMATRIX));
+	instance_buffers.at(vertex_stream).map(aaaaa);
 
-	vertex_stream = std::make_unique<gpu_buffer<DirectX::XMMATRIX>>(device, aaaaa.size() * sizeof(DirectX::XMMATRIX));
-	vertex_stream->map(aaaaa);
+	const std::vector<core::instance_record> records(aaaaa.size(), core::pack_instance(matrix4x4::identity()));
+	const auto& instance_records = record_buffers.create(upload_heaps, records.size() * sizeof(core::instance_record));
+	record_buffers.at(instance_records).map(records);
 
-	const auto& vbv = m_vertex_buffer->get_vbv();
-	const auto& ibv = index_buffer->get_ibv();
-	const auto& stream_view = vertex_stream->get_vbv();
+	const auto& vbv = vertex_buffers.at(vertex_buffer).get_vbv();
+	const auto& ibv = index_buffers.at(index_buffer).get_ibv();
+	const auto& stream_view = instance_buffers.at(vertex_stream).get_vbv();
 
 	std::array<D3D12_VERTEX_BUFFER_VIEW, 2u> views = { vbv, stream_view };
 
+	/*  シーン (描画するインスタンスをエンティティとして持つ)  */
+	core::job_system jobs;
+	core::entity_world world;
+
+	for (auto i = 0; i < aaaaa.size(); ++i)
+	{
+		world.create(core::world_transform{ matrix4x4::identity() }, core::world_bounds{ { 0, 0, 0 }, 1.5f }, core::mesh_component{});
+	}
+
+	/*
+		シミュレーションは別スレッドで一定間隔で進め、描画に使うインスタンスだけをスナップショットで渡す
+		(描画が present() で待たされてもシミュレーションは遅れない。world はこのスレッドだけが触る)
+		描画側は1つ前の tick との間を補間するので、tick の間隔と描画の間隔が揃わなくても動きが滑らかになる (1 tick 遅れて見える)
+	*/
+	using instance_type = std::conditional_t<use_instance_records, core::instance_record, matrix4x4>;
+	struct scene_snapshot
+	{
+		std::vector<instance_type> instances;
+		std::vector<instance_type> previous;		// 1つ前の tick のもの
+		size_t count = 0;
+		size_t previous_count = 0;
+		uint64_t tick = 0;
+		std::chrono::nanoseconds time{ 0 };			// 書き出した時刻
+	};
+
+	constexpr double simulation_tick_rate = 60.0;
+	core::triple_buffer<scene_snapshot> snapshots(scene_snapshot{ std::vector<instance_type>(aaaaa.size()), std::vector<instance_type>(aaaaa.size()) });
+
+	auto& time_source = core::steady_clock_source::get();
+	core::frame_clock frame_clock(time_source);
+
+	// シミュレーションスレッドだけが触る、直前の tick の結果
+	std::vector<instance_type> last_instances(aaaaa.size());
+	size_t last_count = 0;
+
+	// tick の中だけで使う一時メモリ (チャンクの一覧など。シミュレーションスレッドだけが触る)
+	constexpr size_t tick_arena_capacity = 64 * 1024;
+	core::linear_arena tick_arena(tick_arena_capacity);
+
+	// 乱数は tick ごとに別の列にし、チャンクの順に続けて使う (同じ種なら毎回同じ動きになる)
+	const math::philox4x32 scene_random(1);
+	std::vector<float> scene_positions(aaaaa.size() * 2);
+
+	core::simulation_thread simulation(simulation_tick_rate, [&](uint64_t tick, double)
+	{
+		tick_arena.reset();
+
+		{
+			PROFILE_SCOPE("scene");
+			const auto& random = scene_random.split(tick);
+			uint64_t offset = 0;
+
+			world.each<core::world_transform>([&](gsl::span<const core::entity>, gsl::span<core::world_transform> transforms)
+			{
+				// x, y を交互に並べてまとめて埋める
+				const auto& positions = gsl::span<float>(scene_positions).first(transforms.size() * 2);
+				random.fill_uniform(positions, 0.0f, 10.0f, offset);
+				offset += positions.size();
+
+				for (size_t i = 0; i < transforms.size(); ++i)
+				{
+					transforms[i].world.at(12u) = positions[i * 2 + 0];
+					transforms[i].world.at(13u) = positions[i * 2 + 1];
+				}
+			});
+		}
+
+		{
+			PROFILE_SCOPE("extract");
+			auto& snapshot = snapshots.back();
+			snapshot.count = core::extract_instances(world, jobs, gsl::span<instance_type>(snapshot.instances), &tick_arena);
+			snapshot.tick = tick;
+			snapshot.time = time_source.now();
+
+			// 最初の tick は前がないので同じものを使う
+			const auto& has_previous = tick > 0;
+			snapshot.previous_count = has_previous ? last_count : snapshot.count;
+			std::copy_n(has_previous ? last_instances.data() : snapshot.instances.data(), snapshot.previous_count, snapshot.previous.data());
+
+			std::copy_n(snapshot.instances.data(), snapshot.count, last_instances.data());
+			last_count = snapshot.count;
+		}
+
+		snapshots.publish();
+	}, time_source);
+
 	while (app->isloop())
 	{
+		PROFILE_FRAME();
+		frame_clock.tick();
+
 		/*  更新処理  */
-		app->update();
+		{
+			PROFILE_SCOPE("update");
+			app->update();
+			core::frame_counters::add(core::frame_counter::stream_bytes, streamer.dispatch(stream_upload_budget));
+			core::frame_counters::get().set(core::frame_counter::stream_pending, streamer.get_stats().pending);
+		}
 
-		auto data = vertex_stream->data().get();
-		for (auto i = 0; i < aaaaa.size(); ++i)
+		// 行列は変更があったときだけ作り直し、各フレームのバッファにも1回だけ書く
+		camera.set_aspect(static_cast<float>(app->get_width()) / static_cast<float>(app->get_height()));
+		camera.update();
+		d3d12->update_camera(camera);
+
+		/*
+			最新のスナップショットを前の tick と補間してインスタンスバッファへ書き出す
+			alpha は書き出されてからの経過時間 / tick の間隔 (次が来ないまま 1 tick 過ぎたら最新のままにする)
+		*/
+		size_t instance_count = 0;
 		{
-			data[i] = DirectX::XMMatrixTranslation(rand() % 1000 / 100.f, rand() % 1000 / 100.f, 0);
+			PROFILE_SCOPE("upload");
+			snapshots.acquire();
+			const auto& snapshot = snapshots.front();
+			instance_count = snapshot.count;
+
+			const auto& elapsed = std::chrono::duration<double>(frame_clock.now() - snapshot.time).count();
+			const auto& alpha = static_cast<float>(std::clamp(elapsed * simulation_tick_rate, 0.0, 1.0));
+			const auto& blended = std::min(snapshot.count, snapshot.previous_count);
+
+			instance_type* instances = nullptr;
+			if constexpr (use_instance_records)
+			{
+				instances = record_buffers.at(instance_records).data().get();
+			}
+			else
+			{
+				instances = reinterpret_cast<matrix4x4*>(instance_buffers.at(vertex_stream).data().get());
+			}
+
+			// 増えた分は補間する相手がないのでそのまま
+			std::transform(snapshot.previous.data(), snapshot.previous.data() + blended, snapshot.instances.data(), instances,
+				[alpha](const instance_type& a, const instance_type& b) { return core::lerp_instance(a, b, alpha); });
+			std::copy(snapshot.instances.data() + blended, snapshot.instances.data() + instance_count, instances + blended);
+
+			// マップしたままのバッファへ直接書いた分
+			core::frame_counters::add(core::frame_counter::upload_bytes, instance_count * sizeof(instance_type));
 		}
 
 		d3d12->render_begin();
 		d3d12->render_init();
 		//d3d12->render(vbv, ibv);
-		d3d12->render(views, ibv);
+		{
+			GPU_PROFILE_SCOPE(d3d12->get_gpu_profiler(), "scene pass");
+			if constexpr (use_instance_records)
+			{
+				d3d12->render_instances(vbv, ibv, record_buffers.at(instance_records).get_resource()->GetGPUVirtualAddress(), 0, gsl::narrow<uint32_t>(instance_count));
+			}
+			else
+			{
+				d3d12->render(views, ibv);
+			}
+		}
 		d3d12->render_end();
 		d3d12->present();
+
+		core::frame_counters::get().end_frame();
 	}
 
+	simulation.stop();
 	d3d12->wait_gpu();
 
+#if CORE_PROFILE
+	/*  直近の記録を chrome://tracing / Perfetto で開ける形で残す  */
+	core::profiler::get().write_chrome_trace("profile_trace.json");
+#endif
+
+	/*  直近のフレームごとのカウンタ  */
+	core::frame_counters::get().write_csv("frame_counters.csv");
+
+	/*  フレーム間隔の分布 (0.5ms 刻み)  */
+	frame_clock.histogram().write_csv("frame_times.csv");
+
 	return 0;
 }
\ No newline at end of file
@@ -25,7 +25,7 @@ namespace math
 		x -= gsl::narrow_cast<uint32_t>(x / p) * p; // -2π～2πにする
 
 		float sum = x, t = x;
-		for(int i = 1; i <= LOOP_COUNT; i++)
+		for(uint32_t i = 1; i <= LOOP_COUNT; i++)
 		{
 			t *= -(x * x) / ((2 * i + 1) * (2 * i));
 			sum += t;
@@ -47,7 +47,7 @@ namespace math
 	{
 		if(x <= 0) return 0;
 		float t = x;
-		for(int i = 1; i <= LOOP_COUNT; i++) t = (t + x / t) / 2.0f;
+		for(uint32_t i = 1; i <= LOOP_COUNT; i++) t = (t + x / t) / 2.0f;
 		return t;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,35 @@
+﻿#pragma once
+
+namespace core
+{
+	struct memory_budget_info
+	{
+		uint64_t budget;		// OS から割り当てられた上限
+		uint64_t usage;			// プロセス全体の現在の使用量
+	};
+
+	/*  GPU メモリ予算の問い合わせ先  */
+	class memory_budget_source
+	{
+	public:
+		virtual ~memory_budget_source() = default;
+
+	public:
+		virtual memory_budget_info query() = 0;
+	};
+
+	/*  固定の予算 (上限を手動で絞るとき用)  */
+	class fixed_memory_budget final : public memory_budget_source
+	{
+	public:
+		explicit fixed_memory_budget(uint64_t budget) noexcept : m_info{ budget, 0 } {}
+
+	public:
+		inline memory_budget_info query() override { return m_info; }
+		inline void set_budget(uint64_t budget) noexcept { m_info.budget = budget; }
+		inline void set_usage(uint64_t usage) noexcept { m_info.usage = usage; }
+
+	private:
+		memory_budget_info m_info;
+	};
+}
\ No newline at end of file
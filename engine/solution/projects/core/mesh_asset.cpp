@@ -0,0 +1,212 @@
+﻿#include "include.hpp"
+
+namespace
+{
+	inline constexpr uint64_t align_up(uint64_t value, uint64_t alignment) noexcept
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	template<class T> inline gsl::span<const std::byte> as_bytes(gsl::span<const T> span) noexcept
+	{
+		return { reinterpret_cast<const std::byte*>(span.data()), span.size_bytes() };
+	}
+
+	// mesh_section の順の要素サイズ
+	constexpr std::array<uint64_t, static_cast<size_t>(core::mesh_section::count)> SECTION_ELEMENT_SIZES =
+	{
+		sizeof(vertex),
+		sizeof(uint32_t),
+		sizeof(core::lod_level),
+		sizeof(core::meshlet),
+		sizeof(core::meshlet_bounds),
+		sizeof(uint32_t),
+		sizeof(uint32_t),
+	};
+
+	// [offset, offset + count) が size 個の中に収まるか (足し算であふれない)
+	inline constexpr bool in_range(uint64_t offset, uint64_t count, uint64_t size) noexcept
+	{
+		return offset <= size && count <= size - offset;
+	}
+}
+
+namespace core
+{
+	bool mesh_asset::open(const std::string& path)
+	{
+		m_header = nullptr;
+		m_file = mapped_file(path);
+
+		if(!m_file.is_open()) return false;
+		if(m_file.size() < sizeof(mesh_asset_header)) return false;
+
+		const auto* header = reinterpret_cast<const mesh_asset_header*>(m_file.data().data());
+
+		/*  ヘッダの検証  */
+		if(header->magic != MESH_ASSET_MAGIC) return false;
+		if(header->version != MESH_ASSET_VERSION) return false;
+		if(header->vertex_stride != sizeof(vertex)) return false;
+		if(header->section_count != static_cast<uint32_t>(mesh_section::count)) return false;
+
+		/*  セクションがファイル内に収まり、整列していて、要素の大きさで割り切れるか  */
+		for(auto i = 0u; i < header->sections.size(); ++i)
+		{
+			const auto& section = header->sections.at(i);
+			if(section.offset % MESH_ASSET_ALIGNMENT != 0) return false;
+			if(!in_range(section.offset, section.size, m_file.size())) return false;
+			if(section.size % SECTION_ELEMENT_SIZES.at(i) != 0) return false;
+		}
+
+		m_header = header;
+
+		/*  LOD とメッシュレットが指す範囲がセクションの中にあるか (以降は範囲を調べずに引ける)  */
+		const auto& valid = [this]
+		{
+			for(const auto& lod : lods())
+			{
+				if(!in_range(lod.index_offset, lod.index_count, indices().size())) return false;
+			}
+
+			if(cluster_bounds().size() != meshlets().size()) return false;
+			for(const auto& m : meshlets())
+			{
+				if(!in_range(m.vertex_offset, m.vertex_count, meshlet_vertices().size())) return false;
+				if(!in_range(m.triangle_offset, m.triangle_count, meshlet_triangles().size())) return false;
+			}
+			return true;
+		}();
+
+		if(!valid) m_header = nullptr;
+		return valid;
+	}
+
+	bool write_mesh_asset(const std::string& path, gsl::span<const vertex> vertices, gsl::span<const vector3> positions, const lod_chain& lods, const meshlet_mesh& meshlets)
+	{
+		Expects(vertices.size() == positions.size());
+
+		mesh_asset_header header{};
+		header.magic = MESH_ASSET_MAGIC;
+		header.version = MESH_ASSET_VERSION;
+		header.vertex_stride = sizeof(vertex);
+		header.section_count = static_cast<uint32_t>(mesh_section::count);
+
+		/*  バウンディング (AABB と、その中心を使った包含球)  */
+		auto min = vector3(std::numeric_limits<float>::max());
+		auto max = vector3(std::numeric_limits<float>::lowest());
+		for(const auto& p : positions)
+		{
+			min = vector3(std::min(min.x(), p.x()), std::min(min.y(), p.y()), std::min(min.z(), p.z()));
+			max = vector3(std::max(max.x(), p.x()), std::max(max.y(), p.y()), std::max(max.z(), p.z()));
+		}
+
+		const auto& center = (min + max) * 0.5f;
+		auto radius_square = 0.0f;
+		for(const auto& p : positions) radius_square = std::max(radius_square, (p - center).length_square());
+
+		header.aabb_min = { min.x(), min.y(), min.z() };
+		header.aabb_max = { max.x(), max.y(), max.z() };
+		header.sphere_center = { center.x(), center.y(), center.z() };
+		header.sphere_radius = std::sqrt(radius_square);
+
+		/*  セクションの配置  */
+		const std::array<gsl::span<const std::byte>, static_cast<size_t>(mesh_section::count)> payloads =
+		{
+			as_bytes(vertices),
+			as_bytes(gsl::span<const uint32_t>(lods.indices)),
+			as_bytes(gsl::span<const lod_level>(lods.levels)),
+			as_bytes(gsl::span<const meshlet>(meshlets.meshlets)),
+			as_bytes(gsl::span<const meshlet_bounds>(meshlets.bounds)),
+			as_bytes(gsl::span<const uint32_t>(meshlets.vertex_indices)),
+			as_bytes(gsl::span<const uint32_t>(meshlets.triangles)),
+		};
+
+		auto offset = align_up(sizeof(mesh_asset_header), MESH_ASSET_ALIGNMENT);
+		for(auto i = 0u; i < payloads.size(); ++i)
+		{
+			header.sections.at(i) = mesh_asset_section{ offset, payloads.at(i).size() };
+			offset = align_up(offset + payloads.at(i).size(), MESH_ASSET_ALIGNMENT);
+		}
+
+		/*  書き出し  */
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if(!file) return false;
+
+		constexpr std::array<char, MESH_ASSET_ALIGNMENT> padding = {};
+		auto write_position = uint64_t(0);
+
+		auto write = [&](const void* data, uint64_t size)
+		{
+			file.write(static_cast<const char*>(data), gsl::narrow<std::streamsize>(size));
+			write_position += size;
+		};
+
+		write(&header, sizeof(header));
+		for(auto i = 0u; i < payloads.size(); ++i)
+		{
+			write(padding.data(), header.sections.at(i).offset - write_position);
+			write(payloads.at(i).data(), payloads.at(i).size());
+		}
+
+		return file.good();
+	}
+
+	bool read_text_mesh(const std::string& path, text_mesh& out)
+	{
+		out = text_mesh{};
+
+		std::ifstream file(path);
+		if(!file) return false;
+
+		std::string tag;
+		while(file >> tag)
+		{
+			if(tag == "v")
+			{
+				float x{}, y{}, z{}, r{}, g{}, b{}, a{};
+				if(!(file >> x >> y >> z >> r >> g >> b >> a)) return false;
+
+				out.positions.emplace_back(x, y, z);
+				out.colors.emplace_back(r, g, b, a);
+			}
+			else if(tag == "f")
+			{
+				uint32_t i0{}, i1{}, i2{};
+				if(!(file >> i0 >> i1 >> i2)) return false;
+
+				out.indices.insert(out.indices.end(), { i0, i1, i2 });
+			}
+			else
+			{
+				// 未知の行は読み飛ばす
+				std::string line;
+				std::getline(file, line);
+			}
+		}
+
+		if(out.positions.empty() || out.indices.empty()) return false;
+
+		for(const auto& index : out.indices)
+		{
+			if(index >= out.positions.size()) return false;
+		}
+
+		return true;
+	}
+
+	bool convert_text_mesh(const std::string& source_path, const std::string& destination_path, uint32_t lod_count)
+	{
+		text_mesh mesh;
+		if(!read_text_mesh(source_path, mesh)) return false;
+
+		/*  変換  */
+		std::vector<vertex> vertices;
+		vertices.reserve(mesh.positions.size());
+		for(auto i = 0u; i < mesh.positions.size(); ++i) vertices.emplace_back(mesh.positions.at(i), mesh.colors.at(i));
+
+		const auto& lods = build_lod_chain(mesh.positions, mesh.indices, lod_count);
+		const auto& meshlets = build_meshlets(mesh.positions, mesh.indices);
+
+		return write_mesh_asset(destination_path, vertices, mesh.positions, lods, meshlets);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+﻿#pragma once
+#include "file_mapping.hpp"
+
+/*
+	バイナリメッシュ (.mesh)
+
+	[header][section table][section 0][section 1]...
+	各セクションは MESH_ASSET_ALIGNMENT 境界に配置されるので、
+	ファイルをマップしたポインタをそのまま型付きの span として扱える
+*/
+
+namespace core
+{
+	inline constexpr uint32_t MESH_ASSET_MAGIC = 0x4853454du;		// "MESH"
+	inline constexpr uint32_t MESH_ASSET_VERSION = 1u;
+	inline constexpr uint64_t MESH_ASSET_ALIGNMENT = 64u;
+
+	enum class mesh_section : uint32_t
+	{
+		vertices,
+		indices,
+		lods,
+		meshlets,
+		meshlet_bounds,
+		meshlet_vertices,
+		meshlet_triangles,
+
+		count,
+	};
+
+	struct mesh_asset_section
+	{
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	struct mesh_asset_header
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t vertex_stride;
+		uint32_t section_count;
+
+		std::array<float, 3> aabb_min;
+		std::array<float, 3> aabb_max;
+		std::array<float, 3> sphere_center;
+		float sphere_radius;
+
+		std::array<mesh_asset_section, static_cast<size_t>(mesh_section::count)> sections;
+	};
+
+	/*  マップしたファイルへのビュー (読み込み時にパースもコピーもしない)  */
+	class mesh_asset
+	{
+	public:
+		mesh_asset() noexcept = default;
+
+	public:
+		// ヘッダ、セクション範囲と大きさ、LOD / メッシュレットが指す範囲を検証する。失敗したら false
+		bool open(const std::string& path);
+
+	public:
+		inline const mesh_asset_header& header() const noexcept { return *m_header; }
+		inline gsl::span<const vertex> vertices() const noexcept { return section<vertex>(mesh_section::vertices); }
+		inline gsl::span<const uint32_t> indices() const noexcept { return section<uint32_t>(mesh_section::indices); }
+		inline gsl::span<const lod_level> lods() const noexcept { return section<lod_level>(mesh_section::lods); }
+		inline gsl::span<const meshlet> meshlets() const noexcept { return section<meshlet>(mesh_section::meshlets); }
+		inline gsl::span<const meshlet_bounds> cluster_bounds() const noexcept { return section<meshlet_bounds>(mesh_section::meshlet_bounds); }
+		inline gsl::span<const uint32_t> meshlet_vertices() const noexcept { return section<uint32_t>(mesh_section::meshlet_vertices); }
+		inline gsl::span<const uint32_t> meshlet_triangles() const noexcept { return section<uint32_t>(mesh_section::meshlet_triangles); }
+
+	private:
+		template<class T> inline gsl::span<const T> section(mesh_section type) const noexcept
+		{
+			const auto& range = m_header->sections.at(static_cast<size_t>(type));
+			const auto* ptr = reinterpret_cast<const T*>(m_file.data().data() + range.offset);
+			return { ptr, gsl::narrow_cast<size_t>(range.size / sizeof(T)) };
+		}
+
+	private:
+		mapped_file m_file;
+		const mesh_asset_header* m_header = nullptr;
+	};
+
+	/*  -----  書き出し / 変換  -----------------------------------  */
+
+	/*  テキスト形式 ("v x y z r g b a" / "f i0 i1 i2"。インデックスは 0 始まり) を読んだもの  */
+	struct text_mesh
+	{
+		std::vector<vector3> positions;
+		std::vector<vector4> colors;
+		std::vector<uint32_t> indices;
+	};
+
+	// 範囲外のインデックスや読めない行があれば false
+	bool read_text_mesh(const std::string& path, text_mesh& out);
+
+	bool write_mesh_asset(const std::string& path, gsl::span<const vertex> vertices, gsl::span<const vector3> positions, const lod_chain& lods, const meshlet_mesh& meshlets);
+
+	// テキスト形式からバイナリに変換する
+	bool convert_text_mesh(const std::string& source_path, const std::string& destination_path, uint32_t lod_count = 4);
+}
\ No newline at end of file
@@ -0,0 +1,368 @@
+﻿#include "include.hpp"
+
+namespace
+{
+	/*  対称4x4行列を10要素で保持する二次誤差  */
+	struct quadric
+	{
+		std::array<double, 10> _;
+
+		inline void add_plane(double a, double b, double c, double d, double weight) noexcept
+		{
+			_.at(0) += weight * a * a;
+			_.at(1) += weight * a * b;
+			_.at(2) += weight * a * c;
+			_.at(3) += weight * a * d;
+			_.at(4) += weight * b * b;
+			_.at(5) += weight * b * c;
+			_.at(6) += weight * b * d;
+			_.at(7) += weight * c * c;
+			_.at(8) += weight * c * d;
+			_.at(9) += weight * d * d;
+		}
+
+		inline quadric& operator+=(const quadric& other) noexcept
+		{
+			for(auto i = 0u; i < _.size(); ++i) _.at(i) += other._.at(i);
+			return *this;
+		}
+
+		inline double error(const vector3& v) const noexcept
+		{
+			const double x = v.x();
+			const double y = v.y();
+			const double z = v.z();
+
+			const auto& e =
+				_.at(0) * x * x + 2.0 * _.at(1) * x * y + 2.0 * _.at(2) * x * z + 2.0 * _.at(3) * x +
+				_.at(4) * y * y + 2.0 * _.at(5) * y * z + 2.0 * _.at(6) * y +
+				_.at(7) * z * z + 2.0 * _.at(8) * z +
+				_.at(9);
+
+			return std::max(e, 0.0);
+		}
+	};
+
+	struct collapse
+	{
+		uint32_t from;
+		uint32_t to;
+		double cost;
+	};
+
+	inline uint64_t edge_key(uint32_t a, uint32_t b) noexcept
+	{
+		return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+	}
+
+	inline vector3 triangle_normal(const vector3& a, const vector3& b, const vector3& c) noexcept
+	{
+		return (b - a).cross(c - a);
+	}
+
+	/*  頂点 -> 三角形の逆引き (CSR)  */
+	struct vertex_adjacency
+	{
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> triangles;
+
+		void build(gsl::span<const uint32_t> indices, size_t vertex_count)
+		{
+			offsets.assign(vertex_count + 1, 0);
+			for(const auto& index : indices) ++offsets.at(index + 1);
+			for(auto i = 1u; i < offsets.size(); ++i) offsets.at(i) += offsets.at(i - 1);
+
+			triangles.resize(indices.size());
+			auto cursor = std::vector<uint32_t>(offsets.begin(), offsets.end() - 1);
+			for(auto i = 0u; i < indices.size(); ++i) triangles.at(cursor.at(indices[i])++) = i / 3;
+		}
+
+		inline gsl::span<const uint32_t> at(uint32_t vertex) const
+		{
+			return gsl::span<const uint32_t>(triangles).subspan(offsets.at(vertex), offsets.at(vertex + 1) - offsets.at(vertex));
+		}
+	};
+
+	/*  from を to へ移動したときに面が裏返らないか  */
+	bool flips(gsl::span<const vector3> positions, gsl::span<const uint32_t> indices, const vertex_adjacency& adjacency, uint32_t from, uint32_t to)
+	{
+		for(const auto& triangle : adjacency.at(from))
+		{
+			std::array<uint32_t, 3> tri = { indices[triangle * 3 + 0], indices[triangle * 3 + 1], indices[triangle * 3 + 2] };
+
+			// 縮約で消える三角形は判定しない
+			if(tri.at(0) == to || tri.at(1) == to || tri.at(2) == to) continue;
+
+			const auto& before = triangle_normal(positions[tri.at(0)], positions[tri.at(1)], positions[tri.at(2)]);
+			for(auto& index : tri) if(index == from) index = to;
+			const auto& after = triangle_normal(positions[tri.at(0)], positions[tri.at(1)], positions[tri.at(2)]);
+
+			if(before.dot(after) <= 0.0f) return true;
+		}
+
+		return false;
+	}
+}
+
+namespace core
+{
+	std::vector<uint32_t> simplify(gsl::span<const vector3> positions, gsl::span<const uint32_t> indices, size_t target_index_count, float max_error, float* out_error)
+	{
+		Expects(indices.size() % 3 == 0);
+
+		const auto& vertex_count = positions.size();
+		std::vector<uint32_t> result(indices.begin(), indices.end());
+
+		/*  面の平面から頂点ごとの二次誤差を求める (面積で重み付け)  */
+		std::vector<quadric> quadrics(vertex_count, quadric{});
+		for(auto i = 0u; i < result.size(); i += 3)
+		{
+			const auto& a = positions[result.at(i + 0)];
+			const auto& b = positions[result.at(i + 1)];
+			const auto& c = positions[result.at(i + 2)];
+
+			const auto& n = triangle_normal(a, b, c);
+			const auto& area2 = std::sqrt(n.length_square());
+			if(area2 <= 0.0f) continue;
+
+			const auto& unit = n * (1.0f / area2);
+			quadrics.at(result.at(i + 0)).add_plane(unit.x(), unit.y(), unit.z(), -unit.dot(a), area2);
+			quadrics.at(result.at(i + 1)).add_plane(unit.x(), unit.y(), unit.z(), -unit.dot(a), area2);
+			quadrics.at(result.at(i + 2)).add_plane(unit.x(), unit.y(), unit.z(), -unit.dot(a), area2);
+		}
+
+		/*  境界辺 (1枚の三角形にしか属さない辺) の頂点は境界上でしか動かさない  */
+		std::unordered_map<uint64_t, uint32_t> edge_use;
+		for(auto i = 0u; i < result.size(); i += 3)
+		{
+			for(auto k = 0u; k < 3; ++k) ++edge_use[edge_key(result.at(i + k), result.at(i + (k + 1) % 3))];
+		}
+
+		std::vector<uint8_t> border(vertex_count, 0);
+		for(const auto& [key, count] : edge_use)
+		{
+			if(count != 1) continue;
+			border.at(key >> 32) = 1;
+			border.at(key & 0xffffffffu) = 1;
+		}
+
+		const auto& limit = double(max_error) * double(max_error);
+		double max_applied = 0.0;
+
+		std::vector<uint32_t> remap(vertex_count);
+		std::vector<uint8_t> locked(vertex_count);
+		std::vector<collapse> candidates;
+		vertex_adjacency adjacency;
+
+		while(result.size() > target_index_count)
+		{
+			adjacency.build(result, vertex_count);
+
+			/*  候補となる辺の縮約コストを計算  */
+			candidates.clear();
+			for(auto i = 0u; i < result.size(); i += 3)
+			{
+				for(auto k = 0u; k < 3; ++k)
+				{
+					const auto& a = result.at(i + k);
+					const auto& b = result.at(i + (k + 1) % 3);
+
+					// 各辺を1度だけ処理する
+					if(a > b && edge_use.count(edge_key(a, b)) && edge_use.at(edge_key(a, b)) > 1) continue;
+
+					auto q = quadrics.at(a);
+					q += quadrics.at(b);
+
+					const auto& is_border_edge = edge_use.count(edge_key(a, b)) && edge_use.at(edge_key(a, b)) == 1;
+					const auto& can_ab = !border.at(a) || (border.at(b) && is_border_edge);
+					const auto& can_ba = !border.at(b) || (border.at(a) && is_border_edge);
+
+					const auto& cost_ab = can_ab ? q.error(positions[b]) : std::numeric_limits<double>::max();
+					const auto& cost_ba = can_ba ? q.error(positions[a]) : std::numeric_limits<double>::max();
+
+					if(!can_ab && !can_ba) continue;
+
+					candidates.push_back(cost_ab <= cost_ba ? collapse{ a, b, cost_ab } : collapse{ b, a, cost_ba });
+				}
+			}
+
+			std::sort(candidates.begin(), candidates.end(), [](const collapse& l, const collapse& r) { return l.cost < r.cost; });
+
+			/*  コストの低い順に縮約する (1パスで同じ頂点は1度しか触らない)  */
+			for(auto i = 0u; i < vertex_count; ++i) remap.at(i) = i;
+			std::fill(locked.begin(), locked.end(), uint8_t(0));
+
+			const auto& triangles_to_remove = (result.size() - target_index_count) / 3;
+			size_t removed = 0;
+			size_t collapsed = 0;
+
+			for(const auto& candidate : candidates)
+			{
+				if(candidate.cost > limit) break;
+				if(removed >= triangles_to_remove) break;
+				if(locked.at(candidate.from) || locked.at(candidate.to)) continue;
+				if(flips(positions, result, adjacency, candidate.from, candidate.to)) continue;
+
+				remap.at(candidate.from) = candidate.to;
+				quadrics.at(candidate.to) += quadrics.at(candidate.from);
+				max_applied = std::max(max_applied, candidate.cost);
+
+				// 周囲の三角形の頂点を固定して、同じパス内での矛盾した縮約を防ぐ
+				for(const auto& triangle : adjacency.at(candidate.from))
+				{
+					locked.at(result.at(triangle * 3 + 0)) = 1;
+					locked.at(result.at(triangle * 3 + 1)) = 1;
+					locked.at(result.at(triangle * 3 + 2)) = 1;
+				}
+				for(const auto& triangle : adjacency.at(candidate.to))
+				{
+					locked.at(result.at(triangle * 3 + 0)) = 1;
+					locked.at(result.at(triangle * 3 + 1)) = 1;
+					locked.at(result.at(triangle * 3 + 2)) = 1;
+				}
+
+				// 辺を共有する三角形 (通常2枚) が消える
+				removed += edge_use.count(edge_key(candidate.from, candidate.to)) ? edge_use.at(edge_key(candidate.from, candidate.to)) : 1;
+				++collapsed;
+			}
+
+			if(collapsed == 0) break;
+
+			/*  インデックスを書き換えて縮退三角形を取り除く  */
+			size_t write = 0;
+			for(auto i = 0u; i < result.size(); i += 3)
+			{
+				const auto& a = remap.at(result.at(i + 0));
+				const auto& b = remap.at(result.at(i + 1));
+				const auto& c = remap.at(result.at(i + 2));
+
+				if(a == b || b == c || c == a) continue;
+
+				result.at(write + 0) = a;
+				result.at(write + 1) = b;
+				result.at(write + 2) = c;
+				write += 3;
+			}
+			result.resize(write);
+
+			/*  辺の使用数を更新  */
+			edge_use.clear();
+			for(auto i = 0u; i < result.size(); i += 3)
+			{
+				for(auto k = 0u; k < 3; ++k) ++edge_use[edge_key(result.at(i + k), result.at(i + (k + 1) % 3))];
+			}
+		}
+
+		if(out_error != nullptr)
+		{
+			*out_error = gsl::narrow_cast<float>(std::sqrt(max_applied));
+		}
+
+		return result;
+	}
+
+	lod_chain build_lod_chain(gsl::span<const vector3> positions, gsl::span<const uint32_t> indices, uint32_t lod_count, float reduction, float max_error)
+	{
+		Expects(0 < lod_count && lod_count <= MAX_LOD_COUNT);
+		Expects(0.0f < reduction && reduction < 1.0f);
+
+		lod_chain chain{};
+		chain.indices.assign(indices.begin(), indices.end());
+		chain.levels.push_back(lod_level{ 0, gsl::narrow<uint32_t>(indices.size()), 0.0f });
+
+		std::vector<uint32_t> source(indices.begin(), indices.end());
+		float accumulated_error = 0.0f;
+
+		for(auto i = 1u; i < lod_count; ++i)
+		{
+			const auto& target = gsl::narrow_cast<size_t>(source.size() / 3 * reduction) * 3;
+
+			float error = 0.0f;
+			auto lod = simplify(positions, source, target, max_error, &error);
+
+			// これ以上減らせなければ打ち切る
+			if(lod.empty() || lod.size() >= source.size()) break;
+
+			accumulated_error = std::max(accumulated_error, error);
+			chain.levels.push_back(lod_level{ gsl::narrow<uint32_t>(chain.indices.size()), gsl::narrow<uint32_t>(lod.size()), accumulated_error });
+			chain.indices.insert(chain.indices.end(), lod.begin(), lod.end());
+
+			source = std::move(lod);
+		}
+
+		return chain;
+	}
+
+	void select_lods(const lod_select_desc& desc, gsl::span<const float> position_x, gsl::span<const float> position_y, gsl::span<const float> position_z, gsl::span<const float> radius, gsl::span<uint8_t> out_lods)
+	{
+		Expects(position_x.size() == position_y.size() && position_x.size() == position_z.size());
+		Expects(position_x.size() == radius.size() && position_x.size() == out_lods.size());
+		Expects(0 < desc.lod_count && desc.lod_count <= MAX_LOD_COUNT);
+
+		const auto cx = desc.camera_position.x();
+		const auto cy = desc.camera_position.y();
+		const auto cz = desc.camera_position.z();
+
+		// 直径 (ピクセル) = 2r * scale * (height / 2) / distance
+		const auto pixel_scale = desc.projection_scale * desc.viewport_height;
+
+		// 距離の平方根を避けるため、閾値側を二乗して比較する
+		// lod_count 以降の段は 0 のままにしておくと比較が常に偽になるので、内側のループを MAX_LOD_COUNT 固定で回せる
+		std::array<float, MAX_LOD_COUNT> threshold_square{};
+		for(auto k = 0u; k < desc.lod_count; ++k)
+		{
+			const auto& threshold = desc.screen_thresholds.at(k) / pixel_scale;
+			threshold_square.at(k) = threshold * threshold;
+		}
+
+		const auto count = position_x.size();
+		const auto* px = position_x.data();
+		const auto* py = position_y.data();
+		const auto* pz = position_z.data();
+		const auto* pr = radius.data();
+		auto* out = out_lods.data();
+
+		for(size_t i = 0; i < count; ++i)
+		{
+			const auto dx = px[i] - cx;
+			const auto dy = py[i] - cy;
+			const auto dz = pz[i] - cz;
+			const auto distance_square = dx * dx + dy * dy + dz * dz;
+			const auto radius_square = pr[i] * pr[i];
+
+			// (r / d)^2 < t^2 となる段の数がそのまま LOD 番号 (回数が定数なので展開され、外側のループがベクトル化される)
+			uint32_t lod = 0;
+			for(auto k = 1u; k < MAX_LOD_COUNT; ++k)
+			{
+				lod += (radius_square < threshold_square[k] * distance_square) ? 1u : 0u;
+			}
+
+			out[i] = gsl::narrow_cast<uint8_t>(lod);
+		}
+	}
+
+	lod_buckets bucket_by_lod(gsl::span<const uint8_t> lods, uint32_t lod_count, gsl::span<uint32_t> out_order)
+	{
+		Expects(lods.size() == out_order.size());
+		Expects(0 < lod_count && lod_count <= MAX_LOD_COUNT);
+
+		lod_buckets buckets{};
+
+		for(const auto& lod : lods) ++buckets.instance_count.at(lod);
+
+		uint32_t offset = 0;
+		for(auto k = 0u; k < lod_count; ++k)
+		{
+			buckets.instance_offset.at(k) = offset;
+			offset += buckets.instance_count.at(k);
+		}
+
+		auto cursor = buckets.instance_offset;
+		for(auto i = 0u; i < lods.size(); ++i)
+		{
+			out_order[cursor.at(lods[i])++] = i;
+		}
+
+		return buckets;
+	}
+}
\ No newline at end of file
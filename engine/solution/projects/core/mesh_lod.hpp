@@ -0,0 +1,55 @@
+﻿#pragma once
+
+namespace core
+{
+	inline constexpr uint32_t MAX_LOD_COUNT = 8u;
+
+	/*  LOD 1段分 (全段で頂点バッファを共有し、インデックス範囲だけが異なる)  */
+	struct lod_level
+	{
+		uint32_t index_offset;
+		uint32_t index_count;
+		float error;		// 元メッシュからの幾何誤差 (メッシュ空間の距離)
+	};
+
+	struct lod_chain
+	{
+		std::vector<uint32_t> indices;
+		std::vector<lod_level> levels;
+	};
+
+	/*  LOD 選択の設定  */
+	struct lod_select_desc
+	{
+		vector3 camera_position;
+		float projection_scale;		// 射影行列の _22 (= 1 / tan(fov_y / 2))
+		float viewport_height;
+
+		// 投影直径 (ピクセル) が screen_thresholds[i] を下回ると levels[i] を使う。降順に並べる ([0] は未使用)
+		std::array<float, MAX_LOD_COUNT> screen_thresholds;
+		uint32_t lod_count;
+	};
+
+	/*  LOD ごとにまとめたインスタンスの並び  */
+	struct lod_buckets
+	{
+		std::array<uint32_t, MAX_LOD_COUNT> instance_offset;
+		std::array<uint32_t, MAX_LOD_COUNT> instance_count;
+	};
+
+	/*  -----  LOD 生成  -----------------------------------  */
+
+	// 二次誤差メトリクス (QEM) による辺の縮約で、target_index_count 以下になるまで簡略化する
+	std::vector<uint32_t> simplify(gsl::span<const vector3> positions, gsl::span<const uint32_t> indices, size_t target_index_count, float max_error, float* out_error = nullptr);
+
+	// LOD0 を元メッシュとし、reduction の比率で段階的に簡略化したチェーンを作る
+	lod_chain build_lod_chain(gsl::span<const vector3> positions, gsl::span<const uint32_t> indices, uint32_t lod_count, float reduction = 0.5f, float max_error = 1.0f);
+
+	/*  -----  LOD 選択  -----------------------------------  */
+
+	// インスタンスごとの投影サイズから LOD 番号を求める (SoA 入力。分岐のないループで自動ベクトル化させる)
+	void select_lods(const lod_select_desc& desc, gsl::span<const float> position_x, gsl::span<const float> position_y, gsl::span<const float> position_z, gsl::span<const float> radius, gsl::span<uint8_t> out_lods);
+
+	// LOD 番号ごとにインスタンス番号を並べ替える (LOD ごとに1回の DrawIndexedInstanced で描画できる)
+	lod_buckets bucket_by_lod(gsl::span<const uint8_t> lods, uint32_t lod_count, gsl::span<uint32_t> out_order);
+}
\ No newline at end of file
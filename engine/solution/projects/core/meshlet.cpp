@@ -0,0 +1,229 @@
+﻿#include "include.hpp"
+
+namespace
+{
+	inline int8_t to_snorm8(float value) noexcept
+	{
+		const auto scaled = std::clamp(value, -1.0f, 1.0f) * 127.0f;
+		return gsl::narrow_cast<int8_t>(scaled >= 0.0f ? scaled + 0.5f : scaled - 0.5f);
+	}
+
+	inline uint32_t pack_cone(int8_t x, int8_t y, int8_t z, int8_t cutoff) noexcept
+	{
+		return
+			(gsl::narrow_cast<uint32_t>(gsl::narrow_cast<uint8_t>(x)) << 0) |
+			(gsl::narrow_cast<uint32_t>(gsl::narrow_cast<uint8_t>(y)) << 8) |
+			(gsl::narrow_cast<uint32_t>(gsl::narrow_cast<uint8_t>(z)) << 16) |
+			(gsl::narrow_cast<uint32_t>(gsl::narrow_cast<uint8_t>(cutoff)) << 24);
+	}
+
+	/*  Ritter 法による包含球  */
+	std::pair<vector3, float> bounding_sphere(gsl::span<const vector3> positions, gsl::span<const uint32_t> vertices)
+	{
+		// 任意の点から最も遠い点 a、a から最も遠い点 b を探し、ab を直径とする球を初期値にする
+		auto farthest = [&](const vector3& from)
+		{
+			auto best = positions[vertices[0]];
+			auto best_distance = -1.0f;
+			for(const auto& v : vertices)
+			{
+				const auto& d = (positions[v] - from).length_square();
+				if(d > best_distance)
+				{
+					best_distance = d;
+					best = positions[v];
+				}
+			}
+			return best;
+		};
+
+		const auto& a = farthest(positions[vertices[0]]);
+		const auto& b = farthest(a);
+
+		auto center = (a + b) * 0.5f;
+		auto radius = std::sqrt((b - a).length_square()) * 0.5f;
+
+		// 外に出ている点を含むように球を広げる
+		for(const auto& v : vertices)
+		{
+			const auto& p = positions[v];
+			const auto& d = std::sqrt((p - center).length_square());
+			if(d <= radius) continue;
+
+			const auto& new_radius = (radius + d) * 0.5f;
+			center += (p - center) * ((new_radius - radius) / d);
+			radius = new_radius;
+		}
+
+		return { center, radius };
+	}
+
+	/*  三角形の法線を内包するコーン  */
+	uint32_t normal_cone(gsl::span<const vector3> positions, gsl::span<const uint32_t> indices)
+	{
+		// 縮退したコーン (カリングされない)
+		const auto& no_cull = pack_cone(0, 0, 0, 127);
+
+		std::vector<vector3> normals;
+		normals.reserve(indices.size() / 3);
+
+		auto axis = vector3::zero();
+		for(auto i = 0u; i + 2 < indices.size(); i += 3)
+		{
+			const auto& a = positions[indices[i + 0]];
+			const auto& b = positions[indices[i + 1]];
+			const auto& c = positions[indices[i + 2]];
+
+			const auto& n = (b - a).cross(c - a);
+			const auto& length = std::sqrt(n.length_square());
+			if(length <= 0.0f) continue;
+
+			normals.push_back(n * (1.0f / length));
+			axis += normals.back();
+		}
+
+		const auto& axis_length = std::sqrt(axis.length_square());
+		if(normals.empty() || axis_length <= 0.0f) return no_cull;
+
+		axis *= 1.0f / axis_length;
+
+		// 量子化後の軸で開き角を測り直して、保守的なカットオフにする
+		const auto& qx = to_snorm8(axis.x());
+		const auto& qy = to_snorm8(axis.y());
+		const auto& qz = to_snorm8(axis.z());
+		auto quantized = vector3(qx / 127.0f, qy / 127.0f, qz / 127.0f);
+		quantized *= 1.0f / std::sqrt(quantized.length_square());
+
+		auto min_dot = 1.0f;
+		for(const auto& n : normals) min_dot = std::min(min_dot, n.dot(quantized));
+
+		// 開き角が90度以上なら背面カリングはできない
+		if(min_dot <= 0.0f) return no_cull;
+
+		// cutoff = sin(開き角)。切り上げで量子化する
+		const auto& cutoff = std::sqrt(1.0f - min_dot * min_dot);
+		const auto& cutoff_q = gsl::narrow_cast<int8_t>(std::min(std::ceil(cutoff * 127.0f) + 1.0f, 127.0f));
+
+		return pack_cone(qx, qy, qz, cutoff_q);
+	}
+}
+
+namespace core
+{
+	meshlet_mesh build_meshlets(gsl::span<const vector3> positions, gsl::span<const uint32_t> indices, uint32_t max_vertices, uint32_t max_triangles)
+	{
+		Expects(indices.size() % 3 == 0);
+		Expects(3 <= max_vertices && max_vertices <= 256);
+		Expects(1 <= max_triangles && max_triangles <= 512);
+
+		meshlet_mesh mesh{};
+
+		// 元の頂点番号 -> 作成中のメッシュレット内の番号 (0xff... は未登録)
+		constexpr uint32_t invalid = std::numeric_limits<uint32_t>::max();
+		std::vector<uint32_t> local(positions.size(), invalid);
+
+		meshlet current{};
+		std::vector<uint32_t> current_indices;
+
+		auto flush = [&]
+		{
+			if(current.triangle_count == 0) return;
+
+			const auto& vertices = gsl::span<const uint32_t>(mesh.vertex_indices).subspan(current.vertex_offset, current.vertex_count);
+			const auto& [center, radius] = bounding_sphere(positions, vertices);
+
+			meshlet_bounds bounds{};
+			bounds.center = { center.x(), center.y(), center.z() };
+			bounds.radius = radius;
+			bounds.cone = normal_cone(positions, current_indices);
+
+			mesh.meshlets.push_back(current);
+			mesh.bounds.push_back(bounds);
+
+			for(const auto& v : vertices) local.at(v) = invalid;
+
+			current = meshlet{};
+			current.vertex_offset = gsl::narrow<uint32_t>(mesh.vertex_indices.size());
+			current.triangle_offset = gsl::narrow<uint32_t>(mesh.triangles.size());
+			current_indices.clear();
+		};
+
+		for(auto i = 0u; i < indices.size(); i += 3)
+		{
+			const std::array<uint32_t, 3> tri = { indices[i + 0], indices[i + 1], indices[i + 2] };
+
+			// 縮退三角形は捨てる (同じ頂点を2度数えないように)
+			if(tri.at(0) == tri.at(1) || tri.at(1) == tri.at(2) || tri.at(2) == tri.at(0)) continue;
+
+			uint32_t new_vertices = 0;
+			for(const auto& v : tri) new_vertices += local.at(v) == invalid ? 1 : 0;
+
+			if(current.vertex_count + new_vertices > max_vertices || current.triangle_count + 1 > max_triangles)
+			{
+				flush();
+			}
+
+			std::array<uint32_t, 3> local_tri{};
+			for(auto k = 0u; k < 3; ++k)
+			{
+				auto& slot = local.at(tri.at(k));
+				if(slot == invalid)
+				{
+					slot = current.vertex_count++;
+					mesh.vertex_indices.push_back(tri.at(k));
+				}
+				local_tri.at(k) = slot;
+			}
+
+			mesh.triangles.push_back(pack_meshlet_triangle(local_tri.at(0), local_tri.at(1), local_tri.at(2)));
+			current_indices.insert(current_indices.end(), tri.begin(), tri.end());
+			++current.triangle_count;
+		}
+
+		flush();
+
+		return mesh;
+	}
+
+	std::array<vector4, 6> extract_frustum_planes(gsl::span<const float, 16> view_proj)
+	{
+		const auto& view = frustum::from_view_projection(view_proj);
+
+		std::array<vector4, 6> planes;
+		for(size_t i = 0; i < planes.size(); ++i) planes[i] = view.planes[i].to_vector();
+		return planes;
+	}
+
+	bool is_meshlet_visible(const meshlet_bounds& bounds, const meshlet_cull_view& view)
+	{
+		const auto& center = vector3(bounds.center.at(0), bounds.center.at(1), bounds.center.at(2));
+
+		/*  視錐台  */
+		for(const auto& plane : view.planes)
+		{
+			const auto& distance = plane.x() * center.x() + plane.y() * center.y() + plane.z() * center.z() + plane.w();
+			if(distance < -bounds.radius) return false;
+		}
+
+		/*  法線コーン (全ての面が裏を向いていれば不可視)  */
+		const auto& cone = unpack_meshlet_cone(bounds.cone);
+		const auto& axis = vector3(cone.x(), cone.y(), cone.z());
+		const auto& to_center = center - view.camera_position;
+
+		return to_center.dot(axis) < cone.w() * std::sqrt(to_center.length_square()) + bounds.radius;
+	}
+
+	size_t cull_meshlets(const meshlet_mesh& mesh, const meshlet_cull_view& view, gsl::span<uint32_t> out_visible)
+	{
+		Expects(out_visible.size() >= mesh.meshlets.size());
+
+		size_t count = 0;
+		for(auto i = 0u; i < mesh.bounds.size(); ++i)
+		{
+			out_visible[count] = i;
+			count += is_meshlet_visible(mesh.bounds.at(i), view) ? 1 : 0;
+		}
+
+		return count;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+﻿#pragma once
+
+namespace core
+{
+	inline constexpr uint32_t MESHLET_MAX_VERTICES = 64u;
+	inline constexpr uint32_t MESHLET_MAX_TRIANGLES = 124u;
+
+	/*
+		GPU へそのまま転送できるメッシュレットのレイアウト
+		(メッシュ/増幅シェーダから StructuredBuffer として読む想定)
+	*/
+
+	struct meshlet
+	{
+		uint32_t vertex_offset;		// meshlet_mesh::vertex_indices の先頭
+		uint32_t vertex_count;
+		uint32_t triangle_offset;	// meshlet_mesh::triangles の先頭
+		uint32_t triangle_count;
+	};
+
+	/*  カリング用データ (20 bytes)  */
+	struct meshlet_bounds
+	{
+		std::array<float, 3> center;
+		float radius;
+		uint32_t cone;				// 法線コーン: 軸 xyz + カットオフを snorm8 x4 で格納
+	};
+
+	struct meshlet_mesh
+	{
+		std::vector<meshlet> meshlets;
+		std::vector<meshlet_bounds> bounds;
+		std::vector<uint32_t> vertex_indices;	// メッシュレット内の頂点番号 -> 元の頂点番号
+		std::vector<uint32_t> triangles;		// メッシュレット内の頂点番号を 10bit x3 で格納
+	};
+
+	/*  カリングに使う視点 (メッシュ空間で与える)  */
+	struct meshlet_cull_view
+	{
+		vector3 camera_position;
+		std::array<vector4, 6> planes;		// xyz: 内向きの法線, w: 距離
+	};
+
+	/*  -----  構築  -----------------------------------  */
+
+	// インデックス順に三角形を詰めていき、頂点数か三角形数が上限に達したら次のメッシュレットに移る
+	meshlet_mesh build_meshlets(gsl::span<const vector3> positions, gsl::span<const uint32_t> indices, uint32_t max_vertices = MESHLET_MAX_VERTICES, uint32_t max_triangles = MESHLET_MAX_TRIANGLES);
+
+	/*  -----  パック / アンパック  -----------------------------------  */
+
+	inline constexpr uint32_t pack_meshlet_triangle(uint32_t a, uint32_t b, uint32_t c) noexcept { return (a & 0x3ffu) | ((b & 0x3ffu) << 10) | ((c & 0x3ffu) << 20); }
+	inline constexpr std::array<uint32_t, 3> unpack_meshlet_triangle(uint32_t packed) noexcept { return { packed & 0x3ffu, (packed >> 10) & 0x3ffu, (packed >> 20) & 0x3ffu }; }
+	inline constexpr vector4 unpack_meshlet_cone(uint32_t cone) noexcept
+	{
+		return vector4(
+			std::max(gsl::narrow_cast<int8_t>(cone >> 0) / 127.0f, -1.0f),
+			std::max(gsl::narrow_cast<int8_t>(cone >> 8) / 127.0f, -1.0f),
+			std::max(gsl::narrow_cast<int8_t>(cone >> 16) / 127.0f, -1.0f),
+			std::max(gsl::narrow_cast<int8_t>(cone >> 24) / 127.0f, -1.0f));
+	}
+
+	/*  -----  CPU カリング  -----------------------------------  */
+
+	// ビュー行列 * 射影行列 (DirectXMath と同じ行ベクトル形式、行優先の16要素) から視錐台の6平面を取り出す
+	std::array<vector4, 6> extract_frustum_planes(gsl::span<const float, 16> view_proj);
+
+	bool is_meshlet_visible(const meshlet_bounds& bounds, const meshlet_cull_view& view);
+
+	// 見えているメッシュレットの番号を out_visible に詰め、その数を返す
+	size_t cull_meshlets(const meshlet_mesh& mesh, const meshlet_cull_view& view, gsl::span<uint32_t> out_visible);
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+﻿#include "include.hpp"
+
+namespace core
+{
+	null_render_backend::null_render_backend(uint32_t frame_count, size_t max_instances)
+		: m_upload(frame_count, std::vector<instance_record>(max_instances))
+	{
+		Expects(frame_count > 0);
+	}
+
+	void null_render_backend::render_begin()
+	{
+		Expects(!m_recording);
+
+		m_stats = null_frame_stats{};
+		m_recording = true;
+	}
+
+	void null_render_backend::update_camera(const camera& camera)
+	{
+		m_view_projection = camera.view_projection();
+	}
+
+	void null_render_backend::render_instances(gsl::span<const instance_record> instances)
+	{
+		Expects(m_recording);
+
+		/*  マップしたアップロードバッファへの書き込みの代わり (入りきらない分は捨てる)  */
+		auto& upload = m_upload.at(m_frame_index);
+		const auto count = std::min<size_t>(instances.size(), upload.size() - m_stats.instances);
+		std::memcpy(upload.data() + m_stats.instances, instances.data(), count * sizeof(instance_record));
+
+		++m_stats.draws;
+		m_stats.instances += count;
+		m_stats.upload_bytes += count * sizeof(instance_record);
+
+		frame_counters::add(frame_counter::draws, 1);
+		frame_counters::add(frame_counter::instances, count);
+		frame_counters::add(frame_counter::upload_bytes, count * sizeof(instance_record));
+	}
+
+	void null_render_backend::render_end()
+	{
+		Expects(m_recording);
+		m_recording = false;
+	}
+
+	void null_render_backend::present()
+	{
+		m_frame_index = (m_frame_index + 1) % gsl::narrow_cast<uint32_t>(m_upload.size());
+	}
+
+	void null_render_backend::timestamp(uint32_t index)
+	{
+		if(m_timestamps.size() <= index) m_timestamps.resize(index + 1);
+		m_timestamps[index] = profile_clock();
+	}
+
+	void null_render_backend::begin_statistics(uint32_t index)
+	{
+		if(m_statistics.size() <= index) m_statistics.resize(index + 1);
+		m_statistics[index] = gpu_pipeline_stats{};
+	}
+
+	void null_render_backend::end_statistics(uint32_t index)
+	{
+		// 頂点は描かないのでインスタンス数だけ入れておく
+		m_statistics.at(index).ia_primitives = m_stats.instances;
+	}
+
+	void null_render_backend::resolve(uint32_t, uint32_t, uint32_t, uint32_t)
+	{
+		// 書いた時点で読める
+	}
+
+	void null_render_backend::read(uint32_t first_timestamp, gsl::span<uint64_t> timestamps, uint32_t first_statistics, gsl::span<gpu_pipeline_stats> statistics)
+	{
+		std::copy_n(m_timestamps.begin() + first_timestamp, timestamps.size(), timestamps.begin());
+		std::copy_n(m_statistics.begin() + first_statistics, statistics.size(), statistics.begin());
+	}
+
+	uint64_t null_render_backend::frequency()
+	{
+		return static_cast<uint64_t>(profiler::get().ticks_per_second());
+	}
+
+	void null_render_backend::calibrate(uint64_t& gpu_timestamp, uint64_t& cpu_ticks)
+	{
+		gpu_timestamp = profile_clock();
+		cpu_ticks = gpu_timestamp;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+﻿#pragma once
+#include "gpu_profiler.hpp"
+
+namespace core
+{
+	struct null_frame_stats
+	{
+		uint32_t draws;
+		uint64_t instances;
+		uint64_t upload_bytes;
+	};
+
+	/*
+		GPU を使わない描画先 (ヘッドレスでの計測用)
+
+		graphic_d3d12 と同じ順 (render_begin -> render_instances -> render_end -> present) で呼ぶ
+		インスタンスデータはフレームごとのメモリへのコピーでアップロードの代わりにし、
+		クエリはその場の CPU 時刻を返すので gpu_profiler もそのまま使える
+	*/
+	class null_render_backend final : public gpu_query_backend
+	{
+	public:
+		null_render_backend(uint32_t frame_count, size_t max_instances);
+
+	public:
+		void render_begin();
+		void update_camera(const camera& camera);
+		void render_instances(gsl::span<const instance_record> instances);
+		void render_end();
+		void present();
+
+	public:
+		inline uint32_t get_frame_index() const noexcept { return m_frame_index; }
+		inline const null_frame_stats& get_stats() const noexcept { return m_stats; }
+		inline gsl::span<const instance_record> uploaded() const { return gsl::span<const instance_record>(m_upload.at(m_frame_index)).first(m_stats.instances); }
+
+	public:
+		void timestamp(uint32_t index) override;
+		void begin_statistics(uint32_t index) override;
+		void end_statistics(uint32_t index) override;
+
+		void resolve(uint32_t first_timestamp, uint32_t timestamp_count, uint32_t first_statistics, uint32_t statistics_count) override;
+		void read(uint32_t first_timestamp, gsl::span<uint64_t> timestamps, uint32_t first_statistics, gsl::span<gpu_pipeline_stats> statistics) override;
+
+		uint64_t frequency() override;
+		void calibrate(uint64_t& gpu_timestamp, uint64_t& cpu_ticks) override;
+
+	private:
+		std::vector<std::vector<instance_record>> m_upload;		// フレームごとのインスタンスバッファ
+		matrix4x4 m_view_projection = matrix4x4::identity();
+
+		std::vector<uint64_t> m_timestamps;
+		std::vector<gpu_pipeline_stats> m_statistics;
+
+		uint32_t m_frame_index = 0;
+		null_frame_stats m_stats = {};
+		bool m_recording = false;
+	};
+}
\ No newline at end of file
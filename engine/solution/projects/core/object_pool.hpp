@@ -0,0 +1,164 @@
+﻿#pragma once
+
+namespace core
+{
+	/*
+		32bit の世代付きハンドル (下位 20bit: スロット番号 / 上位 12bit: 世代)
+		・オブジェクトを破棄するとスロットの世代が進むので、古いハンドルは O(1) で無効と分かる
+		・型ごとに別の型になるので、別のプールのハンドルは渡せない
+	*/
+	template<class T> struct handle
+	{
+		static constexpr uint32_t INDEX_BITS = 20;
+		static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+		static constexpr uint32_t GENERATION_MASK = (1u << (32 - INDEX_BITS)) - 1;
+
+		uint32_t value = 0;		// 0 は無効 (世代は 1 から始まる)
+
+		inline constexpr uint32_t index() const noexcept { return value & INDEX_MASK; }
+		inline constexpr uint32_t generation() const noexcept { return value >> INDEX_BITS; }
+		inline constexpr bool valid() const noexcept { return value != 0; }
+
+		inline constexpr bool operator==(const handle& other) const noexcept { return value == other.value; }
+		inline constexpr bool operator!=(const handle& other) const noexcept { return value != other.value; }
+
+		static inline constexpr handle make(uint32_t index, uint32_t generation) noexcept
+		{
+			return handle{ (generation << INDEX_BITS) | index };
+		}
+	};
+
+	/*
+		型ごとのオブジェクトプール
+		・実体は配列に詰めて持つ (破棄時は末尾と入れ替える) ので、begin()/end() で隙間なく走査できる
+		・ハンドル → スロット → 配列の位置 の 2 段で引く
+		・破棄や追加で配列が動くため、get() で得たポインタは次の create()/destroy() まで有効
+	*/
+	template<class T> class object_pool
+	{
+	public:
+		using handle_type = handle<T>;
+
+	public:
+		object_pool() = default;
+
+		object_pool(const object_pool&) = delete;
+		object_pool& operator=(const object_pool&) = delete;
+
+	public:
+		template<class... Args> handle_type create(Args&&... args)
+		{
+			uint32_t index{};
+			if(!m_free_slots.empty())
+			{
+				index = m_free_slots.back();
+				m_free_slots.pop_back();
+			}
+			else
+			{
+				index = gsl::narrow<uint32_t>(m_slots.size());
+				Expects(index <= handle_type::INDEX_MASK);
+
+				m_slots.push_back(slot{ 0, 1 });
+			}
+
+			auto& slot = m_slots.at(index);
+			slot.dense = gsl::narrow<uint32_t>(m_objects.size());
+
+			m_objects.emplace_back(std::forward<Args>(args)...);
+			m_dense_slots.push_back(index);
+
+			return handle_type::make(index, slot.generation);
+		}
+
+		// 古いハンドルなら何もせず false
+		bool destroy(handle_type h)
+		{
+			if(!contains(h)) return false;
+
+			auto& slot = m_slots.at(h.index());
+			const auto dense = slot.dense;
+			const auto last = gsl::narrow<uint32_t>(m_objects.size() - 1);
+
+			/*  末尾の要素を空いた位置に移す  */
+			if(dense != last)
+			{
+				m_objects.at(dense) = std::move(m_objects.at(last));
+				m_dense_slots.at(dense) = m_dense_slots.at(last);
+				m_slots.at(m_dense_slots.at(dense)).dense = dense;
+			}
+			m_objects.pop_back();
+			m_dense_slots.pop_back();
+
+			// 世代を進める (0 は無効ハンドル用に飛ばす)
+			slot.generation = (slot.generation + 1) & handle_type::GENERATION_MASK;
+			if(slot.generation == 0) slot.generation = 1;
+
+			m_free_slots.push_back(h.index());
+			return true;
+		}
+
+		void clear()
+		{
+			for(const auto& index : m_dense_slots)
+			{
+				auto& slot = m_slots.at(index);
+				slot.generation = (slot.generation + 1) & handle_type::GENERATION_MASK;
+				if(slot.generation == 0) slot.generation = 1;
+
+				m_free_slots.push_back(index);
+			}
+
+			m_objects.clear();
+			m_dense_slots.clear();
+		}
+
+	public:
+		inline bool contains(handle_type h) const noexcept
+		{
+			return h.index() < m_slots.size() && m_slots[h.index()].generation == h.generation();
+		}
+
+		// 古いハンドルなら nullptr
+		inline T* get(handle_type h) noexcept { return contains(h) ? &m_objects[m_slots[h.index()].dense] : nullptr; }
+		inline const T* get(handle_type h) const noexcept { return contains(h) ? &m_objects[m_slots[h.index()].dense] : nullptr; }
+
+		inline T& at(handle_type h)
+		{
+			Expects(contains(h));
+			return m_objects.at(m_slots.at(h.index()).dense);
+		}
+
+		// 配列の i 番目の要素のハンドル
+		inline handle_type handle_at(size_t i) const
+		{
+			const auto& index = m_dense_slots.at(i);
+			return handle_type::make(index, m_slots.at(index).generation);
+		}
+
+	public:
+		inline size_t size() const noexcept { return m_objects.size(); }
+		inline bool empty() const noexcept { return m_objects.empty(); }
+
+		inline gsl::span<T> objects() noexcept { return m_objects; }
+		inline gsl::span<const T> objects() const noexcept { return m_objects; }
+
+		inline auto begin() noexcept { return m_objects.begin(); }
+		inline auto end() noexcept { return m_objects.end(); }
+		inline auto begin() const noexcept { return m_objects.begin(); }
+		inline auto end() const noexcept { return m_objects.end(); }
+
+	private:
+		struct slot
+		{
+			uint32_t dense;			// m_objects 内の位置
+			uint32_t generation;
+		};
+
+	private:
+		std::vector<T> m_objects;
+		std::vector<uint32_t> m_dense_slots;	// m_objects と同じ並びのスロット番号
+		std::vector<slot> m_slots;
+		std::vector<uint32_t> m_free_slots;
+	};
+}
\ No newline at end of file
@@ -1,5 +1,11 @@
 ﻿#pragma once
 
+/*
+	Windows (Visual Studio) と、それ以外 (CMake、null バックエンドだけ) で分ける
+	Windows 以外では d3d12 のデバイスと winapp を使わず、DirectX-Headers の構造体と列挙 (DXGI_FORMAT、入力レイアウト) だけを使う
+*/
+#ifdef _WIN32
+
 /*  コード分析の警告を無効化  */
 #include <codeanalysis\warnings.h>
 #pragma warning(push)
@@ -39,6 +45,18 @@
 #include <string>
 #include <iostream>
 #include <chrono>
+#include <bit>
+#include <utility>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory_resource>
+#include <string_view>
+#include <intrin.h>
 
 #undef near
 #undef far
@@ -46,4 +64,52 @@
 /*  警告を有効化  */
 #pragma warning(pop)
 
-#pragma warning(disable: 26812)	// C26812: enum -> enum class
\ No newline at end of file
+#pragma warning(disable: 26812)	// C26812: enum -> enum class
+
+#else
+
+/*  vcpkg  */
+#include <gsl/gsl>
+#include <boost/format.hpp>
+#include <boost/random.hpp>
+#include <boost/random/random_device.hpp>
+
+/*  DirectX-Headers (構造体と列挙だけ。Win32 の型は wsl/winadapter.h が補う)  */
+#include <wsl/winadapter.h>
+#include <directx/d3d12.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <array>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <string>
+#include <iostream>
+#include <chrono>
+#include <bit>
+#include <utility>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory_resource>
+#include <string_view>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <optional>
+#include <filesystem>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,23 @@
+﻿#pragma once
+#include <cstdint>
+
+namespace core
+{
+	/*
+		メインループから見たウィンドウ
+		update() はたまっているメッセージを全て処理し、isloop() が false になったらループを抜ける
+	*/
+	class platform_window
+	{
+	public:
+		virtual ~platform_window() = default;
+
+	public:
+		virtual void update() noexcept = 0;
+
+	public:
+		virtual bool isloop() const noexcept = 0;
+		virtual uint32_t get_width() const noexcept = 0;
+		virtual uint32_t get_height() const noexcept = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,236 @@
+﻿#include "pch.hpp"
+#include "profiler.hpp"
+
+namespace
+{
+	constexpr uint64_t EVENT_MASK = core::profiler::THREAD_CAPACITY - 1;
+
+	// JSON の文字列として書き出す
+	void write_string(std::ofstream& file, std::string_view text)
+	{
+		file << '"';
+		for(const auto& c : text)
+		{
+			if(c == '"' || c == '\\') file << '\\';
+			file << c;
+		}
+		file << '"';
+	}
+}
+
+namespace core
+{
+	profiler& profiler::get()
+	{
+		static profiler instance;
+		return instance;
+	}
+
+	profiler::profiler()
+		: m_start_ticks(profile_clock())
+		, m_start_time(std::chrono::steady_clock::now())
+	{
+	}
+
+	void profiler::set_thread_name(const char* name)
+	{
+		auto& buffer = local_buffer();
+
+		std::lock_guard lock(m_mutex);
+		buffer.name = name;
+	}
+
+	uint32_t profiler::create_track(const char* name)
+	{
+		auto& buffer = register_thread();
+
+		std::lock_guard lock(m_mutex);
+		buffer.name = name;
+
+		return buffer.id;
+	}
+
+	void profiler::record(uint32_t track, const profile_event& event)
+	{
+		// 1フレームに数十件程度なのでロックで済ませる
+		std::lock_guard lock(m_mutex);
+
+		write(*m_threads.at(track), event);
+	}
+
+	void profiler::frame()
+	{
+		const auto& now = profile_clock();
+
+		std::lock_guard lock(m_mutex);
+
+		/*  前回の区切りから増えた分を集計する (上書きされた分は諦める)  */
+		for(auto& buffer : m_threads)
+		{
+			const auto& head = buffer->head.load(std::memory_order_acquire);
+			const auto& oldest = head > THREAD_CAPACITY ? head - THREAD_CAPACITY : 0;
+
+			for(auto i = std::max(buffer->consumed, oldest); i < head; ++i)
+			{
+				profile_event event;
+				if(read(*buffer, i, event)) add_sample(event.name, event.depth, event.end - event.begin);
+			}
+
+			buffer->consumed = head;
+		}
+
+		if(m_frame_count > 0) add_sample("frame", 0, now - m_frames[(m_frame_count - 1) % FRAME_CAPACITY]);
+
+		m_frames[m_frame_count % FRAME_CAPACITY] = now;
+		++m_frame_count;
+	}
+
+	std::vector<profile_summary> profiler::summary() const
+	{
+		const auto& to_ms = 1000.0 / ticks_per_second();
+
+		std::lock_guard lock(m_mutex);
+
+		std::vector<profile_summary> result;
+		result.reserve(m_zones.size());
+
+		std::vector<uint64_t> samples;
+		for(const auto& [name, zone] : m_zones)
+		{
+			const auto& count = std::min<uint64_t>(zone.count, HISTORY);
+			if(count == 0) continue;
+
+			samples.assign(zone.samples.begin(), zone.samples.begin() + count);
+
+			uint64_t total = 0;
+			for(const auto& sample : samples) total += sample;
+
+			const auto& p99 = samples.begin() + (count * 99 + 99) / 100 - 1;
+			std::nth_element(samples.begin(), p99, samples.end());
+
+			result.push_back(profile_summary
+			{
+				name,
+				zone.depth,
+				zone.count,
+				*std::min_element(samples.begin(), samples.end()) * to_ms,
+				static_cast<double>(total) / count * to_ms,
+				*p99 * to_ms,
+			});
+		}
+
+		// 重いものから並べる
+		std::sort(result.begin(), result.end(), [](const profile_summary& l, const profile_summary& r) { return l.avg_ms > r.avg_ms; });
+
+		return result;
+	}
+
+	bool profiler::write_chrome_trace(const std::string& path) const
+	{
+		const auto& to_us = 1000000.0 / ticks_per_second();
+
+		std::ofstream file(path);
+		if(!file) return false;
+
+		file << std::fixed;
+		file.precision(3);
+
+		std::lock_guard lock(m_mutex);
+
+		file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+		auto first = true;
+		auto separator = [&]
+		{
+			if(!first) file << ",\n";
+			first = false;
+		};
+
+		for(const auto& buffer : m_threads)
+		{
+			/*  スレッド名  */
+			if(!buffer->name.empty())
+			{
+				separator();
+				file << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":0,\"tid\":" << buffer->id << ",\"args\":{\"name\":";
+				write_string(file, buffer->name);
+				file << "}}";
+			}
+
+			/*  ゾーン (開始と長さを持つ完了イベント)  */
+			const auto& head = buffer->head.load(std::memory_order_acquire);
+			const auto& oldest = head > THREAD_CAPACITY ? head - THREAD_CAPACITY : 0;
+
+			for(auto i = oldest; i < head; ++i)
+			{
+				profile_event event;
+				if(!read(*buffer, i, event)) continue;
+				if(event.begin < m_start_ticks) continue;
+
+				separator();
+				file << "{\"ph\":\"X\",\"name\":";
+				write_string(file, event.name);
+				file << ",\"pid\":0,\"tid\":" << buffer->id << ",\"ts\":" << (event.begin - m_start_ticks) * to_us << ",\"dur\":" << (event.end - event.begin) * to_us << "}";
+			}
+		}
+
+		/*  フレームの区切り  */
+		const auto& first_frame = m_frame_count > FRAME_CAPACITY ? m_frame_count - FRAME_CAPACITY : 0;
+		for(auto i = first_frame; i < m_frame_count; ++i)
+		{
+			separator();
+			file << "{\"ph\":\"i\",\"s\":\"g\",\"name\":\"frame " << i << "\",\"pid\":0,\"tid\":0,\"ts\":" << (m_frames[i % FRAME_CAPACITY] - m_start_ticks) * to_us << "}";
+		}
+
+		file << "\n]}\n";
+
+		return file.good();
+	}
+
+	double profiler::ticks_per_second() const noexcept
+	{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+		/*  TSC の周波数は起動からの経過時間と比べて求める (短すぎると誤差が大きいので少し待つ)  */
+		constexpr auto minimum = std::chrono::milliseconds(10);
+
+		const auto& waited = std::chrono::steady_clock::now() - m_start_time;
+		if(waited < minimum) std::this_thread::sleep_for(minimum - waited);
+
+		const auto& ticks = profile_clock() - m_start_ticks;
+		const auto& elapsed = std::chrono::steady_clock::now() - m_start_time;
+		return static_cast<double>(ticks) / std::chrono::duration<double>(elapsed).count();
+#else
+		return 1.0e9;
+#endif
+	}
+
+	bool profiler::read(const thread_buffer& buffer, uint64_t index, profile_event& out) noexcept
+	{
+		const auto& sequence = buffer.sequences[index & EVENT_MASK];
+		if(sequence.load(std::memory_order_acquire) != index + 1) return false;
+
+		out = buffer.events[index & EVENT_MASK];
+
+		// 中身を読み終えてから番号を読み直す
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return sequence.load(std::memory_order_relaxed) == index + 1;
+	}
+
+	profiler::thread_buffer& profiler::register_thread()
+	{
+		std::lock_guard lock(m_mutex);
+
+		auto& buffer = m_threads.emplace_back(std::make_unique<thread_buffer>());
+		buffer->id = gsl::narrow<uint32_t>(m_threads.size() - 1);
+
+		return *buffer;
+	}
+
+	void profiler::add_sample(std::string_view name, uint32_t depth, uint64_t ticks)
+	{
+		auto& zone = m_zones[name];
+		zone.samples[zone.count % HISTORY] = ticks;
+		zone.depth = depth;
+		++zone.count;
+	}
+}
\ No newline at end of file
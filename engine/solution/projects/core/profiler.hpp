@@ -0,0 +1,198 @@
+﻿#pragma once
+
+/*
+	CPU プロファイラ
+
+	PROFILE_SCOPE("名前") でスコープの開始・終了時刻をスレッドごとのリングバッファに記録し、
+	PROFILE_FRAME() でフレームの区切りを入れる (区切りごとにゾーン別の min / avg / p99 を更新する)
+	write_chrome_trace() の出力は chrome://tracing / Perfetto で開ける
+
+	CORE_PROFILE を 0 にするとマクロは何も生成しない
+	名前は文字列リテラルなど、プログラムの終了まで有効なものを渡す
+	1ゾーンのコストは profile_clock() 2回 + リングへの書き込み (core_benchmark profiler で計る)
+*/
+
+#ifndef CORE_PROFILE
+#define CORE_PROFILE 1
+#endif
+
+namespace core
+{
+	/*  -----  時刻  -----------------------------------  */
+
+	// x86 では TSC (数 ns で読める)、それ以外は steady_clock の ns
+	inline uint64_t profile_clock() noexcept
+	{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return gsl::narrow_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+	}
+
+	/*  -----  記録  -----------------------------------  */
+
+	struct profile_event
+	{
+		const char* name;
+		uint64_t begin;
+		uint64_t end;
+		uint32_t depth;		// 同じスレッドで何段目のゾーンか (0 が一番外)
+	};
+
+	struct profile_summary
+	{
+		std::string_view name;
+		uint32_t depth;
+		uint64_t count;		// これまでの呼び出し回数
+		double min_ms;
+		double avg_ms;
+		double p99_ms;
+	};
+
+	class profiler
+	{
+	public:
+		static constexpr size_t THREAD_CAPACITY = 1u << 15;		// スレッドごとに保持するイベント数 (2 の累乗)
+		static constexpr size_t HISTORY = 512;					// ゾーンごとに集計に使う直近の回数
+		static constexpr size_t FRAME_CAPACITY = 1024;
+
+	public:
+		static profiler& get();
+
+		profiler(const profiler&) = delete;
+		profiler& operator=(const profiler&) = delete;
+
+	public:
+		// 呼び出したスレッドのリングに書く (スレッドの初回だけ登録のためにロックする)
+		static inline void record(const char* name, uint64_t begin, uint64_t end, uint32_t depth)
+		{
+			write(local_buffer(), profile_event{ name, begin, end, depth });
+		}
+
+		// 呼び出したスレッドの名前 (トレースに表示する)
+		void set_thread_name(const char* name);
+
+		// スレッドに結び付かない記録先 (GPU のタイムラインなど)。時刻は profile_clock() に合わせて渡す
+		uint32_t create_track(const char* name);
+		void record(uint32_t track, const profile_event& event);
+
+		// フレームの区切り。前回からの記録を集計する
+		void frame();
+
+	public:
+		// 直近 HISTORY 回分のゾーン別の集計 (フレーム時間は "frame" として含む)
+		std::vector<profile_summary> summary() const;
+
+		// 各スレッドのリングに残っている記録とフレームの区切りを Chrome trace 形式で書き出す
+		bool write_chrome_trace(const std::string& path) const;
+
+		// profile_clock() の 1 秒あたりの値
+		double ticks_per_second() const noexcept;
+
+	private:
+		/*
+			リングが一周すると、読む側が見ている最も古いスロットを書く側が同時に上書きする
+			スロットごとの番号 (書き込み中は 0、書き終わったら 何件目か + 1) を中身の前後で読み、変わっていたら捨てる
+		*/
+		struct thread_buffer
+		{
+			std::unique_ptr<profile_event[]> events = std::make_unique<profile_event[]>(THREAD_CAPACITY);
+			std::unique_ptr<std::atomic<uint64_t>[]> sequences = std::make_unique<std::atomic<uint64_t>[]>(THREAD_CAPACITY);
+			std::atomic<uint64_t> head = 0;		// 書いた数 (書き込みはそのスレッドだけ)
+			uint64_t consumed = 0;				// frame() が集計済みの位置
+			uint32_t id = 0;
+			std::string name;
+		};
+
+		struct zone_history
+		{
+			std::array<uint64_t, HISTORY> samples = {};
+			uint64_t count = 0;
+			uint32_t depth = 0;
+		};
+
+	private:
+		profiler();
+
+		static inline thread_buffer& local_buffer()
+		{
+			if(s_local == nullptr) s_local = &get().register_thread();
+			return *s_local;
+		}
+
+		static inline void write(thread_buffer& buffer, const profile_event& event)
+		{
+			const auto& head = buffer.head.load(std::memory_order_relaxed);
+			auto& sequence = buffer.sequences[head & (THREAD_CAPACITY - 1)];
+
+			// 番号を消してから中身を書き、書き終わったら番号を付ける (読む側は head までしか見ない)
+			sequence.store(0, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			buffer.events[head & (THREAD_CAPACITY - 1)] = event;
+			sequence.store(head + 1, std::memory_order_release);
+			buffer.head.store(head + 1, std::memory_order_release);
+		}
+
+		// index 件目を読む。読んでいる間に上書きされたら false
+		static bool read(const thread_buffer& buffer, uint64_t index, profile_event& out) noexcept;
+
+		thread_buffer& register_thread();
+		void add_sample(std::string_view name, uint32_t depth, uint64_t ticks);
+
+	private:
+		static inline thread_local thread_buffer* s_local = nullptr;
+
+		mutable std::mutex m_mutex;
+		std::vector<std::unique_ptr<thread_buffer>> m_threads;		// スレッドが終了しても記録は残す
+
+		std::unordered_map<std::string_view, zone_history> m_zones;
+		std::array<uint64_t, FRAME_CAPACITY> m_frames = {};		// フレームの区切りの時刻
+		uint64_t m_frame_count = 0;
+
+		// ticks_per_second() の較正用
+		uint64_t m_start_ticks;
+		std::chrono::steady_clock::time_point m_start_time;
+	};
+
+	/*  スコープの開始から終了までを記録する  */
+	class profile_zone
+	{
+	public:
+		explicit profile_zone(const char* name) noexcept
+			: m_name(name)
+			, m_depth(s_depth++)
+			, m_begin(profile_clock())
+		{
+		}
+
+		~profile_zone()
+		{
+			const auto& end = profile_clock();
+			--s_depth;
+			profiler::record(m_name, m_begin, end, m_depth);
+		}
+
+		profile_zone(const profile_zone&) = delete;
+		profile_zone& operator=(const profile_zone&) = delete;
+
+	private:
+		static inline thread_local uint32_t s_depth = 0;
+
+		const char* m_name;
+		uint32_t m_depth;
+		uint64_t m_begin;
+	};
+}
+
+#if CORE_PROFILE
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) const core::profile_zone PROFILE_CONCAT(profile_zone_, __COUNTER__)(name)
+#define PROFILE_FRAME() core::profiler::get().frame()
+#define PROFILE_THREAD(name) core::profiler::get().set_thread_name(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#endif
\ No newline at end of file
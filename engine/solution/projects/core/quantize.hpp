@@ -0,0 +1,197 @@
+﻿#pragma once
+
+namespace math
+{
+	/*  -----  スカラーの量子化  -----------------------------------  */
+
+	inline constexpr uint16_t to_half(float value) noexcept;
+	inline constexpr float from_half(uint16_t value) noexcept;
+	inline constexpr uint8_t to_unorm8(float value) noexcept;
+	inline constexpr uint16_t to_unorm16(float value) noexcept;
+	inline constexpr int16_t to_snorm16(float value) noexcept;
+	inline constexpr float from_unorm8(uint8_t value) noexcept;
+	inline constexpr float from_unorm16(uint16_t value) noexcept;
+	inline constexpr float from_snorm16(int16_t value) noexcept;
+
+	/*  -----  ベクトルの量子化  -----------------------------------  */
+
+	inline constexpr std::array<uint16_t, 4> encode_half4(const vector3& value) noexcept;
+	inline constexpr std::array<uint16_t, 4> encode_half4(const vector4& value) noexcept;
+	inline constexpr uint32_t encode_rgba8(const vector4& color) noexcept;
+	inline constexpr vector4 decode_rgba8(uint32_t color) noexcept;
+	inline constexpr std::array<uint16_t, 2> encode_unorm16x2(const vector2& uv) noexcept;
+
+	/*  -----  八面体エンコード (単位ベクトル -> snorm16x2)  -----  */
+
+	inline constexpr std::array<int16_t, 2> encode_octahedral(const vector3& normal) noexcept;
+	inline constexpr vector3 decode_octahedral(const std::array<int16_t, 2>& encoded) noexcept;
+}
+
+namespace math
+{
+	/*  -----  inline定義  -----------------------------------  */
+
+	inline constexpr uint16_t to_half(float value) noexcept
+	{
+		const auto& bits = std::bit_cast<uint32_t>(value);
+		const auto& sign = gsl::narrow_cast<uint16_t>((bits >> 16) & 0x8000u);
+		const auto& exponent = gsl::narrow_cast<int32_t>((bits >> 23) & 0xffu);
+		auto mantissa = bits & 0x007fffffu;
+
+		// NaN / Inf
+		if(exponent == 0xff)
+		{
+			return gsl::narrow_cast<uint16_t>(sign | 0x7c00u | (mantissa != 0 ? 0x0200u : 0u));
+		}
+
+		const auto& half_exponent = exponent - 127 + 15;
+
+		// オーバーフローは Inf に丸める
+		if(half_exponent >= 0x1f)
+		{
+			return gsl::narrow_cast<uint16_t>(sign | 0x7c00u);
+		}
+
+		// 非正規化数 (アンダーフローは 0)
+		if(half_exponent <= 0)
+		{
+			if(half_exponent < -10) return sign;
+
+			mantissa |= 0x00800000u;
+			const auto& shift = gsl::narrow_cast<uint32_t>(14 - half_exponent);
+			auto half_mantissa = mantissa >> shift;
+			const auto& remainder = mantissa & ((1u << shift) - 1u);
+			const auto& halfway = 1u << (shift - 1u);
+
+			// round to nearest even
+			if(remainder > halfway || (remainder == halfway && (half_mantissa & 1u) != 0)) ++half_mantissa;
+
+			return gsl::narrow_cast<uint16_t>(sign | half_mantissa);
+		}
+
+		auto half = (gsl::narrow_cast<uint32_t>(half_exponent) << 10) | (mantissa >> 13);
+		const auto& remainder = mantissa & 0x1fffu;
+
+		// round to nearest even (繰り上がりで指数部へ溢れても正しく Inf になる)
+		if(remainder > 0x1000u || (remainder == 0x1000u && (half & 1u) != 0)) ++half;
+
+		return gsl::narrow_cast<uint16_t>(sign | half);
+	}
+
+	inline constexpr float from_half(uint16_t value) noexcept
+	{
+		const auto& sign = gsl::narrow_cast<uint32_t>(value & 0x8000u) << 16;
+		auto exponent = gsl::narrow_cast<int32_t>((value >> 10) & 0x1fu);
+		auto mantissa = gsl::narrow_cast<uint32_t>(value & 0x03ffu);
+
+		if(exponent == 0x1f)
+		{
+			return std::bit_cast<float>(sign | 0x7f800000u | (mantissa << 13));
+		}
+
+		if(exponent == 0)
+		{
+			if(mantissa == 0) return std::bit_cast<float>(sign);
+
+			// 非正規化数を正規化する
+			exponent = 1;
+			while((mantissa & 0x0400u) == 0)
+			{
+				mantissa <<= 1;
+				--exponent;
+			}
+			mantissa &= 0x03ffu;
+		}
+
+		return std::bit_cast<float>(sign | (gsl::narrow_cast<uint32_t>(exponent - 15 + 127) << 23) | (mantissa << 13));
+	}
+
+	inline constexpr uint8_t to_unorm8(float value) noexcept
+	{
+		const auto clamped = std::clamp(value, 0.0f, 1.0f);
+		return gsl::narrow_cast<uint8_t>(clamped * 255.0f + 0.5f);
+	}
+
+	inline constexpr uint16_t to_unorm16(float value) noexcept
+	{
+		const auto clamped = std::clamp(value, 0.0f, 1.0f);
+		return gsl::narrow_cast<uint16_t>(clamped * 65535.0f + 0.5f);
+	}
+
+	inline constexpr int16_t to_snorm16(float value) noexcept
+	{
+		const auto scaled = std::clamp(value, -1.0f, 1.0f) * 32767.0f;
+		return gsl::narrow_cast<int16_t>(scaled >= 0.0f ? scaled + 0.5f : scaled - 0.5f);
+	}
+
+	inline constexpr float from_unorm8(uint8_t value) noexcept { return value / 255.0f; }
+	inline constexpr float from_unorm16(uint16_t value) noexcept { return value / 65535.0f; }
+	inline constexpr float from_snorm16(int16_t value) noexcept { return std::max(value / 32767.0f, -1.0f); }
+
+	inline constexpr std::array<uint16_t, 4> encode_half4(const vector3& value) noexcept
+	{
+		return { to_half(value.x()), to_half(value.y()), to_half(value.z()), to_half(1.0f) };
+	}
+
+	inline constexpr std::array<uint16_t, 4> encode_half4(const vector4& value) noexcept
+	{
+		return { to_half(value.x()), to_half(value.y()), to_half(value.z()), to_half(value.w()) };
+	}
+
+	inline constexpr uint32_t encode_rgba8(const vector4& color) noexcept
+	{
+		// DXGI_FORMAT_R8G8B8A8_UNORM はリトルエンディアンで R が最下位バイト
+		return
+			(gsl::narrow_cast<uint32_t>(to_unorm8(color.x())) << 0) |
+			(gsl::narrow_cast<uint32_t>(to_unorm8(color.y())) << 8) |
+			(gsl::narrow_cast<uint32_t>(to_unorm8(color.z())) << 16) |
+			(gsl::narrow_cast<uint32_t>(to_unorm8(color.w())) << 24);
+	}
+
+	inline constexpr vector4 decode_rgba8(uint32_t color) noexcept
+	{
+		return vector4(
+			from_unorm8(gsl::narrow_cast<uint8_t>(color >> 0)),
+			from_unorm8(gsl::narrow_cast<uint8_t>(color >> 8)),
+			from_unorm8(gsl::narrow_cast<uint8_t>(color >> 16)),
+			from_unorm8(gsl::narrow_cast<uint8_t>(color >> 24)));
+	}
+
+	inline constexpr std::array<uint16_t, 2> encode_unorm16x2(const vector2& uv) noexcept
+	{
+		return { to_unorm16(uv.x()), to_unorm16(uv.y()) };
+	}
+
+	inline constexpr std::array<int16_t, 2> encode_octahedral(const vector3& normal) noexcept
+	{
+		const auto& l1 = abs_of(normal.x()) + abs_of(normal.y()) + abs_of(normal.z());
+		if(l1 <= 0.0f) return { 0, 0 };
+
+		auto u = normal.x() / l1;
+		auto v = normal.y() / l1;
+
+		// 下半球は対角線で折り返す
+		if(normal.z() < 0.0f)
+		{
+			const auto& fold_u = (1.0f - abs_of(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+			const auto& fold_v = (1.0f - abs_of(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+			u = fold_u;
+			v = fold_v;
+		}
+
+		return { to_snorm16(u), to_snorm16(v) };
+	}
+
+	inline constexpr vector3 decode_octahedral(const std::array<int16_t, 2>& encoded) noexcept
+	{
+		const auto& u = from_snorm16(encoded.at(0));
+		const auto& v = from_snorm16(encoded.at(1));
+
+		auto n = vector3(u, v, 1.0f - abs_of(u) - abs_of(v));
+		const auto t = std::max(-n.z(), 0.0f);
+		n.x() += n.x() >= 0.0f ? -t : t;
+		n.y() += n.y() >= 0.0f ? -t : t;
+
+		return n * (1.0f / sqrt_of(n.length_square()));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,211 @@
+﻿#include "include.hpp"
+
+namespace
+{
+	using math::philox4x32;
+
+	// 変換するときに一度に作る数 (スタックに置く)
+	constexpr size_t CHUNK_SIZE = 256;
+
+#if MATH_SSE
+	// 4 ブロック分のカウンタ (std::array<__m128i, 4> だと GCC が __m128i の属性を捨てると警告する)
+	struct lanes
+	{
+		__m128i c[4];
+	};
+
+	/*
+		4 ブロックを1本ずつのレーンに置いて計算する (c[w] のレーン j = ブロック j の w 番目)
+		32bit x 32bit -> 64bit は _mm_mul_epu32 が偶数レーンしか扱わないので、奇数レーンはずらして掛ける
+	*/
+	inline void mulhilo(__m128i a, __m128i multiplier, __m128i& lo, __m128i& hi) noexcept
+	{
+		const auto& even = _mm_shuffle_epi32(_mm_mul_epu32(a, multiplier), _MM_SHUFFLE(3, 1, 2, 0));						// lo0 lo2 hi0 hi2
+		const auto& odd = _mm_shuffle_epi32(_mm_mul_epu32(_mm_srli_epi64(a, 32), multiplier), _MM_SHUFFLE(3, 1, 2, 0));	// lo1 lo3 hi1 hi3
+		lo = _mm_unpacklo_epi32(even, odd);
+		hi = _mm_unpackhi_epi32(even, odd);
+	}
+
+	inline void load_counters(const philox4x32::counter_type& base, uint64_t block, lanes& l) noexcept
+	{
+		std::array<uint64_t, 4> index = { block, block + 1, block + 2, block + 3 };
+		l.c[0] = _mm_set_epi32(static_cast<int32_t>(index[3]), static_cast<int32_t>(index[2]), static_cast<int32_t>(index[1]), static_cast<int32_t>(index[0]));
+		l.c[1] = _mm_set_epi32(static_cast<int32_t>(index[3] >> 32), static_cast<int32_t>(index[2] >> 32), static_cast<int32_t>(index[1] >> 32), static_cast<int32_t>(index[0] >> 32));
+		l.c[2] = _mm_set1_epi32(static_cast<int32_t>(base[2]));
+		l.c[3] = _mm_set1_epi32(static_cast<int32_t>(base[3]));
+	}
+
+	inline void philox_round(lanes& l, __m128i m0, __m128i m1, __m128i k0, __m128i k1) noexcept
+	{
+		__m128i lo0, hi0, lo1, hi1;
+		mulhilo(l.c[0], m0, lo0, hi0);
+		mulhilo(l.c[2], m1, lo1, hi1);
+		l = { { _mm_xor_si128(_mm_xor_si128(hi1, l.c[1]), k0), lo1, _mm_xor_si128(_mm_xor_si128(hi0, l.c[3]), k1), lo0 } };
+	}
+
+	// レーンごとのブロックをブロック順 (ブロック j の w 番目 = out[j * 4 + w]) に並べ替えて書く
+	inline void store_blocks(const lanes& l, uint32_t* out) noexcept
+	{
+		auto r0 = _mm_castsi128_ps(l.c[0]);
+		auto r1 = _mm_castsi128_ps(l.c[1]);
+		auto r2 = _mm_castsi128_ps(l.c[2]);
+		auto r3 = _mm_castsi128_ps(l.c[3]);
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 0), _mm_castps_si128(r0));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), _mm_castps_si128(r1));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_castps_si128(r2));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 12), _mm_castps_si128(r3));
+	}
+#endif
+
+	// block 番目から count ブロック分を out (count * 4 個) に書く
+	void generate_blocks(const philox4x32::counter_type& base, const philox4x32::key_type& key, uint64_t block, size_t count, uint32_t* out) noexcept
+	{
+		size_t i = 0;
+
+#if MATH_SSE
+		/*  乗算の待ち時間を埋めるため、4 ブロックの組を2つ並べて進める  */
+		constexpr size_t GROUP = 8;
+
+		const auto& m0 = _mm_set1_epi32(static_cast<int32_t>(philox4x32::MULTIPLIER_0));
+		const auto& m1 = _mm_set1_epi32(static_cast<int32_t>(philox4x32::MULTIPLIER_1));
+		const auto& w0 = _mm_set1_epi32(static_cast<int32_t>(philox4x32::WEYL_0));
+		const auto& w1 = _mm_set1_epi32(static_cast<int32_t>(philox4x32::WEYL_1));
+
+		for(; i + GROUP <= count; i += GROUP)
+		{
+			lanes a;
+			lanes b;
+			load_counters(base, block + i, a);
+			load_counters(base, block + i + 4, b);
+
+			auto k0 = _mm_set1_epi32(static_cast<int32_t>(key[0]));
+			auto k1 = _mm_set1_epi32(static_cast<int32_t>(key[1]));
+			for(auto r = 0u; r < philox4x32::ROUNDS; ++r)
+			{
+				if(r > 0)
+				{
+					k0 = _mm_add_epi32(k0, w0);
+					k1 = _mm_add_epi32(k1, w1);
+				}
+				philox_round(a, m0, m1, k0, k1);
+				philox_round(b, m0, m1, k0, k1);
+			}
+
+			store_blocks(a, out + i * philox4x32::BLOCK_SIZE);
+			store_blocks(b, out + (i + 4) * philox4x32::BLOCK_SIZE);
+		}
+#endif
+
+		for(; i < count; ++i)
+		{
+			auto counter = base;
+			counter[0] = static_cast<uint32_t>(block + i);
+			counter[1] = static_cast<uint32_t>((block + i) >> 32);
+
+			const auto& result = philox4x32::generate(counter, key);
+			std::copy(result.begin(), result.end(), out + i * philox4x32::BLOCK_SIZE);
+		}
+	}
+
+	// 上位 24 bit を [0, 1) の float にする
+	constexpr float UNIT_SCALE = 1.0f / 16777216.0f;
+
+	void to_uniform(const uint32_t* in, size_t count, float low, float high, float* out) noexcept
+	{
+		const auto& scale = (high - low) * UNIT_SCALE;
+		size_t i = 0;
+
+#if MATH_SSE
+		const auto& s = _mm_set1_ps(scale);
+		const auto& l = _mm_set1_ps(low);
+		for(; i + 4 <= count; i += 4)
+		{
+			const auto& bits = _mm_srli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), 8);
+			_mm_storeu_ps(out + i, _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(bits), s), l));
+		}
+#endif
+
+		for(; i < count; ++i) out[i] = static_cast<float>(in[i] >> 8) * scale + low;
+	}
+}
+
+namespace math
+{
+	philox4x32::philox4x32(uint64_t seed, uint64_t stream) noexcept
+		: m_seed(seed)
+		, m_stream(stream)
+	{
+	}
+
+	philox4x32::result_type philox4x32::operator()() noexcept
+	{
+		const auto& block = m_position / BLOCK_SIZE;
+		if(block != m_cache_block)
+		{
+			m_cache = generate(counter(block), key());
+			m_cache_block = block;
+		}
+		return m_cache[m_position++ % BLOCK_SIZE];
+	}
+
+	philox4x32::result_type philox4x32::at(uint64_t index) const noexcept
+	{
+		return generate(counter(index / BLOCK_SIZE), key())[index % BLOCK_SIZE];
+	}
+
+	void philox4x32::fill(gsl::span<uint32_t> out, uint64_t offset) const noexcept
+	{
+		const auto& base = counter(0);
+		const auto& k = key();
+
+		// ブロックの途中から始まる分と、最後の半端な分は1ブロック作って写す
+		auto partial = [&](size_t begin, size_t end)
+		{
+			for(auto i = begin; i < end;)
+			{
+				const auto& index = offset + i;
+				const auto& block = generate(counter(index / BLOCK_SIZE), k);
+				for(auto lane = index % BLOCK_SIZE; lane < BLOCK_SIZE && i < end; ++lane, ++i) out[i] = block[lane];
+			}
+		};
+
+		const size_t head = std::min<size_t>((BLOCK_SIZE - offset % BLOCK_SIZE) % BLOCK_SIZE, out.size());
+		partial(0, head);
+
+		const auto& blocks = (out.size() - head) / BLOCK_SIZE;
+		generate_blocks(base, k, (offset + head) / BLOCK_SIZE, blocks, out.data() + head);
+
+		partial(head + blocks * BLOCK_SIZE, out.size());
+	}
+
+	void philox4x32::fill_uniform(gsl::span<float> out, float low, float high, uint64_t offset) const noexcept
+	{
+		std::array<uint32_t, CHUNK_SIZE> bits;
+		for(size_t i = 0; i < out.size(); i += CHUNK_SIZE)
+		{
+			const size_t count = std::min(CHUNK_SIZE, out.size() - i);
+			fill(gsl::span<uint32_t>(bits).first(count), offset + i);
+			to_uniform(bits.data(), count, low, high, out.data() + i);
+		}
+	}
+
+	void philox4x32::fill_uniform(gsl::span<int32_t> out, int32_t low, int32_t high, uint64_t offset) const noexcept
+	{
+		Expects(low <= high);
+
+		const auto& range = static_cast<uint64_t>(static_cast<int64_t>(high) - low) + 1;
+
+		std::array<uint32_t, CHUNK_SIZE> bits;
+		for(size_t i = 0; i < out.size(); i += CHUNK_SIZE)
+		{
+			const size_t count = std::min(CHUNK_SIZE, out.size() - i);
+			fill(gsl::span<uint32_t>(bits).first(count), offset + i);
+
+			for(size_t j = 0; j < count; ++j)
+			{
+				out[i + j] = static_cast<int32_t>(static_cast<int64_t>(low) + static_cast<int64_t>((bits[j] * range) >> 32));
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+﻿#pragma once
+
+/*
+	カウンタ方式の乱数 (Philox4x32-10、Salmon et al. "Parallel Random Numbers: As Easy as 1, 2, 3")
+
+	n 番目の値は (seed, stream, n) だけで決まり、前の値を順に作らなくてよい
+	・fill 系は offset 番目から書くので、範囲を分けて別々のスレッドで埋めても1本で埋めたのと同じ列になる
+	・stream を変えると独立した列になる (split() でワーカーや tick ごとに分ける)
+	・operator() で順に取り出すこともできる (boost::random の分布にそのまま渡せる)
+	・まとめて作るときは x86 で SSE を使い、8 ブロック (32 個) ずつ計算する
+*/
+
+namespace math
+{
+	class philox4x32
+	{
+	public:
+		using result_type = uint32_t;
+		using counter_type = std::array<uint32_t, 4>;
+		using key_type = std::array<uint32_t, 2>;
+
+		// 1回の計算で作る数
+		static constexpr size_t BLOCK_SIZE = 4;
+
+	public:
+		explicit philox4x32(uint64_t seed = 0, uint64_t stream = 0) noexcept;
+
+	public:
+		result_type operator()() noexcept;
+		inline void discard(uint64_t count) noexcept { m_position += count; }
+
+		// 同じ種で別の列
+		inline philox4x32 split(uint64_t stream) const noexcept { return philox4x32(m_seed, stream); }
+
+	public:
+		inline uint64_t seed() const noexcept { return m_seed; }
+		inline uint64_t stream() const noexcept { return m_stream; }
+		inline uint64_t position() const noexcept { return m_position; }
+
+		// index 番目の数 (position() は変わらない)
+		result_type at(uint64_t index) const noexcept;
+
+	public:
+		/*  out[i] = at(offset + i)  */
+		void fill(gsl::span<uint32_t> out, uint64_t offset = 0) const noexcept;
+
+		// [low, high) の一様分布 (上位 24 bit を使う。範囲が広いと丸めで high ちょうどになることはある)
+		void fill_uniform(gsl::span<float> out, float low, float high, uint64_t offset = 0) const noexcept;
+
+		// [low, high] の整数 (掛けて上位を取るので、偏りは (high - low + 1) / 2^32 以下)
+		void fill_uniform(gsl::span<int32_t> out, int32_t low, int32_t high, uint64_t offset = 0) const noexcept;
+
+	public:
+		static inline constexpr result_type min() noexcept { return 0; }
+		static inline constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+		// 1ブロック分 (10 ラウンド)
+		static inline constexpr counter_type generate(counter_type counter, key_type key) noexcept;
+
+	public:
+		static constexpr uint32_t MULTIPLIER_0 = 0xD2511F53;
+		static constexpr uint32_t MULTIPLIER_1 = 0xCD9E8D57;
+		static constexpr uint32_t WEYL_0 = 0x9E3779B9;		// 黄金比
+		static constexpr uint32_t WEYL_1 = 0xBB67AE85;		// sqrt(3) - 1
+		static constexpr uint32_t ROUNDS = 10;
+
+	private:
+		inline key_type key() const noexcept { return { static_cast<uint32_t>(m_seed), static_cast<uint32_t>(m_seed >> 32) }; }
+		inline counter_type counter(uint64_t block) const noexcept { return { static_cast<uint32_t>(block), static_cast<uint32_t>(block >> 32), static_cast<uint32_t>(m_stream), static_cast<uint32_t>(m_stream >> 32) }; }
+
+	private:
+		uint64_t m_seed;
+		uint64_t m_stream;
+		uint64_t m_position = 0;
+
+		// operator() 用に最後に作ったブロック
+		counter_type m_cache = {};
+		uint64_t m_cache_block = std::numeric_limits<uint64_t>::max();
+	};
+
+	/*  -----  inline定義  -----------------------------------  */
+
+	inline constexpr philox4x32::counter_type philox4x32::generate(counter_type counter, key_type key) noexcept
+	{
+		for(auto round = 0u; round < ROUNDS; ++round)
+		{
+			if(round > 0)
+			{
+				key[0] += WEYL_0;
+				key[1] += WEYL_1;
+			}
+
+			const auto& product_0 = static_cast<uint64_t>(MULTIPLIER_0) * counter[0];
+			const auto& product_1 = static_cast<uint64_t>(MULTIPLIER_1) * counter[2];
+			counter =
+			{
+				static_cast<uint32_t>(product_1 >> 32) ^ counter[1] ^ key[0],
+				static_cast<uint32_t>(product_1),
+				static_cast<uint32_t>(product_0 >> 32) ^ counter[3] ^ key[1],
+				static_cast<uint32_t>(product_0),
+			};
+		}
+		return counter;
+	}
+
+	// Random123 の既知の答え
+	static_assert(philox4x32::generate({ 0, 0, 0, 0 }, { 0, 0 }) == philox4x32::counter_type{ 0x6627E8D5, 0xE169C58D, 0xBC57AC4C, 0x9B00DBD8 }, "philox4x32-10");
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+﻿#include "include.hpp"
+
+namespace
+{
+	using namespace core;
+
+	inline void store(matrix4x4& out, const world_transform& transform) noexcept { out = transform.world; }
+	inline void store(instance_record& out, const world_transform& transform) noexcept { out = pack_instance(transform.world); }
+
+	template<typename T> size_t extract(entity_world& world, gsl::span<T> out)
+	{
+		size_t written = 0;
+
+		world.each<world_transform, mesh_component>([&](gsl::span<const entity>, gsl::span<world_transform> transforms, gsl::span<mesh_component>)
+		{
+			const auto count = std::min(transforms.size(), out.size() - written);
+			for(size_t i = 0; i < count; ++i) store(out[written + i], transforms[i]);
+
+			written += count;
+		});
+
+		return written;
+	}
+
+	template<typename T> size_t extract(entity_world& world, job_system& jobs, gsl::span<T> out, std::pmr::memory_resource* scratch)
+	{
+		const auto& chunks = world.collect_chunks(make_component_mask<world_transform, mesh_component>(), scratch);
+
+		/*  チャンクごとの書き込み位置  */
+		std::pmr::vector<size_t> offsets(chunks.size() + 1, scratch);
+		for(size_t i = 0; i < chunks.size(); ++i)
+		{
+			offsets.at(i + 1) = offsets.at(i) + chunks.at(i).first->chunk_size(chunks.at(i).second);
+		}
+
+		const auto total = std::min(offsets.back(), out.size());
+
+		jobs.parallel_for(chunks.size(), 4, [&](size_t begin, size_t end)
+		{
+			for(auto i = begin; i < end; ++i)
+			{
+				if(offsets.at(i) >= total) break;
+
+				auto& [type, index] = chunks.at(i);
+				const auto* transforms = type->components<world_transform>(index);
+				const auto& count = std::min(offsets.at(i + 1), total) - offsets.at(i);
+
+				for(size_t j = 0; j < count; ++j) store(out[offsets.at(i) + j], transforms[j]);
+			}
+		});
+
+		return total;
+	}
+}
+
+namespace core
+{
+	size_t extract_instances(entity_world& world, gsl::span<matrix4x4> out) { return extract(world, out); }
+	size_t extract_instances(entity_world& world, job_system& jobs, gsl::span<matrix4x4> out, std::pmr::memory_resource* scratch) { return extract(world, jobs, out, scratch); }
+	size_t extract_instances(entity_world& world, gsl::span<instance_record> out) { return extract(world, out); }
+	size_t extract_instances(entity_world& world, job_system& jobs, gsl::span<instance_record> out, std::pmr::memory_resource* scratch) { return extract(world, jobs, out, scratch); }
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+﻿#pragma once
+#include "entity_world.hpp"
+
+namespace core
+{
+	using mesh_handle = handle<struct mesh_tag>;
+	using material_handle = handle<struct material_tag>;
+
+	/*  -----  描画用のコンポーネント  -----------------------------------  */
+
+	// インスタンスバッファの WORLD0..3 にそのまま書く
+	struct world_transform
+	{
+		matrix4x4 world;
+	};
+
+	struct world_bounds
+	{
+		std::array<float, 3> center;
+		float radius;
+	};
+
+	struct mesh_component
+	{
+		mesh_handle mesh;
+	};
+
+	struct material_component
+	{
+		material_handle material;
+	};
+
+	/*  -----  GPU のインスタンスデータ  -----------------------------------  */
+
+	/*
+		StructuredBuffer に置くインスタンス1つ分 (48 bytes)
+		行ベクトル形式の world を転置した 3x4 (最後の列 0,0,0,1 は捨てる)
+		シェーダでは world_pos = float3(dot(row_0, p), dot(row_1, p), dot(row_2, p)) で復元する
+	*/
+	struct instance_record
+	{
+		std::array<float, 4> row_0;
+		std::array<float, 4> row_1;
+		std::array<float, 4> row_2;
+	};
+
+	static_assert(sizeof(instance_record) == 48, "instance_record は 48 bytes (3 x float4)");
+
+	inline constexpr instance_record pack_instance(const matrix4x4& world) noexcept
+	{
+		const auto* m = world.data();
+		return instance_record
+		{
+			{ m[0], m[4], m[8], m[12] },
+			{ m[1], m[5], m[9], m[13] },
+			{ m[2], m[6], m[10], m[14] },
+		};
+	}
+
+	// affine3x4 は同じ並びなのでそのまま写す
+	inline constexpr instance_record pack_instance(const affine3x4& world) noexcept
+	{
+		return std::bit_cast<instance_record>(world);
+	}
+
+	/*
+		前の tick と今の tick の間を t (0..1) で補間する (描画の間隔がシミュレーションと揃わないとき用)
+		要素ごとの線形補間なので、1 tick の間の回転が大きいと拡縮が混ざる
+	*/
+	inline constexpr matrix4x4 lerp_instance(const matrix4x4& a, const matrix4x4& b, float t) noexcept
+	{
+		return a + (b - a) * t;
+	}
+
+	inline constexpr instance_record lerp_instance(const instance_record& a, const instance_record& b, float t) noexcept
+	{
+		instance_record result{};
+		for(auto i = 0u; i < 4; ++i)
+		{
+			result.row_0[i] = a.row_0[i] + (b.row_0[i] - a.row_0[i]) * t;
+			result.row_1[i] = a.row_1[i] + (b.row_1[i] - a.row_1[i]) * t;
+			result.row_2[i] = a.row_2[i] + (b.row_2[i] - a.row_2[i]) * t;
+		}
+		return result;
+	}
+
+	/*
+		描画の抽出: world_transform と mesh_component を持つエンティティのワールド行列を
+		チャンク順に out へ詰め、書いた数を返す (out に入りきらない分は捨てる)
+	*/
+	size_t extract_instances(entity_world& world, gsl::span<matrix4x4> out);
+
+	/*
+		チャンク単位でジョブに分ける版 (各チャンクの書き込み先は先に累積和で決める)
+		チャンクの一覧と書き込み位置は scratch に置く (tick / フレームごとのアリーナを渡せばヒープに触れない)
+	*/
+	size_t extract_instances(entity_world& world, job_system& jobs, gsl::span<matrix4x4> out, std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
+
+	// StructuredBuffer 用に 3x4 へ詰めて書き出す版
+	size_t extract_instances(entity_world& world, gsl::span<instance_record> out);
+	size_t extract_instances(entity_world& world, job_system& jobs, gsl::span<instance_record> out, std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
+}
\ No newline at end of file
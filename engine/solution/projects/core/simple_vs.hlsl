@@ -17,8 +17,7 @@ struct vs_output
 
 cbuffer transform : register(b0)
 {
-    float4x4 view : packoffset(c0);
-    float4x4 proj : packoffset(c4);
+    float4x4 view_proj : packoffset(c0);
 }
 
 vs_output main(vs_input input)
@@ -27,8 +26,7 @@ vs_output main(vs_input input)
 
     float4 local_pos = float4(input.position, 1.0f);
     float4 world_pos = mul(transpose(float4x4(input.world_0, input.world_1, input.world_2, input.world_3)), local_pos);
-    float4 view_pos = mul(view, world_pos);
-    float4 proj_pos = mul(proj, view_pos);
+    float4 proj_pos = mul(view_proj, world_pos);
     
     output.position = proj_pos;
     output.color = input.color;
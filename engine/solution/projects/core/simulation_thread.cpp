@@ -0,0 +1,62 @@
+﻿#include "pch.hpp"
+#include "profiler.hpp"
+#include "frame_clock.hpp"
+#include "simulation_thread.hpp"
+
+namespace core
+{
+	simulation_thread::simulation_thread(double tick_rate, tick_function func, clock_source& clock)
+		: m_func(std::move(func))
+		, m_tick_rate(tick_rate)
+		, m_period(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(1.0 / tick_rate)))
+		, m_clock(&clock)
+	{
+		Expects(m_func != nullptr);
+		Expects(tick_rate > 0.0);
+		Expects(m_period.count() > 0);
+
+		// メンバーが揃ってから動かす
+		m_thread = std::thread([this] { run(); });
+	}
+
+	simulation_thread::~simulation_thread()
+	{
+		stop();
+	}
+
+	void simulation_thread::stop()
+	{
+		m_exit.store(true, std::memory_order_release);
+		m_clock->wake();
+
+		if(m_thread.joinable()) m_thread.join();
+	}
+
+	void simulation_thread::run()
+	{
+		PROFILE_THREAD("simulation");
+
+		const auto& delta = 1.0 / m_tick_rate;
+		fixed_timestep timestep(m_period, MAX_CATCH_UP);
+		auto last = m_clock->now();
+
+		for(uint64_t tick = 0;;)
+		{
+			// 遅れすぎた分は fixed_timestep が捨てる (描画や OS に止められた後にまとめて回さない)
+			const auto& now = m_clock->now();
+			const auto& steps = timestep.advance(now - last);
+			last = now;
+			m_dropped.store(timestep.dropped().count(), std::memory_order_release);
+
+			for(auto i = 0u; i < steps; ++i, ++tick)
+			{
+				PROFILE_SCOPE("tick");
+				m_func(tick, delta);
+				m_ticks.store(tick + 1, std::memory_order_release);
+			}
+
+			// tick にかかった時間も含めて、次の区切りまで待つ
+			if(m_clock->wait_until(last + timestep.until_next(), m_exit)) break;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+﻿#pragma once
+
+namespace core
+{
+	/*
+		一定の間隔で tick 関数を呼び続けるスレッド (描画とは別に進むシミュレーション用)
+
+		・tick は tick_rate 回 / 秒を目標に呼ぶ。経過時間を fixed_timestep にためて、たまった回数だけ続けて呼ぶ
+		・1回に MAX_CATCH_UP 回分より遅れていたら、それを超える分は捨てる (追いつこうとして更に遅れない)
+		・時刻は clock から読み、次の区切りまで clock で待つ (manual_clock を渡すと advance() した分だけ進み、実時間では待たない)
+		・結果を描画側へ渡すときは triple_buffer を使う (描画が止まってもこちらは待たない)
+	*/
+	class simulation_thread
+	{
+	public:
+		// tick: 0 からの通し番号, delta: 1 tick の秒数 (常に同じ値)
+		using tick_function = std::function<void(uint64_t tick, double delta)>;
+
+		static constexpr uint32_t MAX_CATCH_UP = 5;
+
+	public:
+		simulation_thread(double tick_rate, tick_function func, clock_source& clock = steady_clock_source::get());
+		~simulation_thread();
+
+		simulation_thread(const simulation_thread&) = delete;
+		simulation_thread& operator=(const simulation_thread&) = delete;
+
+	public:
+		// 実行中の tick が終わるのを待って止める (何度呼んでもよい)
+		void stop();
+
+	public:
+		inline uint64_t tick_count() const noexcept { return m_ticks.load(std::memory_order_acquire); }
+		inline double tick_rate() const noexcept { return m_tick_rate; }
+
+		// 間に合わずに捨てた時間
+		inline std::chrono::nanoseconds dropped() const noexcept { return std::chrono::nanoseconds(m_dropped.load(std::memory_order_acquire)); }
+
+	private:
+		void run();
+
+	private:
+		tick_function m_func;
+		double m_tick_rate;
+		std::chrono::nanoseconds m_period;
+		gsl::not_null<clock_source*> m_clock;
+
+		std::atomic<uint64_t> m_ticks = 0;
+		std::atomic<int64_t> m_dropped = 0;
+
+		std::atomic<bool> m_exit = false;
+
+		std::thread m_thread;
+	};
+}
\ No newline at end of file
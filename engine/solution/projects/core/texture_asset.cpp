@@ -0,0 +1,114 @@
+﻿#include "include.hpp"
+
+namespace
+{
+	inline constexpr uint64_t align_up(uint64_t value, uint64_t alignment) noexcept
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	/*  ミップ1段のブロック配置  */
+	inline core::texture_asset_mip describe_mip(uint32_t block_bytes, uint32_t width, uint32_t height, uint32_t mip) noexcept
+	{
+		core::texture_asset_mip desc{};
+		desc.width = std::max(width >> mip, 1u);
+		desc.height = std::max(height >> mip, 1u);
+		desc.row_pitch = core::bc_blocks(desc.width) * block_bytes;
+		desc.row_count = core::bc_blocks(desc.height);
+		desc.size = uint64_t(desc.row_pitch) * desc.row_count;
+		return desc;
+	}
+}
+
+namespace core
+{
+	bool texture_asset::open(const std::string& path)
+	{
+		m_header = nullptr;
+		m_file = mapped_file(path);
+
+		if(!m_file.is_open()) return false;
+		if(m_file.size() < sizeof(texture_asset_header)) return false;
+
+		const auto* header = reinterpret_cast<const texture_asset_header*>(m_file.data().data());
+
+		/*  ヘッダの検証  */
+		if(header->magic != TEXTURE_ASSET_MAGIC) return false;
+		if(header->version != TEXTURE_ASSET_VERSION) return false;
+		if(bc_block_bytes(header->format) == 0) return false;
+		if(header->mip_count == 0 || header->mip_count > MAX_TEXTURE_MIPS) return false;
+		if(header->mip_tail_start > header->mip_count) return false;
+
+		/*  ミップがファイル内に収まり、整列しているか  */
+		for(auto i = 0u; i < header->mip_count; ++i)
+		{
+			const auto& mip = header->mips.at(i);
+			if(mip.offset % TEXTURE_ASSET_ALIGNMENT != 0) return false;
+			if(mip.offset > m_file.size() || mip.size > m_file.size() - mip.offset) return false;
+			if(uint64_t(mip.row_pitch) * mip.row_count != mip.size) return false;
+		}
+
+		m_header = header;
+		return true;
+	}
+
+	std::vector<uint64_t> texture_asset::mip_bytes() const
+	{
+		std::vector<uint64_t> bytes(m_header->mip_count);
+		for(auto i = 0u; i < bytes.size(); ++i) bytes.at(i) = m_header->mips.at(i).size;
+		return bytes;
+	}
+
+	bool write_texture_asset(const std::string& path, DXGI_FORMAT format, uint32_t width, uint32_t height, gsl::span<const gsl::span<const std::byte>> mips)
+	{
+		const auto& block_bytes = bc_block_bytes(format);
+		Expects(block_bytes != 0);
+		Expects(0 < mips.size() && mips.size() <= MAX_TEXTURE_MIPS);
+
+		texture_asset_header header{};
+		header.magic = TEXTURE_ASSET_MAGIC;
+		header.version = TEXTURE_ASSET_VERSION;
+		header.format = format;
+		header.width = width;
+		header.height = height;
+		header.mip_count = gsl::narrow<uint32_t>(mips.size());
+		header.mip_tail_start = header.mip_count;
+
+		/*  ミップの配置  */
+		auto offset = align_up(sizeof(texture_asset_header), TEXTURE_ASSET_ALIGNMENT);
+		for(auto i = 0u; i < header.mip_count; ++i)
+		{
+			auto desc = describe_mip(block_bytes, width, height, i);
+			if(desc.size != mips[i].size()) return false;
+
+			desc.offset = offset;
+			header.mips.at(i) = desc;
+			offset = align_up(offset + desc.size, TEXTURE_ASSET_ALIGNMENT);
+
+			// TEXTURE_MIP_TAIL_BYTES 以下になった最初の段からがミップテール
+			if(header.mip_tail_start == header.mip_count && desc.size <= TEXTURE_MIP_TAIL_BYTES) header.mip_tail_start = i;
+		}
+
+		/*  書き出し  */
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if(!file) return false;
+
+		constexpr std::array<char, TEXTURE_ASSET_ALIGNMENT> padding = {};
+		auto write_position = uint64_t(0);
+
+		auto write = [&](const void* data, uint64_t size)
+		{
+			file.write(static_cast<const char*>(data), gsl::narrow<std::streamsize>(size));
+			write_position += size;
+		};
+
+		write(&header, sizeof(header));
+		for(auto i = 0u; i < header.mip_count; ++i)
+		{
+			write(padding.data(), header.mips.at(i).offset - write_position);
+			write(mips[i].data(), mips[i].size());
+		}
+
+		return file.good();
+	}
+}
\ No newline at end of file
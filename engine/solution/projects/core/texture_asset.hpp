@@ -0,0 +1,110 @@
+﻿#pragma once
+#include "file_mapping.hpp"
+#include "texture_residency.hpp"
+
+/*
+	ブロック圧縮テクスチャ (.tex)
+
+	[header][mip 0][mip 1]...[mip n-1]
+	各ミップは TEXTURE_ASSET_ALIGNMENT 境界に置き、行ピッチは圧縮ブロック単位で詰める
+	ミップはファイルをマップしたまま必要になった段だけ GPU に転送する
+*/
+
+namespace core
+{
+	inline constexpr uint32_t TEXTURE_ASSET_MAGIC = 0x30584554u;		// "TEX0"
+	inline constexpr uint32_t TEXTURE_ASSET_VERSION = 1u;
+	inline constexpr uint64_t TEXTURE_ASSET_ALIGNMENT = 512u;		// D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+	inline constexpr uint64_t TEXTURE_MIP_TAIL_BYTES = 64u * 1024u;	// これ以下のミップはまとめて常駐させる
+
+	struct texture_asset_mip
+	{
+		uint64_t offset;
+		uint64_t size;
+		uint32_t width;
+		uint32_t height;
+		uint32_t row_pitch;
+		uint32_t row_count;		// ブロック行の数
+	};
+
+	struct texture_asset_header
+	{
+		uint32_t magic;
+		uint32_t version;
+		DXGI_FORMAT format;
+		uint32_t width;
+		uint32_t height;
+		uint32_t mip_count;
+		uint32_t mip_tail_start;
+		uint32_t reserved;
+
+		std::array<texture_asset_mip, MAX_TEXTURE_MIPS> mips;
+	};
+
+	/*  -----  BC フォーマット  -----------------------------------  */
+
+	// 4x4 ブロック1つのバイト数 (BC 以外は 0)
+	inline constexpr uint32_t bc_block_bytes(DXGI_FORMAT format) noexcept
+	{
+		switch(format)
+		{
+			case DXGI_FORMAT_BC1_TYPELESS:
+			case DXGI_FORMAT_BC1_UNORM:
+			case DXGI_FORMAT_BC1_UNORM_SRGB:
+			case DXGI_FORMAT_BC4_TYPELESS:
+			case DXGI_FORMAT_BC4_UNORM:
+			case DXGI_FORMAT_BC4_SNORM:
+				return 8;
+
+			case DXGI_FORMAT_BC2_TYPELESS:
+			case DXGI_FORMAT_BC2_UNORM:
+			case DXGI_FORMAT_BC2_UNORM_SRGB:
+			case DXGI_FORMAT_BC3_TYPELESS:
+			case DXGI_FORMAT_BC3_UNORM:
+			case DXGI_FORMAT_BC3_UNORM_SRGB:
+			case DXGI_FORMAT_BC5_TYPELESS:
+			case DXGI_FORMAT_BC5_UNORM:
+			case DXGI_FORMAT_BC5_SNORM:
+			case DXGI_FORMAT_BC6H_TYPELESS:
+			case DXGI_FORMAT_BC6H_UF16:
+			case DXGI_FORMAT_BC6H_SF16:
+			case DXGI_FORMAT_BC7_TYPELESS:
+			case DXGI_FORMAT_BC7_UNORM:
+			case DXGI_FORMAT_BC7_UNORM_SRGB:
+				return 16;
+
+			default:
+				return 0;
+		}
+	}
+
+	inline constexpr uint32_t bc_blocks(uint32_t texels) noexcept { return std::max((texels + 3u) / 4u, 1u); }
+
+	/*  マップしたファイルへのビュー  */
+	class texture_asset
+	{
+	public:
+		texture_asset() noexcept = default;
+
+	public:
+		bool open(const std::string& path);
+
+	public:
+		inline const texture_asset_header& header() const noexcept { return *m_header; }
+		inline gsl::span<const std::byte> mip_data(uint32_t mip) const
+		{
+			const auto& range = m_header->mips.at(mip);
+			return m_file.data().subspan(range.offset, range.size);
+		}
+
+		// texture_residency::add にそのまま渡せるミップごとのサイズ
+		std::vector<uint64_t> mip_bytes() const;
+
+	private:
+		mapped_file m_file;
+		const texture_asset_header* m_header = nullptr;
+	};
+
+	/*  圧縮済みのミップチェーンを書き出す (mips[0] が最大のミップ)  */
+	bool write_texture_asset(const std::string& path, DXGI_FORMAT format, uint32_t width, uint32_t height, gsl::span<const gsl::span<const std::byte>> mips);
+}
\ No newline at end of file
@@ -0,0 +1,214 @@
+﻿#include "pch.hpp"
+#include "texture_residency.hpp"
+
+namespace core
+{
+	texture_residency::texture_residency(gsl::not_null<memory_budget_source*> budget)
+		: m_budget(budget)
+	{
+	}
+
+	texture_id texture_residency::add(gsl::span<const uint64_t> mip_bytes, uint32_t mip_tail_start)
+	{
+		Expects(0 < mip_bytes.size() && mip_bytes.size() <= MAX_TEXTURE_MIPS);
+		Expects(mip_tail_start <= mip_bytes.size());
+
+		texture_id id{};
+		if(!m_free.empty())
+		{
+			id = m_free.back();
+			m_free.pop_back();
+		}
+		else
+		{
+			id = gsl::narrow<texture_id>(m_textures.size());
+			m_textures.emplace_back();
+		}
+
+		auto& texture = m_textures.at(id);
+		texture = texture_state{};
+		std::copy(mip_bytes.begin(), mip_bytes.end(), texture.mip_bytes.begin());
+		texture.mip_count = gsl::narrow<uint32_t>(mip_bytes.size());
+		texture.mip_tail_start = mip_tail_start;
+		texture.resident_mip = mip_tail_start;
+		texture.requested_mip = mip_tail_start;
+		texture.loading_mip = texture.mip_count;
+		texture.prev = INVALID_TEXTURE;
+		texture.next = INVALID_TEXTURE;
+		texture.alive = true;
+
+		// ミップテールは常駐させる
+		for(auto mip = mip_tail_start; mip < texture.mip_count; ++mip) m_usage += texture.mip_bytes.at(mip);
+
+		touch(id);
+
+		return id;
+	}
+
+	void texture_residency::remove(texture_id id)
+	{
+		auto& texture = m_textures.at(id);
+		Expects(texture.alive);
+
+		for(auto mip = texture.resident_mip; mip < texture.mip_count; ++mip) m_usage -= texture.mip_bytes.at(mip);
+		if(texture.loading_mip < texture.mip_count) m_loading -= texture.mip_bytes.at(texture.loading_mip);
+
+		unlink(id);
+		texture.alive = false;
+		m_free.push_back(id);
+	}
+
+	void texture_residency::request(texture_id id, uint32_t mip, uint64_t frame)
+	{
+		auto& texture = m_textures.at(id);
+		Expects(texture.alive);
+
+		const auto clamped = std::min(mip, texture.mip_tail_start);
+
+		// フレームの最初の通知で値を置き換え、以降は最小値を取る
+		texture.requested_mip = texture.last_used_frame == frame ? std::min(texture.requested_mip, clamped) : clamped;
+		texture.last_used_frame = frame;
+
+		touch(id);
+	}
+
+	void texture_residency::update(uint64_t frame, std::vector<residency_command>& out, uint32_t max_loads)
+	{
+		/*  予算が減っていれば先に追い出す  */
+		while(m_usage + m_loading > available_budget())
+		{
+			if(!evict_one(frame, out)) break;
+		}
+
+		/*  足りないミップを持つテクスチャを集める (直近で使われたもののみ)  */
+		std::vector<texture_id> candidates;
+		for(auto id = 0u; id < m_textures.size(); ++id)
+		{
+			const auto& texture = m_textures.at(id);
+			if(!texture.alive) continue;
+			if(texture.loading_mip < texture.mip_count) continue;
+			if(texture.requested_mip >= texture.resident_mip) continue;
+			if(texture.last_used_frame + 1 < frame) continue;
+
+			candidates.push_back(id);
+		}
+
+		// 足りない段数が多いもの、最近使われたものを優先
+		std::sort(candidates.begin(), candidates.end(), [this](texture_id l, texture_id r)
+		{
+			const auto& a = m_textures.at(l);
+			const auto& b = m_textures.at(r);
+			const auto& gap_a = a.resident_mip - a.requested_mip;
+			const auto& gap_b = b.resident_mip - b.requested_mip;
+			return gap_a != gap_b ? gap_a > gap_b : a.last_used_frame > b.last_used_frame;
+		});
+
+		uint32_t loads = 0;
+		for(const auto& id : candidates)
+		{
+			if(loads >= max_loads) break;
+
+			auto& texture = m_textures.at(id);
+			const auto& mip = texture.resident_mip - 1;
+			const auto& bytes = texture.mip_bytes.at(mip);
+
+			// 予算に収まるまで他のテクスチャを追い出す (自分のミップを追い出すと mip より下が抜けるので除く)
+			auto fits = true;
+			while(m_usage + m_loading + bytes > available_budget())
+			{
+				if(!evict_one(frame, out, id))
+				{
+					fits = false;
+					break;
+				}
+			}
+			if(!fits) break;
+
+			texture.loading_mip = mip;
+			m_loading += bytes;
+			out.push_back(residency_command{ id, mip, residency_action::load });
+			++loads;
+		}
+	}
+
+	void texture_residency::on_loaded(texture_id id, uint32_t mip)
+	{
+		auto& texture = m_textures.at(id);
+
+		// 読み込み中に削除・再登録されたものは無視する
+		if(!texture.alive || texture.loading_mip != mip) return;
+
+		m_loading -= texture.mip_bytes.at(mip);
+		m_usage += texture.mip_bytes.at(mip);
+		texture.resident_mip = mip;
+		texture.loading_mip = texture.mip_count;
+	}
+
+	uint64_t texture_residency::available_budget() const
+	{
+		const auto& info = m_budget->query();
+
+		// プロセスの使用量には自分の分も含まれているので差し引く
+		const auto& others = info.usage > m_usage ? info.usage - m_usage : 0;
+		return info.budget > others ? info.budget - others : 0;
+	}
+
+	void texture_residency::touch(texture_id id)
+	{
+		if(m_lru_head == id) return;
+
+		unlink(id);
+
+		auto& texture = m_textures.at(id);
+		texture.prev = INVALID_TEXTURE;
+		texture.next = m_lru_head;
+
+		if(m_lru_head != INVALID_TEXTURE) m_textures.at(m_lru_head).prev = id;
+		m_lru_head = id;
+
+		if(m_lru_tail == INVALID_TEXTURE) m_lru_tail = id;
+	}
+
+	void texture_residency::unlink(texture_id id)
+	{
+		auto& texture = m_textures.at(id);
+
+		const auto& linked = texture.prev != INVALID_TEXTURE || texture.next != INVALID_TEXTURE || m_lru_head == id;
+		if(!linked) return;
+
+		if(texture.prev != INVALID_TEXTURE) m_textures.at(texture.prev).next = texture.next;
+		else m_lru_head = texture.next;
+
+		if(texture.next != INVALID_TEXTURE) m_textures.at(texture.next).prev = texture.prev;
+		else m_lru_tail = texture.prev;
+
+		texture.prev = INVALID_TEXTURE;
+		texture.next = INVALID_TEXTURE;
+	}
+
+	bool texture_residency::evict_one(uint64_t frame, std::vector<residency_command>& out, texture_id exclude)
+	{
+		// 1周目: このフレームで使われていないもの / 2周目: 要求より細かいミップを持っているもの
+		for(auto pass = 0u; pass < 2; ++pass)
+		{
+			for(auto id = m_lru_tail; id != INVALID_TEXTURE; id = m_textures.at(id).prev)
+			{
+				auto& texture = m_textures.at(id);
+
+				if(id == exclude) continue;
+				if(texture.resident_mip >= texture.mip_tail_start) continue;
+				if(texture.loading_mip < texture.mip_count) continue;
+				if(pass == 0 && texture.last_used_frame >= frame) continue;
+				if(pass == 1 && texture.resident_mip >= texture.requested_mip) continue;
+
+				m_usage -= texture.mip_bytes.at(texture.resident_mip);
+				out.push_back(residency_command{ id, texture.resident_mip, residency_action::evict });
+				++texture.resident_mip;
+
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
\ No newline at end of file
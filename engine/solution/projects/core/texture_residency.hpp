@@ -0,0 +1,90 @@
+﻿#pragma once
+#include "memory_budget.hpp"
+
+namespace core
+{
+	using texture_id = uint32_t;
+
+	inline constexpr texture_id INVALID_TEXTURE = std::numeric_limits<texture_id>::max();
+	inline constexpr uint32_t MAX_TEXTURE_MIPS = 16u;
+
+	enum class residency_action : uint8_t
+	{
+		load,
+		evict,
+	};
+
+	/*  update() が出力する命令 (実際のコピー・解放は呼び出し側が行う)  */
+	struct residency_command
+	{
+		texture_id texture;
+		uint32_t mip;
+		residency_action action;
+	};
+
+	/*
+		テクスチャのミップ単位の常駐管理
+
+		・mip_tail_start 以降 (小さいミップ) は登録時から常に常駐
+		・request() で毎フレーム必要なミップを通知し、足りないミップを1段ずつ読み込む
+		・予算を超える場合は、最近使われていないテクスチャの一番大きいミップから捨てる
+	*/
+	class texture_residency
+	{
+	public:
+		explicit texture_residency(gsl::not_null<memory_budget_source*> budget);
+
+	public:
+		texture_id add(gsl::span<const uint64_t> mip_bytes, uint32_t mip_tail_start);
+		void remove(texture_id id);
+
+		// このフレームで必要なミップ (小さいほど高解像度) を通知する。同じフレームで複数回呼ぶと最小値を採用
+		void request(texture_id id, uint32_t mip, uint64_t frame);
+
+		// 読み込み・追い出しの命令を作る。読み込みは1フレームに max_loads 件まで
+		void update(uint64_t frame, std::vector<residency_command>& out, uint32_t max_loads);
+
+		// load 命令の完了を通知する
+		void on_loaded(texture_id id, uint32_t mip);
+
+	public:
+		inline uint32_t resident_mip(texture_id id) const { return m_textures.at(id).resident_mip; }
+		inline uint64_t usage() const noexcept { return m_usage; }
+		uint64_t available_budget() const;
+
+	private:
+		struct texture_state
+		{
+			std::array<uint64_t, MAX_TEXTURE_MIPS> mip_bytes;
+			uint32_t mip_count;
+			uint32_t mip_tail_start;
+			uint32_t resident_mip;		// 常駐している最も大きいミップ
+			uint32_t requested_mip;
+			uint32_t loading_mip;		// 読み込み中のミップ (なければ mip_count)
+			uint64_t last_used_frame;
+
+			// LRU リスト (先頭が最近使ったもの)
+			texture_id prev;
+			texture_id next;
+
+			bool alive;
+		};
+
+	private:
+		void touch(texture_id id);
+		void unlink(texture_id id);
+		// exclude は追い出さない (読み込もうとしているテクスチャ自身)
+		bool evict_one(uint64_t frame, std::vector<residency_command>& out, texture_id exclude = INVALID_TEXTURE);
+
+	private:
+		memory_budget_source* m_budget;
+		std::vector<texture_state> m_textures;
+		std::vector<texture_id> m_free;
+
+		texture_id m_lru_head = INVALID_TEXTURE;
+		texture_id m_lru_tail = INVALID_TEXTURE;
+
+		uint64_t m_usage = 0;
+		uint64_t m_loading = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,244 @@
+﻿#include "pch.hpp"
+#include "tlsf_allocator.hpp"
+
+namespace core
+{
+	tlsf_allocator::tlsf_allocator(uint64_t capacity, uint64_t granularity)
+	{
+		Expects(std::has_single_bit(granularity));
+		Expects(capacity >= granularity);
+
+		m_granularity_shift = gsl::narrow_cast<uint32_t>(std::countr_zero(granularity));
+		m_capacity = capacity >> m_granularity_shift;
+
+		for(auto& heads : m_heads) heads.fill(INVALID_TLSF_BLOCK);
+
+		/*  範囲全体を1つの空きブロックにする  */
+		const auto& index = create_node();
+		m_blocks.at(index) = block{ 0, m_capacity, 0, INVALID_TLSF_BLOCK, INVALID_TLSF_BLOCK, INVALID_TLSF_BLOCK, INVALID_TLSF_BLOCK, true };
+		insert_free(index);
+	}
+
+	tlsf_allocation tlsf_allocator::allocate(uint64_t size, uint64_t alignment, uint64_t user_data)
+	{
+		Expects(size > 0);
+		Expects(std::has_single_bit(alignment));
+
+		const auto& granularity_mask = (uint64_t(1) << m_granularity_shift) - 1;
+		const auto& units = (size + granularity_mask) >> m_granularity_shift;
+		const auto align = std::max(alignment >> m_granularity_shift, uint64_t(1));
+
+		// 整列で前を削っても収まるように、整列の分だけ大きいブロックを探す
+		const auto& index = find_free(units + align - 1);
+		if(index == INVALID_TLSF_BLOCK) return INVALID_TLSF_ALLOCATION;
+
+		remove_free(index);
+
+		auto current = index;
+		const auto offset = m_blocks.at(current).offset;
+		const auto& aligned = (offset + align - 1) & ~(align - 1);
+
+		/*  前の余り: 見つけたブロックを空きのまま残し、後ろに新しいノードを作る  */
+		if(aligned != offset)
+		{
+			const auto& next = create_node();
+			auto& front = m_blocks.at(current);
+
+			m_blocks.at(next) = block{ aligned, front.size - (aligned - offset), 0, current, front.next_physical, INVALID_TLSF_BLOCK, INVALID_TLSF_BLOCK, false };
+			if(front.next_physical != INVALID_TLSF_BLOCK) m_blocks.at(front.next_physical).prev_physical = next;
+			front.next_physical = next;
+			front.size = aligned - offset;
+
+			insert_free(current);
+			current = next;
+		}
+
+		/*  後ろの余りを空きブロックとして切り出す  */
+		if(m_blocks.at(current).size > units)
+		{
+			const auto& next = create_node();
+			auto& used = m_blocks.at(current);
+
+			m_blocks.at(next) = block{ used.offset + units, used.size - units, 0, current, used.next_physical, INVALID_TLSF_BLOCK, INVALID_TLSF_BLOCK, true };
+			if(used.next_physical != INVALID_TLSF_BLOCK) m_blocks.at(used.next_physical).prev_physical = next;
+			used.next_physical = next;
+			used.size = units;
+
+			insert_free(next);
+		}
+
+		auto& used = m_blocks.at(current);
+		used.free = false;
+		used.user_data = user_data;
+
+		m_used += units;
+		++m_allocation_count;
+
+		return tlsf_allocation{ used.offset << m_granularity_shift, used.size << m_granularity_shift, current };
+	}
+
+	void tlsf_allocator::free(const tlsf_allocation& allocation)
+	{
+		Expects(allocation.valid());
+
+		auto current = allocation.block;
+		Expects(!m_blocks.at(current).free);
+
+		m_used -= m_blocks.at(current).size;
+		--m_allocation_count;
+		m_blocks.at(current).free = true;
+
+		/*  後ろの空きブロックを取り込む  */
+		const auto next = m_blocks.at(current).next_physical;
+		if(next != INVALID_TLSF_BLOCK && m_blocks.at(next).free)
+		{
+			remove_free(next);
+
+			auto& merged = m_blocks.at(current);
+			merged.size += m_blocks.at(next).size;
+			merged.next_physical = m_blocks.at(next).next_physical;
+			if(merged.next_physical != INVALID_TLSF_BLOCK) m_blocks.at(merged.next_physical).prev_physical = current;
+
+			destroy_node(next);
+		}
+
+		/*  前の空きブロックに取り込まれる  */
+		const auto prev = m_blocks.at(current).prev_physical;
+		if(prev != INVALID_TLSF_BLOCK && m_blocks.at(prev).free)
+		{
+			remove_free(prev);
+
+			auto& merged = m_blocks.at(prev);
+			merged.size += m_blocks.at(current).size;
+			merged.next_physical = m_blocks.at(current).next_physical;
+			if(merged.next_physical != INVALID_TLSF_BLOCK) m_blocks.at(merged.next_physical).prev_physical = prev;
+
+			destroy_node(current);
+			current = prev;
+		}
+
+		insert_free(current);
+	}
+
+	tlsf_stats tlsf_allocator::get_stats() const
+	{
+		tlsf_stats stats{};
+		stats.capacity = capacity();
+		stats.used = used();
+		stats.allocations = m_allocation_count;
+
+		/*  最大の空きブロックは一番上のクラスのリストにある  */
+		if(m_fl_bitmap != 0)
+		{
+			const auto& fl = 63u - gsl::narrow_cast<uint32_t>(std::countl_zero(m_fl_bitmap));
+			const auto& sl = 31u - gsl::narrow_cast<uint32_t>(std::countl_zero(m_sl_bitmap.at(fl)));
+
+			for(auto i = m_heads.at(fl).at(sl); i != INVALID_TLSF_BLOCK; i = m_blocks.at(i).next_free)
+			{
+				stats.largest_free = std::max(stats.largest_free, m_blocks.at(i).size << m_granularity_shift);
+			}
+		}
+
+		for(const auto& node : m_blocks)
+		{
+			if(node.free && node.size > 0) ++stats.free_blocks;
+		}
+
+		return stats;
+	}
+
+	tlsf_allocator::size_class tlsf_allocator::mapping(uint64_t size) noexcept
+	{
+		// 小さいサイズは第1段 0 に 1 単位ずつ並べる
+		if(size < SL_COUNT) return size_class{ 0, gsl::narrow_cast<uint32_t>(size) };
+
+		const auto& msb = 63u - gsl::narrow_cast<uint32_t>(std::countl_zero(size));
+		return size_class{ msb - SL_LOG2 + 1, gsl::narrow_cast<uint32_t>(size >> (msb - SL_LOG2)) - SL_COUNT };
+	}
+
+	uint32_t tlsf_allocator::find_free(uint64_t size) const noexcept
+	{
+		/*  クラスの上端まで切り上げ、そのクラス以上のリストの先頭なら必ず収まる  */
+		auto rounded = size;
+		if(rounded >= SL_COUNT)
+		{
+			const auto& msb = 63u - gsl::narrow_cast<uint32_t>(std::countl_zero(rounded));
+			rounded += (uint64_t(1) << (msb - SL_LOG2)) - 1;
+		}
+		if(rounded < size) return INVALID_TLSF_BLOCK;
+
+		auto [fl, sl] = mapping(rounded);
+
+		auto sl_map = m_sl_bitmap.at(fl) & (~0u << sl);
+		if(sl_map == 0)
+		{
+			if(fl + 1 >= FL_COUNT) return INVALID_TLSF_BLOCK;
+
+			const auto& fl_map = m_fl_bitmap & (~uint64_t(0) << (fl + 1));
+			if(fl_map == 0) return INVALID_TLSF_BLOCK;
+
+			fl = gsl::narrow_cast<uint32_t>(std::countr_zero(fl_map));
+			sl_map = m_sl_bitmap.at(fl);
+		}
+
+		sl = gsl::narrow_cast<uint32_t>(std::countr_zero(sl_map));
+		return m_heads.at(fl).at(sl);
+	}
+
+	void tlsf_allocator::insert_free(uint32_t index)
+	{
+		auto& node = m_blocks.at(index);
+		const auto& [fl, sl] = mapping(node.size);
+		auto& head = m_heads.at(fl).at(sl);
+
+		node.prev_free = INVALID_TLSF_BLOCK;
+		node.next_free = head;
+		if(head != INVALID_TLSF_BLOCK) m_blocks.at(head).prev_free = index;
+		head = index;
+
+		m_fl_bitmap |= uint64_t(1) << fl;
+		m_sl_bitmap.at(fl) |= 1u << sl;
+	}
+
+	void tlsf_allocator::remove_free(uint32_t index)
+	{
+		auto& node = m_blocks.at(index);
+		const auto& [fl, sl] = mapping(node.size);
+
+		if(node.prev_free != INVALID_TLSF_BLOCK) m_blocks.at(node.prev_free).next_free = node.next_free;
+		else m_heads.at(fl).at(sl) = node.next_free;
+
+		if(node.next_free != INVALID_TLSF_BLOCK) m_blocks.at(node.next_free).prev_free = node.prev_free;
+
+		node.prev_free = INVALID_TLSF_BLOCK;
+		node.next_free = INVALID_TLSF_BLOCK;
+
+		/*  リストが空になったらビットを落とす  */
+		if(m_heads.at(fl).at(sl) == INVALID_TLSF_BLOCK)
+		{
+			m_sl_bitmap.at(fl) &= ~(1u << sl);
+			if(m_sl_bitmap.at(fl) == 0) m_fl_bitmap &= ~(uint64_t(1) << fl);
+		}
+	}
+
+	uint32_t tlsf_allocator::create_node()
+	{
+		if(!m_unused_nodes.empty())
+		{
+			const auto index = m_unused_nodes.back();
+			m_unused_nodes.pop_back();
+			return index;
+		}
+
+		m_blocks.emplace_back();
+		return gsl::narrow<uint32_t>(m_blocks.size() - 1);
+	}
+
+	void tlsf_allocator::destroy_node(uint32_t index)
+	{
+		// 統計で数えないようにサイズを 0 にしておく
+		m_blocks.at(index).size = 0;
+		m_blocks.at(index).free = true;
+		m_unused_nodes.push_back(index);
+	}
+}
\ No newline at end of file
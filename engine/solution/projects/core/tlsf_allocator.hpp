@@ -0,0 +1,122 @@
+﻿#pragma once
+
+/*
+	TLSF (Two-Level Segregated Fit) によるオフセット範囲の割り当て
+
+	・管理情報は範囲の外 (ノード配列) に持つので、GPU ヒープのような CPU から触れないメモリにも使える
+	・サイズを 2 段階 (2 の累乗 / その 32 分割) のクラスに分け、ビットマップで空きリストを探すため割り当て・解放とも O(1)
+	・隣接する空きブロックは解放時に必ず結合する
+*/
+
+namespace core
+{
+	inline constexpr uint32_t INVALID_TLSF_BLOCK = std::numeric_limits<uint32_t>::max();
+
+	struct tlsf_allocation
+	{
+		uint64_t offset;
+		uint64_t size;
+		uint32_t block;		// 解放に使うノード番号
+
+		inline bool valid() const noexcept { return block != INVALID_TLSF_BLOCK; }
+	};
+
+	inline constexpr tlsf_allocation INVALID_TLSF_ALLOCATION = { 0, 0, INVALID_TLSF_BLOCK };
+
+	struct tlsf_stats
+	{
+		uint64_t capacity;
+		uint64_t used;
+		uint64_t largest_free;		// 1回で割り当てられる最大サイズ
+		uint32_t allocations;
+		uint32_t free_blocks;
+	};
+
+	class tlsf_allocator
+	{
+	public:
+		static constexpr uint32_t SL_LOG2 = 5;
+		static constexpr uint32_t SL_COUNT = 1u << SL_LOG2;
+		static constexpr uint32_t FL_COUNT = 64;
+
+	public:
+		tlsf_allocator() noexcept = default;
+
+		// granularity は割り当ての最小単位 (2 の累乗)。サイズとオフセットは常にこの倍数になる
+		explicit tlsf_allocator(uint64_t capacity, uint64_t granularity = 1);
+
+	public:
+		// 割り当てられない場合は valid() == false を返す
+		tlsf_allocation allocate(uint64_t size, uint64_t alignment = 1, uint64_t user_data = 0);
+		void free(const tlsf_allocation& allocation);
+
+		tlsf_stats get_stats() const;
+
+		inline void set_user_data(const tlsf_allocation& allocation, uint64_t user_data) { m_blocks.at(allocation.block).user_data = user_data; }
+
+	public:
+		inline uint64_t capacity() const noexcept { return m_capacity << m_granularity_shift; }
+		inline uint64_t used() const noexcept { return m_used << m_granularity_shift; }
+		inline uint32_t allocation_count() const noexcept { return m_allocation_count; }
+		inline bool empty() const noexcept { return m_allocation_count == 0; }
+
+		// 使用中のブロックをオフセット順に列挙する (デフラグ用)
+		template<class F> void for_each_allocation(F&& func) const
+		{
+			if(m_blocks.empty()) return;
+
+			for(auto i = 0u; i != INVALID_TLSF_BLOCK; i = m_blocks.at(i).next_physical)
+			{
+				const auto& block = m_blocks.at(i);
+				if(block.free) continue;
+
+				func(tlsf_allocation{ block.offset << m_granularity_shift, block.size << m_granularity_shift, i }, block.user_data);
+			}
+		}
+
+	private:
+		/*  ノード 0 は常に先頭のブロック (結合時は低いアドレス側を残す)  */
+		struct block
+		{
+			uint64_t offset;
+			uint64_t size;
+			uint64_t user_data;
+
+			uint32_t prev_physical;
+			uint32_t next_physical;
+			uint32_t prev_free;
+			uint32_t next_free;
+
+			bool free;
+		};
+
+		struct size_class
+		{
+			uint32_t fl;
+			uint32_t sl;
+		};
+
+	private:
+		static size_class mapping(uint64_t size) noexcept;
+
+		uint32_t find_free(uint64_t size) const noexcept;
+		void insert_free(uint32_t index);
+		void remove_free(uint32_t index);
+
+		uint32_t create_node();
+		void destroy_node(uint32_t index);
+
+	private:
+		std::vector<block> m_blocks;
+		std::vector<uint32_t> m_unused_nodes;
+
+		uint64_t m_fl_bitmap = 0;
+		std::array<uint32_t, FL_COUNT> m_sl_bitmap = {};
+		std::array<std::array<uint32_t, SL_COUNT>, FL_COUNT> m_heads = {};
+
+		uint64_t m_capacity = 0;		// 以下すべて granularity 単位
+		uint64_t m_used = 0;
+		uint32_t m_granularity_shift = 0;
+		uint32_t m_allocation_count = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,269 @@
+﻿#include "include.hpp"
+
+namespace core
+{
+	transform_id transform_hierarchy::create(const matrix4x4& local, transform_id parent, uint32_t instance)
+	{
+		uint32_t index{};
+		if(!m_free_slots.empty())
+		{
+			index = m_free_slots.back();
+			m_free_slots.pop_back();
+		}
+		else
+		{
+			index = gsl::narrow<uint32_t>(m_slots.size());
+			Expects(index <= transform_id::INDEX_MASK);
+
+			m_slots.push_back(slot{ 0, 1, false });
+		}
+
+		auto& slot = m_slots.at(index);
+		slot.position = gsl::narrow<uint32_t>(m_parent.size());
+		slot.alive = true;
+
+		/*  末尾に追加する (親は必ず前にあるので順次更新は正しいが、深さごとの区切りは作り直す)  */
+		m_parent.push_back(parent.valid() ? position(parent) : NO_PARENT);
+		m_local.push_back(local);
+		m_world.push_back(local);
+		m_dirty.push_back(1);
+		m_instance.push_back(instance);
+		m_slot_of.push_back(index);
+
+		m_order_dirty = true;
+
+		return transform_id::make(index, slot.generation);
+	}
+
+	void transform_hierarchy::destroy(transform_id id)
+	{
+		if(!alive(id)) return;
+
+		m_slots.at(id.index()).alive = false;
+		m_order_dirty = true;
+
+		/*  子孫もすぐに alive() を false にする (配列から外すのは次の rebuild())  */
+		constexpr uint8_t unknown = 0;
+		constexpr uint8_t kept = 1;
+		constexpr uint8_t removed = 2;
+
+		std::vector<uint8_t> state(m_parent.size(), unknown);
+		std::vector<uint32_t> stack;
+
+		for(size_t i = 0; i < m_parent.size(); ++i)
+		{
+			// 状態の分かっている祖先か、削除されたノードまで辿ってから戻りながら決める
+			auto node = gsl::narrow_cast<uint32_t>(i);
+			while(state.at(node) == unknown)
+			{
+				stack.push_back(node);
+
+				const auto& parent = m_parent.at(node);
+				if(!m_slots.at(m_slot_of.at(node)).alive || parent == NO_PARENT) break;
+				node = parent;
+			}
+
+			while(!stack.empty())
+			{
+				const auto current = stack.back();
+				stack.pop_back();
+
+				const auto& parent = m_parent.at(current);
+				if(!m_slots.at(m_slot_of.at(current)).alive) state.at(current) = removed;
+				else if(parent == NO_PARENT) state.at(current) = kept;
+				else state.at(current) = state.at(parent);
+			}
+
+			if(state.at(i) == removed) m_slots.at(m_slot_of.at(i)).alive = false;
+		}
+	}
+
+	void transform_hierarchy::set_parent(transform_id id, transform_id parent)
+	{
+		const auto& pos = position(id);
+		const auto& parent_pos = parent.valid() ? position(parent) : NO_PARENT;
+
+		/*  自分の子孫を親にはできない  */
+		for(auto p = parent_pos; p != NO_PARENT; p = m_parent.at(p))
+		{
+			Expects(p != pos);
+		}
+
+		m_parent.at(pos) = parent_pos;
+		m_dirty.at(pos) = 1;
+		m_order_dirty = true;
+	}
+
+	void transform_hierarchy::set_local(transform_id id, const matrix4x4& local)
+	{
+		const auto& pos = position(id);
+		m_local.at(pos) = local;
+		m_dirty.at(pos) = 1;
+	}
+
+	bool transform_hierarchy::alive(transform_id id) const noexcept
+	{
+		if(!id.valid() || id.index() >= m_slots.size()) return false;
+
+		const auto& slot = m_slots[id.index()];
+		return slot.alive && slot.generation == id.generation();
+	}
+
+	const matrix4x4& transform_hierarchy::local(transform_id id) const
+	{
+		return m_local.at(position(id));
+	}
+
+	const matrix4x4& transform_hierarchy::world(transform_id id) const
+	{
+		return m_world.at(position(id));
+	}
+
+	void transform_hierarchy::update(gsl::span<matrix4x4> instances, job_system* jobs)
+	{
+		if(m_order_dirty) rebuild();
+
+		/*  親の深さの処理が終わってから次の深さへ  */
+		for(size_t level = 0; level + 1 < m_level_offsets.size(); ++level)
+		{
+			const auto& begin = m_level_offsets.at(level);
+			const auto& end = m_level_offsets.at(level + 1);
+
+			if(jobs == nullptr)
+			{
+				update_range(begin, end, instances);
+				continue;
+			}
+
+			constexpr size_t grain = 1024;
+			jobs->parallel_for(end - begin, grain, [&](size_t first, size_t last)
+			{
+				update_range(begin + first, begin + last, instances);
+			});
+		}
+
+		// 子が親のフラグを読み終えるまで下ろせないので、最後にまとめて下ろす
+		std::fill(m_dirty.begin(), m_dirty.end(), uint8_t(0));
+	}
+
+	void transform_hierarchy::update_range(size_t begin, size_t end, gsl::span<matrix4x4> instances)
+	{
+		for(auto i = begin; i < end; ++i)
+		{
+			const auto& parent = m_parent[i];
+
+			// 親が更新されていれば自分も更新する (親のフラグは前の深さで確定している)
+			if(parent != NO_PARENT) m_dirty[i] |= m_dirty[parent];
+			if(m_dirty[i] == 0) continue;
+
+			if(parent == NO_PARENT) m_world[i] = m_local[i];
+			else m_world[i] = m_local[i] * m_world[parent];
+
+			const auto& instance = m_instance[i];
+			if(instance < instances.size()) instances[instance] = m_world[i];
+		}
+	}
+
+	void transform_hierarchy::rebuild()
+	{
+		const auto& count = m_parent.size();
+
+		/*  深さを求める (削除されたノードの子孫は削除扱い)  */
+		constexpr uint32_t unknown = std::numeric_limits<uint32_t>::max();
+		constexpr uint32_t removed = unknown - 1;
+
+		std::vector<uint32_t> depth(count, unknown);
+		std::vector<uint32_t> stack;
+
+		for(size_t i = 0; i < count; ++i)
+		{
+			// 深さの分かっている祖先まで辿ってから戻りながら決める
+			auto node = gsl::narrow_cast<uint32_t>(i);
+			while(depth.at(node) == unknown)
+			{
+				stack.push_back(node);
+
+				const auto& parent = m_parent.at(node);
+				if(!m_slots.at(m_slot_of.at(node)).alive || parent == NO_PARENT) break;
+				node = parent;
+			}
+
+			while(!stack.empty())
+			{
+				const auto current = stack.back();
+				stack.pop_back();
+
+				const auto& parent = m_parent.at(current);
+				if(!m_slots.at(m_slot_of.at(current)).alive) depth.at(current) = removed;
+				else if(parent == NO_PARENT) depth.at(current) = 0;
+				else depth.at(current) = depth.at(parent) == removed ? removed : depth.at(parent) + 1;
+			}
+		}
+
+		/*  深さごとに数え、安定な計数ソートで並べ替える  */
+		std::vector<uint32_t> counts;
+		for(const auto& d : depth)
+		{
+			if(d == removed) continue;
+			if(d >= counts.size()) counts.resize(d + 1, 0);
+			++counts.at(d);
+		}
+
+		m_level_offsets.assign(counts.size() + 1, 0);
+		for(size_t d = 0; d < counts.size(); ++d) m_level_offsets.at(d + 1) = m_level_offsets.at(d) + counts.at(d);
+
+		std::vector<uint32_t> new_position(count, NO_PARENT);
+		{
+			auto cursor = m_level_offsets;
+			for(size_t i = 0; i < count; ++i)
+			{
+				if(depth.at(i) != removed) new_position.at(i) = cursor.at(depth.at(i))++;
+			}
+		}
+
+		const auto& alive_count = m_level_offsets.back();
+
+		std::vector<uint32_t> parent(alive_count);
+		std::vector<matrix4x4> local(alive_count);
+		std::vector<matrix4x4> world(alive_count);
+		std::vector<uint8_t> dirty(alive_count);
+		std::vector<uint32_t> instance(alive_count);
+		std::vector<uint32_t> slot_of(alive_count);
+
+		for(size_t i = 0; i < count; ++i)
+		{
+			const auto& slot_index = m_slot_of.at(i);
+			auto& slot = m_slots.at(slot_index);
+
+			/*  削除されたノードのスロットは世代を進めて再利用する  */
+			if(depth.at(i) == removed)
+			{
+				slot.alive = false;
+				slot.generation = (slot.generation + 1) & transform_id::GENERATION_MASK;
+				if(slot.generation == 0) slot.generation = 1;
+
+				m_free_slots.push_back(slot_index);
+				continue;
+			}
+
+			const auto& to = new_position.at(i);
+			parent.at(to) = m_parent.at(i) == NO_PARENT ? NO_PARENT : new_position.at(m_parent.at(i));
+			local.at(to) = m_local.at(i);
+			world.at(to) = m_world.at(i);
+			dirty.at(to) = m_dirty.at(i);
+			instance.at(to) = m_instance.at(i);
+			slot_of.at(to) = slot_index;
+
+			slot.position = to;
+		}
+
+		m_parent = std::move(parent);
+		m_local = std::move(local);
+		m_world = std::move(world);
+		m_dirty = std::move(dirty);
+		m_instance = std::move(instance);
+		m_slot_of = std::move(slot_of);
+
+		m_order_dirty = false;
+	}
+}
\ No newline at end of file
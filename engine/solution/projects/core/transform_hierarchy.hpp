@@ -0,0 +1,81 @@
+﻿#pragma once
+#include "object_pool.hpp"
+#include "job_system.hpp"
+
+namespace core
+{
+	using transform_id = handle<struct transform_tag>;
+
+	inline constexpr uint32_t NO_INSTANCE = std::numeric_limits<uint32_t>::max();
+
+	/*
+		親子関係を持つ変換
+
+		・ノードは深さ順 (幅優先) に並べた SoA で持つので、先頭から1回走査すれば親が必ず子より先に更新される
+		・同じ深さのノードは互いに依存しないため、深さごとに並列に更新できる
+		・set_local() で変更したノードとその子孫だけワールド行列を計算し直す
+		・行ベクトル規約 (world = local * parent_world)、行列は行優先で WORLD0..3 と同じ並び
+		・親子関係を変えると次の update() で並び替える (O(n)、変更がなければ行わない)
+	*/
+	class transform_hierarchy
+	{
+	public:
+		transform_hierarchy() = default;
+
+	public:
+		// instance はワールド行列を書き込むインスタンスバッファ上の位置 (なければ NO_INSTANCE)
+		transform_id create(const matrix4x4& local, transform_id parent = {}, uint32_t instance = NO_INSTANCE);
+
+		// 子孫もまとめて削除する (どれもすぐに alive() が false になる。配列を詰めるのは次の update()。O(n))
+		void destroy(transform_id id);
+
+		void set_parent(transform_id id, transform_id parent);
+		void set_local(transform_id id, const matrix4x4& local);
+
+		bool alive(transform_id id) const noexcept;
+		const matrix4x4& local(transform_id id) const;
+		const matrix4x4& world(transform_id id) const;		// 最後の update() の結果
+
+		/*
+			変更のあったノードのワールド行列を計算し、instances[instance] にも書き込む
+			jobs を渡すと深さごとに並列に処理する
+		*/
+		void update(gsl::span<matrix4x4> instances, job_system* jobs = nullptr);
+
+	public:
+		inline size_t size() const noexcept { return m_parent.size(); }
+		inline size_t depth_count() const noexcept { return m_level_offsets.empty() ? 0 : m_level_offsets.size() - 1; }
+
+	private:
+		static constexpr uint32_t NO_PARENT = std::numeric_limits<uint32_t>::max();
+
+		struct slot
+		{
+			uint32_t position;		// SoA 配列上の位置
+			uint32_t generation;
+			bool alive;
+		};
+
+	private:
+		void rebuild();
+		void update_range(size_t begin, size_t end, gsl::span<matrix4x4> instances);
+		inline uint32_t position(transform_id id) const { Expects(alive(id)); return m_slots.at(id.index()).position; }
+
+	private:
+		/*  SoA (深さ順)  */
+		std::vector<uint32_t> m_parent;			// 親の位置
+		std::vector<matrix4x4> m_local;
+		std::vector<matrix4x4> m_world;
+		std::vector<uint8_t> m_dirty;
+		std::vector<uint32_t> m_instance;
+		std::vector<uint32_t> m_slot_of;		// 位置 → スロット
+
+		std::vector<uint32_t> m_level_offsets;	// 深さ d のノードは [m_level_offsets[d], m_level_offsets[d + 1])
+
+		std::vector<slot> m_slots;
+		std::vector<uint32_t> m_free_slots;
+
+		// 親の付け替え・削除があり、並びが深さ順になっていない
+		bool m_order_dirty = false;
+	};
+}
\ No newline at end of file
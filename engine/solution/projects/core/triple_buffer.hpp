@@ -0,0 +1,52 @@
+﻿#pragma once
+
+namespace core
+{
+	/*
+		1つの書き手から1つの読み手へ最新の値を渡すトリプルバッファ (ロックなし)
+
+		・書き手は back() に書いて publish() する。読み手が読み終わっていなくても待たない
+		・読み手は acquire() で最新の値に切り替え、front() を読む。新しい値がなければ前の値のまま
+		・3つの枠のうち書き手と読み手が1つずつ持ち、残りの1つを交換に使う
+	*/
+	template<typename T> class triple_buffer
+	{
+	public:
+		triple_buffer() = default;
+		explicit triple_buffer(const T& initial) : m_slots{ initial, initial, initial } {}
+
+		triple_buffer(const triple_buffer&) = delete;
+		triple_buffer& operator=(const triple_buffer&) = delete;
+
+	public:
+		/*  書き手  */
+		inline T& back() noexcept { return m_slots[m_back]; }
+		inline void publish() noexcept
+		{
+			// 書いた枠を交換用に置き、前の交換用の枠を次の書き込み先にする
+			m_back = m_middle.exchange(gsl::narrow_cast<uint8_t>(m_back | FRESH), std::memory_order_acq_rel) & INDEX_MASK;
+		}
+
+	public:
+		/*  読み手 (新しい値に切り替えたら true)  */
+		inline bool acquire() noexcept
+		{
+			if((m_middle.load(std::memory_order_relaxed) & FRESH) == 0) return false;
+
+			m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX_MASK;
+			return true;
+		}
+		inline const T& front() const noexcept { return m_slots[m_front]; }
+
+	private:
+		static constexpr uint8_t INDEX_MASK = 0x3;
+		static constexpr uint8_t FRESH = 0x4;		// 交換用の枠に読まれていない値がある
+
+	private:
+		std::array<T, 3> m_slots = {};
+
+		alignas(64) std::atomic<uint8_t> m_middle = 1;
+		alignas(64) uint8_t m_back = 0;		// 書き手だけが触る
+		alignas(64) uint8_t m_front = 2;		// 読み手だけが触る
+	};
+}
\ No newline at end of file
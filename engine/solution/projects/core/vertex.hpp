@@ -1,7 +1,20 @@
 ﻿#pragma once
+#include "vertex_format.hpp"
+
+using vertex_layout = vertex_stream<0,
+	vertex_attribute::position_f16,
+	vertex_attribute::color_rgba8>;
 
 struct vertex
 {
-	vector3 position;
-	vector4 color;
-};
\ No newline at end of file
+	inline constexpr vertex(const vector3& pos, const vector4& col) noexcept
+		: position(vertex_attribute::position_f16::encode(pos))
+		, color(vertex_attribute::color_rgba8::encode(col))
+	{
+	}
+
+	vertex_attribute::position_f16::storage position;
+	vertex_attribute::color_rgba8::storage color;
+};
+
+static_assert(sizeof(vertex) == vertex_layout::stride, "vertex と vertex_layout のサイズが一致しない");
\ No newline at end of file
@@ -0,0 +1,188 @@
+﻿#pragma once
+#include "quantize.hpp"
+
+/*
+	頂点フォーマット記述
+
+	属性 (attribute) は次のメンバを持つ型として記述する
+		semantic : HLSL のセマンティクス名
+		index    : セマンティクスインデックス
+		format   : DXGI_FORMAT
+		storage  : CPU 側の格納型 (sizeof が GPU 上のサイズと一致する)
+		encode() : CPU の値を storage へ変換する
+
+	vertex_stream / instance_stream で属性を入力スロットにまとめ、
+	input_layout でパイプライン用の D3D12_INPUT_ELEMENT_DESC 配列をコンパイル時に生成する
+*/
+
+namespace vertex_attribute
+{
+	/*  -----  位置  -----------------------------------  */
+
+	struct position_f32
+	{
+		static constexpr auto semantic = "POSITION";
+		static constexpr uint32_t index = 0;
+		static constexpr DXGI_FORMAT format = DXGI_FORMAT_R32G32B32_FLOAT;
+		using storage = vector3;
+
+		static inline constexpr storage encode(const vector3& value) noexcept { return value; }
+	};
+
+	// w は 1.0 で埋める (シェーダ側は float3 で受け取る)
+	struct position_f16
+	{
+		static constexpr auto semantic = "POSITION";
+		static constexpr uint32_t index = 0;
+		static constexpr DXGI_FORMAT format = DXGI_FORMAT_R16G16B16A16_FLOAT;
+		using storage = std::array<uint16_t, 4>;
+
+		static inline constexpr storage encode(const vector3& value) noexcept { return math::encode_half4(value); }
+	};
+
+	/*  -----  法線  -----------------------------------  */
+
+	struct normal_f32
+	{
+		static constexpr auto semantic = "NORMAL";
+		static constexpr uint32_t index = 0;
+		static constexpr DXGI_FORMAT format = DXGI_FORMAT_R32G32B32_FLOAT;
+		using storage = vector3;
+
+		static inline constexpr storage encode(const vector3& value) noexcept { return value; }
+	};
+
+	// シェーダ側で八面体デコードが必要
+	struct normal_oct16
+	{
+		static constexpr auto semantic = "NORMAL";
+		static constexpr uint32_t index = 0;
+		static constexpr DXGI_FORMAT format = DXGI_FORMAT_R16G16_SNORM;
+		using storage = std::array<int16_t, 2>;
+
+		static inline constexpr storage encode(const vector3& value) noexcept { return math::encode_octahedral(value); }
+	};
+
+	/*  -----  カラー  -----------------------------------  */
+
+	struct color_f32
+	{
+		static constexpr auto semantic = "COLOR";
+		static constexpr uint32_t index = 0;
+		static constexpr DXGI_FORMAT format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+		using storage = vector4;
+
+		static inline constexpr storage encode(const vector4& value) noexcept { return value; }
+	};
+
+	struct color_rgba8
+	{
+		static constexpr auto semantic = "COLOR";
+		static constexpr uint32_t index = 0;
+		static constexpr DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		using storage = uint32_t;
+
+		static inline constexpr storage encode(const vector4& value) noexcept { return math::encode_rgba8(value); }
+	};
+
+	/*  -----  UV  -----------------------------------  */
+
+	struct texcoord_f32
+	{
+		static constexpr auto semantic = "TEXCOORD";
+		static constexpr uint32_t index = 0;
+		static constexpr DXGI_FORMAT format = DXGI_FORMAT_R32G32_FLOAT;
+		using storage = vector2;
+
+		static inline constexpr storage encode(const vector2& value) noexcept { return value; }
+	};
+
+	// 0～1 の範囲に収まる UV 用
+	struct texcoord_unorm16
+	{
+		static constexpr auto semantic = "TEXCOORD";
+		static constexpr uint32_t index = 0;
+		static constexpr DXGI_FORMAT format = DXGI_FORMAT_R16G16_UNORM;
+		using storage = std::array<uint16_t, 2>;
+
+		static inline constexpr storage encode(const vector2& value) noexcept { return math::encode_unorm16x2(value); }
+	};
+
+	/*  -----  インスタンス用ワールド行列 (1行分)  -----------------------------------  */
+
+	template<uint32_t Row> struct world_row
+	{
+		static constexpr auto semantic = "WORLD";
+		static constexpr uint32_t index = Row;
+		static constexpr DXGI_FORMAT format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+		using storage = vector4;
+
+		static inline constexpr storage encode(const vector4& value) noexcept { return value; }
+	};
+}
+
+template<uint32_t Slot, D3D12_INPUT_CLASSIFICATION Classification, uint32_t StepRate, class... Attributes> struct basic_vertex_stream
+{
+	static constexpr uint32_t slot = Slot;
+	static constexpr uint32_t count = sizeof...(Attributes);
+	static constexpr uint32_t stride = (gsl::narrow_cast<uint32_t>(sizeof(typename Attributes::storage)) + ...);
+
+	static inline constexpr std::array<D3D12_INPUT_ELEMENT_DESC, count> elements() noexcept
+	{
+		std::array<D3D12_INPUT_ELEMENT_DESC, count> result{};
+
+		// 属性を宣言順に詰めて配置する
+		uint32_t offset = 0;
+		uint32_t i = 0;
+		([&]
+		{
+			result.at(i++) = D3D12_INPUT_ELEMENT_DESC
+			{
+				Attributes::semantic,
+				Attributes::index,
+				Attributes::format,
+				Slot,
+				offset,
+				Classification,
+				StepRate
+			};
+
+			offset += gsl::narrow_cast<uint32_t>(sizeof(typename Attributes::storage));
+		}(), ...);
+
+		return result;
+	}
+};
+
+template<uint32_t Slot, class... Attributes>
+using vertex_stream = basic_vertex_stream<Slot, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0, Attributes...>;
+
+template<uint32_t Slot, class... Attributes>
+using instance_stream = basic_vertex_stream<Slot, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1, Attributes...>;
+
+template<class... Streams> struct input_layout
+{
+	static constexpr uint32_t count = (Streams::count + ...);
+
+	static inline constexpr std::array<D3D12_INPUT_ELEMENT_DESC, count> elements() noexcept
+	{
+		std::array<D3D12_INPUT_ELEMENT_DESC, count> result{};
+
+		uint32_t i = 0;
+		([&]
+		{
+			for(const auto& element : Streams::elements()) result.at(i++) = element;
+		}(), ...);
+
+		return result;
+	}
+};
+
+/*  -----  エンジン標準のフォーマット  -----------------------------------  */
+
+// float4x4 を 4 行に分けてスロット 1 に流す
+using world_instance_stream = instance_stream<1,
+	vertex_attribute::world_row<0>,
+	vertex_attribute::world_row<1>,
+	vertex_attribute::world_row<2>,
+	vertex_attribute::world_row<3>>;
\ No newline at end of file
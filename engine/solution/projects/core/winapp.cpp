@@ -80,8 +80,11 @@ winapp::~winapp()
 
 void winapp::update() noexcept
 {
-	if(PeekMessage(&m_msg, nullptr, 0, 0, PM_REMOVE))
+	// 1フレームに1つずつだと入力がたまっていくので、空になるまで回す
+	while(PeekMessage(&m_msg, nullptr, 0, 0, PM_REMOVE))
 	{
+		if(m_msg.message == WM_QUIT) break;
+
 		TranslateMessage(&m_msg);
 		DispatchMessage(&m_msg);
 	}
@@ -2,13 +2,14 @@
 #include <cstdint>
 #include <memory>
 #include <windows.h>
+#include "platform_window.hpp"
 
-class winapp
+class winapp final : public core::platform_window
 {
 public:
 	winapp() = default;
 	winapp(uint32_t width, uint32_t height);
-	~winapp();
+	~winapp() override;
 
 public:
 	winapp(winapp&&) = default;
@@ -19,12 +20,13 @@ public:
 	winapp& operator=(const winapp&) = delete;
 
 public:
-	void update() noexcept;
+	// たまっているメッセージを全て処理する (WM_QUIT が来たらそこで止める)
+	void update() noexcept override;
 
 public:
-	inline bool isloop() const noexcept { return WM_QUIT != m_msg.message; }
-	inline uint32_t get_width() const noexcept { return m_width; }
-	inline uint32_t get_height() const noexcept { return m_height; }
+	inline bool isloop() const noexcept override { return WM_QUIT != m_msg.message; }
+	inline uint32_t get_width() const noexcept override { return m_width; }
+	inline uint32_t get_height() const noexcept override { return m_height; }
 	inline HINSTANCE get_hinstance() const noexcept { return m_hinst; }
 	inline HWND get_hwnd() const noexcept { return m_hwnd; }
 
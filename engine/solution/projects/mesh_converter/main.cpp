@@ -0,0 +1,33 @@
+﻿#include "include.hpp"
+
+/*
+	テキストメッシュ -> バイナリメッシュ (.mesh) 変換ツール
+
+	usage: mesh_converter <source> <destination> [lod_count]
+*/
+
+int32_t main(int32_t argc, char** argv)
+{
+	if(argc < 3)
+	{
+		std::cerr << "usage: mesh_converter <source> <destination> [lod_count]" << std::endl;
+		return 1;
+	}
+
+	const auto& args = gsl::span<char*>(argv, gsl::narrow<size_t>(argc));
+	const auto& lod_count = argc >= 4 ? gsl::narrow<uint32_t>(std::stoul(args[3])) : 4u;
+
+	if(lod_count == 0 || lod_count > core::MAX_LOD_COUNT)
+	{
+		std::cerr << boost::format("lod_count must be 1..%1%") % core::MAX_LOD_COUNT << std::endl;
+		return 1;
+	}
+
+	if(!core::convert_text_mesh(args[1], args[2], lod_count))
+	{
+		std::cerr << boost::format("failed to convert %1%") % args[1] << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+﻿#include "include.hpp"
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	/*  open() されるまで読み込みを止めておくバックエンド (パスの長さだけのデータを返す)  */
+	class gated_backend final : public core::file_backend
+	{
+	public:
+		bool read(const std::string& path, std::vector<std::byte>& out) override
+		{
+			std::unique_lock lock(m_mutex);
+			++m_started;
+			m_condition.notify_all();
+			m_condition.wait(lock, [this] { return m_open; });
+
+			out.assign(path.size(), std::byte{ 1 });
+			return true;
+		}
+
+		void wait_started(uint32_t count)
+		{
+			std::unique_lock lock(m_mutex);
+			m_condition.wait(lock, [&] { return m_started >= count; });
+		}
+
+		void open()
+		{
+			{
+				std::lock_guard lock(m_mutex);
+				m_open = true;
+			}
+			m_condition.notify_all();
+		}
+
+	private:
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		uint32_t m_started = 0;
+		bool m_open = false;
+	};
+
+	// ready が count 件になるまで待つ
+	void wait_ready(const core::asset_streamer& streamer, uint32_t count)
+	{
+		for(auto i = 0; i < 5000 && streamer.get_stats().ready < count; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(asset_streamer)
+
+// 優先度の更新や取り消しでキューに残った古いエントリは pending / ready に数えない
+BOOST_AUTO_TEST_CASE(stats_count_live_requests)
+{
+	auto backend = std::make_unique<gated_backend>();
+	auto& gate = *backend;
+	core::asset_streamer streamer(std::move(backend), 1);
+
+	std::vector<core::stream_id> completed;
+	auto callback = [&](core::stream_id id, bool succeeded, gsl::span<const std::byte>) { if(succeeded) completed.push_back(id); };
+
+	const auto& a = streamer.request("a", 0.0f, callback);
+	gate.wait_started(1);
+
+	// a は読み込み中、残りは待ち
+	const auto& b = streamer.request("bb", 1.0f, callback);
+	const auto& c = streamer.request("ccc", 2.0f, callback);
+	const auto& d = streamer.request("dddd", 3.0f, callback);
+	for(auto i = 0; i < 5; ++i) streamer.update_priority(b, 4.0f + i);
+	BOOST_TEST(streamer.get_stats().pending == 3u);
+
+	streamer.cancel(c);
+	streamer.cancel(c);
+	BOOST_TEST(streamer.get_stats().pending == 2u);
+	BOOST_TEST(streamer.get_stats().cancelled == 1u);
+
+	gate.open();
+	wait_ready(streamer, 3);
+
+	auto stats = streamer.get_stats();
+	BOOST_TEST(stats.pending == 0u);
+	BOOST_TEST(stats.ready == 3u);
+
+	// ready のものも優先度を変えられる (古いエントリは数えない)
+	for(auto i = 0; i < 3; ++i) streamer.update_priority(d, -1.0f - i);
+	BOOST_TEST(streamer.get_stats().ready == 3u);
+
+	streamer.cancel(a);
+	BOOST_TEST(streamer.get_stats().ready == 2u);
+
+	// d (最も優先度が高い) から渡し、予算を超えたら次のフレームに回す
+	BOOST_TEST(streamer.dispatch(1) == 4u);
+	BOOST_TEST(streamer.get_stats().ready == 1u);
+	BOOST_TEST(streamer.dispatch(1024) == 2u);
+
+	stats = streamer.get_stats();
+	BOOST_TEST(stats.pending == 0u);
+	BOOST_TEST(stats.ready == 0u);
+	BOOST_TEST(stats.completed == 2u);
+	BOOST_TEST(stats.cancelled == 2u);
+	BOOST_TEST((completed == std::vector<core::stream_id>{ d, b }));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,190 @@
+﻿#include "include.hpp"
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	// 端数のブロックも通るように 8 の倍数から外す
+	constexpr size_t COUNT = 1003;
+
+	std::vector<float> uniform(uint64_t stream, size_t count, float low, float high)
+	{
+		std::vector<float> values(count);
+		math::philox4x32(47, stream).fill_uniform(values, low, high);
+		return values;
+	}
+
+	std::vector<math::aabb> random_boxes(uint64_t stream, size_t count)
+	{
+		const auto& center = uniform(stream, count * 3, -40.0f, 40.0f);
+		const auto& extent = uniform(stream + 1, count * 3, 0.0f, 5.0f);
+
+		std::vector<math::aabb> boxes(count);
+		for(size_t i = 0; i < count; ++i)
+		{
+			boxes[i] = math::aabb::from_center(vector3(center[i * 3 + 0], center[i * 3 + 1], center[i * 3 + 2]), vector3(extent[i * 3 + 0], extent[i * 3 + 1], extent[i * 3 + 2]));
+		}
+		return boxes;
+	}
+
+	std::vector<vector3> random_points(uint64_t stream, size_t count)
+	{
+		const auto& values = uniform(stream, count * 3, -100.0f, 100.0f);
+
+		std::vector<vector3> points(count);
+		for(size_t i = 0; i < count; ++i) points[i] = vector3(values[i * 3 + 0], values[i * 3 + 1], values[i * 3 + 2]);
+		return points;
+	}
+
+	// 軸に沿わない面を含む視錐台 (x, y, z が [-30, 30] の箱を斜めに削る)
+	math::frustum test_frustum()
+	{
+		const std::array<vector4, 6> planes =
+		{
+			vector4(1.0f, 0.0f, 0.0f, 30.0f),
+			vector4(-1.0f, 0.0f, 0.0f, 30.0f),
+			vector4(0.0f, 1.0f, 0.0f, 30.0f),
+			vector4(0.0f, -1.0f, 0.0f, 30.0f),
+			vector4(0.6f, 0.0f, 0.8f, 20.0f),
+			vector4(-0.6f, 0.0f, -0.8f, 20.0f),
+		};
+		return math::frustum::from_vectors(planes);
+	}
+
+	bool near(float a, float b) { return std::abs(a - b) <= 1e-4f * std::max(1.0f, std::max(std::abs(a), std::abs(b))); }
+}
+
+BOOST_AUTO_TEST_SUITE(bounds)
+
+// まとめて変換した結果は aabb::transformed と同じ
+BOOST_AUTO_TEST_CASE(transform_aabbs_matches_scalar)
+{
+	const auto& boxes = random_boxes(0, COUNT);
+	const auto& linear = uniform(2, COUNT * 9, -2.0f, 2.0f);
+	const auto& offset = uniform(3, COUNT * 3, -50.0f, 50.0f);
+
+	std::vector<affine3x4> transforms(COUNT);
+	for(size_t i = 0; i < COUNT; ++i)
+	{
+		const auto* m = linear.data() + i * 9;
+		const auto* t = offset.data() + i * 3;
+		transforms[i] = affine3x4(vector4a(m[0], m[1], m[2], t[0]), vector4a(m[3], m[4], m[5], t[1]), vector4a(m[6], m[7], m[8], t[2]));
+	}
+
+	std::vector<math::aabb> out(COUNT);
+	math::transform_aabbs(boxes, transforms, out);
+
+	for(size_t i = 0; i < COUNT; ++i)
+	{
+		const auto& expected = boxes[i].transformed(transforms[i]);
+		for(size_t k = 0; k < 3; ++k)
+		{
+			BOOST_TEST(near(out[i].min[k], expected.min[k]), "box " << i << " min[" << k << "] " << out[i].min[k] << " != " << expected.min[k]);
+			BOOST_TEST(near(out[i].max[k], expected.max[k]), "box " << i << " max[" << k << "] " << out[i].max[k] << " != " << expected.max[k]);
+		}
+	}
+}
+
+// min / max は丸めがないので、1つずつ足したものと一致する
+BOOST_AUTO_TEST_CASE(merge_matches_scalar)
+{
+	for(const auto& count : { size_t(1), size_t(5), COUNT })
+	{
+		const auto& boxes = random_boxes(4, count);
+
+		auto expected = math::aabb::empty();
+		for(const auto& box : boxes) expected.merge(box);
+
+		std::vector<math::aabb8> blocks(math::bounds_blocks(count));
+		math::pack_aabbs(boxes, blocks);
+
+		BOOST_TEST((math::merge_aabbs(gsl::span<const math::aabb>(boxes)).min == expected.min));
+		BOOST_TEST((math::merge_aabbs(gsl::span<const math::aabb>(boxes)).max == expected.max));
+		BOOST_TEST((math::merge_aabbs(gsl::span<const math::aabb8>(blocks)).min == expected.min));
+		BOOST_TEST((math::merge_aabbs(gsl::span<const math::aabb8>(blocks)).max == expected.max));
+	}
+
+	const auto& points = random_points(6, COUNT);
+	auto expected = math::aabb::empty();
+	for(const auto& point : points) expected.merge(point);
+
+	const auto& box = math::aabb_from_points(points);
+	BOOST_TEST((box.min == expected.min));
+	BOOST_TEST((box.max == expected.max));
+}
+
+// 全ての点が入り、最も離れた2点の距離の半分より小さくならない
+BOOST_AUTO_TEST_CASE(sphere_contains_points)
+{
+	for(const auto& count : { size_t(1), size_t(7), COUNT })
+	{
+		const auto& points = random_points(7, count);
+		const auto& s = math::sphere_from_points(points);
+
+		for(const auto& point : points) BOOST_TEST((point - s.center).length() <= s.radius * (1.0f + 1e-5f) + 1e-5f);
+
+		auto diameter = 0.0f;
+		for(const auto& a : points) for(const auto& b : points) diameter = std::max(diameter, (a - b).length());
+		BOOST_TEST(s.radius >= diameter * 0.5f * (1.0f - 1e-5f));
+	}
+}
+
+// ビットが立つのは frustum::test が outside でないものだけで、count 以降は 0
+BOOST_AUTO_TEST_CASE(cull_matches_frustum_test)
+{
+	const auto& view = test_frustum();
+
+	const auto& boxes = random_boxes(8, COUNT);
+	std::vector<math::aabb8> box_blocks(math::bounds_blocks(COUNT));
+	std::vector<uint8_t> box_masks(box_blocks.size());
+	math::pack_aabbs(boxes, box_blocks);
+	math::cull_aabbs(view, box_blocks, COUNT, box_masks);
+
+	const auto& centers = random_points(10, COUNT);
+	const auto& radii = uniform(11, COUNT, 0.0f, 8.0f);
+	std::vector<math::sphere> spheres(COUNT);
+	for(size_t i = 0; i < COUNT; ++i) spheres[i] = math::sphere{ centers[i] * 0.5f, radii[i] };
+
+	std::vector<math::sphere8> sphere_blocks(math::bounds_blocks(COUNT));
+	std::vector<uint8_t> sphere_masks(sphere_blocks.size());
+	math::pack_spheres(spheres, sphere_blocks);
+	math::cull_spheres(view, sphere_blocks, COUNT, sphere_masks);
+
+	size_t box_visible = 0, sphere_visible = 0;
+	for(size_t i = 0; i < box_blocks.size() * math::BOUNDS_LANES; ++i)
+	{
+		const auto& box_bit = (box_masks[i / 8] >> (i % 8)) & 1u;
+		const auto& sphere_bit = (sphere_masks[i / 8] >> (i % 8)) & 1u;
+		if(i >= COUNT)
+		{
+			BOOST_TEST(box_bit == 0u);
+			BOOST_TEST(sphere_bit == 0u);
+			continue;
+		}
+
+		BOOST_TEST(box_bit == (view.test(boxes[i]) != math::containment::outside ? 1u : 0u), "box " << i);
+		BOOST_TEST(sphere_bit == (view.test(spheres[i]) != math::containment::outside ? 1u : 0u), "sphere " << i);
+		box_visible += box_bit;
+		sphere_visible += sphere_bit;
+	}
+
+	// どちらにも偏っていない (全部見える / 全部消えるでは比べた意味がない)
+	BOOST_TEST(box_visible > 0u);
+	BOOST_TEST(box_visible < COUNT);
+	BOOST_TEST(sphere_visible > 0u);
+	BOOST_TEST(sphere_visible < COUNT);
+}
+
+// 単位行列なら D3D の正規化デバイス座標 (-1 <= x, y <= 1, 0 <= z <= 1) の箱になる
+BOOST_AUTO_TEST_CASE(frustum_from_identity)
+{
+	const std::array<float, 16> identity = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+	const auto& view = math::frustum::from_view_projection(identity);
+
+	BOOST_TEST((view.test(math::aabb{ vector3(-0.5f, -0.5f, 0.25f), vector3(0.5f, 0.5f, 0.75f) }) == math::containment::inside));
+	BOOST_TEST((view.test(math::aabb{ vector3(0.5f, -0.5f, 0.25f), vector3(1.5f, 0.5f, 0.75f) }) == math::containment::intersect));
+	BOOST_TEST((view.test(math::aabb{ vector3(-0.5f, -0.5f, -0.75f), vector3(0.5f, 0.5f, -0.25f) }) == math::containment::outside));
+	BOOST_TEST((view.test(math::sphere{ vector3(0.0f, 0.0f, 2.0f), 0.5f }) == math::containment::outside));
+	BOOST_TEST((view.test(math::sphere{ vector3(0.0f, 0.0f, 1.2f), 0.5f }) == math::containment::intersect));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
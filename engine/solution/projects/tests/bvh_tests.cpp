@@ -0,0 +1,229 @@
+﻿#include "include.hpp"
+#include <boost/test/unit_test.hpp>
+
+/*
+	bvh の問い合わせを全物体の総当たりと比べる
+	挿入・削除・移動・refit/rebuild を乱数で混ぜながら、毎回 AABB / 視錐台 / レイ / raycast の結果を確かめる
+*/
+namespace
+{
+	using core::bvh_bounds;
+
+	constexpr float INF = std::numeric_limits<float>::infinity();
+
+	float random_float(math::philox4x32& random, float low, float high)
+	{
+		return low + (high - low) * static_cast<float>(random() >> 8) / 16777216.0f;
+	}
+
+	// 中心は [-100, 100]、半分の幅は [0, extent]
+	bvh_bounds random_box(math::philox4x32& random, float extent)
+	{
+		bvh_bounds b{};
+		for(auto axis = 0; axis < 3; ++axis)
+		{
+			const auto& center = random_float(random, -100.0f, 100.0f);
+			const auto& half = random_float(random, 0.0f, extent);
+			b.min[axis] = center - half;
+			b.max[axis] = center + half;
+		}
+		return b;
+	}
+
+	/*  総当たり (bvh.cpp の判定と同じ式)  */
+	bool overlaps(const bvh_bounds& a, const bvh_bounds& b)
+	{
+		for(auto axis = 0; axis < 3; ++axis)
+		{
+			if(a.min[axis] > b.max[axis] || b.min[axis] > a.max[axis]) return false;
+		}
+		return true;
+	}
+
+	bool outside(const bvh_bounds& b, gsl::span<const vector4, 6> planes)
+	{
+		for(const auto& plane : planes)
+		{
+			const auto& distance = plane.x() * (plane.x() > 0 ? b.max[0] : b.min[0]) + plane.y() * (plane.y() > 0 ? b.max[1] : b.min[1]) + plane.z() * (plane.z() > 0 ? b.max[2] : b.min[2]) + plane.w();
+			if(distance < 0) return true;
+		}
+		return false;
+	}
+
+	bool intersect(const vector3& origin, const vector3& direction, float max_distance, const bvh_bounds& b, float& t_enter)
+	{
+		const std::array<float, 3> o = { origin.x(), origin.y(), origin.z() };
+		const std::array<float, 3> inverse = { 1.0f / direction.x(), 1.0f / direction.y(), 1.0f / direction.z() };
+
+		auto t_min = 0.0f;
+		auto t_max = max_distance;
+		for(auto axis = 0; axis < 3; ++axis)
+		{
+			const auto& t0 = (b.min[axis] - o[axis]) * inverse[axis];
+			const auto& t1 = (b.max[axis] - o[axis]) * inverse[axis];
+			t_min = std::max(t_min, std::min(t0, t1));
+			t_max = std::min(t_max, std::max(t0, t1));
+		}
+
+		t_enter = t_min;
+		return t_min <= t_max;
+	}
+
+	std::vector<uint32_t> sorted(std::vector<uint32_t> values)
+	{
+		std::sort(values.begin(), values.end());
+		return values;
+	}
+
+	/*  bvh と同じ物体を持つ総当たりの参照  */
+	struct reference
+	{
+		std::vector<bvh_bounds> bounds;
+		std::vector<uint8_t> alive;
+
+		template<class F> std::vector<uint32_t> select(F&& predicate) const
+		{
+			std::vector<uint32_t> out;
+			for(auto i = 0u; i < bounds.size(); ++i)
+			{
+				if(alive[i] != 0 && predicate(bounds[i])) out.push_back(i);
+			}
+			return out;
+		}
+	};
+
+	void check_queries(const core::bvh& tree, const reference& ref, math::philox4x32& random)
+	{
+		std::vector<uint32_t> out;
+
+		for(auto q = 0; q < 8; ++q)
+		{
+			/*  AABB  */
+			const auto& box = random_box(random, 40.0f);
+			out.clear();
+			tree.query_aabb(box, out);
+			BOOST_TEST_REQUIRE(sorted(out) == ref.select([&](const bvh_bounds& b) { return overlaps(b, box); }), boost::test_tools::per_element());
+
+			/*  視錐台 (中心の周りに向きのばらばらな面を6枚)  */
+			std::array<vector4, 6> planes;
+			const vector3 center(random_float(random, -60.0f, 60.0f), random_float(random, -60.0f, 60.0f), random_float(random, -60.0f, 60.0f));
+			for(auto& plane : planes)
+			{
+				const auto& normal = vector3(random_float(random, -1.0f, 1.0f), random_float(random, -1.0f, 1.0f), random_float(random, -1.0f, 1.0f)).normalized();
+				const auto& distance = random_float(random, 10.0f, 80.0f);
+				plane = vector4(normal.x(), normal.y(), normal.z(), distance - normal.dot(center));
+			}
+			out.clear();
+			tree.query_frustum(planes, out);
+			BOOST_TEST_REQUIRE(sorted(out) == ref.select([&](const bvh_bounds& b) { return !outside(b, planes); }), boost::test_tools::per_element());
+
+			/*  レイ (どの軸も 0 でない向き)  */
+			const vector3 origin(random_float(random, -150.0f, 150.0f), random_float(random, -150.0f, 150.0f), random_float(random, -150.0f, 150.0f));
+			auto direction = vector3(random_float(random, 0.1f, 1.0f), random_float(random, 0.1f, 1.0f), random_float(random, 0.1f, 1.0f));
+			if(random() & 1) direction = vector3(-direction.x(), direction.y(), -direction.z());
+			direction = direction.normalized();
+			const auto& max_distance = random_float(random, 50.0f, 400.0f);
+
+			float t{};
+			out.clear();
+			tree.query_ray(origin, direction, max_distance, out);
+			BOOST_TEST_REQUIRE(sorted(out) == ref.select([&](const bvh_bounds& b) { return intersect(origin, direction, max_distance, b, t); }), boost::test_tools::per_element());
+
+			/*  raycast は最も手前の距離が同じなら、どれを返してもよい  */
+			auto nearest = max_distance;
+			auto any_hit = false;
+			for(const auto& object : ref.select([&](const bvh_bounds& b) { return intersect(origin, direction, max_distance, b, t); }))
+			{
+				intersect(origin, direction, max_distance, ref.bounds[object], t);
+				nearest = std::min(nearest, t);
+				any_hit = true;
+			}
+
+			const auto& hit = tree.raycast(origin, direction, max_distance);
+			BOOST_TEST_REQUIRE((hit.object != core::INVALID_BVH_OBJECT) == any_hit);
+			if(any_hit)
+			{
+				BOOST_TEST_REQUIRE(hit.distance == nearest);
+				BOOST_TEST_REQUIRE(intersect(origin, direction, max_distance, ref.bounds.at(hit.object), t));
+				BOOST_TEST_REQUIRE(t == nearest);
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(bvh)
+
+BOOST_AUTO_TEST_CASE(queries_match_brute_force)
+{
+	math::philox4x32 random(97);
+
+	reference ref;
+	for(auto i = 0; i < 2000; ++i)
+	{
+		ref.bounds.push_back(random_box(random, 6.0f));
+		ref.alive.push_back(1);
+	}
+
+	core::bvh tree;
+	tree.build(ref.bounds);
+	BOOST_TEST(tree.object_count() == ref.bounds.size());
+	check_queries(tree, ref, random);
+
+	for(auto step = 0; step < 60; ++step)
+	{
+		/*  挿入 (木の外のリストに入る)  */
+		for(auto i = 0; i < 20; ++i)
+		{
+			const auto& b = random_box(random, 6.0f);
+			const auto& object = tree.insert(b);
+			if(object >= ref.bounds.size())
+			{
+				ref.bounds.resize(object + 1);
+				ref.alive.resize(object + 1, 0);
+			}
+			ref.bounds[object] = b;
+			ref.alive[object] = 1;
+		}
+
+		/*  削除と移動  */
+		for(auto i = 0; i < 40; ++i)
+		{
+			const auto& object = static_cast<uint32_t>(random() % ref.bounds.size());
+			if(ref.alive[object] == 0) continue;
+
+			if(i % 2 == 0)
+			{
+				tree.remove(object);
+				ref.alive[object] = 0;
+			}
+			else
+			{
+				const auto& b = random_box(random, 6.0f);
+				tree.update(object, b);
+				ref.bounds[object] = b;
+			}
+		}
+
+		// 移動した物体は refit() まで木の AABB に入らない。時々は作り直す
+		if(step % 10 == 9) tree.rebuild();
+		else tree.maintain();
+
+		BOOST_TEST_REQUIRE(tree.object_count() == static_cast<size_t>(std::count(ref.alive.begin(), ref.alive.end(), uint8_t(1))));
+		for(auto i = 0u; i < ref.bounds.size(); ++i) BOOST_TEST_REQUIRE(tree.alive(i) == (ref.alive[i] != 0));
+
+		check_queries(tree, ref, random);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(empty_tree)
+{
+	core::bvh tree;
+	tree.build({});
+
+	std::vector<uint32_t> out;
+	tree.query_aabb(bvh_bounds{ { -INF, -INF, -INF }, { INF, INF, INF } }, out);
+	BOOST_TEST(out.empty());
+	BOOST_TEST(tree.raycast(vector3(0.0f), vector3(1.0f, 0.0f, 0.0f), 10.0f).object == core::INVALID_BVH_OBJECT);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,163 @@
+﻿#include "include.hpp"
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	// 行ベクトル (x, y, z, 1) * m
+	vector4 transform(const matrix4x4& m, const vector3& p)
+	{
+		std::array<float, 4> out = {};
+		const std::array<float, 4> v = { p.x(), p.y(), p.z(), 1.0f };
+		for(auto column = 0u; column < 4; ++column)
+		{
+			for(auto row = 0u; row < 4; ++row) out[column] += v[row] * m.at(row * 4 + column);
+		}
+		return vector4(out[0], out[1], out[2], out[3]);
+	}
+
+	float depth(const core::camera& camera, const vector3& local)
+	{
+		const auto& clip = transform(camera.view_projection(), local);
+		return clip.z() / clip.w();
+	}
+
+	float distance(const vector4& plane, const vector3& p)
+	{
+		return plane.x() * p.x() + plane.y() * p.y() + plane.z() * p.z() + plane.w();
+	}
+
+	bool inside(const core::camera& camera, const vector3& p)
+	{
+		for(const auto& plane : camera.frustum())
+		{
+			if(distance(plane, p) < 0.0f) return false;
+		}
+		return true;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(camera)
+
+BOOST_AUTO_TEST_CASE(depth_ranges)
+{
+	core::camera camera;
+	camera.set_direction(vector3(0.0f, 0.0f, 1.0f));
+
+	/*  reversed: near -> 1, far -> 0  */
+	camera.set_perspective(1.0f, 1.5f, 0.5f, 100.0f);
+	camera.update();
+	BOOST_TEST(depth(camera, vector3(0.0f, 0.0f, 0.5f)) == 1.0f, boost::test_tools::tolerance(1e-5f));
+	BOOST_TEST(depth(camera, vector3(0.0f, 0.0f, 100.0f)) == 0.0f, boost::test_tools::tolerance(1e-5f));
+
+	/*  standard: near -> 0, far -> 1  */
+	camera.set_depth_mode(core::depth_mode::standard);
+	camera.update();
+	BOOST_TEST(depth(camera, vector3(0.0f, 0.0f, 0.5f)) == 0.0f, boost::test_tools::tolerance(1e-5f));
+	BOOST_TEST(depth(camera, vector3(0.0f, 0.0f, 100.0f)) == 1.0f, boost::test_tools::tolerance(1e-5f));
+
+	/*  遠平面なしの reversed: 遠くなるほど 0 に近づき、負にならない  */
+	camera.set_depth_mode(core::depth_mode::reversed);
+	camera.set_perspective(1.0f, 1.5f, 0.5f);
+	camera.update();
+	BOOST_TEST(depth(camera, vector3(0.0f, 0.0f, 0.5f)) == 1.0f, boost::test_tools::tolerance(1e-5f));
+	BOOST_TEST(depth(camera, vector3(0.0f, 0.0f, 1e6f)) > 0.0f);
+	BOOST_TEST(depth(camera, vector3(0.0f, 0.0f, 1e6f)) < 1e-5f);
+}
+
+BOOST_AUTO_TEST_CASE(frustum_matches_projection)
+{
+	core::camera camera;
+	camera.set_position(vector3d(10.0, 2.0, -3.0));
+	camera.set_direction(vector3(1.0f, 0.2f, 0.5f));
+	camera.set_perspective(1.2f, 16.0f / 9.0f, 0.1f, 200.0f);
+	camera.update();
+
+	const auto& eye = camera.to_local(camera.position());
+	const auto& forward = camera.forward();
+
+	BOOST_TEST(inside(camera, eye + forward * 50.0f));
+	BOOST_TEST(!inside(camera, eye - forward * 50.0f));
+	BOOST_TEST(!inside(camera, eye + forward * 250.0f));
+	BOOST_TEST(!inside(camera, eye + forward * 0.05f));
+
+	// 平面の内外と、射影後に [-1, 1] の範囲に入るかが一致する
+	math::philox4x32 random(5);
+	std::vector<float> values(3 * 2000);
+	random.fill_uniform(values, -150.0f, 150.0f);
+	for(size_t i = 0; i < values.size(); i += 3)
+	{
+		const auto& p = eye + vector3(values[i], values[i + 1], values[i + 2]);
+		const auto& clip = transform(camera.view_projection(), p);
+		if(clip.w() <= 0.0f)
+		{
+			BOOST_TEST_REQUIRE(!inside(camera, p));
+			continue;
+		}
+
+		const auto& x = clip.x() / clip.w();
+		const auto& y = clip.y() / clip.w();
+		const auto& z = clip.z() / clip.w();
+
+		// 境界のすぐ近くは丸めでどちらにもなりうるので外す
+		constexpr float margin = 1e-3f;
+		const auto& clearly_in = std::abs(x) < 1.0f - margin && std::abs(y) < 1.0f - margin && margin < z && z < 1.0f - margin;
+		const auto& clearly_out = std::abs(x) > 1.0f + margin || std::abs(y) > 1.0f + margin || z < -margin || z > 1.0f + margin;
+		if(clearly_in) BOOST_TEST_REQUIRE(inside(camera, p));
+		if(clearly_out) BOOST_TEST_REQUIRE(!inside(camera, p));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(up_parallel_to_forward_uses_fallback)
+{
+	for(const auto& forward : { vector3(0.0f, 1.0f, 0.0f), vector3(0.0f, -1.0f, 0.0f), vector3(0.0f, 0.0f, 1.0f) })
+	{
+		core::camera camera;
+		camera.set_direction(forward, forward);
+		camera.update();
+
+		// 基底が潰れずに正規直交になっている (view の左上 3x3)
+		const auto& view = camera.view();
+		for(auto a = 0u; a < 3; ++a)
+		{
+			for(auto b = 0u; b < 3; ++b)
+			{
+				float dot = 0.0f;
+				for(auto k = 0u; k < 3; ++k) dot += view.at(k * 4 + a) * view.at(k * 4 + b);
+				BOOST_TEST(dot == (a == b ? 1.0f : 0.0f), boost::test_tools::tolerance(1e-5f));
+			}
+		}
+
+		BOOST_TEST(inside(camera, forward * 10.0f));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(rebase_and_version)
+{
+	core::camera camera;
+	camera.set_rebase_distance(100.0);
+
+	BOOST_TEST(camera.update());
+	BOOST_TEST(!camera.update());
+	const auto& version = camera.version();
+
+	// 閾値の内側では原点は動かない
+	camera.set_position(vector3d(50.0, 0.0, 0.0));
+	BOOST_TEST(camera.update());
+	BOOST_TEST(camera.version() == version + 1);
+	BOOST_TEST(camera.origin_epoch() == 0u);
+
+	camera.set_position(vector3d(1e7 + 0.25, 0.0, -1e7));
+	camera.update();
+	BOOST_TEST(camera.origin_epoch() == 1u);
+	BOOST_TEST(camera.origin().x() == 1e7 + 0.25);
+
+	// 原点からの相対座標は float でも細かい差が残る
+	const auto& local = camera.to_local(vector3d(1e7 + 0.5, 0.0, -1e7));
+	BOOST_TEST(local.x() == 0.25f);
+
+	// 値が変わらなければ作り直さない
+	camera.set_aspect(1.0f);
+	BOOST_TEST(!camera.update());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,240 @@
+﻿#include "include.hpp"
+#include <boost/test/unit_test.hpp>
+
+/*
+	GPU の代わりに完了したフェンス値 (completed) を手で進め、積まれたものがそのフレームの値が完了するまで破棄されないことを確かめる
+	破棄は collect() / flush() を呼んだ描画スレッド (テストのスレッド) でだけ起きるので、デストラクタの中で調べられる
+*/
+namespace
+{
+	struct release_context
+	{
+		uint64_t completed = 0;				// 偽のフェンスの完了値
+		uint64_t destroyed = 0;
+		uint64_t too_early = 0;				// 完了前に破棄されたもの
+	};
+
+	// fence_value 以上が完了していないのに破棄されたら数える
+	class tracked
+	{
+	public:
+		tracked(release_context* context, uint64_t fence_value) noexcept : m_context(context), m_fence_value(fence_value) {}
+
+		~tracked()
+		{
+			if(m_context == nullptr) return;
+			if(m_context->completed < m_fence_value) ++m_context->too_early;
+			++m_context->destroyed;
+		}
+
+		tracked(tracked&& other) noexcept : m_context(std::exchange(other.m_context, nullptr)), m_fence_value(other.m_fence_value) {}
+		tracked(const tracked&) = delete;
+		tracked& operator=(const tracked&) = delete;
+		tracked& operator=(tracked&&) = delete;
+
+	private:
+		release_context* m_context;
+		uint64_t m_fence_value;
+	};
+
+	// completed まで GPU が終わったことにして回収する
+	uint32_t complete(core::deferred_release_queue& queue, release_context& context, uint64_t completed)
+	{
+		context.completed = completed;
+		return queue.collect(completed);
+	}
+
+	constexpr uint32_t THREADS = 4;
+	constexpr uint32_t PER_THREAD = 500;
+	constexpr uint64_t FRAMES_IN_FLIGHT = 2;
+}
+
+BOOST_AUTO_TEST_SUITE(deferred_release)
+
+BOOST_AUTO_TEST_CASE(stats_follow_frames)
+{
+	release_context context;
+	core::deferred_release_queue queue;
+
+	queue.begin_frame(1);
+	for(auto i = 0; i < 3; ++i) queue.release(tracked(&context, 1));
+	BOOST_TEST(queue.get_stats().queued == 3u);
+
+	queue.begin_frame(2);
+	BOOST_TEST(queue.get_stats().queued == 0u);
+	for(auto i = 0; i < 2; ++i) queue.release(tracked(&context, 2));
+
+	// まだどちらも完了していない
+	BOOST_TEST(complete(queue, context, 0) == 0u);
+	BOOST_TEST(queue.get_stats().pending == 5u);
+	BOOST_TEST(context.destroyed == 0u);
+
+	BOOST_TEST(complete(queue, context, 1) == 3u);
+	{
+		const auto& stats = queue.get_stats();
+		BOOST_TEST(stats.released == 3u);
+		BOOST_TEST(stats.total_released == 3u);
+		BOOST_TEST(stats.pending == 2u);
+	}
+
+	// 同じ値でもう一度呼んでも何も起きない
+	BOOST_TEST(complete(queue, context, 1) == 0u);
+	BOOST_TEST(queue.get_stats().released == 0u);
+
+	BOOST_TEST(complete(queue, context, 2) == 2u);
+	{
+		const auto& stats = queue.get_stats();
+		BOOST_TEST(stats.total_released == 5u);
+		BOOST_TEST(stats.pending == 0u);
+	}
+
+	BOOST_TEST(context.destroyed == 5u);
+	BOOST_TEST(context.too_early == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(flush_releases_everything)
+{
+	release_context context;
+	{
+		core::deferred_release_queue queue;
+		queue.begin_frame(7);
+		queue.release(tracked(&context, 7));
+		queue.release(std::make_unique<int>(1));
+
+		// flush() は GPU の待機後に呼ぶので、完了値は進めておく
+		context.completed = 7;
+		queue.flush();
+		BOOST_TEST(queue.get_stats().released == 2u);
+		BOOST_TEST(queue.get_stats().pending == 0u);
+
+		queue.release(tracked(&context, 7));
+	}
+
+	// 残っていたものはデストラクタで破棄される
+	BOOST_TEST(context.destroyed == 2u);
+	BOOST_TEST(context.too_early == 0u);
+}
+
+// フレームごとに複数のスレッドから積み、完了値を FRAMES_IN_FLIGHT 遅れで進める
+BOOST_AUTO_TEST_CASE(threads_release_per_frame)
+{
+	constexpr uint64_t FRAMES = 8;
+
+	release_context context;
+	core::deferred_release_queue queue;
+
+	for(uint64_t frame = 1; frame <= FRAMES; ++frame)
+	{
+		queue.begin_frame(frame);
+
+		std::vector<std::thread> threads;
+		for(uint32_t t = 0; t < THREADS; ++t)
+		{
+			threads.emplace_back([&queue, &context, frame]
+			{
+				for(uint32_t i = 0; i < PER_THREAD; ++i) queue.release(tracked(&context, frame));
+			});
+		}
+		for(auto& thread : threads) thread.join();
+
+		BOOST_TEST(queue.get_stats().queued == THREADS * PER_THREAD);
+
+		// frame - FRAMES_IN_FLIGHT までのフレームが完了した
+		const auto& completed = frame > FRAMES_IN_FLIGHT ? frame - FRAMES_IN_FLIGHT : 0;
+		const auto& released = complete(queue, context, completed);
+		BOOST_TEST(released == (completed > 0 ? THREADS * PER_THREAD : 0u));
+
+		const auto& stats = queue.get_stats();
+		BOOST_TEST(stats.total_released == completed * THREADS * PER_THREAD);
+		BOOST_TEST(stats.pending == (frame - completed) * THREADS * PER_THREAD);
+		BOOST_TEST(context.destroyed == completed * THREADS * PER_THREAD);
+	}
+
+	BOOST_TEST(complete(queue, context, FRAMES) == FRAMES_IN_FLIGHT * THREADS * PER_THREAD);
+	BOOST_TEST(queue.get_stats().pending == 0u);
+	BOOST_TEST(context.destroyed == FRAMES * THREADS * PER_THREAD);
+	BOOST_TEST(context.too_early == 0u);
+}
+
+/*
+	スレッドが積み続けている間に begin_frame() で境界をまたぐ
+	積む前に読んだフレーム番号より前の値が付くことはないので、それが完了するまでは破棄されてはいけない
+*/
+BOOST_AUTO_TEST_CASE(threads_release_across_frame_boundaries)
+{
+	constexpr uint64_t FRAMES = 200;
+	constexpr uint32_t MAX_PER_FRAME = 256;
+
+	release_context context;
+	core::deferred_release_queue queue;
+
+	std::atomic<uint64_t> current_frame = 1;
+	std::atomic<bool> running = true;
+	std::atomic<uint64_t> released_count = 0;
+	std::array<std::atomic<uint64_t>, THREADS> seen_frame{};		// 各スレッドが最後に積んだフレーム
+
+	queue.begin_frame(1);
+
+	std::vector<std::thread> threads;
+	for(uint32_t t = 0; t < THREADS; ++t)
+	{
+		threads.emplace_back([&, t]
+		{
+			uint64_t last_frame = 0;
+			uint32_t in_frame = 0;
+
+			while(running.load(std::memory_order_relaxed))
+			{
+				// begin_frame() の後に書き換えるので、これより前の値が付くことはない
+				const auto& frame = current_frame.load(std::memory_order_acquire);
+				if(frame != last_frame)
+				{
+					last_frame = frame;
+					in_frame = 0;
+				}
+
+				// 描画スレッドが止まっている間に積みすぎないようにする
+				if(in_frame == MAX_PER_FRAME)
+				{
+					std::this_thread::yield();
+					continue;
+				}
+
+				queue.release(tracked(&context, frame));
+				released_count.fetch_add(1, std::memory_order_relaxed);
+				seen_frame.at(t).store(frame, std::memory_order_relaxed);
+				++in_frame;
+			}
+		});
+	}
+
+	for(uint64_t frame = 2; frame <= FRAMES; ++frame)
+	{
+		queue.begin_frame(frame);
+		current_frame.store(frame, std::memory_order_release);
+
+		// 全てのスレッドがこのフレームで積み始めるまで待つ (その間も前のフレームの番号で積まれうる)
+		for(const auto& seen : seen_frame)
+		{
+			while(seen.load(std::memory_order_relaxed) != frame) std::this_thread::yield();
+		}
+
+		if(frame > FRAMES_IN_FLIGHT) complete(queue, context, frame - FRAMES_IN_FLIGHT);
+		BOOST_TEST_REQUIRE(context.too_early == 0u);
+	}
+
+	running = false;
+	for(auto& thread : threads) thread.join();
+
+	// GPU を待ってから残りを破棄する
+	context.completed = FRAMES;
+	queue.flush();
+
+	const auto& stats = queue.get_stats();
+	BOOST_TEST(stats.pending == 0u);
+	BOOST_TEST(stats.total_released == released_count.load());
+	BOOST_TEST(context.destroyed == released_count.load());
+	BOOST_TEST(context.too_early == 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
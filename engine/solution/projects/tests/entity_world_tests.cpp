@@ -0,0 +1,171 @@
+﻿#include "include.hpp"
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	struct position
+	{
+		float x, y, z;
+	};
+
+	struct velocity
+	{
+		float x, y, z;
+	};
+
+	struct tag
+	{
+		uint32_t value;
+	};
+
+	// 1チャンクに収まらない数 (チャンクをまたいだ走査と入れ替えを通す)
+	constexpr uint32_t MANY = 3000;
+}
+
+BOOST_AUTO_TEST_SUITE(entity_world)
+
+BOOST_AUTO_TEST_CASE(create_and_get)
+{
+	core::entity_world world;
+	const auto& a = world.create(position{ 1, 2, 3 }, velocity{ 4, 5, 6 });
+	const auto& b = world.create(position{ 7, 8, 9 });
+
+	BOOST_TEST(world.size() == 2u);
+	BOOST_TEST(world.alive(a));
+	BOOST_TEST(world.has<position>(a));
+	BOOST_TEST(world.has<velocity>(a));
+	BOOST_TEST(!world.has<velocity>(b));
+	BOOST_TEST(world.get<velocity>(b) == nullptr);
+
+	BOOST_TEST(world.get<position>(a)->y == 2.0f);
+	BOOST_TEST(world.get<velocity>(a)->z == 6.0f);
+	BOOST_TEST(world.get<position>(b)->x == 7.0f);
+
+	BOOST_TEST(world.count<position>() == 2u);
+	BOOST_TEST((world.count<position, velocity>() == 1u));
+}
+
+BOOST_AUTO_TEST_CASE(destroyed_handles_are_stale)
+{
+	core::entity_world world;
+	const auto& a = world.create(tag{ 1 });
+	world.destroy(a);
+
+	BOOST_TEST(!world.alive(a));
+	BOOST_TEST(!world.has<tag>(a));
+	BOOST_TEST(world.get<tag>(a) == nullptr);
+	BOOST_TEST(world.size() == 0u);
+
+	// 2回目の破棄は何もしない
+	world.destroy(a);
+	BOOST_TEST(world.size() == 0u);
+
+	// 同じ番号を使い回しても古いハンドルは通らない
+	const auto& b = world.create(tag{ 2 });
+	BOOST_TEST(b.index() == a.index());
+	BOOST_TEST(!world.alive(a));
+	BOOST_TEST(world.get<tag>(b)->value == 2u);
+	BOOST_TEST(!core::entity_world().alive(core::entity{}));
+}
+
+// 途中のエンティティを消すと末尾の行が移ってくるが、他のエンティティの値は変わらない
+BOOST_AUTO_TEST_CASE(destroy_keeps_other_entities)
+{
+	core::entity_world world;
+	std::vector<core::entity> entities;
+	for(auto i = 0u; i < MANY; ++i) entities.push_back(world.create(tag{ i }, position{ static_cast<float>(i), 0, 0 }));
+
+	for(auto i = 0u; i < MANY; i += 3) world.destroy(entities[i]);
+
+	for(auto i = 0u; i < MANY; ++i)
+	{
+		if(i % 3 == 0)
+		{
+			BOOST_TEST_REQUIRE(!world.alive(entities[i]));
+			continue;
+		}
+
+		BOOST_TEST_REQUIRE(world.get<tag>(entities[i])->value == i);
+		BOOST_TEST_REQUIRE(world.get<position>(entities[i])->x == static_cast<float>(i));
+	}
+	BOOST_TEST(world.size() == MANY - (MANY + 2) / 3);
+}
+
+// 追加・削除でアーキタイプを移っても、残るコンポーネントとハンドルはそのまま
+BOOST_AUTO_TEST_CASE(add_and_remove_move_between_archetypes)
+{
+	core::entity_world world;
+	const auto& a = world.create(position{ 1, 2, 3 });
+	const auto& b = world.create(position{ 4, 5, 6 });
+
+	world.add(a, velocity{ 7, 8, 9 });
+	BOOST_TEST(world.has<velocity>(a));
+	BOOST_TEST(world.get<position>(a)->z == 3.0f);
+	BOOST_TEST(world.get<velocity>(a)->x == 7.0f);
+
+	// 元のアーキタイプに残った方も変わらない
+	BOOST_TEST(world.get<position>(b)->x == 4.0f);
+	BOOST_TEST((world.count<position, velocity>() == 1u));
+
+	// 既にあれば上書き
+	world.add(a, velocity{ 10, 11, 12 });
+	BOOST_TEST(world.get<velocity>(a)->x == 10.0f);
+	BOOST_TEST((world.count<position, velocity>() == 1u));
+
+	world.remove<position>(a);
+	BOOST_TEST(!world.has<position>(a));
+	BOOST_TEST(world.get<velocity>(a)->y == 11.0f);
+
+	// 持っていないものを消しても何もしない
+	world.remove<tag>(a);
+	BOOST_TEST(world.alive(a));
+	BOOST_TEST(world.size() == 2u);
+}
+
+BOOST_AUTO_TEST_CASE(each_visits_matching_chunks)
+{
+	core::entity_world world;
+	for(auto i = 0u; i < MANY; ++i)
+	{
+		if(i % 2 == 0) world.create(position{ static_cast<float>(i), 0, 0 }, velocity{ 1, 0, 0 });
+		else world.create(position{ static_cast<float>(i), 0, 0 });
+	}
+
+	uint32_t visited = 0;
+	world.each<position, velocity>([&](gsl::span<const core::entity> entities, gsl::span<position> positions, gsl::span<velocity> velocities)
+	{
+		BOOST_TEST_REQUIRE(entities.size() == positions.size());
+		for(size_t i = 0; i < positions.size(); ++i) positions[i].x += velocities[i].x;
+		visited += gsl::narrow<uint32_t>(entities.size());
+	});
+	BOOST_TEST(visited == MANY / 2);
+
+	// velocity を持つもの (偶数番目) だけ進んでいる
+	double sum = 0.0;
+	world.each<position>([&](gsl::span<const core::entity>, gsl::span<position> positions)
+	{
+		for(const auto& p : positions) sum += p.x;
+	});
+	BOOST_TEST(sum == static_cast<double>(MANY) * (MANY - 1) / 2 + MANY / 2);
+
+	BOOST_TEST(world.collect_chunks(core::make_component_mask<position, velocity>()).size() > 1u);
+}
+
+BOOST_AUTO_TEST_CASE(parallel_each_matches_each)
+{
+	core::job_system jobs;
+	core::entity_world world;
+	for(auto i = 0u; i < MANY; ++i) world.create(tag{ i });
+
+	std::atomic<uint64_t> sum = 0;
+	world.parallel_each<tag>(jobs, [&](gsl::span<const core::entity>, gsl::span<tag> tags)
+	{
+		uint64_t local = 0;
+		for(const auto& t : tags) local += t.value;
+		sum += local;
+	});
+
+	BOOST_TEST(sum.load() == static_cast<uint64_t>(MANY) * (MANY - 1) / 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
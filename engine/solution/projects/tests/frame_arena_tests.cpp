@@ -0,0 +1,86 @@
+﻿#include "include.hpp"
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	// 2つのアーキタイプに分かれたシーン (チャンクが複数になる数)
+	void fill_world(core::entity_world& world, uint32_t count)
+	{
+		for(auto i = 0u; i < count; ++i)
+		{
+			auto transform = matrix4x4::identity();
+			transform.at(12u) = static_cast<float>(i);
+
+			if(i % 3 == 0) world.create(core::world_transform{ transform }, core::mesh_component{}, core::material_component{});
+			else world.create(core::world_transform{ transform }, core::mesh_component{});
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(frame_arena)
+
+BOOST_AUTO_TEST_CASE(linear_arena_aligns_and_grows)
+{
+	core::counting_resource upstream;
+	core::linear_arena arena(256, &upstream);
+	BOOST_TEST(upstream.allocations() == 1u);
+
+	auto* a = arena.allocate(3, 1);
+	auto* b = arena.allocate(64, 64);
+	BOOST_TEST(a != b);
+	BOOST_TEST(reinterpret_cast<uintptr_t>(b) % 64 == 0u);
+
+	// 入らない分は新しいチャンクになり、reset() で最大使用量の1チャンクにまとめ直す
+	BOOST_TEST(arena.allocate(1024, 16) != nullptr);
+	BOOST_TEST(upstream.allocations() == 2u);
+	arena.reset();
+	BOOST_TEST(upstream.allocations() == 3u);
+
+	// 同じ使い方なら以降は上流に触れない
+	for(auto frame = 0; frame < 4; ++frame)
+	{
+		BOOST_TEST(arena.allocate(3, 1) != nullptr);
+		BOOST_TEST(arena.allocate(64, 64) != nullptr);
+		BOOST_TEST(arena.allocate(1024, 16) != nullptr);
+		arena.reset();
+	}
+	BOOST_TEST(upstream.allocations() == 3u);
+	BOOST_TEST(arena.get_stats().high_water >= 1024u + 64u);
+}
+
+// tick のアリーナを渡した抽出は、使用量が落ち着けばヒープに触れない
+BOOST_AUTO_TEST_CASE(extract_with_arena_does_not_allocate)
+{
+	core::entity_world world;
+	fill_world(world, 20000);
+
+	// プロファイラのバッファはスレッドの最初の記録で作られるので、先に済ませる (ワーカーは job_system の起動時に済む)
+	PROFILE_THREAD("core_tests");
+
+	core::job_system jobs(2);
+	core::linear_arena arena(256);
+	std::vector<core::instance_record> out(world.size());
+
+	for(auto tick = 0; tick < 4; ++tick)
+	{
+		arena.reset();
+		BOOST_TEST(core::extract_instances(world, jobs, gsl::span<core::instance_record>(out), &arena) == world.size());
+	}
+
+	const auto& before = core::heap_allocations();
+	for(auto tick = 0; tick < 16; ++tick)
+	{
+		arena.reset();
+		core::extract_instances(world, jobs, gsl::span<core::instance_record>(out), &arena);
+	}
+	BOOST_TEST(core::heap_allocations() - before == 0u);
+
+	// 既定のリソースでは毎回チャンクの一覧と書き込み位置を確保する
+	const auto& heap_before = core::heap_allocations();
+	core::extract_instances(world, jobs, gsl::span<core::instance_record>(out));
+	BOOST_TEST(core::heap_allocations() - heap_before >= 2u);
+
+	BOOST_TEST(out.back().row_0[3] == 19999.0f);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
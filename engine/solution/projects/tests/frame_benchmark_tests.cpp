@@ -0,0 +1,75 @@
+﻿#include "include.hpp"
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(frame_benchmark)
+
+// 同じ種なら同じシーンになり、null バックエンドまで1フレームが通る
+BOOST_AUTO_TEST_CASE(deterministic_scene)
+{
+	core::job_system jobs(2);
+	const core::frame_benchmark_desc desc{ "test", 3000, 6, 2 };
+
+	const auto& a = core::run_frame_benchmark(desc, jobs);
+	const auto& b = core::run_frame_benchmark(desc, jobs);
+
+	BOOST_TEST(a.summary.frames == desc.frame_count - desc.warmup_frames);
+	BOOST_TEST(a.summary.stages.size() == 5u);
+	BOOST_TEST(a.summary.visible_per_frame > 0.0);
+	BOOST_TEST(a.summary.visible_per_frame < static_cast<double>(desc.instance_count));
+	BOOST_TEST(a.summary.visible_per_frame == b.summary.visible_per_frame);
+}
+
+BOOST_AUTO_TEST_CASE(writes_json)
+{
+	core::job_system jobs(1);
+	const std::array<core::frame_benchmark_desc, 1> benchmarks = { core::frame_benchmark_desc{ "json", 500, 3, 1 } };
+
+	const auto& path = (std::filesystem::temp_directory_path() / "frame_benchmark_test.json").string();
+	BOOST_TEST(core::run_frame_benchmarks(path, jobs, benchmarks));
+
+	std::ifstream file(path);
+	const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	BOOST_TEST(text.find("\"name\":\"json\"") != std::string::npos);
+	BOOST_TEST(text.find("\"stages\":{\"simulate\"") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(heap_allocations)
+
+// core_tests は allocation_hooks.cpp をリンクしているので数える
+BOOST_AUTO_TEST_CASE(counts_operator_new)
+{
+	BOOST_TEST(core::heap_allocation_tracking());
+
+	const auto& before = core::heap_allocations();
+	auto values = std::make_unique<std::vector<int>>();
+	values->resize(1000);
+	BOOST_TEST(core::heap_allocations() - before == 2u);
+}
+
+BOOST_AUTO_TEST_CASE(frame_stats_counts_allocations_in_frame)
+{
+	core::frame_stats stats;
+	stats.add_stage("work");
+
+	stats.begin_frame();
+	{
+		std::vector<int> values;
+		for(auto i = 0; i < 3; ++i) values.reserve(values.capacity() + 16);
+	}
+	stats.end_frame(0, 0);
+
+	stats.begin_frame();
+	stats.end_frame(0, 0);
+
+	const auto& samples = stats.samples();
+	BOOST_TEST(samples[0].allocations == 3u);
+	BOOST_TEST(samples[1].allocations == 0u);
+
+	const auto& summary = stats.summary();
+	BOOST_TEST(summary.allocations_tracked);
+	BOOST_TEST(summary.allocations_per_frame == 1.5);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,100 @@
+﻿#include "include.hpp"
+#include <boost/test/unit_test.hpp>
+
+using namespace std::chrono_literals;
+
+BOOST_AUTO_TEST_SUITE(frame_clock)
+
+BOOST_AUTO_TEST_CASE(delta_is_clamped_and_smoothed)
+{
+	core::manual_clock clock;
+	core::frame_clock frames(clock, 0.5, 250ms);
+
+	// 最初の tick は前がないので 0
+	clock.advance(5s);
+	BOOST_TEST(frames.tick().count() == 0);
+	BOOST_TEST(frames.delta() == 0.0);
+	BOOST_TEST(frames.histogram().count() == 0u);
+
+	// 2回目で平均を初期化する
+	clock.advance(10ms);
+	BOOST_TEST(frames.tick() == 10ms);
+	BOOST_TEST(frames.delta() == 0.010, boost::test_tools::tolerance(1e-12));
+	BOOST_TEST(frames.smoothed_delta() == 0.010, boost::test_tools::tolerance(1e-12));
+
+	// smoothing 0.5 なので新しい値との中間
+	clock.advance(20ms);
+	frames.tick();
+	BOOST_TEST(frames.smoothed_delta() == 0.015, boost::test_tools::tolerance(1e-12));
+
+	/*  止まっていた後: 戻り値とヒストグラムは実際の値、delta は max_delta まで  */
+	clock.advance(2s);
+	BOOST_TEST(frames.tick() == 2s);
+	BOOST_TEST(frames.delta() == 0.25, boost::test_tools::tolerance(1e-12));
+	BOOST_TEST(frames.smoothed_delta() == 0.1325, boost::test_tools::tolerance(1e-12));
+
+	BOOST_TEST(frames.frame_count() == 4u);
+	BOOST_TEST(frames.histogram().count() == 3u);
+	BOOST_TEST(frames.histogram().max() == 2s);
+	BOOST_TEST(frames.histogram().min() == 10ms);
+	BOOST_TEST(frames.histogram().bucket(core::frame_time_histogram::BUCKET_COUNT - 1) == 1u);
+}
+
+BOOST_AUTO_TEST_CASE(histogram_percentiles)
+{
+	core::manual_clock clock;
+	core::frame_clock frames(clock);
+	frames.tick();
+
+	// 60Hz のフレームが 90 回、33.3ms を超えたフレームが 10 回
+	for(auto i = 0; i < 100; ++i)
+	{
+		clock.advance(i % 10 == 9 ? 40ms : 16ms);
+		frames.tick();
+	}
+
+	const auto& histogram = frames.histogram();
+	BOOST_TEST(histogram.count() == 100u);
+	BOOST_TEST(histogram.average() == 18'400us);
+
+	// バケットの上端を返す (0.5ms 刻み)
+	BOOST_TEST(histogram.percentile(0.5) == 16'500us);
+	BOOST_TEST(histogram.percentile(0.9) == 16'500us);
+	BOOST_TEST(histogram.percentile(0.91) == 40'500us);
+	BOOST_TEST(histogram.percentile(1.0) == 40'500us);
+
+	BOOST_TEST(histogram.count_over(33'333us) == 10u);
+	BOOST_TEST(histogram.count_over(16ms) == 100u);
+	BOOST_TEST(histogram.count_over(16'001us) == 10u);
+
+	frames.histogram().clear();
+	BOOST_TEST(histogram.count() == 0u);
+	BOOST_TEST(histogram.percentile(0.5).count() == 0);
+	BOOST_TEST(histogram.min().count() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(fixed_timestep_accumulates)
+{
+	core::fixed_timestep timestep(10ms, 3);
+
+	BOOST_TEST(timestep.advance(4ms) == 0u);
+	BOOST_TEST(timestep.alpha() == 0.4, boost::test_tools::tolerance(1e-12));
+	BOOST_TEST(timestep.until_next() == 6ms);
+
+	BOOST_TEST(timestep.advance(17ms) == 2u);
+	BOOST_TEST(timestep.until_next() == 9ms);
+
+	// 時刻が戻っても減らさない
+	BOOST_TEST(timestep.advance(-5ms) == 0u);
+	BOOST_TEST(timestep.until_next() == 9ms);
+
+	// max_steps を超えた分は捨てて、端数は残す
+	BOOST_TEST(timestep.advance(59ms) == 3u);
+	BOOST_TEST(timestep.dropped() == 30ms);
+	BOOST_TEST(timestep.until_next() == 10ms);
+
+	BOOST_TEST(timestep.total_steps() == 5u);
+	BOOST_TEST(timestep.step_seconds() == 0.01, boost::test_tools::tolerance(1e-12));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,49 @@
+﻿#include "include.hpp"
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(frame_counters)
+
+BOOST_AUTO_TEST_CASE(sums_increments_from_every_thread)
+{
+	auto& counters = core::frame_counters::get();
+	const auto& counter = counters.register_counter("test_sum");
+
+	counters.end_frame();
+
+	core::frame_counters::add(counter, 3);
+	std::thread([&]{ core::frame_counters::add(counter, 4); }).join();
+
+	counters.end_frame();
+	BOOST_TEST(counters.value(counter) == 7u);
+
+	// 次のフレームには持ち越さない
+	counters.end_frame();
+	BOOST_TEST(counters.value(counter) == 0u);
+	BOOST_TEST(counters.value(counter, 1) == 7u);
+}
+
+BOOST_AUTO_TEST_CASE(snapshot_survives_history_overwrite)
+{
+	auto& counters = core::frame_counters::get();
+	const auto& counter = counters.register_counter("test_snapshot");
+
+	core::frame_counters::add(counter, 42);
+	counters.end_frame();
+
+	const auto& snapshot = counters.snapshot();
+	BOOST_TEST_REQUIRE(counter < snapshot.values.size());
+	BOOST_TEST(snapshot.values[counter] == 42u);
+
+	// 履歴を一周させて同じ場所を上書きしても、取ったスナップショットは変わらない
+	for(size_t i = 0; i < core::frame_counters::HISTORY; ++i)
+	{
+		core::frame_counters::add(counter, 1);
+		counters.end_frame();
+	}
+
+	BOOST_TEST(snapshot.values[counter] == 42u);
+	BOOST_TEST(counters.value(counter) == 1u);
+	BOOST_TEST(counters.snapshot(core::frame_counters::HISTORY).values.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,228 @@
+﻿#include "include.hpp"
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	/*
+		GPU の代わりにクエリヒープを配列で持つバックエンド
+		timestamp() は now を書き、resolve() した範囲だけ read() で読めるようにする
+	*/
+	class fake_query_backend : public core::gpu_query_backend
+	{
+	public:
+		static constexpr uint64_t FREQUENCY = 1000000;		// 1 tick = 1 us
+
+		struct resolve_call
+		{
+			uint32_t first_timestamp;
+			uint32_t timestamp_count;
+			uint32_t first_statistics;
+			uint32_t statistics_count;
+		};
+
+	public:
+		fake_query_backend(uint32_t timestamps, uint32_t statistics)
+			: m_timestamps(timestamps)
+			, m_timestamp_resolved(timestamps, 0)
+			, m_statistics(statistics)
+			, m_statistics_resolved(statistics, 0)
+		{
+		}
+
+	public:
+		void timestamp(uint32_t index) override
+		{
+			m_timestamps.at(index) = now;
+			m_timestamp_resolved.at(index) = 0;
+		}
+
+		void begin_statistics(uint32_t index) override
+		{
+			m_statistics.at(index) = {};
+			m_statistics_resolved.at(index) = 0;
+		}
+
+		void end_statistics(uint32_t index) override
+		{
+			m_statistics.at(index).vs_invocations = 1000 + index;
+		}
+
+		void resolve(uint32_t first_timestamp, uint32_t timestamp_count, uint32_t first_statistics, uint32_t statistics_count) override
+		{
+			resolves.push_back(resolve_call{ first_timestamp, timestamp_count, first_statistics, statistics_count });
+			std::fill_n(m_timestamp_resolved.begin() + first_timestamp, timestamp_count, uint8_t(1));
+			std::fill_n(m_statistics_resolved.begin() + first_statistics, statistics_count, uint8_t(1));
+		}
+
+		void read(uint32_t first_timestamp, gsl::span<uint64_t> timestamps, uint32_t first_statistics, gsl::span<core::gpu_pipeline_stats> statistics) override
+		{
+			++reads;
+			for(size_t i = 0; i < timestamps.size(); ++i)
+			{
+				BOOST_TEST_REQUIRE(m_timestamp_resolved.at(first_timestamp + i) != 0);
+				timestamps[i] = m_timestamps.at(first_timestamp + i);
+			}
+			for(size_t i = 0; i < statistics.size(); ++i)
+			{
+				BOOST_TEST_REQUIRE(m_statistics_resolved.at(first_statistics + i) != 0);
+				statistics[i] = m_statistics.at(first_statistics + i);
+			}
+		}
+
+		uint64_t frequency() override { return FREQUENCY; }
+
+		void calibrate(uint64_t& gpu_timestamp, uint64_t& cpu_ticks) override
+		{
+			gpu_timestamp = now;
+			cpu_ticks = core::profile_clock();
+		}
+
+		// 次のタイムスタンプに書く値を進める
+		inline void advance_us(uint64_t us) noexcept { now += us; }
+
+		// ヒープ上の値を直接書き換える (壊れた値の再現用)
+		inline void overwrite(uint32_t index, uint64_t value) { m_timestamps.at(index) = value; }
+
+	public:
+		uint64_t now = 5000;
+		std::vector<resolve_call> resolves;
+		uint32_t reads = 0;
+
+	private:
+		std::vector<uint64_t> m_timestamps;
+		std::vector<uint8_t> m_timestamp_resolved;
+		std::vector<core::gpu_pipeline_stats> m_statistics;
+		std::vector<uint8_t> m_statistics_resolved;
+	};
+
+	constexpr uint32_t FRAME_COUNT = 3;
+	constexpr uint32_t MAX_SCOPES = 4;
+
+	fake_query_backend make_backend()
+	{
+		return fake_query_backend(core::gpu_profiler::timestamp_capacity(FRAME_COUNT, MAX_SCOPES), core::gpu_profiler::statistics_capacity(FRAME_COUNT, MAX_SCOPES));
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(gpu_profiler)
+
+BOOST_AUTO_TEST_CASE(results_arrive_when_frame_buffer_is_reused)
+{
+	auto backend = make_backend();
+	core::gpu_profiler profiler(&backend, FRAME_COUNT, MAX_SCOPES);
+
+	/*  フレーム n は frame_count フレーム後に同じバッファを使い始めたところで読める  */
+	for(auto frame = 0u; frame < FRAME_COUNT * 3; ++frame)
+	{
+		const auto& buffer = frame % FRAME_COUNT;
+		profiler.begin_frame(buffer);
+
+		if(frame < FRAME_COUNT)
+		{
+			BOOST_TEST(backend.reads == 0u);
+			BOOST_TEST(profiler.results().empty());
+		}
+		else
+		{
+			BOOST_TEST(backend.reads == frame - FRAME_COUNT + 1);
+
+			// frame - FRAME_COUNT の長さ (下の記録を参照)
+			const auto& results = profiler.results();
+			BOOST_TEST_REQUIRE(results.size() == 2u);
+			BOOST_TEST(std::string_view(results[0].name) == "pass");
+			BOOST_TEST(results[0].depth == 0u);
+			BOOST_TEST(results[0].begin_ms == 0.0);
+			BOOST_TEST(results[0].duration_ms == 0.1 * (frame - FRAME_COUNT + 1) + 0.3, boost::test_tools::tolerance(1e-9));
+			BOOST_TEST(!results[0].has_statistics);
+
+			BOOST_TEST(std::string_view(results[1].name) == "draw");
+			BOOST_TEST(results[1].depth == 1u);
+			BOOST_TEST(results[1].begin_ms == 0.1, boost::test_tools::tolerance(1e-9));
+			BOOST_TEST(results[1].duration_ms == 0.1 * (frame - FRAME_COUNT + 1), boost::test_tools::tolerance(1e-9));
+			BOOST_TEST(results[1].has_statistics);
+			BOOST_TEST(results[1].statistics.vs_invocations == 1000u + buffer * MAX_SCOPES);
+		}
+
+		// pass { 100us, draw { (frame + 1) * 100us }, 200us }
+		profiler.begin_scope("pass");
+		backend.advance_us(100);
+		profiler.begin_scope("draw", true);
+		backend.advance_us((frame + 1) * 100);
+		profiler.end_scope();
+		backend.advance_us(200);
+		profiler.end_scope();
+		profiler.end_frame();
+
+		/*  resolve はこのバッファの範囲だけ  */
+		BOOST_TEST_REQUIRE(backend.resolves.size() == frame + 1);
+		const auto& call = backend.resolves.back();
+		BOOST_TEST(call.first_timestamp == buffer * MAX_SCOPES * 2);
+		BOOST_TEST(call.timestamp_count == 4u);
+		BOOST_TEST(call.first_statistics == buffer * MAX_SCOPES);
+		BOOST_TEST(call.statistics_count == 1u);
+
+		backend.advance_us(1000);
+	}
+
+	BOOST_TEST(profiler.dropped() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(scopes_over_capacity_are_dropped)
+{
+	auto backend = make_backend();
+	core::gpu_profiler profiler(&backend, FRAME_COUNT, MAX_SCOPES);
+
+	profiler.begin_frame(0);
+	for(auto i = 0u; i < MAX_SCOPES + 2; ++i)
+	{
+		// 入れ子にしても開いた数と閉じた数は揃う
+		profiler.begin_scope("outer");
+		profiler.begin_scope("inner");
+		backend.advance_us(10);
+		profiler.end_scope();
+		profiler.end_scope();
+	}
+	profiler.end_frame();
+
+	BOOST_TEST(profiler.dropped() == (MAX_SCOPES + 2) * 2 - MAX_SCOPES);
+	BOOST_TEST_REQUIRE(backend.resolves.size() == 1u);
+	BOOST_TEST(backend.resolves.back().timestamp_count == MAX_SCOPES * 2);
+
+	for(auto frame = 1u; frame <= FRAME_COUNT; ++frame)
+	{
+		profiler.begin_frame(frame % FRAME_COUNT);
+		profiler.end_frame();
+	}
+	BOOST_TEST(profiler.results().size() == MAX_SCOPES);
+
+	// スコープのないフレームは resolve も read もしない
+	BOOST_TEST(backend.resolves.size() == 1u);
+	BOOST_TEST(backend.reads == 1u);
+}
+
+BOOST_AUTO_TEST_CASE(corrupt_timestamps_are_skipped)
+{
+	auto backend = make_backend();
+	core::gpu_profiler profiler(&backend, FRAME_COUNT, MAX_SCOPES);
+
+	profiler.begin_frame(1);
+	for(auto i = 0; i < 3; ++i)
+	{
+		profiler.begin_scope("pass");
+		backend.advance_us(50);
+		profiler.end_scope();
+	}
+	profiler.end_frame();
+
+	// 2つ目のスコープの終わりが始まりより前 (デバイスのリセットなど)
+	const auto& base = 1 * MAX_SCOPES * 2;
+	backend.overwrite(base + 3, 0);
+
+	profiler.begin_frame(1);
+	BOOST_TEST_REQUIRE(profiler.results().size() == 2u);
+	BOOST_TEST(profiler.results()[0].begin_ms == 0.0);
+	BOOST_TEST(profiler.results()[1].begin_ms == 0.1, boost::test_tools::tolerance(1e-9));
+	profiler.end_frame();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,664 @@
+﻿#pragma once
+
+/*
+	置き換える前 (3fd79d4) の vector2/3/4 と matrix4x4 をそのまま写したもの。basic_vector / basic_matrix と比べるテストだけで使う
+	namespace を math から legacy に変えた以外は手を入れていない (既知の誤りもそのまま残す)
+	・normalize() は length() ではなく length_square() で割る
+	・vector3 / vector4 の operator/ は自分を呼び続ける
+	・matrix4x4 の operator+ / operator- は和と差を転置して返し、operator* は (b * a) の転置を返す
+*/
+
+/*  -----  vector2.hpp  -----------------------------------  */
+
+namespace
+{
+	constexpr uint8_t VEC2_X = 0u;
+	constexpr uint8_t VEC2_Y = 1u;
+	constexpr uint8_t VEC2_COUNT = 2u;
+}
+
+namespace legacy
+{
+	template<typename T> class basic_vector2
+	{
+	public:
+		explicit inline constexpr basic_vector2();
+		explicit inline constexpr basic_vector2(T value);
+		explicit inline constexpr basic_vector2(T x, T y);
+
+	public:
+		inline constexpr T* data();
+		inline constexpr T& x();
+		inline constexpr T& y();
+
+	public:
+		inline constexpr const T* data() const;
+		inline constexpr const T& x() const;
+		inline constexpr const T& y() const;
+
+	public:
+		inline constexpr basic_vector2& operator+=(const basic_vector2& other);
+		inline constexpr basic_vector2& operator-=(const basic_vector2& other);
+		inline constexpr basic_vector2& operator*=(float value);
+		inline constexpr basic_vector2& operator/=(float value);
+
+	public:
+		inline constexpr basic_vector2 operator+(const basic_vector2& other) const;
+		inline constexpr basic_vector2 operator-(const basic_vector2& other) const;
+		inline constexpr basic_vector2 operator*(float value) const;
+		inline constexpr basic_vector2 operator/(float value) const;
+
+	public:
+		inline constexpr void normalize();
+
+	public:
+		inline constexpr T length_square() const;
+		inline constexpr T length() const;
+		inline constexpr basic_vector2 normalized() const;
+		inline constexpr float dot(basic_vector2 other) const;
+		inline constexpr float cross(basic_vector2 other) const;
+
+	private:
+		std::array<T, VEC2_COUNT> _;
+	};
+
+	/*  -----  using宣言  -----------------------------------  */
+
+	using vector2 = basic_vector2<float>;
+	using vector2f = basic_vector2<float>;
+	using vector2d = basic_vector2<double>;
+	using vector2i = basic_vector2<int32_t>;
+	using vector2u = basic_vector2<uint32_t>;
+
+	/*  -----  inline定義  -----------------------------------  */
+
+	template<typename T> inline constexpr basic_vector2<T>::basic_vector2() : basic_vector2(0) {}
+	template<typename T> inline constexpr basic_vector2<T>::basic_vector2(T value) : basic_vector2(value, value) {}
+	template<typename T> inline constexpr basic_vector2<T>::basic_vector2(T x, T y) : _{x,y} {}
+
+	template<typename T> inline constexpr T* basic_vector2<T>::data() { return _.data(); }
+	template<typename T> inline constexpr T& basic_vector2<T>::x() { return _.at(VEC2_X); }
+	template<typename T> inline constexpr T& basic_vector2<T>::y() { return _.at(VEC2_Y); }
+
+	template<typename T> inline constexpr const T* basic_vector2<T>::data() const { return _.data(); }
+	template<typename T> inline constexpr const T& basic_vector2<T>::x() const { return _.at(VEC2_X); }
+	template<typename T> inline constexpr const T& basic_vector2<T>::y() const { return _.at(VEC2_Y); }
+
+	template<typename T> inline constexpr basic_vector2<T>& basic_vector2<T>::operator+=(const basic_vector2& other)
+	{
+		x() += other.x();
+		y() += other.y();
+		return *this;
+	}
+
+	template<typename T> inline constexpr basic_vector2<T>& basic_vector2<T>::operator-=(const basic_vector2& other)
+	{
+		x() -= other.x();
+		y() -= other.y();
+		return *this;
+	}
+
+	template<typename T> inline constexpr basic_vector2<T>& basic_vector2<T>::operator*=(float value)
+	{
+		x() *= value;
+		y() *= value;
+		return *this;
+	}
+
+	template<typename T> inline constexpr basic_vector2<T>& basic_vector2<T>::operator/=(float value)
+	{
+		return *this *= 1.0f / value;
+	}
+
+	template<typename T> inline constexpr basic_vector2<T> basic_vector2<T>::operator+(const basic_vector2& other) const { return basic_vector2(x() + other.x(), y() + other.y()); }
+	template<typename T> inline constexpr basic_vector2<T> basic_vector2<T>::operator-(const basic_vector2& other) const { return basic_vector2(x() - other.x(), y() - other.y()); }
+	template<typename T> inline constexpr basic_vector2<T> basic_vector2<T>::operator*(float value) const { return basic_vector2(x() * value, y() * value); }
+	template<typename T> inline constexpr basic_vector2<T> basic_vector2<T>::operator/(float value) const { return *this * 1.0f / value; }
+
+	template<typename T> inline constexpr void basic_vector2<T>::normalize()
+	{
+		*this /= length_square();
+	}
+
+	template<typename T> inline constexpr T basic_vector2<T>::length_square() const
+	{
+		return x() * x() + y() * y();
+	}
+
+	template<typename T> inline constexpr T basic_vector2<T>::length() const
+	{
+		return math::sqrt(this->length_square());
+	}
+
+	template<typename T> inline constexpr basic_vector2<T> basic_vector2<T>::normalized() const
+	{
+		basic_vector2 copy = *this;
+		copy.normalize();
+		return copy;
+	}
+
+	template<typename T> inline constexpr float basic_vector2<T>::dot(basic_vector2 other) const
+	{
+		return x() * other.x() + y() * other.y();
+	}
+
+	template<typename T> inline constexpr float basic_vector2<T>::cross(basic_vector2 other) const
+	{
+		return x() * other.y() - other.x() * y();
+	}
+}
+
+/*  -----  vector3.hpp  -----------------------------------  */
+
+namespace
+{
+	inline constexpr uint8_t VEC3_X = 0u;
+	inline constexpr uint8_t VEC3_Y = 1u;
+	inline constexpr uint8_t VEC3_Z = 2u;
+	inline constexpr uint8_t VEC3_COUNT = 3u;
+}
+
+namespace legacy
+{
+	template<typename T> class basic_vector3
+	{
+	public:
+		explicit inline constexpr basic_vector3() noexcept;
+		explicit inline constexpr basic_vector3(T value) noexcept;
+		explicit inline constexpr basic_vector3(T x, T y, T z) noexcept;
+
+	public:
+		inline constexpr T* data() noexcept;
+		inline constexpr T& x() noexcept;
+		inline constexpr T& y() noexcept;
+		inline constexpr T& z() noexcept;
+		inline constexpr T& at(const size_t index);
+
+	public:
+		inline constexpr const T* data() const noexcept;
+		inline constexpr const T& x() const noexcept;
+		inline constexpr const T& y() const noexcept;
+		inline constexpr const T& z() const noexcept;
+		inline constexpr T& at(const size_t index) const;
+
+	public:
+		inline constexpr basic_vector3& operator+=(const basic_vector3& other) noexcept;
+		inline constexpr basic_vector3& operator-=(const basic_vector3& other) noexcept;
+		inline constexpr basic_vector3& operator*=(float value) noexcept;
+		inline constexpr basic_vector3& operator/=(float value) noexcept;
+
+	public:
+		inline constexpr basic_vector3 operator+(const basic_vector3& other) const noexcept;
+		inline constexpr basic_vector3 operator-(const basic_vector3& other) const noexcept;
+		inline constexpr basic_vector3 operator*(float value) const noexcept;
+		inline constexpr basic_vector3 operator/(float value) const noexcept;
+
+	public:
+		inline constexpr basic_vector3 operator-() const noexcept;
+
+	public:
+		inline constexpr void normalize();
+
+	public:
+		inline constexpr T length_square() const;
+		inline constexpr T length() const;
+		inline constexpr basic_vector3 normalized() const;
+		inline constexpr float dot(const basic_vector3& other) const;
+		inline constexpr basic_vector3 cross(const basic_vector3& other) const;
+
+	public:
+		static inline constexpr basic_vector3 right() noexcept;
+		static inline constexpr basic_vector3 left() noexcept;
+		static inline constexpr basic_vector3 up() noexcept;
+		static inline constexpr basic_vector3 down() noexcept;
+		static inline constexpr basic_vector3 forward() noexcept;
+		static inline constexpr basic_vector3 backward() noexcept;
+		static inline constexpr basic_vector3 one() noexcept;
+		static inline constexpr basic_vector3 zero() noexcept;
+
+	private:
+		std::array<T, VEC3_COUNT> _;
+	};
+
+	/*  -----  using宣言  -----------------------------------  */
+
+	using vector3 = basic_vector3<float>;
+	using vector3f = basic_vector3<float>;
+	using vector3d = basic_vector3<double>;
+	using vector3i = basic_vector3<int32_t>;
+	using vector3u = basic_vector3<uint32_t>;
+
+	/*  -----  inline定義  -----------------------------------  */
+
+	template<typename T> inline constexpr basic_vector3<T>::basic_vector3() noexcept : basic_vector3(0) {}
+	template<typename T> inline constexpr basic_vector3<T>::basic_vector3(T value) noexcept : basic_vector3(value, value, value) {}
+	template<typename T> inline constexpr basic_vector3<T>::basic_vector3(T x, T y, T z) noexcept : _{ x,y,z } {}
+
+	template<typename T> inline constexpr T* basic_vector3<T>::data() noexcept { return _.data(); }
+	template<typename T> inline constexpr T& basic_vector3<T>::x() noexcept { return _.at(VEC3_X); }
+	template<typename T> inline constexpr T& basic_vector3<T>::y() noexcept { return _.at(VEC3_Y); }
+	template<typename T> inline constexpr T& basic_vector3<T>::z() noexcept { return _.at(VEC3_Z); }
+
+	template<typename T> inline constexpr T& basic_vector3<T>::at(const size_t index) { _.at(index); }
+
+	template<typename T> inline constexpr const T* basic_vector3<T>::data() const noexcept { return _.data(); }
+	template<typename T> inline constexpr const T& basic_vector3<T>::x() const noexcept { return _.at(VEC3_X); }
+	template<typename T> inline constexpr const T& basic_vector3<T>::y() const noexcept { return _.at(VEC3_Y); }
+	template<typename T> inline constexpr const T& basic_vector3<T>::z() const noexcept { return _.at(VEC3_Z); }
+
+	template<typename T> inline constexpr T& basic_vector3<T>::at(const size_t index) const { _.at(index); }
+
+	template<typename T> inline constexpr basic_vector3<T>& basic_vector3<T>::operator+=(const basic_vector3& other) noexcept
+	{
+		x() += other.x();
+		y() += other.y();
+		z() += other.z();
+		return *this;
+	}
+
+	template<typename T> inline constexpr basic_vector3<T>& basic_vector3<T>::operator-=(const basic_vector3& other) noexcept
+	{
+		x() -= other.x();
+		y() -= other.y();
+		z() -= other.z();
+		return *this;
+	}
+
+	template<typename T> inline constexpr basic_vector3<T>& basic_vector3<T>::operator*=(float value) noexcept
+	{
+		x() *= value;
+		y() *= value;
+		z() *= value;
+		return *this;
+	}
+
+	template<typename T> inline constexpr basic_vector3<T>& basic_vector3<T>::operator/=(float value) noexcept
+	{
+		return *this *= 1.0f / value;
+	}
+
+	template<typename T> inline constexpr basic_vector3<T> basic_vector3<T>::operator+(const basic_vector3& other) const noexcept { return basic_vector3(x() + other.x(), y() + other.y(), z() + other.z()); }
+	template<typename T> inline constexpr basic_vector3<T> basic_vector3<T>::operator-(const basic_vector3& other) const noexcept { return basic_vector3(x() - other.x(), y() - other.y(), z() - other.z()); }
+	template<typename T> inline constexpr basic_vector3<T> basic_vector3<T>::operator*(float value) const noexcept { return basic_vector3(x() * value, y() * value, z() * value); }
+	template<typename T> inline constexpr basic_vector3<T> basic_vector3<T>::operator/(float value) const noexcept { return *this * 1.0f / value; }
+
+	template<typename T> inline constexpr basic_vector3<T> basic_vector3<T>::operator-() const noexcept { return basic_vector3(-x(), -y(), -z()); }
+
+	template<typename T> inline constexpr void basic_vector3<T>::normalize()
+	{
+		*this /= length_square();
+	}
+
+	template<typename T> inline constexpr T basic_vector3<T>::length_square() const
+	{
+		return x() * x() + y() * y() + z() * z();
+	}
+
+	template<typename T> inline constexpr T basic_vector3<T>::length() const
+	{
+		return math::sqrt(this->length_square());
+	}
+
+	template<typename T> inline constexpr basic_vector3<T> basic_vector3<T>::normalized() const
+	{
+		basic_vector3 copy = *this;
+		copy.normalize();
+		return copy;
+	}
+
+	template<typename T> inline constexpr float basic_vector3<T>::dot(const basic_vector3& other) const
+	{
+		return x() * other.x() + y() * other.y() + z() * other.z();
+	}
+
+	template<typename T> inline constexpr basic_vector3<T> basic_vector3<T>::cross(const basic_vector3& other) const
+	{
+		return basic_vector3
+		(
+			y() * other.z() - z() * other.y(),
+			z() * other.x() - x() * other.z(),
+			x() * other.y() - y() * other.x()
+		);
+	}
+
+	template<typename T> inline constexpr basic_vector3<T> basic_vector3<T>::right() noexcept { return basic_vector3(1, 0, 0); }
+	template<typename T> inline constexpr basic_vector3<T> basic_vector3<T>::left() noexcept { return basic_vector3(-1, 0, 0); }
+	template<typename T> inline constexpr basic_vector3<T> basic_vector3<T>::up() noexcept { return basic_vector3(0, 1, 0); }
+	template<typename T> inline constexpr basic_vector3<T> basic_vector3<T>::down() noexcept { return basic_vector3(0, -1, 0); }
+	template<typename T> inline constexpr basic_vector3<T> basic_vector3<T>::forward() noexcept { return basic_vector3(0, 0, 1); }
+	template<typename T> inline constexpr basic_vector3<T> basic_vector3<T>::backward() noexcept { return basic_vector3(0, 0, -1); }
+	template<typename T> inline constexpr basic_vector3<T> basic_vector3<T>::one() noexcept { return basic_vector3(1, 1, 1); }
+	template<typename T> inline constexpr basic_vector3<T> basic_vector3<T>::zero() noexcept { return basic_vector3(0, 0, 0); }
+}
+
+/*  -----  vector4.hpp  -----------------------------------  */
+
+namespace
+{
+	constexpr uint8_t VEC4_X = 0u;
+	constexpr uint8_t VEC4_Y = 1u;
+	constexpr uint8_t VEC4_Z = 2u;
+	constexpr uint8_t VEC4_W = 3u;
+	constexpr uint8_t VEC4_COUNT = 4u;
+}
+
+namespace legacy
+{
+	template<typename T> class basic_vector4
+	{
+	public:
+		explicit inline constexpr basic_vector4() noexcept;
+		explicit inline constexpr basic_vector4(T value);
+		explicit inline constexpr basic_vector4(T x, T y, T z, T w);
+
+	public:
+		inline constexpr T* data();
+		inline constexpr T& x();
+		inline constexpr T& y();
+		inline constexpr T& z();
+		inline constexpr T& w();
+
+	public:
+		inline constexpr const T* data() const;
+		inline constexpr const T& x() const;
+		inline constexpr const T& y() const;
+		inline constexpr const T& z() const;
+		inline constexpr const T& w() const;
+
+	public:
+		inline constexpr basic_vector4& operator+=(const basic_vector4& other);
+		inline constexpr basic_vector4& operator-=(const basic_vector4& other);
+		inline constexpr basic_vector4& operator*=(float value);
+		inline constexpr basic_vector4& operator/=(float value);
+
+	public:
+		inline constexpr basic_vector4 operator+(const basic_vector4& other) const;
+		inline constexpr basic_vector4 operator-(const basic_vector4& other) const;
+		inline constexpr basic_vector4 operator*(float value) const;
+		inline constexpr basic_vector4 operator/(float value) const;
+
+	public:
+		inline constexpr void normalize();
+
+	public:
+		inline constexpr T length_square() const;
+		inline constexpr T length() const;
+		inline constexpr basic_vector4 normalized() const;
+		inline constexpr float dot(const basic_vector4& other) const;
+
+	public:
+		static inline constexpr basic_vector4 one() noexcept;
+		static inline constexpr basic_vector4 zero() noexcept;
+
+	private:
+		std::array<T, VEC4_COUNT> _;
+	};
+
+	/*  -----  using宣言  -----------------------------------  */
+	
+	using vector4 = basic_vector4<float>;
+	using vector4f = basic_vector4<float>;
+	using vector4d = basic_vector4<double>;
+	using vector4i = basic_vector4<int32_t>;
+	using vector4u = basic_vector4<uint32_t>;
+
+	/*  -----  inline定義  -----------------------------------  */
+
+	template<typename T> inline constexpr basic_vector4<T>::basic_vector4() noexcept : basic_vector4(0) {}
+	template<typename T> inline constexpr basic_vector4<T>::basic_vector4(T value) : basic_vector4(value, value, value, value) {}
+	template<typename T> inline constexpr basic_vector4<T>::basic_vector4(T x, T y, T z, T w) : _{ x,y,z,w } {}
+
+	template<typename T> inline constexpr T* basic_vector4<T>::data() { return _.data(); }
+	template<typename T> inline constexpr T& basic_vector4<T>::x() { return _.at(VEC4_X); }
+	template<typename T> inline constexpr T& basic_vector4<T>::y() { return _.at(VEC4_Y); }
+	template<typename T> inline constexpr T& basic_vector4<T>::z() { return _.at(VEC4_Z); }
+	template<typename T> inline constexpr T& basic_vector4<T>::w() { return _.at(VEC4_W); }
+
+	template<typename T> inline constexpr const T* basic_vector4<T>::data() const { return _.data(); }
+	template<typename T> inline constexpr const T& basic_vector4<T>::x() const { return _.at(VEC4_X); }
+	template<typename T> inline constexpr const T& basic_vector4<T>::y() const { return _.at(VEC4_Y); }
+	template<typename T> inline constexpr const T& basic_vector4<T>::z() const { return _.at(VEC4_Z); }
+	template<typename T> inline constexpr const T& basic_vector4<T>::w() const { return _.at(VEC4_W); }
+
+	template<typename T> inline constexpr basic_vector4<T>& basic_vector4<T>::operator+=(const basic_vector4& other)
+	{
+		x() += other.x();
+		y() += other.y();
+		z() += other.z();
+		w() += other.w();
+		return *this;
+	}
+
+	template<typename T> inline constexpr basic_vector4<T>& basic_vector4<T>::operator-=(const basic_vector4& other)
+	{
+		x() -= other.x();
+		y() -= other.y();
+		z() -= other.z();
+		w() -= other.w();
+		return *this;
+	}
+
+	template<typename T> inline constexpr basic_vector4<T>& basic_vector4<T>::operator*=(float value)
+	{
+		x() *= value;
+		y() *= value;
+		z() *= value;
+		w() *= value;
+		return *this;
+	}
+
+	template<typename T> inline constexpr basic_vector4<T>& basic_vector4<T>::operator/=(float value)
+	{
+		return *this *= 1.0f / value;
+	}
+
+	template<typename T> inline constexpr basic_vector4<T> basic_vector4<T>::operator+(const basic_vector4& other) const { return basic_vector4(x() + other.x(), y() + other.y(), z() + other.z(), w() + other.w()); }
+	template<typename T> inline constexpr basic_vector4<T> basic_vector4<T>::operator-(const basic_vector4& other) const { return basic_vector4(x() - other.x(), y() - other.y(), z() - other.z(), w() - other.w()); }
+	template<typename T> inline constexpr basic_vector4<T> basic_vector4<T>::operator*(float value) const { return basic_vector4(x() * value, y() * value, z() * value, w() * value); }
+	template<typename T> inline constexpr basic_vector4<T> basic_vector4<T>::operator/(float value) const { return *this * 1.0f / value; }
+
+	template<typename T> inline constexpr void basic_vector4<T>::normalize()
+	{
+		*this /= length_square();
+	}
+
+	template<typename T> inline constexpr T basic_vector4<T>::length_square() const
+	{
+		return x() * x() + y() * y() + z() * z() + w() * w();
+	}
+
+	template<typename T> inline constexpr T basic_vector4<T>::length() const
+	{
+		return math::sqrt(this->length_square());
+	}
+
+	template<typename T> inline constexpr basic_vector4<T> basic_vector4<T>::normalized() const
+	{
+		basic_vector4 copy = *this;
+		copy.normalize();
+		return copy;
+	}
+
+	template<typename T> inline constexpr float basic_vector4<T>::dot(const basic_vector4& other) const
+	{
+		return x() * other.x() + y() * other.y() + z() * other.z() + w() * other.w();
+	}
+
+	template<typename T> inline constexpr basic_vector4<T> basic_vector4<T>::one() noexcept { return basic_vector4(1, 1, 1, 1); }
+	template<typename T> inline constexpr basic_vector4<T> basic_vector4<T>::zero() noexcept { return basic_vector4(0, 0, 0, 0); }
+}
+
+/*  -----  matrix4x4.hpp  -----------------------------------  */
+
+namespace
+{
+	constexpr uint8_t MATRIX4X4_ROW = 4u;
+	constexpr uint8_t MATRIX4X4_COUNT = 16u;
+}
+
+namespace legacy
+{
+	template<typename T = float> class basic_matrix4x4
+	{
+	public:
+		inline constexpr explicit basic_matrix4x4() noexcept = default;
+		inline constexpr explicit basic_matrix4x4(float m_00, float m_01, float m_02, float m_03, float m_10, float m_11, float m_12, float m_13, float m_20, float m_21, float m_22, float m_23, float m_30, float m_31, float m_32, float m_33);
+
+	public:
+		inline constexpr T* data();
+		inline constexpr T& at(uint32_t i);
+		inline constexpr T& at(uint64_t x, uint64_t y);
+
+	public:
+		inline constexpr const T* data() const;
+		inline constexpr const T& at(uint32_t i) const;
+		inline constexpr const T& at(uint64_t x, uint64_t y) const;
+
+	public:
+		inline constexpr basic_matrix4x4& operator+=(const basic_matrix4x4& other);
+		inline constexpr basic_matrix4x4& operator-=(const basic_matrix4x4& other);
+		inline constexpr basic_matrix4x4& operator*=(const basic_matrix4x4& other);
+
+	public:
+		inline constexpr basic_matrix4x4 operator+(const basic_matrix4x4& other) const;
+		inline constexpr basic_matrix4x4 operator-(const basic_matrix4x4& other) const;
+		inline constexpr basic_matrix4x4 operator*(const basic_matrix4x4& other) const;
+
+	public:
+		static inline constexpr basic_matrix4x4 identity();
+
+	private:
+		std::array<T, MATRIX4X4_COUNT> _;
+	};
+
+	using matrix4x4 = basic_matrix4x4<float>;
+	using matrix4x4f = basic_matrix4x4<float>;
+	using matrix4x4d = basic_matrix4x4<double>;
+	using matrix4x4i = basic_matrix4x4<int32_t>;
+	using matrix4x4u = basic_matrix4x4<uint32_t>;
+
+	// ----------------------------------------------------------------------------------------------------
+	// inline定義
+	// ----------------------------------------------------------------------------------------------------
+
+	template<typename T> inline constexpr basic_matrix4x4<T>::basic_matrix4x4(float m_00, float m_01, float m_02, float m_03, float m_10, float m_11, float m_12, float m_13, float m_20, float m_21, float m_22, float m_23, float m_30, float m_31, float m_32, float m_33) : _{ m_00, m_01, m_02, m_03, m_10, m_11, m_12, m_13, m_20, m_21, m_22, m_23, m_30, m_31, m_32, m_33 } {}
+
+	template<typename T> inline constexpr T* basic_matrix4x4<T>::data() { return _.data(); }
+	template<typename T> inline constexpr T& basic_matrix4x4<T>::at(uint32_t i) { return _.at(i); }
+	template<typename T> inline constexpr T& basic_matrix4x4<T>::at(uint64_t x, uint64_t y) { return _.at(x + y * MATRIX4X4_ROW); }
+	template<typename T> inline constexpr const T* basic_matrix4x4<T>::data() const { return _.data(); }
+	template<typename T> inline constexpr const T& basic_matrix4x4<T>::at(uint32_t i) const { return _.at(i); }
+	template<typename T> inline constexpr const T& basic_matrix4x4<T>::at(uint64_t x, uint64_t y) const { return _.at(x + y * MATRIX4X4_ROW); }
+
+	template<typename T> inline constexpr basic_matrix4x4<T>& basic_matrix4x4<T>::operator+=(const basic_matrix4x4& other)
+	{
+		at(0, 0) += other.at(0, 0);
+		at(0, 1) += other.at(0, 1);
+		at(0, 2) += other.at(0, 2);
+		at(0, 3) += other.at(0, 3);
+
+		at(1, 0) += other.at(1, 0);
+		at(1, 1) += other.at(1, 1);
+		at(1, 2) += other.at(1, 2);
+		at(1, 3) += other.at(1, 3);
+
+		at(2, 0) += other.at(2, 0);
+		at(2, 1) += other.at(2, 1);
+		at(2, 2) += other.at(2, 2);
+		at(2, 3) += other.at(2, 3);
+
+		at(3, 0) += other.at(3, 0);
+		at(3, 1) += other.at(3, 1);
+		at(3, 2) += other.at(3, 2);
+		at(3, 3) += other.at(3, 3);
+
+		return *this;
+	}
+
+	template<typename T> inline constexpr basic_matrix4x4<T>& basic_matrix4x4<T>::operator-=(const basic_matrix4x4& other)
+	{
+		at(0, 0) -= other.at(0, 0);
+		at(0, 1) -= other.at(0, 1);
+		at(0, 2) -= other.at(0, 2);
+		at(0, 3) -= other.at(0, 3);
+
+		at(1, 0) -= other.at(1, 0);
+		at(1, 1) -= other.at(1, 1);
+		at(1, 2) -= other.at(1, 2);
+		at(1, 3) -= other.at(1, 3);
+
+		at(2, 0) -= other.at(2, 0);
+		at(2, 1) -= other.at(2, 1);
+		at(2, 2) -= other.at(2, 2);
+		at(2, 3) -= other.at(2, 3);
+
+		at(3, 0) -= other.at(3, 0);
+		at(3, 1) -= other.at(3, 1);
+		at(3, 2) -= other.at(3, 2);
+		at(3, 3) -= other.at(3, 3);
+
+		return *this;
+	}
+
+	template<typename T> inline constexpr basic_matrix4x4<T>& basic_matrix4x4<T>::operator*=(const basic_matrix4x4& other)
+	{
+		*this = *this * other;
+		return *this;
+	}
+
+	template<typename T> inline constexpr basic_matrix4x4<T> basic_matrix4x4<T>::operator+(const basic_matrix4x4& other) const
+	{
+		return basic_matrix4x4(
+			at(0, 0) + other.at(0, 0), at(0, 1) + other.at(0, 1), at(0, 2) + other.at(0, 2), at(0, 3) + other.at(0, 3),
+			at(1, 0) + other.at(1, 0), at(1, 1) + other.at(1, 1), at(1, 2) + other.at(1, 2), at(1, 3) + other.at(1, 3),
+			at(2, 0) + other.at(2, 0), at(2, 1) + other.at(2, 1), at(2, 2) + other.at(2, 2), at(2, 3) + other.at(2, 3),
+			at(3, 0) + other.at(3, 0), at(3, 1) + other.at(3, 1), at(3, 2) + other.at(3, 2), at(3, 3) + other.at(3, 3)
+		);
+	}
+
+	template<typename T> inline constexpr basic_matrix4x4<T> basic_matrix4x4<T>::operator-(const basic_matrix4x4& other) const
+	{
+		return basic_matrix4x4(
+			at(0, 0) - other.at(0, 0), at(0, 1) - other.at(0, 1), at(0, 2) - other.at(0, 2), at(0, 3) - other.at(0, 3),
+			at(1, 0) - other.at(1, 0), at(1, 1) - other.at(1, 1), at(1, 2) - other.at(1, 2), at(1, 3) - other.at(1, 3),
+			at(2, 0) - other.at(2, 0), at(2, 1) - other.at(2, 1), at(2, 2) - other.at(2, 2), at(2, 3) - other.at(2, 3),
+			at(3, 0) - other.at(3, 0), at(3, 1) - other.at(3, 1), at(3, 2) - other.at(3, 2), at(3, 3) - other.at(3, 3)
+		);
+	}
+
+	template<typename T> inline constexpr basic_matrix4x4<T> basic_matrix4x4<T>::operator*(const basic_matrix4x4& other) const
+	{
+		return basic_matrix4x4(
+			at(0, 0) * other.at(0, 0) + at(0, 1) * other.at(1, 0) + at(0, 2) * other.at(2, 0) + at(0, 3) * other.at(3, 0),
+			at(0, 0) * other.at(0, 1) + at(0, 1) * other.at(1, 1) + at(0, 2) * other.at(2, 1) + at(0, 3) * other.at(3, 1),
+			at(0, 0) * other.at(0, 2) + at(0, 1) * other.at(1, 2) + at(0, 2) * other.at(2, 2) + at(0, 3) * other.at(3, 2),
+			at(0, 0) * other.at(0, 3) + at(0, 1) * other.at(1, 3) + at(0, 2) * other.at(2, 3) + at(0, 3) * other.at(3, 3),
+
+			at(1, 0) * other.at(0, 0) + at(1, 1) * other.at(1, 0) + at(1, 2) * other.at(2, 0) + at(1, 3) * other.at(3, 0),
+			at(1, 0) * other.at(0, 1) + at(1, 1) * other.at(1, 1) + at(1, 2) * other.at(2, 1) + at(1, 3) * other.at(3, 1),
+			at(1, 0) * other.at(0, 2) + at(1, 1) * other.at(1, 2) + at(1, 2) * other.at(2, 2) + at(1, 3) * other.at(3, 2),
+			at(1, 0) * other.at(0, 3) + at(1, 1) * other.at(1, 3) + at(1, 2) * other.at(2, 3) + at(1, 3) * other.at(3, 3),
+
+			at(2, 0) * other.at(0, 0) + at(2, 1) * other.at(1, 0) + at(2, 2) * other.at(2, 0) + at(2, 3) * other.at(3, 0),
+			at(2, 0) * other.at(0, 1) + at(2, 1) * other.at(1, 1) + at(2, 2) * other.at(2, 1) + at(2, 3) * other.at(3, 1),
+			at(2, 0) * other.at(0, 2) + at(2, 1) * other.at(1, 2) + at(2, 2) * other.at(2, 2) + at(2, 3) * other.at(3, 2),
+			at(2, 0) * other.at(0, 3) + at(2, 1) * other.at(1, 3) + at(2, 2) * other.at(2, 3) + at(2, 3) * other.at(3, 3),
+
+			at(3, 0) * other.at(0, 0) + at(3, 1) * other.at(1, 0) + at(3, 2) * other.at(2, 0) + at(3, 3) * other.at(3, 0),
+			at(3, 0) * other.at(0, 1) + at(3, 1) * other.at(1, 1) + at(3, 2) * other.at(2, 1) + at(3, 3) * other.at(3, 1),
+			at(3, 0) * other.at(0, 2) + at(3, 1) * other.at(1, 2) + at(3, 2) * other.at(2, 2) + at(3, 3) * other.at(3, 2),
+			at(3, 0) * other.at(0, 3) + at(3, 1) * other.at(1, 3) + at(3, 2) * other.at(2, 3) + at(3, 3) * other.at(3, 3)
+		);
+	}
+
+	template<typename T> inline constexpr basic_matrix4x4<T> basic_matrix4x4<T>::identity()
+	{
+		return basic_matrix4x4
+		(
+			1, 0, 0, 0,
+			0, 1, 0, 0,
+			0, 0, 1, 0,
+			0, 0, 0, 1
+		);
+	}
+}
\ No newline at end of file
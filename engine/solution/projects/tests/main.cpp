@@ -0,0 +1,2 @@
+﻿#define BOOST_TEST_MODULE core_tests
+#include <boost/test/included/unit_test.hpp>
\ No newline at end of file
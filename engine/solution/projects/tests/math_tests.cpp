@@ -0,0 +1,160 @@
+﻿#include "include.hpp"
+#include "legacy_math.hpp"
+#include <boost/test/unit_test.hpp>
+
+/*
+	basic_vector / basic_matrix を置き換える前のクラス (legacy_math.hpp) と比べる
+	要素ごとの演算・dot・cross は同じ式なのでビット単位で一致する
+	行列の +, -, * は前のクラスが転置した結果を返していたので、転置して比べる
+*/
+namespace
+{
+	constexpr size_t COUNT = 10000;
+
+	std::vector<float> uniform(uint64_t stream, size_t count)
+	{
+		std::vector<float> values(count);
+		math::philox4x32(71, stream).fill_uniform(values, -10.0f, 10.0f);
+		return values;
+	}
+
+	template<class V> bool same(const V& a, const legacy::vector3& b)
+	{
+		return a.x() == b.x() && a.y() == b.y() && a.z() == b.z();
+	}
+
+	template<class V> bool same(const V& a, const legacy::vector4& b)
+	{
+		return a.x() == b.x() && a.y() == b.y() && a.z() == b.z() && a.w() == b.w();
+	}
+
+	legacy::matrix4x4 to_legacy(const matrix4x4& m)
+	{
+		legacy::matrix4x4 result;
+		std::copy_n(m.data(), 16, result.data());
+		return result;
+	}
+
+	bool same(const matrix4x4& a, const legacy::matrix4x4& b)
+	{
+		return std::equal(a.data(), a.data() + 16, b.data());
+	}
+
+	bool near(const matrix4x4& a, const legacy::matrix4x4& b)
+	{
+		for(auto i = 0u; i < 16; ++i)
+		{
+			if(std::abs(a.at(i) - b.at(i)) > 1e-3f * std::max(1.0f, std::abs(b.at(i)))) return false;
+		}
+		return true;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(math_compat)
+
+BOOST_AUTO_TEST_CASE(layout_is_unchanged)
+{
+	BOOST_TEST(sizeof(vector2) == sizeof(legacy::vector2));
+	BOOST_TEST(sizeof(vector3) == sizeof(legacy::vector3));
+	BOOST_TEST(sizeof(vector4) == sizeof(legacy::vector4));
+	BOOST_TEST(sizeof(matrix4x4) == sizeof(legacy::matrix4x4));
+
+	// at(x, y) は x 列 y 行で、行優先の並び
+	const auto& values = uniform(0, 16);
+	const matrix4x4 m(values[0], values[1], values[2], values[3], values[4], values[5], values[6], values[7], values[8], values[9], values[10], values[11], values[12], values[13], values[14], values[15]);
+	const legacy::matrix4x4 old(values[0], values[1], values[2], values[3], values[4], values[5], values[6], values[7], values[8], values[9], values[10], values[11], values[12], values[13], values[14], values[15]);
+	for(auto x = 0u; x < 4; ++x)
+	{
+		for(auto y = 0u; y < 4; ++y) BOOST_TEST(m.at(uint64_t(x), uint64_t(y)) == old.at(uint64_t(x), uint64_t(y)));
+	}
+
+	BOOST_TEST(same(matrix4x4::identity(), legacy::matrix4x4::identity()));
+}
+
+BOOST_AUTO_TEST_CASE(vector_ops_match_bitwise)
+{
+	const auto& a = uniform(1, COUNT * 4);
+	const auto& b = uniform(2, COUNT * 4);
+	const auto& s = uniform(3, COUNT);
+
+	for(size_t i = 0; i < COUNT; ++i)
+	{
+		const auto* p = a.data() + i * 4;
+		const auto* q = b.data() + i * 4;
+
+		const vector3 v(p[0], p[1], p[2]);
+		const vector3 w(q[0], q[1], q[2]);
+		const legacy::vector3 ov(p[0], p[1], p[2]);
+		const legacy::vector3 ow(q[0], q[1], q[2]);
+
+		BOOST_TEST_REQUIRE(same(v + w, ov + ow));
+		BOOST_TEST_REQUIRE(same(v - w, ov - ow));
+		BOOST_TEST_REQUIRE(same(v * s[i], ov * s[i]));
+		BOOST_TEST_REQUIRE(same(-v, -ov));
+		BOOST_TEST_REQUIRE(same(v.cross(w), ov.cross(ow)));
+		BOOST_TEST_REQUIRE(v.dot(w) == ov.dot(ow));
+		BOOST_TEST_REQUIRE(v.length_square() == ov.length_square());
+
+		const vector4 v4(p[0], p[1], p[2], p[3]);
+		const vector4 w4(q[0], q[1], q[2], q[3]);
+		const legacy::vector4 ov4(p[0], p[1], p[2], p[3]);
+		const legacy::vector4 ow4(q[0], q[1], q[2], q[3]);
+
+		BOOST_TEST_REQUIRE(same(v4 + w4, ov4 + ow4));
+		BOOST_TEST_REQUIRE(same(v4 - w4, ov4 - ow4));
+		BOOST_TEST_REQUIRE(same(v4 * s[i], ov4 * s[i]));
+		BOOST_TEST_REQUIRE(v4.dot(w4) == ov4.dot(ow4));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(normalize_fixed)
+{
+	// 前の normalize() は length_square() で割っていたので、長さ 1 にならなかった
+	const vector3 v(3.0f, 4.0f, 12.0f);
+	auto old = legacy::vector3(3.0f, 4.0f, 12.0f);
+	old.normalize();
+
+	BOOST_TEST(v.normalized().length() == 1.0f, boost::test_tools::tolerance(1e-6f));
+	BOOST_TEST(old.length() == 13.0f / 169.0f, boost::test_tools::tolerance(1e-4f));
+	BOOST_TEST(vector3(0.0f).normalized().length_square() == 0.0f);
+}
+
+BOOST_AUTO_TEST_CASE(matrix_ops_match_transposed)
+{
+	const auto& a = uniform(4, COUNT * 16);
+	const auto& b = uniform(5, COUNT * 16);
+
+	auto load = [](const float* v)
+	{
+		matrix4x4 m;
+		std::copy_n(v, 16, m.data());
+		return m;
+	};
+
+	for(size_t i = 0; i < COUNT; ++i)
+	{
+		const auto& m = load(a.data() + i * 16);
+		const auto& n = load(b.data() + i * 16);
+		const auto& om = to_legacy(m);
+		const auto& on = to_legacy(n);
+
+		// 前の + と - は転置した和と差
+		BOOST_TEST_REQUIRE(same((m + n).transposed(), om + on));
+		BOOST_TEST_REQUIRE(same((m - n).transposed(), om - on));
+
+		// 前の m * n は (n * m) の転置 (足す順が違うので丸めの差は許す)
+		BOOST_TEST_REQUIRE(near((n * m).transposed(), om * on));
+	}
+
+	/*  今の積は行ベクトル形式の「m の後に n」  */
+	auto translate = matrix4x4::identity();
+	translate.at(12u) = 5.0f;
+	auto scale = matrix4x4::identity();
+	scale.at(0u) = 2.0f;
+
+	// 平行移動してから拡大すると、平行移動も 2 倍になる
+	BOOST_TEST((translate * scale).at(12u) == 10.0f);
+	BOOST_TEST((scale * translate).at(12u) == 5.0f);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,140 @@
+﻿#include "include.hpp"
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	// 16x16 マスの格子
+	void write_grid(const std::string& path)
+	{
+		constexpr uint32_t size = 17;
+
+		std::vector<vector3> positions;
+		std::vector<vertex> vertices;
+		for(auto y = 0u; y < size; ++y)
+		{
+			for(auto x = 0u; x < size; ++x)
+			{
+				positions.emplace_back(static_cast<float>(x), static_cast<float>(y), 0.0f);
+				vertices.emplace_back(positions.back(), vector4(1.0f));
+			}
+		}
+
+		std::vector<uint32_t> indices;
+		for(auto y = 0u; y + 1 < size; ++y)
+		{
+			for(auto x = 0u; x + 1 < size; ++x)
+			{
+				const auto& i = y * size + x;
+				indices.insert(indices.end(), { i, i + 1, i + size, i + 1, i + size + 1, i + size });
+			}
+		}
+
+		const auto& lods = core::build_lod_chain(positions, indices, 3);
+		const auto& meshlets = core::build_meshlets(positions, indices);
+		BOOST_TEST_REQUIRE(core::write_mesh_asset(path, vertices, positions, lods, meshlets));
+	}
+
+	std::vector<char> read_file(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		return std::vector<char>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	}
+
+	void write_file(const std::string& path, const std::vector<char>& bytes)
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(bytes.data(), gsl::narrow<std::streamsize>(bytes.size()));
+	}
+
+	// 元のファイルを func で書き換えたものが開けるか
+	template<class F> bool open_modified(const std::string& source, F&& func)
+	{
+		auto bytes = read_file(source);
+		auto* header = reinterpret_cast<core::mesh_asset_header*>(bytes.data());
+		func(*header, bytes);
+
+		const auto& path = source + ".modified";
+		write_file(path, bytes);
+
+		core::mesh_asset asset;
+		return asset.open(path);
+	}
+
+	template<class T> T* section_data(const core::mesh_asset_header& header, std::vector<char>& bytes, core::mesh_section type)
+	{
+		return reinterpret_cast<T*>(bytes.data() + header.sections.at(static_cast<size_t>(type)).offset);
+	}
+
+	const std::string& asset_path()
+	{
+		static const auto path = [] { auto p = (std::filesystem::temp_directory_path() / "mesh_asset_test.mesh").string(); write_grid(p); return p; }();
+		return path;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(mesh_asset)
+
+BOOST_AUTO_TEST_CASE(round_trip)
+{
+	core::mesh_asset asset;
+	BOOST_TEST_REQUIRE(asset.open(asset_path()));
+
+	BOOST_TEST(asset.vertices().size() == 17u * 17u);
+	BOOST_TEST(asset.lods().size() > 1u);
+	BOOST_TEST(asset.lods().front().index_count == 16u * 16u * 6u);
+	BOOST_TEST(asset.meshlets().size() == asset.cluster_bounds().size());
+	BOOST_TEST(!asset.meshlets().empty());
+
+	BOOST_TEST(open_modified(asset_path(), [](core::mesh_asset_header&, std::vector<char>&) {}));
+}
+
+BOOST_AUTO_TEST_CASE(rejects_bad_header)
+{
+	BOOST_TEST(!open_modified(asset_path(), [](core::mesh_asset_header& header, std::vector<char>&) { header.magic = 0; }));
+	BOOST_TEST(!open_modified(asset_path(), [](core::mesh_asset_header& header, std::vector<char>&) { header.vertex_stride += 4; }));
+	BOOST_TEST(!open_modified(asset_path(), [](core::mesh_asset_header& header, std::vector<char>&) { header.sections.at(0).offset += 4; }));
+	BOOST_TEST(!open_modified(asset_path(), [](core::mesh_asset_header& header, std::vector<char>& bytes) { header.sections.at(1).size = bytes.size(); }));
+}
+
+// 要素の大きさで割り切れないセクション
+BOOST_AUTO_TEST_CASE(rejects_partial_elements)
+{
+	for(const auto& type : { core::mesh_section::vertices, core::mesh_section::lods, core::mesh_section::meshlets, core::mesh_section::meshlet_bounds, core::mesh_section::meshlet_triangles })
+	{
+		BOOST_TEST(!open_modified(asset_path(), [&](core::mesh_asset_header& header, std::vector<char>&) { header.sections.at(static_cast<size_t>(type)).size -= 2; }), "section " << static_cast<uint32_t>(type));
+	}
+}
+
+// LOD とメッシュレットが指す範囲
+BOOST_AUTO_TEST_CASE(rejects_out_of_range_references)
+{
+	using core::mesh_section;
+
+	BOOST_TEST(!open_modified(asset_path(), [](core::mesh_asset_header& header, std::vector<char>& bytes)
+	{
+		// 最後の LOD はインデックスの末尾まで使っている
+		const auto& count = header.sections.at(static_cast<size_t>(mesh_section::lods)).size / sizeof(core::lod_level);
+		section_data<core::lod_level>(header, bytes, mesh_section::lods)[count - 1].index_count += 3;
+	}));
+	BOOST_TEST(!open_modified(asset_path(), [](core::mesh_asset_header& header, std::vector<char>& bytes)
+	{
+		// 足すとあふれる値
+		section_data<core::lod_level>(header, bytes, mesh_section::lods)[0].index_offset = std::numeric_limits<uint32_t>::max();
+	}));
+	BOOST_TEST(!open_modified(asset_path(), [](core::mesh_asset_header& header, std::vector<char>& bytes)
+	{
+		const auto& count = header.sections.at(static_cast<size_t>(mesh_section::meshlets)).size / sizeof(core::meshlet);
+		section_data<core::meshlet>(header, bytes, mesh_section::meshlets)[count - 1].vertex_count += 1;
+	}));
+	BOOST_TEST(!open_modified(asset_path(), [](core::mesh_asset_header& header, std::vector<char>& bytes)
+	{
+		section_data<core::meshlet>(header, bytes, mesh_section::meshlets)[0].triangle_offset = 1u << 30;
+	}));
+	BOOST_TEST(!open_modified(asset_path(), [](core::mesh_asset_header& header, std::vector<char>&)
+	{
+		// 境界の数がメッシュレットの数と合わない
+		header.sections.at(static_cast<size_t>(mesh_section::meshlet_bounds)).size -= sizeof(core::meshlet_bounds);
+	}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,125 @@
+﻿#include "include.hpp"
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	struct pooled
+	{
+		uint32_t id;
+	};
+
+	using pool_type = core::object_pool<pooled>;
+	using handle_type = pool_type::handle_type;
+}
+
+BOOST_AUTO_TEST_SUITE(object_pool)
+
+BOOST_AUTO_TEST_CASE(stale_handle_after_destroy_and_reuse)
+{
+	pool_type pool;
+	const auto& a = pool.create(pooled{ 1 });
+	BOOST_TEST(a.valid());
+	BOOST_TEST(pool.contains(a));
+	BOOST_TEST(pool.at(a).id == 1u);
+
+	BOOST_TEST(pool.destroy(a));
+	BOOST_TEST(!pool.contains(a));
+	BOOST_TEST(pool.get(a) == nullptr);
+
+	// 2回目の破棄は何もしない
+	BOOST_TEST(!pool.destroy(a));
+	BOOST_TEST(pool.empty());
+
+	// 同じスロットを使い回しても、世代が違うので古いハンドルでは引けない
+	const auto& b = pool.create(pooled{ 2 });
+	BOOST_TEST(b.index() == a.index());
+	BOOST_TEST(b.generation() != a.generation());
+	BOOST_TEST(!pool.contains(a));
+	BOOST_TEST(pool.get(a) == nullptr);
+	BOOST_TEST(!pool.destroy(a));
+	BOOST_TEST(pool.at(b).id == 2u);
+
+	// 既定のハンドルは無効
+	BOOST_TEST(!handle_type{}.valid());
+	BOOST_TEST(!pool.contains(handle_type{}));
+}
+
+BOOST_AUTO_TEST_CASE(clear_invalidates_all_handles)
+{
+	pool_type pool;
+	std::vector<handle_type> handles;
+	for(auto i = 0u; i < 8; ++i) handles.push_back(pool.create(pooled{ i }));
+
+	pool.clear();
+	BOOST_TEST(pool.empty());
+	for(const auto& h : handles) BOOST_TEST(!pool.contains(h));
+}
+
+// 途中の要素を消すと末尾の要素が移ってくるが、他のハンドルは同じものを指したまま
+BOOST_AUTO_TEST_CASE(swap_remove_keeps_other_handles_valid)
+{
+	constexpr uint32_t count = 64;
+
+	pool_type pool;
+	std::vector<handle_type> handles;
+	for(auto i = 0u; i < count; ++i) handles.push_back(pool.create(pooled{ i }));
+
+	// 先頭、途中、末尾を含めて偶数番目を消す
+	std::vector<bool> alive(count, true);
+	for(auto i = 0u; i < count; i += 2)
+	{
+		BOOST_TEST_REQUIRE(pool.destroy(handles[i]));
+		alive[i] = false;
+
+		for(auto j = 0u; j < count; ++j)
+		{
+			BOOST_TEST_REQUIRE(pool.contains(handles[j]) == alive[j]);
+			if(alive[j]) BOOST_TEST_REQUIRE(pool.at(handles[j]).id == j);
+		}
+	}
+	BOOST_TEST(pool.size() == count / 2);
+
+	// 配列は詰まったままで、handle_at() は各要素のハンドルを返す
+	std::vector<uint32_t> ids;
+	for(auto i = 0u; i < pool.size(); ++i)
+	{
+		const auto& h = pool.handle_at(i);
+		BOOST_TEST_REQUIRE(pool.get(h) == &pool.objects()[i]);
+		ids.push_back(pool.objects()[i].id);
+	}
+	std::sort(ids.begin(), ids.end());
+	for(auto i = 0u; i < ids.size(); ++i) BOOST_TEST(ids[i] == i * 2 + 1);
+}
+
+// 世代は 12bit なので 4095 の次は 1 に戻る (0 は無効ハンドル用)
+BOOST_AUTO_TEST_CASE(generation_wraps_in_12_bits)
+{
+	static_assert(handle_type::GENERATION_MASK == 0xFFF);
+
+	pool_type pool;
+	const auto& first = pool.create(pooled{ 0 });
+	BOOST_TEST(first.generation() == 1u);
+
+	auto h = first;
+	for(auto i = 1u; i < handle_type::GENERATION_MASK; ++i)
+	{
+		BOOST_TEST_REQUIRE(pool.destroy(h));
+
+		const auto& next = pool.create(pooled{ i });
+		BOOST_TEST_REQUIRE(next.index() == first.index());
+		BOOST_TEST_REQUIRE(next.generation() == i + 1);
+		BOOST_TEST_REQUIRE(!pool.contains(h));
+		h = next;
+	}
+	BOOST_TEST(h.generation() == handle_type::GENERATION_MASK);
+
+	// 一周すると 0 を飛ばして 1 に戻る。この時だけ最初のハンドルがまた通ってしまう
+	BOOST_TEST(pool.destroy(h));
+	const auto& wrapped = pool.create(pooled{ 0 });
+	BOOST_TEST(wrapped.generation() == 1u);
+	BOOST_TEST(wrapped.valid());
+	BOOST_TEST(!pool.contains(h));
+	BOOST_TEST((wrapped == first));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,55 @@
+﻿#include "include.hpp"
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(profiler)
+
+/*
+	書く側がリングを何周もしている間に frame() と write_chrome_trace() で読む
+	どのイベントも長さ 7 なので、上書き途中のスロットを読んで前後が混ざれば min と p99 がずれる
+*/
+BOOST_AUTO_TEST_CASE(reads_do_not_tear_while_ring_wraps)
+{
+	auto& profiler = core::profiler::get();
+	static constexpr char zone[] = "ring_wrap_test";
+	constexpr uint64_t length = 7;
+
+	std::atomic<bool> stop = false;
+	std::atomic<uint64_t> written = 0;
+	std::thread writer([&]
+	{
+		PROFILE_THREAD("ring writer");
+		for(uint64_t i = 1; !stop.load(std::memory_order_relaxed); ++i)
+		{
+			const auto& begin = i * 1000;
+			core::profiler::record(zone, begin, begin + length, static_cast<uint32_t>(i % 3));
+			written.store(i, std::memory_order_relaxed);
+		}
+	});
+
+	const auto& path = (std::filesystem::temp_directory_path() / "profiler_test_trace.json").string();
+
+	// 最低でもリングを数周するまで読み続ける
+	const auto& deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+	for(auto i = 0; written.load() < core::profiler::THREAD_CAPACITY * 4 || i < 50; ++i)
+	{
+		profiler.frame();
+		if(i % 10 == 0) BOOST_TEST(profiler.write_chrome_trace(path));
+		if(std::chrono::steady_clock::now() > deadline) break;
+	}
+
+	stop = true;
+	writer.join();
+	profiler.frame();
+
+	BOOST_TEST(written.load() > core::profiler::THREAD_CAPACITY);
+
+	const auto& summary = profiler.summary();
+	const auto& it = std::find_if(summary.begin(), summary.end(), [](const core::profile_summary& s) { return s.name == zone; });
+	BOOST_TEST_REQUIRE((it != summary.end()));
+	BOOST_TEST(it->count > 0u);
+	BOOST_TEST(it->min_ms == it->p99_ms);
+	// ticks_per_second() は呼ぶたびに較正し直すので少しずれる
+	BOOST_TEST(it->min_ms == length * 1000.0 / profiler.ticks_per_second(), boost::test_tools::tolerance(1e-3));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,135 @@
+﻿#include "include.hpp"
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	// 頂点を定数で作れること (コンパイルが通ればよい)
+	constexpr auto constant_normal = math::encode_octahedral(vector3(0.0f, 0.0f, -1.0f));
+	constexpr auto constant_decoded = math::decode_octahedral(constant_normal);
+	static_assert(math::to_half(1.0f) == 0x3c00u);
+	static_assert(math::encode_rgba8(vector4(1.0f, 0.0f, 0.0f, 1.0f)) == 0xff0000ffu);
+	static_assert(constant_decoded.z() < -0.99f);
+
+	std::vector<vector3> random_normals(uint64_t stream, size_t count)
+	{
+		std::vector<float> values(count * 3);
+		math::philox4x32(67, stream).fill_uniform(values, -1.0f, 1.0f);
+
+		std::vector<vector3> normals;
+		for(size_t i = 0; i < count; ++i)
+		{
+			const auto& v = vector3(values[i * 3 + 0], values[i * 3 + 1], values[i * 3 + 2]);
+			if(v.length_square() > 1e-4f) normals.push_back(v.normalized());
+		}
+		return normals;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(quantize)
+
+BOOST_AUTO_TEST_CASE(half_known_values)
+{
+	BOOST_TEST(math::to_half(0.0f) == 0x0000u);
+	BOOST_TEST(math::to_half(-0.0f) == 0x8000u);
+	BOOST_TEST(math::to_half(-2.0f) == 0xc000u);
+	BOOST_TEST(math::to_half(65504.0f) == 0x7bffu);
+
+	// 最大値を超えたら Inf、最小の非正規化数の半分は偶数丸めで 0
+	BOOST_TEST(math::to_half(65520.0f) == 0x7c00u);
+	BOOST_TEST(math::to_half(std::ldexp(1.0f, -24)) == 0x0001u);
+	BOOST_TEST(math::to_half(std::ldexp(1.0f, -25)) == 0x0000u);
+	BOOST_TEST(math::to_half(std::ldexp(3.0f, -25)) == 0x0002u);
+
+	// 正規化数の偶数丸め
+	BOOST_TEST(math::to_half(1.0f + std::ldexp(1.0f, -11)) == 0x3c00u);
+	BOOST_TEST(math::to_half(1.0f + std::ldexp(3.0f, -11)) == 0x3c02u);
+
+	BOOST_TEST(math::to_half(std::numeric_limits<float>::infinity()) == 0x7c00u);
+	BOOST_TEST(math::to_half(-std::numeric_limits<float>::infinity()) == 0xfc00u);
+	BOOST_TEST(std::isnan(math::from_half(math::to_half(std::numeric_limits<float>::quiet_NaN()))));
+}
+
+BOOST_AUTO_TEST_CASE(half_round_trip)
+{
+	// NaN 以外の全ての half は float を経由しても同じビットに戻る
+	for(uint32_t bits = 0; bits <= 0xffffu; ++bits)
+	{
+		const auto& half = gsl::narrow_cast<uint16_t>(bits);
+		if((half & 0x7c00u) == 0x7c00u && (half & 0x03ffu) != 0) continue;
+
+		BOOST_TEST_REQUIRE(math::to_half(math::from_half(half)) == half);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(normalized_integers)
+{
+	BOOST_TEST(math::to_unorm8(-1.0f) == 0u);
+	BOOST_TEST(math::to_unorm8(2.0f) == 255u);
+	BOOST_TEST(math::to_unorm8(0.5f) == 128u);
+	BOOST_TEST(math::to_unorm16(1.0f) == 65535u);
+	BOOST_TEST(math::to_snorm16(-2.0f) == -32767);
+	BOOST_TEST(math::to_snorm16(1.0f) == 32767);
+	BOOST_TEST(math::from_snorm16(-32768) == -1.0f);
+
+	for(auto i = 0; i <= 1000; ++i)
+	{
+		const auto& value = i / 1000.0f;
+		BOOST_TEST_REQUIRE(std::abs(math::from_unorm8(math::to_unorm8(value)) - value) <= 0.5f / 255.0f + 1e-6f);
+		BOOST_TEST_REQUIRE(std::abs(math::from_unorm16(math::to_unorm16(value)) - value) <= 0.5f / 65535.0f + 1e-7f);
+		BOOST_TEST_REQUIRE(std::abs(math::from_snorm16(math::to_snorm16(value * 2.0f - 1.0f)) - (value * 2.0f - 1.0f)) <= 0.5f / 32767.0f + 1e-7f);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(rgba8_byte_order)
+{
+	// R が最下位バイト (DXGI_FORMAT_R8G8B8A8_UNORM)
+	const auto& color = math::encode_rgba8(vector4(1.0f, 0.5f, 0.0f, 0.25f));
+	BOOST_TEST(color == 0x400080ffu);
+
+	const auto& decoded = math::decode_rgba8(color);
+	BOOST_TEST(decoded.x() == 1.0f);
+	BOOST_TEST(decoded.y() == 128.0f / 255.0f);
+	BOOST_TEST(decoded.z() == 0.0f);
+	BOOST_TEST(decoded.w() == 64.0f / 255.0f);
+
+	const auto& uv = math::encode_unorm16x2(vector2(0.0f, 1.0f));
+	BOOST_TEST(uv.at(0) == 0u);
+	BOOST_TEST(uv.at(1) == 65535u);
+
+	const auto& half4 = math::encode_half4(vector3(1.0f, -2.0f, 0.0f));
+	BOOST_TEST(half4.at(0) == 0x3c00u);
+	BOOST_TEST(half4.at(1) == 0xc000u);
+	BOOST_TEST(half4.at(2) == 0x0000u);
+	BOOST_TEST(half4.at(3) == 0x3c00u);
+}
+
+BOOST_AUTO_TEST_CASE(octahedral_round_trip)
+{
+	BOOST_TEST(math::encode_octahedral(vector3::zero()).at(0) == 0);
+	BOOST_TEST(math::encode_octahedral(vector3::zero()).at(1) == 0);
+
+	// 軸方向はそのまま戻る
+	for(const auto& axis : { vector3(1.0f, 0.0f, 0.0f), vector3(0.0f, -1.0f, 0.0f), vector3(0.0f, 0.0f, 1.0f), vector3(0.0f, 0.0f, -1.0f) })
+	{
+		const auto& decoded = math::decode_octahedral(math::encode_octahedral(axis));
+		BOOST_TEST(decoded.dot(axis) == 1.0f, boost::test_tools::tolerance(1e-6f));
+	}
+
+	// snorm16 x2 なら角度の誤差は 1e-4 rad 程度に収まる
+	float max_angle = 0.0f;
+	for(const auto& normal : random_normals(0, 10000))
+	{
+		const auto& decoded = math::decode_octahedral(math::encode_octahedral(normal));
+		BOOST_TEST_REQUIRE(decoded.length() == 1.0f, boost::test_tools::tolerance(1e-5f));
+		// 1 に近い内積に acos を使うと float の精度が足りないので外積の長さ (= sin) で測る
+		max_angle = std::max(max_angle, decoded.cross(normal).length());
+	}
+	BOOST_TEST(max_angle < 2e-4f);
+
+	// 定数式で作った値も実行時と同じ
+	const auto& runtime = math::encode_octahedral(vector3(0.0f, 0.0f, -1.0f));
+	BOOST_TEST(runtime.at(0) == constant_normal.at(0));
+	BOOST_TEST(runtime.at(1) == constant_normal.at(1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,116 @@
+﻿#include "include.hpp"
+#include <boost/test/unit_test.hpp>
+
+/*
+	philox4x32 の決定性と、簡単な統計的検定
+	種を固定しているので結果は毎回同じ (閾値は有意水準 0.1% 程度で取っている)
+*/
+BOOST_AUTO_TEST_SUITE(philox)
+
+BOOST_AUTO_TEST_CASE(fill_matches_sequential_draws)
+{
+	math::philox4x32 sequential(3, 5);
+	const math::philox4x32 random(3, 5);
+
+	// SSE の 8 ブロック単位と端数の両方を通る長さ
+	std::vector<uint32_t> values(1000);
+	random.fill(values);
+	for(size_t i = 0; i < values.size(); ++i)
+	{
+		BOOST_TEST_REQUIRE(values[i] == sequential());
+		BOOST_TEST_REQUIRE(values[i] == random.at(i));
+	}
+
+	// ブロックの途中から分けて埋めても同じ列になる
+	std::vector<uint32_t> split(values.size());
+	for(size_t begin = 0; begin < split.size(); begin += 37)
+	{
+		const size_t count = std::min<size_t>(37, split.size() - begin);
+		random.fill(gsl::span<uint32_t>(split).subspan(begin, count), begin);
+	}
+	BOOST_TEST(split == values, boost::test_tools::per_element());
+}
+
+BOOST_AUTO_TEST_CASE(streams_differ)
+{
+	std::vector<uint32_t> a(256);
+	std::vector<uint32_t> b(256);
+	math::philox4x32(7, 0).fill(a);
+	math::philox4x32(7, 1).fill(b);
+
+	size_t equal = 0;
+	for(size_t i = 0; i < a.size(); ++i) equal += a[i] == b[i];
+	BOOST_TEST(equal == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(uniform_float_moments)
+{
+	constexpr size_t count = 1 << 20;
+	std::vector<float> values(count);
+	math::philox4x32(11).fill_uniform(values, -2.0f, 6.0f);
+
+	double sum = 0.0;
+	double squares = 0.0;
+	for(const auto& value : values)
+	{
+		BOOST_TEST_REQUIRE(value >= -2.0f);
+		BOOST_TEST_REQUIRE(value < 6.0f);
+		sum += value;
+		squares += static_cast<double>(value) * value;
+	}
+
+	// 平均 2、分散 64 / 12。平均の標準誤差は sqrt(64 / 12 / count) ~ 0.0023
+	const auto& mean = sum / count;
+	const auto& variance = squares / count - mean * mean;
+	BOOST_TEST(std::abs(mean - 2.0) < 0.01);
+	BOOST_TEST(std::abs(variance - 64.0 / 12.0) < 0.05);
+}
+
+BOOST_AUTO_TEST_CASE(uniform_int_chi_square)
+{
+	constexpr size_t count = 1 << 20;
+	constexpr int32_t low = -8;
+	constexpr int32_t high = 7;
+	constexpr size_t bins = high - low + 1;
+
+	std::vector<int32_t> values(count);
+	math::philox4x32(13).fill_uniform(values, low, high);
+
+	std::array<size_t, bins> histogram = {};
+	for(const auto& value : values)
+	{
+		BOOST_TEST_REQUIRE(value >= low);
+		BOOST_TEST_REQUIRE(value <= high);
+		++histogram[value - low];
+	}
+
+	const auto& expected = static_cast<double>(count) / bins;
+	double chi_square = 0.0;
+	for(const auto& observed : histogram) chi_square += (observed - expected) * (observed - expected) / expected;
+
+	// 自由度 15 の 99.9% 点は 37.7
+	BOOST_TEST(chi_square < 37.7);
+}
+
+BOOST_AUTO_TEST_CASE(bits_are_balanced)
+{
+	constexpr size_t count = 1 << 16;
+	std::vector<uint32_t> values(count);
+	math::philox4x32(17).fill(values);
+
+	// 各ビットが立つ割合は 1/2 (標準偏差 sqrt(count) / 2 = 128)。隣り合う値の相関も見る
+	std::array<size_t, 32> ones = {};
+	double correlation = 0.0;
+	for(size_t i = 0; i < count; ++i)
+	{
+		for(auto bit = 0u; bit < 32; ++bit) ones[bit] += (values[i] >> bit) & 1;
+		if(i > 0) correlation += (values[i] / 4294967296.0 - 0.5) * (values[i - 1] / 4294967296.0 - 0.5);
+	}
+
+	for(const auto& count_set : ones) BOOST_TEST(std::abs(static_cast<double>(count_set) - count / 2.0) < 128.0 * 4.0);
+
+	// 1 / 12 で割って相関係数にする (標準誤差は 1 / sqrt(count) ~ 0.004)
+	BOOST_TEST(std::abs(correlation / (count - 1) * 12.0) < 0.02);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
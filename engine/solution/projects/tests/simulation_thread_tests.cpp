@@ -0,0 +1,146 @@
+﻿#include "include.hpp"
+#include <boost/test/unit_test.hpp>
+
+/*
+	ウィンドウを使わないメインループ (fake_window) で simulation_thread -> triple_buffer -> 描画側 の受け渡しを確かめる
+	時刻は manual_clock で進めるので、実時間には依存しない
+*/
+namespace
+{
+	// frames 回 update() したら閉じるウィンドウ
+	class fake_window final : public core::platform_window
+	{
+	public:
+		explicit fake_window(uint32_t frames) : m_remaining(frames) {}
+
+	public:
+		void update() noexcept override
+		{
+			if(m_remaining > 0) --m_remaining;
+			++m_updates;
+		}
+
+	public:
+		bool isloop() const noexcept override { return m_remaining > 0; }
+		uint32_t get_width() const noexcept override { return 1280; }
+		uint32_t get_height() const noexcept override { return 720; }
+
+		inline uint32_t updates() const noexcept { return m_updates; }
+
+	private:
+		uint32_t m_remaining;
+		uint32_t m_updates = 0;
+	};
+
+	constexpr uint64_t NO_TICK = std::numeric_limits<uint64_t>::max();
+
+	struct snapshot
+	{
+		uint64_t tick = NO_TICK;
+		double time = 0.0;		// tick の終わりのシミュレーション時刻 (秒)
+	};
+
+	constexpr double TICK_RATE = 60.0;
+	const auto PERIOD = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(1.0 / TICK_RATE));
+}
+
+BOOST_AUTO_TEST_SUITE(simulation_thread)
+
+BOOST_AUTO_TEST_CASE(one_tick_per_frame_with_manual_clock)
+{
+	core::manual_clock clock;
+	core::triple_buffer<snapshot> snapshots;
+
+	core::simulation_thread simulation(TICK_RATE, [&](uint64_t tick, double delta)
+	{
+		auto& back = snapshots.back();
+		back.tick = tick;
+		back.time = (tick + 1) * delta;
+		snapshots.publish();
+	}, clock);
+
+	// 最初の区切りを待ち始めるまで
+	uint64_t sleeps = 1;
+	clock.wait_for_sleeps(sleeps);
+	BOOST_TEST(simulation.tick_count() == 0u);
+	BOOST_TEST(!snapshots.acquire());
+
+	constexpr uint32_t frames = 120;
+	fake_window window(frames);
+
+	uint64_t frame = 0;
+	while(window.isloop())
+	{
+		window.update();
+
+		// 1フレームで 1 tick 分進め、シミュレーションが次の待ちに入るのを待ってから読む
+		clock.advance(PERIOD);
+		clock.wait_for_sleeps(++sleeps);
+
+		BOOST_TEST_REQUIRE(snapshots.acquire());
+		BOOST_TEST_REQUIRE(snapshots.front().tick == frame);
+		BOOST_TEST_REQUIRE(snapshots.front().time == (frame + 1) / TICK_RATE, boost::test_tools::tolerance(1e-12));
+		BOOST_TEST_REQUIRE(simulation.tick_count() == frame + 1);
+
+		// 次の tick まで新しい値はない
+		BOOST_TEST_REQUIRE(!snapshots.acquire());
+		++frame;
+	}
+
+	simulation.stop();
+	BOOST_TEST(window.updates() == frames);
+	BOOST_TEST(simulation.tick_count() == frames);
+	BOOST_TEST(simulation.dropped().count() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(slow_frames_see_latest_tick_and_drop_backlog)
+{
+	core::manual_clock clock;
+	core::triple_buffer<snapshot> snapshots;
+
+	core::simulation_thread simulation(TICK_RATE, [&](uint64_t tick, double)
+	{
+		snapshots.back().tick = tick;
+		snapshots.publish();
+	}, clock);
+
+	uint64_t sleeps = 1;
+	clock.wait_for_sleeps(sleeps);
+
+	/*  描画が 3.5 tick 分かかった: 3 tick 進み、描画側は最後の1つだけを見る  */
+	clock.advance(PERIOD * 3 + PERIOD / 2);
+	clock.wait_for_sleeps(++sleeps);
+	BOOST_TEST(simulation.tick_count() == 3u);
+	BOOST_TEST_REQUIRE(snapshots.acquire());
+	BOOST_TEST(snapshots.front().tick == 2u);
+
+	// 端数は次に持ち越す
+	clock.advance(PERIOD / 2);
+	clock.wait_for_sleeps(++sleeps);
+	BOOST_TEST(simulation.tick_count() == 4u);
+
+	/*  止まっていた (デバッガなど): MAX_CATCH_UP を超える分は捨てる  */
+	clock.advance(PERIOD * 20);
+	clock.wait_for_sleeps(++sleeps);
+	BOOST_TEST(simulation.tick_count() == 4u + core::simulation_thread::MAX_CATCH_UP);
+	BOOST_TEST(simulation.dropped() == PERIOD * (20 - core::simulation_thread::MAX_CATCH_UP));
+	BOOST_TEST_REQUIRE(snapshots.acquire());
+	BOOST_TEST(snapshots.front().tick == 3u + core::simulation_thread::MAX_CATCH_UP);
+}
+
+BOOST_AUTO_TEST_CASE(stop_wakes_waiting_thread)
+{
+	// 時刻が進まなくても stop() で待ちから抜ける
+	core::manual_clock clock;
+	std::atomic<uint64_t> ticks = 0;
+
+	core::simulation_thread simulation(TICK_RATE, [&](uint64_t, double) { ++ticks; }, clock);
+	clock.wait_for_sleeps(1);
+
+	simulation.stop();
+	simulation.stop();
+	BOOST_TEST(ticks.load() == 0u);
+	BOOST_TEST(clock.sleep_count() == 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,143 @@
+﻿#include "include.hpp"
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	using core::residency_action;
+	using core::residency_command;
+
+	bool contains(const std::vector<residency_command>& commands, core::texture_id id, uint32_t mip, residency_action action)
+	{
+		return std::any_of(commands.begin(), commands.end(), [&](const residency_command& c) { return c.texture == id && c.mip == mip && c.action == action; });
+	}
+
+	// 出した load を全部完了させる
+	void complete(core::texture_residency& residency, const std::vector<residency_command>& commands)
+	{
+		for(const auto& command : commands)
+		{
+			if(command.action == residency_action::load) residency.on_loaded(command.texture, command.mip);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(texture_residency)
+
+BOOST_AUTO_TEST_CASE(loads_one_mip_per_update)
+{
+	core::fixed_memory_budget budget(1 << 20);
+	core::texture_residency residency(&budget);
+
+	const std::array<uint64_t, 3> mips = { 400, 100, 20 };
+	const auto& id = residency.add(mips, 2);
+	BOOST_TEST(residency.usage() == 20u);
+
+	std::vector<residency_command> commands;
+	for(uint64_t frame = 1; frame <= 3; ++frame)
+	{
+		residency.request(id, 0, frame);
+		commands.clear();
+		residency.update(frame, commands, 4);
+		complete(residency, commands);
+	}
+
+	BOOST_TEST(residency.resident_mip(id) == 0u);
+	BOOST_TEST(residency.usage() == 520u);
+
+	residency.remove(id);
+	BOOST_TEST(residency.usage() == 0u);
+}
+
+// 予算が足りなければ、このフレームで使っていないテクスチャから追い出す
+BOOST_AUTO_TEST_CASE(evicts_least_recently_used)
+{
+	core::fixed_memory_budget budget(1 << 20);
+	core::texture_residency residency(&budget);
+
+	const std::array<uint64_t, 3> mips = { 400, 100, 20 };
+	const auto& a = residency.add(mips, 2);
+	const auto& b = residency.add(mips, 2);
+
+	std::vector<residency_command> commands;
+	residency.request(a, 1, 1);
+	residency.update(1, commands, 4);
+	complete(residency, commands);
+	BOOST_TEST(residency.usage() == 140u);
+
+	// b だけを使い、a の mip 1 を追い出さないと入らない予算にする
+	budget.set_budget(200);
+	commands.clear();
+	residency.request(b, 1, 3);
+	residency.update(3, commands, 4);
+
+	BOOST_TEST(contains(commands, a, 1, residency_action::evict));
+	BOOST_TEST(contains(commands, b, 1, residency_action::load));
+	complete(residency, commands);
+
+	BOOST_TEST(residency.resident_mip(a) == 2u);
+	BOOST_TEST(residency.resident_mip(b) == 1u);
+	BOOST_TEST(residency.usage() == 140u);
+}
+
+// 読み込むテクスチャ自身のミップは追い出さない (追い出すと常駐の段が抜け、使用量が合わなくなる)
+BOOST_AUTO_TEST_CASE(does_not_evict_load_candidate)
+{
+	core::fixed_memory_budget budget(1 << 20);
+	core::texture_residency residency(&budget);
+
+	const std::array<uint64_t, 3> mips = { 400, 100, 20 };
+	const auto& id = residency.add(mips, 2);
+
+	std::vector<residency_command> commands;
+	residency.request(id, 0, 1);
+	residency.update(1, commands, 4);
+	complete(residency, commands);
+	BOOST_TEST(residency.resident_mip(id) == 1u);
+	BOOST_TEST(residency.usage() == 120u);
+
+	// 次のフレームは request せずに update する (前のフレームの要求のまま候補になり、追い出しの対象にもなる)
+	budget.set_budget(450);
+	commands.clear();
+	residency.update(2, commands, 4);
+	complete(residency, commands);
+
+	BOOST_TEST(!contains(commands, id, 1, residency_action::evict));
+	BOOST_TEST(!contains(commands, id, 0, residency_action::load));
+	BOOST_TEST(residency.resident_mip(id) == 1u);
+	BOOST_TEST(residency.usage() == 120u);
+
+	// 予算が戻れば読み込める
+	budget.set_budget(1 << 20);
+	commands.clear();
+	residency.request(id, 0, 3);
+	residency.update(3, commands, 4);
+	complete(residency, commands);
+	BOOST_TEST(residency.resident_mip(id) == 0u);
+	BOOST_TEST(residency.usage() == 520u);
+
+	residency.remove(id);
+	BOOST_TEST(residency.usage() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(bc_block_bytes_covers_all_bc_formats)
+{
+	for(const auto& format : { DXGI_FORMAT_BC1_TYPELESS, DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_BC1_UNORM_SRGB, DXGI_FORMAT_BC4_TYPELESS, DXGI_FORMAT_BC4_UNORM, DXGI_FORMAT_BC4_SNORM })
+	{
+		BOOST_TEST(core::bc_block_bytes(format) == 8u, "format " << format);
+	}
+
+	for(const auto& format : {
+		DXGI_FORMAT_BC2_TYPELESS, DXGI_FORMAT_BC2_UNORM, DXGI_FORMAT_BC2_UNORM_SRGB,
+		DXGI_FORMAT_BC3_TYPELESS, DXGI_FORMAT_BC3_UNORM, DXGI_FORMAT_BC3_UNORM_SRGB,
+		DXGI_FORMAT_BC5_TYPELESS, DXGI_FORMAT_BC5_UNORM, DXGI_FORMAT_BC5_SNORM,
+		DXGI_FORMAT_BC6H_TYPELESS, DXGI_FORMAT_BC6H_UF16, DXGI_FORMAT_BC6H_SF16,
+		DXGI_FORMAT_BC7_TYPELESS, DXGI_FORMAT_BC7_UNORM, DXGI_FORMAT_BC7_UNORM_SRGB })
+	{
+		BOOST_TEST(core::bc_block_bytes(format) == 16u, "format " << format);
+	}
+
+	BOOST_TEST(core::bc_block_bytes(DXGI_FORMAT_R8G8B8A8_UNORM) == 0u);
+	BOOST_TEST(core::bc_block_bytes(DXGI_FORMAT_B5G6R5_UNORM) == 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,113 @@
+﻿#include "include.hpp"
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	constexpr uint64_t GRANULARITY = 4096;
+	constexpr uint64_t CAPACITY = 64ull * 1024 * 1024;
+
+	struct live_allocation
+	{
+		core::tlsf_allocation allocation;
+		uint64_t requested;
+	};
+
+	// 使用中の範囲がすべて重ならず、統計と列挙が一致する
+	void check_consistent(const core::tlsf_allocator& allocator, const std::vector<live_allocation>& live)
+	{
+		std::vector<std::pair<uint64_t, uint64_t>> ranges;
+		uint64_t used = 0;
+		for(const auto& entry : live)
+		{
+			ranges.emplace_back(entry.allocation.offset, entry.allocation.offset + entry.allocation.size);
+			used += entry.allocation.size;
+		}
+		std::sort(ranges.begin(), ranges.end());
+
+		for(size_t i = 1; i < ranges.size(); ++i) BOOST_TEST_REQUIRE(ranges[i - 1].second <= ranges[i].first);
+		if(!ranges.empty()) BOOST_TEST_REQUIRE(ranges.back().second <= CAPACITY);
+
+		const auto& stats = allocator.get_stats();
+		BOOST_TEST_REQUIRE(stats.used == used);
+		BOOST_TEST_REQUIRE(stats.allocations == live.size());
+		BOOST_TEST_REQUIRE(stats.largest_free <= CAPACITY - used);
+
+		std::vector<std::pair<uint64_t, uint64_t>> enumerated;
+		allocator.for_each_allocation([&](const core::tlsf_allocation& allocation, uint64_t) { enumerated.emplace_back(allocation.offset, allocation.offset + allocation.size); });
+		BOOST_TEST_REQUIRE((enumerated == ranges));
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(tlsf_allocator)
+
+BOOST_AUTO_TEST_CASE(rejects_too_large)
+{
+	core::tlsf_allocator allocator(CAPACITY, GRANULARITY);
+
+	BOOST_TEST(!allocator.allocate(CAPACITY + 1).valid());
+
+	const auto& all = allocator.allocate(CAPACITY);
+	BOOST_TEST(all.valid());
+	BOOST_TEST(!allocator.allocate(1).valid());
+
+	allocator.free(all);
+	BOOST_TEST(allocator.empty());
+	BOOST_TEST(allocator.get_stats().largest_free == CAPACITY);
+}
+
+// 乱数で確保・解放を繰り返し、毎回、重なりと統計を調べる。全部解放すれば1つの空きブロックに戻る
+BOOST_AUTO_TEST_CASE(fuzz)
+{
+	core::tlsf_allocator allocator(CAPACITY, GRANULARITY);
+	math::philox4x32 random(32);
+
+	std::vector<live_allocation> live;
+	uint32_t failures = 0;
+
+	for(uint32_t step = 0; step < 20000; ++step)
+	{
+		const auto& allocate = live.empty() || random() % 100 < 55;
+		if(allocate)
+		{
+			// 小さいもの (テクスチャのミップ末尾) と大きいもの (4 MiB まで) を混ぜる
+			const auto& size = random() % 4 == 0 ? uint64_t(random() % (4u << 20)) + 1 : uint64_t(random() % (64u << 10)) + 1;
+			const auto& alignment = random() % 2 == 0 ? GRANULARITY : uint64_t(64 * 1024);
+
+			const auto& allocation = allocator.allocate(size, alignment, step);
+			if(!allocation.valid())
+			{
+				++failures;
+				continue;
+			}
+
+			BOOST_TEST_REQUIRE(allocation.offset % alignment == 0u);
+			BOOST_TEST_REQUIRE(allocation.offset % GRANULARITY == 0u);
+			BOOST_TEST_REQUIRE(allocation.size % GRANULARITY == 0u);
+			BOOST_TEST_REQUIRE(allocation.size >= size);
+			BOOST_TEST_REQUIRE(allocation.size < size + GRANULARITY);
+			live.push_back(live_allocation{ allocation, size });
+		}
+		else
+		{
+			const auto& index = random() % live.size();
+			allocator.free(live[index].allocation);
+			live[index] = live.back();
+			live.pop_back();
+		}
+
+		if(step % 97 == 0) check_consistent(allocator, live);
+	}
+
+	// 半分以上埋まるまで回っている
+	BOOST_TEST(failures > 0u);
+	check_consistent(allocator, live);
+
+	for(const auto& entry : live) allocator.free(entry.allocation);
+
+	const auto& stats = allocator.get_stats();
+	BOOST_TEST(stats.used == 0u);
+	BOOST_TEST(stats.free_blocks == 1u);
+	BOOST_TEST(stats.largest_free == CAPACITY);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,71 @@
+﻿#include "include.hpp"
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	matrix4x4 translation(float x, float y, float z)
+	{
+		auto m = matrix4x4::identity();
+		m.at(12u) = x;
+		m.at(13u) = y;
+		m.at(14u) = z;
+		return m;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(transform_hierarchy)
+
+BOOST_AUTO_TEST_CASE(world_accumulates_parents)
+{
+	core::transform_hierarchy hierarchy;
+	const auto& root = hierarchy.create(translation(1.0f, 0.0f, 0.0f));
+	const auto& child = hierarchy.create(translation(0.0f, 2.0f, 0.0f), root, 1);
+	const auto& grandchild = hierarchy.create(translation(0.0f, 0.0f, 3.0f), child, 0);
+
+	std::vector<matrix4x4> instances(2, matrix4x4::identity());
+	hierarchy.update(instances);
+
+	BOOST_TEST(hierarchy.depth_count() == 3u);
+	BOOST_TEST(hierarchy.world(grandchild).at(12u) == 1.0f);
+	BOOST_TEST(hierarchy.world(grandchild).at(13u) == 2.0f);
+	BOOST_TEST(hierarchy.world(grandchild).at(14u) == 3.0f);
+	BOOST_TEST(instances[0].at(14u) == 3.0f);
+	BOOST_TEST(instances[1].at(13u) == 2.0f);
+
+	// 親を動かすと子孫も付いてくる
+	hierarchy.set_local(root, translation(5.0f, 0.0f, 0.0f));
+	hierarchy.update(instances);
+	BOOST_TEST(instances[0].at(12u) == 5.0f);
+	BOOST_TEST(instances[1].at(12u) == 5.0f);
+}
+
+BOOST_AUTO_TEST_CASE(destroy_kills_subtree_immediately)
+{
+	core::transform_hierarchy hierarchy;
+	const auto& root = hierarchy.create(matrix4x4::identity());
+	const auto& other = hierarchy.create(matrix4x4::identity());
+	const auto& child = hierarchy.create(matrix4x4::identity(), root);
+	const auto& grandchild = hierarchy.create(matrix4x4::identity(), child);
+
+	// 並びが深さ順でない状態 (親の付け替え後) でも子孫を辿れる
+	hierarchy.set_parent(root, other);
+	hierarchy.destroy(root);
+
+	BOOST_TEST(!hierarchy.alive(root));
+	BOOST_TEST(!hierarchy.alive(child));
+	BOOST_TEST(!hierarchy.alive(grandchild));
+	BOOST_TEST(hierarchy.alive(other));
+
+	hierarchy.update({});
+	BOOST_TEST(hierarchy.size() == 1u);
+	BOOST_TEST(hierarchy.alive(other));
+
+	// 空いたスロットは世代を進めて使い回す
+	const auto& reused = hierarchy.create(matrix4x4::identity(), other);
+	BOOST_TEST(hierarchy.alive(reused));
+	BOOST_TEST(!hierarchy.alive(root));
+	BOOST_TEST(!hierarchy.alive(child));
+	BOOST_TEST(!hierarchy.alive(grandchild));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
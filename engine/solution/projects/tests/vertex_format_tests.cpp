@@ -0,0 +1,77 @@
+﻿#include "include.hpp"
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	using full_stream = vertex_stream<0,
+		vertex_attribute::position_f32,
+		vertex_attribute::normal_oct16,
+		vertex_attribute::texcoord_unorm16,
+		vertex_attribute::color_rgba8>;
+
+	// パイプラインと同じく定数として作れること
+	constexpr auto layout = input_layout<vertex_layout, world_instance_stream>::elements();
+	static_assert(layout.size() == 6);
+
+	void check_element(const D3D12_INPUT_ELEMENT_DESC& element, std::string_view semantic, uint32_t index, DXGI_FORMAT format, uint32_t slot, uint32_t offset, D3D12_INPUT_CLASSIFICATION classification, uint32_t step_rate)
+	{
+		BOOST_TEST(std::string_view(element.SemanticName) == semantic);
+		BOOST_TEST(element.SemanticIndex == index);
+		BOOST_TEST(element.Format == format);
+		BOOST_TEST(element.InputSlot == slot);
+		BOOST_TEST(element.AlignedByteOffset == offset);
+		BOOST_TEST(element.InputSlotClass == classification);
+		BOOST_TEST(element.InstanceDataStepRate == step_rate);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(vertex_format)
+
+BOOST_AUTO_TEST_CASE(stream_offsets)
+{
+	// 12 + 4 + 4 + 4
+	BOOST_TEST(full_stream::stride == 24u);
+	BOOST_TEST(full_stream::count == 4u);
+
+	const auto& elements = full_stream::elements();
+	check_element(elements.at(0), "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0);
+	check_element(elements.at(1), "NORMAL", 0, DXGI_FORMAT_R16G16_SNORM, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0);
+	check_element(elements.at(2), "TEXCOORD", 0, DXGI_FORMAT_R16G16_UNORM, 0, 16, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0);
+	check_element(elements.at(3), "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, 20, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0);
+}
+
+BOOST_AUTO_TEST_CASE(standard_input_layout)
+{
+	BOOST_TEST(vertex_layout::stride == sizeof(vertex));
+	BOOST_TEST(world_instance_stream::stride == sizeof(matrix4x4));
+
+	// 頂点ストリームの後にインスタンスストリームが続く
+	check_element(layout.at(0), "POSITION", 0, DXGI_FORMAT_R16G16B16A16_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0);
+	check_element(layout.at(1), "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, 8, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0);
+	for(auto row = 0u; row < 4; ++row)
+	{
+		check_element(layout.at(2 + row), "WORLD", row, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, row * 16, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(vertex_encoding)
+{
+	// vertex は vertex_layout の並びどおりにエンコードした値を持つ
+	const vertex v(vector3(1.0f, -2.0f, 0.5f), vector4(1.0f, 0.0f, 0.0f, 1.0f));
+
+	std::array<std::byte, sizeof(vertex)> bytes{};
+	std::memcpy(bytes.data(), &v, sizeof(vertex));
+
+	std::array<uint16_t, 4> position{};
+	uint32_t color = 0;
+	std::memcpy(position.data(), bytes.data() + layout.at(0).AlignedByteOffset, sizeof(position));
+	std::memcpy(&color, bytes.data() + layout.at(1).AlignedByteOffset, sizeof(color));
+
+	BOOST_TEST(position.at(0) == math::to_half(1.0f));
+	BOOST_TEST(position.at(1) == math::to_half(-2.0f));
+	BOOST_TEST(position.at(2) == math::to_half(0.5f));
+	BOOST_TEST(position.at(3) == math::to_half(1.0f));
+	BOOST_TEST(color == 0xff0000ffu);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file